@@ -0,0 +1,92 @@
+#include "renderer/FrustumCuller.h"
+#include "renderer/Scene.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// FrustumCullBenchmark [objects] [iterations]
+//
+// Culls a random scene (about a third of it visible) with every SIMD level
+// the CPU supports, single-threaded and on the thread pool, and prints the
+// best time of `iterations` runs as objects per millisecond.
+
+namespace {
+
+void perspectivePlanes(float planes[6][4]) {
+    // 90 degree FOV, aspect 1, near 0.1, far 1000, camera at the origin looking down +z
+    const float n = 0.1f;
+    const float f = 1000.0f;
+    const float matrix[16] = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, f / (f - n), 1.0f,
+        0.0f, 0.0f, -f * n / (f - n), 0.0f,
+    };
+    FrustumCuller::extractPlanes(matrix, planes);
+}
+
+template <typename Fn>
+double bestMs(uint32_t iterations, Fn&& fn) {
+    double best = 1e30;
+    for (uint32_t i = 0; i < iterations; i++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count());
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char** argv) {
+    uint32_t objectCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 500000;
+    uint32_t iterations = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 50;
+
+    Scene scene;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> lateral(-800.0f, 800.0f);
+    std::uniform_real_distribution<float> depth(-200.0f, 1000.0f);
+    std::uniform_real_distribution<float> size(0.5f, 4.0f);
+    for (uint32_t i = 0; i < objectCount; i++) {
+        Entity entity = scene.createEntity(RENDERABLE_COMPONENTS);
+        BoundsComponent bounds;
+        bounds.center[0] = lateral(rng);
+        bounds.center[1] = lateral(rng);
+        bounds.center[2] = depth(rng);
+        bounds.radius = size(rng);
+        scene.setBounds(entity, bounds);
+    }
+
+    float planes[6][4];
+    perspectivePlanes(planes);
+
+    ThreadPool pool;
+    std::cout << "Frustum culling " << objectCount << " spheres in " << scene.getStats().chunkCount
+              << " chunks, best of " << iterations << " (" << pool.getThreadSlotCount() << " threads)" << std::endl;
+
+    SimdLevel detected = FrustumCuller::detectSimdLevel();
+    for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::Sse41, SimdLevel::Avx2 }) {
+        if (level > detected) {
+            continue;
+        }
+
+        FrustumCuller culler(level);
+        SceneCullResult result;
+        double serialMs = bestMs(iterations, [&]() { culler.cull(planes, scene, nullptr, result); });
+        double parallelMs = bestMs(iterations, [&]() { culler.cull(planes, scene, &pool, result); });
+
+        std::cout << std::left << std::setw(8) << FrustumCuller::simdLevelName(level) << std::right << std::fixed
+                  << std::setprecision(3)
+                  << " 1 thread: " << std::setw(8) << serialMs << " ms, " << std::setw(8) << std::setprecision(0)
+                  << (objectCount / serialMs) << " objects/ms"
+                  << " | pool: " << std::setw(8) << std::setprecision(3) << parallelMs << " ms, " << std::setw(8)
+                  << std::setprecision(0) << (objectCount / parallelMs) << " objects/ms"
+                  << " | visible " << result.visible.size() << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+#version 450
+
+// Per-vertex position; everything else comes from the instance buffer
+layout(location = 0) in vec3 inPosition;
+
+// Output to fragment shader
+layout(location = 0) out vec3 fragColor;
+
+struct Instance {
+    vec4 positionScale;     // xyz = world position, w = uniform scale
+    vec4 color;
+    uint meshIndex;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances { Instance instances[]; };
+
+layout(push_constant) uniform DrawParams {
+    mat4 viewProjection;
+} params;
+
+void main() {
+    // firstInstance of each indirect command is the instance index
+    Instance instance = instances[gl_InstanceIndex];
+
+    vec3 worldPosition = inPosition * instance.positionScale.w + instance.positionScale.xyz;
+    gl_Position = params.viewProjection * vec4(worldPosition, 1.0);
+    fragColor = instance.color.rgb;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+// Per-instance data in draw order: a TransformComponent. 32 bytes, usable as
+// a per-instance vertex stream or a std430 array.
+struct DrawInstance {
+    float position[3];
+    float scale;
+    float rotation[4];      // Quaternion xyzw
+};
+
+/**
+ * IDrawBackend - Where the renderer's sorted draws end up
+ *
+ * IDs are the renderer's own (material table, MeshComponent::meshIndex); the
+ * backend maps them to API objects. Calls arrive in submission order between
+ * beginDraws() and endDraws(), once per frame, and only when state actually
+ * changes: a bind stays in effect until the next bind of the same kind, except
+ * that binding a pipeline invalidates the bound material. The renderer merges
+ * draws of the same mesh and material, so one draw may cover many instances.
+ */
+class IDrawBackend {
+public:
+    virtual ~IDrawBackend() = default;
+
+    virtual void beginDraws() = 0;
+    // The frame's instances, before any draw; draw() ranges index into them.
+    // Only valid for the duration of the call.
+    virtual void setInstances(const DrawInstance* instances, uint32_t count) = 0;
+    virtual void bindPipeline(uint32_t pipeline) = 0;
+    virtual void bindMaterial(uint32_t material) = 0;
+    virtual void bindMesh(uint32_t mesh) = 0;
+    // Draws the bound mesh instanceCount times starting at instance firstInstance
+    virtual void draw(uint32_t firstInstance, uint32_t instanceCount) = 0;
+    virtual void endDraws() = 0;
+};
@@ -22,6 +22,7 @@ public:
     
     virtual bool shouldClose() const = 0;
     virtual void pollEvents() = 0;
+    virtual void waitEvents() = 0;     // Blocks until at least one event arrived
     virtual int getWidth() const = 0;
     virtual int getHeight() const = 0;
     virtual void* getNativeHandle() const = 0;
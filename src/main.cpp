@@ -13,8 +13,62 @@
 #include "vulkan/VulkanContext.h"
 #include "renderer/Renderer.h"
 #include "utils/Logger.h"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Renders a fixed number of offscreen frames and reports throughput.
+// Needs no display, so it also runs on render farm nodes and in CI.
+static int runHeadless(uint32_t frames, uint32_t framesInFlight) {
+    VulkanContextConfig config;
+    config.headless = true;
+    config.framesInFlight = framesInFlight;
+    config.width = 1920;
+    config.height = 1080;
+    if (const char* device = std::getenv("HYBRID_DEVICE")) {
+        config.device = device;
+    }
+
+    VulkanContext vulkanContext(nullptr, config);
+    vulkanContext.initialize();
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < frames; i++) {
+        vulkanContext.beginFrame();
+        vulkanContext.endFrame();
+    }
+    vulkanContext.waitIdle();
+
+    double seconds = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    std::cout << "Headless: " << frames << " frames in " << seconds << " s ("
+              << (frames / seconds) << " FPS)" << std::endl;
+
+    GpuProfiler& profiler = vulkanContext.getGpuProfiler();
+    std::cout << "GPU frame: " << profiler.getAveragePassMs("frame") << " ms avg, CPU waited "
+              << vulkanContext.getFramePacingStats().averageCpuWaitMs() << " ms avg ("
+              << framesInFlight << " frames in flight)" << std::endl;
+    profiler.writeJson("gpu_timings.json");
+
+    vulkanContext.cleanup();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // --headless [frames] [framesInFlight]: offscreen benchmark, no window
+    if (argc > 1 && std::strcmp(argv[1], "--headless") == 0) {
+        try {
+            uint32_t frames = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 1000;
+            uint32_t framesInFlight = argc > 3 ? static_cast<uint32_t>(std::stoul(argv[3])) : 2;
+            return runHeadless(frames, framesInFlight);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "=== FATAL ERROR ===" << std::endl;
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
 
-int main() {
     try {
 		std::cout << "=== Hybrid Renderer Starting ===" << std::endl;
         std::cout << std::endl;
@@ -24,9 +78,21 @@ int main() {
         GLFWWindow window(1920, 1080, "Hybrid Renderer");
         std::cout << std::endl;
 
+        // --hot-reload: recompile edited shaders while running
+        VulkanContextConfig config;
+        config.shaderHotReload = argc > 1 && std::strcmp(argv[1], "--hot-reload") == 0;
+        // HYBRID_DEVICE=<index|name>: run on a specific adapter
+        if (const char* device = std::getenv("HYBRID_DEVICE")) {
+            config.device = device;
+        }
+#ifdef HYBRID_SHADER_SOURCE_DIR
+        config.shaderSourceDir = HYBRID_SHADER_SOURCE_DIR;
+        config.shaderCompiler = HYBRID_GLSLC;
+#endif
+
         // Create Vulkan context
         std::cout << "Creating Vulkan context..." << std::endl;
-        VulkanContext vulkanContext(&window);
+        VulkanContext vulkanContext(&window, config);
         std::cout << std::endl;
 
         // Create renderer
@@ -37,6 +103,7 @@ int main() {
         // Initialize
         std::cout << "Initializing renderer..." << std::endl;
         renderer.initialize();
+        renderer.setThreadPool(&vulkanContext.getThreadPool());
         std::cout << std::endl;
 
         std::cout << "=== Initialization Complete ===" << std::endl;
@@ -53,6 +120,7 @@ int main() {
 
         while (!window.shouldClose()) {
             window.pollEvents();
+            vulkanContext.getLatencyTracker().markInput();
 
             // Test input
             if (window.isKeyPressed(Key::W)) {
@@ -71,7 +139,12 @@ int main() {
 
             if (elapsed.count() >= 1000) {
                 float fps = frameCount / (elapsed.count() / 1000.0f);
-                std::cout << "FPS: " << fps << " | Frames: " << frameCount << std::endl;
+                std::cout << "FPS: " << fps << " | Frames: " << frameCount
+                          << " | GPU: " << vulkanContext.getGpuProfiler().getPassMs("frame") << " ms"
+                          << " | CPU wait: " << vulkanContext.getFramePacingStats().lastCpuWaitMs << " ms"
+                          << " | Input->present: " << vulkanContext.getLatencyTracker().getStats().averageInputToPresentMs
+                          << " ms | Compile stall: " << vulkanContext.getLastFrameCompileStallMs()
+                          << " ms" << std::endl;
 
                 frameCount = 0;
                 lastPrintTime = now;
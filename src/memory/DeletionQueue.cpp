@@ -0,0 +1,46 @@
+#include "DeletionQueue.h"
+#include <vector>
+
+DeletionQueue::~DeletionQueue() {
+    flushAll();
+}
+
+void DeletionQueue::push(uint64_t serial, Deleter deleter) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Keep the queue sorted so flush() can stop at the first pending entry
+    if (!entries.empty() && serial < entries.back().serial) {
+        serial = entries.back().serial;
+    }
+    entries.push_back({ serial, std::move(deleter) });
+}
+
+size_t DeletionQueue::flush(uint64_t completedSerial) {
+    std::vector<Deleter> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!entries.empty() && entries.front().serial <= completedSerial) {
+            ready.push_back(std::move(entries.front().deleter));
+            entries.pop_front();
+        }
+    }
+
+    for (Deleter& deleter : ready) {
+        deleter();
+    }
+    return ready.size();
+}
+
+size_t DeletionQueue::flushAll() {
+    // Deleters may queue further deletions; drain until empty
+    size_t count = 0;
+    while (!empty()) {
+        count += flush(UINT64_MAX);
+    }
+    return count;
+}
+
+size_t DeletionQueue::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
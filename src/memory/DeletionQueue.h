@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+/**
+ * DeletionQueue - Defers resource destruction until the GPU is done with it
+ *
+ * Every deleter is tagged with the serial of the last frame (or other GPU
+ * submission) that may still reference the resource. flush() runs, in push
+ * order, every deleter whose serial has completed. Serials only move
+ * forward: a deleter pushed with an older serial than the queue's newest is
+ * held back until that newer serial completes, which is always safe.
+ *
+ * Thread-safe. Deleters run on the flushing thread, outside the lock, so
+ * they may push new entries.
+ */
+class DeletionQueue {
+public:
+    using Deleter = std::function<void()>;
+
+    DeletionQueue() = default;
+    ~DeletionQueue();
+
+    DeletionQueue(const DeletionQueue&) = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+    void push(uint64_t serial, Deleter deleter);
+
+    // Runs the deleters of every serial <= completedSerial; returns how many ran
+    size_t flush(uint64_t completedSerial);
+
+    // Runs everything; only valid once the device is idle
+    size_t flushAll();
+
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+
+private:
+    struct Entry {
+        uint64_t serial;
+        Deleter deleter;
+    };
+
+    std::deque<Entry> entries;      // Non-decreasing serials
+    mutable std::mutex mutex;
+};
@@ -0,0 +1,89 @@
+#include "RingAllocator.h"
+#include <stdexcept>
+
+namespace {
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}
+
+RingAllocator::RingAllocator(uint64_t capacity)
+    : capacity(capacity)
+    , head(0)
+    , tail(0)
+    , usedBytes(0)
+    , openBytes(0)
+{
+    if (capacity == 0) {
+        throw std::runtime_error("Ring allocator capacity must be non-zero!");
+    }
+}
+
+uint64_t RingAllocator::allocate(uint64_t size, uint64_t alignment) {
+    if (size == 0 || size > capacity) {
+        return INVALID_OFFSET;
+    }
+    if (alignment == 0) {
+        alignment = 1;
+    }
+
+    // Nothing in flight: restart at 0 so the whole range is contiguous
+    if (usedBytes == 0) {
+        head = 0;
+        tail = 0;
+    } else if (head == tail) {
+        return INVALID_OFFSET;  // Completely full
+    }
+
+    uint64_t offset = alignUp(head, alignment);
+    uint64_t padding = 0;
+
+    if (head >= tail) {
+        // In-use bytes are [tail, head): free space is [head, capacity) + [0, tail)
+        if (offset + size <= capacity) {
+            padding = offset - head;
+        } else if (size <= tail) {
+            offset = 0;
+            padding = capacity - head;  // Skip the unusable end of the range
+        } else {
+            return INVALID_OFFSET;
+        }
+    } else {
+        // Wrapped: free space is [head, tail)
+        if (offset + size > tail) {
+            return INVALID_OFFSET;
+        }
+        padding = offset - head;
+    }
+
+    head = offset + size;
+    if (head == capacity) {
+        head = 0;
+    }
+
+    usedBytes += padding + size;
+    openBytes += padding + size;
+    return offset;
+}
+
+void RingAllocator::endSubmission(uint64_t serial) {
+    if (openBytes == 0) {
+        return;
+    }
+    if (!submissions.empty() && serial <= submissions.back().serial) {
+        throw std::runtime_error("Ring allocator serials must increase!");
+    }
+
+    submissions.push_back({ serial, openBytes });
+    openBytes = 0;
+}
+
+void RingAllocator::release(uint64_t completedSerial) {
+    while (!submissions.empty() && submissions.front().serial <= completedSerial) {
+        tail = (tail + submissions.front().bytes) % capacity;
+        usedBytes -= submissions.front().bytes;
+        submissions.pop_front();
+    }
+}
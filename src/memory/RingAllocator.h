@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+/**
+ * RingAllocator - FIFO placement over an abstract [0, capacity) range
+ *
+ * Allocations are carved linearly from the head and wrap to offset 0 when
+ * the end is reached. Everything allocated between two endSubmission()
+ * calls is tagged with that submission's serial and returned in one step
+ * by release() once the GPU has finished with it, so per-allocation
+ * bookkeeping is a single pointer bump.
+ *
+ * Bytes skipped for alignment or at the wrap point are accounted to the
+ * submission that skipped them and come back with it.
+ */
+class RingAllocator {
+public:
+    static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+    explicit RingAllocator(uint64_t capacity);
+
+    // Returns INVALID_OFFSET when the ring has no contiguous room left
+    uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+
+    // Closes the allocations made since the previous call under `serial`.
+    // Serials must increase monotonically.
+    void endSubmission(uint64_t serial);
+
+    // Frees every closed submission with a serial <= completedSerial
+    void release(uint64_t completedSerial);
+
+    uint64_t getCapacity() const { return capacity; }
+    uint64_t getUsedBytes() const { return usedBytes; }
+    uint64_t getFreeBytes() const { return capacity - usedBytes; }
+    uint64_t getOpenBytes() const { return openBytes; }
+    size_t getPendingSubmissionCount() const { return submissions.size(); }
+    bool isEmpty() const { return usedBytes == 0; }
+
+private:
+    struct Submission {
+        uint64_t serial;
+        uint64_t bytes;
+    };
+
+    uint64_t capacity;
+    uint64_t head;          // Next byte to hand out
+    uint64_t tail;          // Oldest byte still in use
+    uint64_t usedBytes;     // Includes alignment and wrap padding
+    uint64_t openBytes;     // Not yet closed by endSubmission
+    std::deque<Submission> submissions;
+};
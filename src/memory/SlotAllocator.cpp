@@ -0,0 +1,39 @@
+#include "SlotAllocator.h"
+#include <stdexcept>
+
+SlotAllocator::SlotAllocator(uint32_t capacity)
+    : capacity(capacity)
+    , nextUnused(0)
+    , usedCount(0)
+    , allocated(capacity, false)
+{
+    if (capacity == 0 || capacity == INVALID_SLOT) {
+        throw std::runtime_error("SlotAllocator: invalid capacity!");
+    }
+}
+
+uint32_t SlotAllocator::allocate() {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else if (nextUnused < capacity) {
+        slot = nextUnused++;
+    } else {
+        return INVALID_SLOT;
+    }
+
+    allocated[slot] = true;
+    usedCount++;
+    return slot;
+}
+
+void SlotAllocator::free(uint32_t slot) {
+    if (!isAllocated(slot)) {
+        throw std::runtime_error("SlotAllocator: invalid or double free!");
+    }
+
+    allocated[slot] = false;
+    usedCount--;
+    freeSlots.push_back(slot);
+}
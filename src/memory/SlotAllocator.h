@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * SlotAllocator - Free-list allocator for indices in [0, capacity)
+ *
+ * Hands out descriptor array slots (or any dense index). Never-used slots
+ * come first, in order; freed slots are reused most-recently-freed first.
+ * Both operations are O(1).
+ */
+class SlotAllocator {
+public:
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+    explicit SlotAllocator(uint32_t capacity);
+
+    // Returns INVALID_SLOT when every slot is in use
+    uint32_t allocate();
+    void free(uint32_t slot);
+
+    bool isAllocated(uint32_t slot) const { return slot < capacity && allocated[slot]; }
+    uint32_t getCapacity() const { return capacity; }
+    uint32_t getUsedCount() const { return usedCount; }
+    uint32_t getFreeCount() const { return capacity - usedCount; }
+
+    // One past the highest slot ever handed out
+    uint32_t getHighWaterMark() const { return nextUnused; }
+
+private:
+    uint32_t capacity;
+    uint32_t nextUnused;
+    uint32_t usedCount;
+    std::vector<uint32_t> freeSlots;
+    std::vector<bool> allocated;
+};
@@ -0,0 +1,316 @@
+#include "TlsfAllocator.h"
+#include <stdexcept>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// ==================== Bit Helpers ====================
+
+namespace {
+
+uint32_t highestBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+}
+
+uint32_t lowestBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+}
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+// ==================== Construction ====================
+
+TlsfAllocator::TlsfAllocator(uint64_t capacity)
+    : capacity(capacity)
+    , usedBytes(0)
+    , allocationCount(0)
+    , freeRegionCount(0)
+    , firstPhysical(INVALID_HANDLE)
+    , flBitmap(0)
+{
+    if (capacity == 0) {
+        throw std::runtime_error("TlsfAllocator: capacity must be non-zero!");
+    }
+
+    for (uint32_t fl = 0; fl < FL_COUNT; fl++) {
+        slBitmap[fl] = 0;
+        for (uint32_t sl = 0; sl < SL_COUNT; sl++) {
+            freeHeads[fl][sl] = INVALID_HANDLE;
+        }
+    }
+
+    firstPhysical = newBlock(0, capacity);
+    insertFree(firstPhysical);
+}
+
+// ==================== Size Classes ====================
+
+void TlsfAllocator::mapping(uint64_t size, uint32_t& fl, uint32_t& sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+        // Linear classes below SMALL_BLOCK_SIZE
+        fl = 0;
+        sl = static_cast<uint32_t>(size / SMALL_GRANULARITY);
+        return;
+    }
+
+    uint32_t msb = highestBit(size);
+    sl = static_cast<uint32_t>(size >> (msb - SL_LOG2)) ^ SL_COUNT;
+    fl = msb - SMALL_BLOCK_LOG2 + 1;
+}
+
+uint64_t TlsfAllocator::roundUpForSearch(uint64_t size) {
+    // Round into the next class so that every block found in it is big enough
+    if (size < SMALL_BLOCK_SIZE) {
+        return alignUp(size, SMALL_GRANULARITY);
+    }
+    uint64_t round = (1ull << (highestBit(size) - SL_LOG2)) - 1;
+    return size + round;
+}
+
+// ==================== Allocation ====================
+
+TlsfAllocator::Allocation TlsfAllocator::allocate(uint64_t size, uint64_t alignment) {
+    Allocation result;
+
+    if (size == 0) {
+        return result;
+    }
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        throw std::runtime_error("TlsfAllocator: alignment must be a power of two!");
+    }
+
+    // Search for room for the worst-case alignment padding as well
+    uint64_t searchSize = size + (alignment > 1 ? alignment - 1 : 0);
+    if (searchSize > capacity) {
+        return result;
+    }
+
+    uint32_t index = findFreeBlock(searchSize);
+    if (index == INVALID_HANDLE) {
+        return result;
+    }
+
+    removeFree(index);
+
+    // Give the alignment padding back as its own free region
+    uint64_t padding = alignUp(blocks[index].offset, alignment) - blocks[index].offset;
+    if (padding > 0) {
+        uint32_t pad = newBlock(blocks[index].offset, padding);
+        Block& block = blocks[index];
+
+        blocks[pad].prevPhysical = block.prevPhysical;
+        blocks[pad].nextPhysical = index;
+        if (block.prevPhysical != INVALID_HANDLE) {
+            blocks[block.prevPhysical].nextPhysical = pad;
+        } else {
+            firstPhysical = pad;
+        }
+        block.prevPhysical = pad;
+        block.offset += padding;
+        block.size -= padding;
+
+        insertFree(pad);
+    }
+
+    splitAfter(index, size);
+
+    Block& block = blocks[index];
+    block.isFree = false;
+    usedBytes += block.size;
+    allocationCount++;
+
+    result.handle = index;
+    result.offset = block.offset;
+    result.size = block.size;
+    return result;
+}
+
+void TlsfAllocator::free(uint32_t handle) {
+    if (handle >= blocks.size() || blocks[handle].isFree || blocks[handle].size == 0) {
+        throw std::runtime_error("TlsfAllocator: invalid or double free!");
+    }
+
+    usedBytes -= blocks[handle].size;
+    allocationCount--;
+    blocks[handle].isFree = true;
+
+    // Merge with the previous physical neighbour
+    uint32_t prev = blocks[handle].prevPhysical;
+    if (prev != INVALID_HANDLE && blocks[prev].isFree) {
+        removeFree(prev);
+        blocks[prev].size += blocks[handle].size;
+        blocks[prev].nextPhysical = blocks[handle].nextPhysical;
+        if (blocks[handle].nextPhysical != INVALID_HANDLE) {
+            blocks[blocks[handle].nextPhysical].prevPhysical = prev;
+        }
+        releaseBlock(handle);
+        handle = prev;
+    }
+
+    // Merge with the next physical neighbour
+    uint32_t next = blocks[handle].nextPhysical;
+    if (next != INVALID_HANDLE && blocks[next].isFree) {
+        removeFree(next);
+        blocks[handle].size += blocks[next].size;
+        blocks[handle].nextPhysical = blocks[next].nextPhysical;
+        if (blocks[next].nextPhysical != INVALID_HANDLE) {
+            blocks[blocks[next].nextPhysical].prevPhysical = handle;
+        }
+        releaseBlock(next);
+    }
+
+    insertFree(handle);
+}
+
+void TlsfAllocator::splitAfter(uint32_t index, uint64_t size) {
+    uint64_t remainder = blocks[index].size - size;
+    if (remainder < SMALL_GRANULARITY) {
+        return;  // Too small to track, stays attached to the allocation
+    }
+
+    uint32_t tail = newBlock(blocks[index].offset + size, remainder);
+    Block& block = blocks[index];
+
+    blocks[tail].prevPhysical = index;
+    blocks[tail].nextPhysical = block.nextPhysical;
+    if (block.nextPhysical != INVALID_HANDLE) {
+        blocks[block.nextPhysical].prevPhysical = tail;
+    }
+    block.nextPhysical = tail;
+    block.size = size;
+
+    insertFree(tail);
+}
+
+// ==================== Free Lists ====================
+
+uint32_t TlsfAllocator::findFreeBlock(uint64_t size) const {
+    uint32_t fl, sl;
+    mapping(roundUpForSearch(size), fl, sl);
+    if (fl >= FL_COUNT) {
+        return INVALID_HANDLE;
+    }
+
+    uint32_t slMap = slBitmap[fl] & (~0u << sl);
+    if (slMap == 0) {
+        uint64_t flMap = (fl + 1 < 64) ? (flBitmap & (~0ull << (fl + 1))) : 0;
+        if (flMap == 0) {
+            return INVALID_HANDLE;
+        }
+        fl = lowestBit(flMap);
+        slMap = slBitmap[fl];
+    }
+    sl = lowestBit(slMap);
+
+    return freeHeads[fl][sl];
+}
+
+void TlsfAllocator::insertFree(uint32_t index) {
+    uint32_t fl, sl;
+    mapping(blocks[index].size, fl, sl);
+
+    Block& block = blocks[index];
+    block.isFree = true;
+    block.prevFree = INVALID_HANDLE;
+    block.nextFree = freeHeads[fl][sl];
+    if (block.nextFree != INVALID_HANDLE) {
+        blocks[block.nextFree].prevFree = index;
+    }
+
+    freeHeads[fl][sl] = index;
+    flBitmap |= 1ull << fl;
+    slBitmap[fl] |= 1u << sl;
+    freeRegionCount++;
+}
+
+void TlsfAllocator::removeFree(uint32_t index) {
+    uint32_t fl, sl;
+    mapping(blocks[index].size, fl, sl);
+
+    Block& block = blocks[index];
+    if (block.prevFree != INVALID_HANDLE) {
+        blocks[block.prevFree].nextFree = block.nextFree;
+    } else {
+        freeHeads[fl][sl] = block.nextFree;
+    }
+    if (block.nextFree != INVALID_HANDLE) {
+        blocks[block.nextFree].prevFree = block.prevFree;
+    }
+
+    if (freeHeads[fl][sl] == INVALID_HANDLE) {
+        slBitmap[fl] &= ~(1u << sl);
+        if (slBitmap[fl] == 0) {
+            flBitmap &= ~(1ull << fl);
+        }
+    }
+
+    block.prevFree = INVALID_HANDLE;
+    block.nextFree = INVALID_HANDLE;
+    freeRegionCount--;
+}
+
+// ==================== Block Pool ====================
+
+uint32_t TlsfAllocator::newBlock(uint64_t offset, uint64_t size) {
+    Block block{ offset, size, INVALID_HANDLE, INVALID_HANDLE, INVALID_HANDLE, INVALID_HANDLE, false };
+
+    if (!unusedBlocks.empty()) {
+        uint32_t index = unusedBlocks.back();
+        unusedBlocks.pop_back();
+        blocks[index] = block;
+        return index;
+    }
+
+    blocks.push_back(block);
+    return static_cast<uint32_t>(blocks.size() - 1);
+}
+
+void TlsfAllocator::releaseBlock(uint32_t index) {
+    blocks[index].size = 0;
+    blocks[index].isFree = false;
+    unusedBlocks.push_back(index);
+}
+
+// ==================== Statistics ====================
+
+uint64_t TlsfAllocator::getLargestFreeRegion() const {
+    if (flBitmap == 0) {
+        return 0;
+    }
+
+    uint32_t fl = highestBit(flBitmap);
+    uint32_t sl = highestBit(slBitmap[fl]);
+
+    uint64_t largest = 0;
+    for (uint32_t i = freeHeads[fl][sl]; i != INVALID_HANDLE; i = blocks[i].nextFree) {
+        if (blocks[i].size > largest) {
+            largest = blocks[i].size;
+        }
+    }
+    return largest;
+}
+
+void TlsfAllocator::forEachAllocation(const std::function<void(uint32_t, uint64_t, uint64_t)>& fn) const {
+    for (uint32_t i = firstPhysical; i != INVALID_HANDLE; i = blocks[i].nextPhysical) {
+        if (!blocks[i].isFree) {
+            fn(i, blocks[i].offset, blocks[i].size);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * TlsfAllocator - Two-Level Segregated Fit placement over an abstract range
+ *
+ * Manages offsets inside a [0, capacity) range without touching any memory
+ * itself, so the same code places sub-allocations inside VkDeviceMemory
+ * blocks and can be tested without a GPU.
+ *
+ * - O(1) allocate and free (two bitmap lookups, no list walks)
+ * - Immediate coalescing of physically adjacent free regions
+ * - Arbitrary power-of-two alignment per allocation
+ */
+class TlsfAllocator {
+public:
+    static constexpr uint32_t INVALID_HANDLE = UINT32_MAX;
+
+    struct Allocation {
+        uint32_t handle = INVALID_HANDLE;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+
+        bool isValid() const { return handle != INVALID_HANDLE; }
+    };
+
+    explicit TlsfAllocator(uint64_t capacity);
+
+    // Returns an invalid Allocation when no free region is large enough
+    Allocation allocate(uint64_t size, uint64_t alignment = 1);
+    void free(uint32_t handle);
+
+    uint64_t getCapacity() const { return capacity; }
+    uint64_t getUsedBytes() const { return usedBytes; }
+    uint64_t getFreeBytes() const { return capacity - usedBytes; }
+    uint32_t getAllocationCount() const { return allocationCount; }
+    uint32_t getFreeRegionCount() const { return freeRegionCount; }
+    uint64_t getLargestFreeRegion() const;
+    bool isEmpty() const { return allocationCount == 0; }
+
+    // Calls fn(handle, offset, size) for every live allocation in address order
+    void forEachAllocation(const std::function<void(uint32_t, uint64_t, uint64_t)>& fn) const;
+
+private:
+    static constexpr uint32_t SL_LOG2 = 5;
+    static constexpr uint32_t SL_COUNT = 1u << SL_LOG2;
+    static constexpr uint32_t SMALL_BLOCK_LOG2 = 8;
+    static constexpr uint64_t SMALL_BLOCK_SIZE = 1ull << SMALL_BLOCK_LOG2;
+    static constexpr uint64_t SMALL_GRANULARITY = SMALL_BLOCK_SIZE / SL_COUNT;
+    static constexpr uint32_t FL_COUNT = 64 - SMALL_BLOCK_LOG2 + 1;
+
+    struct Block {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t prevPhysical;
+        uint32_t nextPhysical;
+        uint32_t prevFree;
+        uint32_t nextFree;
+        bool isFree;
+    };
+
+    uint64_t capacity;
+    uint64_t usedBytes;
+    uint32_t allocationCount;
+    uint32_t freeRegionCount;
+
+    std::vector<Block> blocks;
+    std::vector<uint32_t> unusedBlocks;
+    uint32_t firstPhysical;
+
+    uint64_t flBitmap;
+    uint32_t slBitmap[FL_COUNT];
+    uint32_t freeHeads[FL_COUNT][SL_COUNT];
+
+    static void mapping(uint64_t size, uint32_t& fl, uint32_t& sl);
+    static uint64_t roundUpForSearch(uint64_t size);
+
+    uint32_t newBlock(uint64_t offset, uint64_t size);
+    void releaseBlock(uint32_t index);
+    uint32_t findFreeBlock(uint64_t size) const;
+    void insertFree(uint32_t index);
+    void removeFree(uint32_t index);
+    void splitAfter(uint32_t index, uint64_t size);
+};
@@ -13,6 +13,14 @@ static void keyCallback(GLFWwindow* window, int key, int scancode, int action, i
     }
 }
 
+void GLFWWindow::framebufferSizeCallback(GLFWwindow* window, int width, int height) {
+    GLFWWindow* self = static_cast<GLFWWindow*>(glfwGetWindowUserPointer(window));
+    if (self) {
+        self->width = width;
+        self->height = height;
+    }
+}
+
 GLFWWindow::GLFWWindow(int width, int height, const char* title)
     : width(width), height(height), window(nullptr)
 {
@@ -36,6 +44,10 @@ GLFWWindow::GLFWWindow(int width, int height, const char* title)
 
     glfwSetKeyCallback(window, keyCallback);
 
+    // Track resizes; a minimized window reports 0x0
+    glfwSetWindowUserPointer(window, this);
+    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+
     Logger::verbose("Window created");
 
 }
@@ -58,6 +70,10 @@ void GLFWWindow::pollEvents() {
     glfwPollEvents();
 }
 
+void GLFWWindow::waitEvents() {
+    glfwWaitEvents();
+}
+
 int GLFWWindow::getWidth() const {
     return width;
 }
@@ -13,6 +13,7 @@ public:
 
     bool shouldClose() const override;
     void pollEvents() override;
+    void waitEvents() override;
     int getWidth() const override;
     int getHeight() const override;
     void* getNativeHandle() const override;
@@ -26,6 +27,8 @@ private:
     int width;
     int height;
 
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+
     int toGLFWKey(Key key) const;
     int toGLFWMouseButton(MouseButton button) const;
 };
\ No newline at end of file
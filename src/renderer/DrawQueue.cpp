@@ -0,0 +1,127 @@
+#include "DrawQueue.h"
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint32_t NONE = ~0u;
+
+}
+
+uint64_t DrawQueue::makeKey(const DrawPacket& packet) {
+    if (packet.pass >= MAX_PASSES || packet.pipeline >= MAX_PIPELINES ||
+        packet.material >= MAX_MATERIALS || packet.mesh >= MAX_MESHES) {
+        throw std::runtime_error("DrawQueue: draw packet ID does not fit its sort key field!");
+    }
+
+    const uint64_t pass = packet.pass;
+    const uint64_t pipeline = packet.pipeline;
+    const uint64_t material = packet.material;
+    const uint64_t mesh = packet.mesh;
+    const uint64_t depth = quantizeDepth(packet.depth);
+
+    if (packet.backToFront) {
+        return (pass << 60) | ((0xFFFFu ^ depth) << 44) | (pipeline << 32) | (material << 16) | mesh;
+    }
+    return (pass << 60) | (pipeline << 48) | (material << 32) | (mesh << 16) | depth;
+}
+
+uint16_t DrawQueue::quantizeDepth(float depth) {
+    // Non-negative IEEE floats order like their bit patterns
+    if (!(depth > 0.0f)) {
+        return 0;
+    }
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+void DrawQueue::clear() {
+    packets.clear();
+    keys.clear();
+    order.clear();
+    instances.clear();
+}
+
+void DrawQueue::resize(uint32_t count) {
+    packets.resize(count);
+    keys.resize(count);
+    order.resize(count);
+}
+
+void DrawQueue::setPacket(uint32_t index, const DrawPacket& packet) {
+    packets[index] = packet;
+    keys[index] = makeKey(packet);
+    order[index] = index;
+}
+
+void DrawQueue::add(const DrawPacket& packet) {
+    uint32_t index = size();
+    resize(index + 1);
+    setPacket(index, packet);
+}
+
+void DrawQueue::sort(ThreadPool* pool) {
+    auto start = std::chrono::high_resolution_clock::now();
+    sorter.sort(keys, order, pool);
+    instances.resize(order.size());
+    stats.sortMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+const DrawQueueStats& DrawQueue::submit(IDrawBackend& backend) {
+    double sortMs = stats.sortMs;
+    stats = DrawQueueStats();
+    stats.sortMs = sortMs;
+
+    uint32_t boundPipeline = NONE;
+    uint32_t boundMaterial = NONE;
+    uint32_t boundMesh = NONE;
+
+    backend.beginDraws();
+    backend.setInstances(instances.data(), static_cast<uint32_t>(instances.size()));
+
+    const uint32_t count = static_cast<uint32_t>(order.size());
+    uint32_t runStart = 0;
+    while (runStart < count) {
+        const DrawPacket& packet = packets[order[runStart]];
+
+        if (packet.pipeline != boundPipeline) {
+            backend.bindPipeline(packet.pipeline);
+            boundPipeline = packet.pipeline;
+            boundMaterial = NONE;   // Material bindings are tied to the pipeline's layout
+            stats.pipelineBinds++;
+        }
+        if (packet.material != boundMaterial) {
+            backend.bindMaterial(packet.material);
+            boundMaterial = packet.material;
+            stats.materialBinds++;
+        }
+        if (packet.mesh != boundMesh) {
+            backend.bindMesh(packet.mesh);
+            boundMesh = packet.mesh;
+            stats.meshBinds++;
+        }
+
+        // Same pass and state throughout: one draw. Blended runs keep their order.
+        uint32_t runEnd = runStart + 1;
+        while (runEnd < count) {
+            const DrawPacket& next = packets[order[runEnd]];
+            if (next.pass != packet.pass || next.pipeline != packet.pipeline ||
+                next.material != packet.material || next.mesh != packet.mesh) {
+                break;
+            }
+            runEnd++;
+        }
+
+        backend.draw(runStart, runEnd - runStart);
+        stats.draws++;
+        runStart = runEnd;
+    }
+    backend.endDraws();
+
+    stats.packets = count;
+    stats.elidedBinds = 3 * stats.packets - (stats.pipelineBinds + stats.materialBinds + stats.meshBinds);
+    return stats;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../interfaces/IDrawBackend.h"
+#include "../utils/RadixSorter.h"
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// One draw before sorting
+struct DrawPacket {
+    uint32_t pass = 0;          // Passes submit in ascending order
+    uint32_t pipeline = 0;
+    uint32_t material = 0;
+    uint32_t mesh = 0;
+    float depth = 0.0f;         // View depth, larger = farther
+    bool backToFront = false;   // Depth before state (blending); else state first
+    uint32_t object = 0;        // Caller's index, e.g. into the visible list
+};
+
+struct DrawQueueStats {
+    uint32_t packets = 0;
+    uint32_t draws = 0;         // Instanced draw calls the packets were merged into
+    uint32_t pipelineBinds = 0;
+    uint32_t materialBinds = 0;
+    uint32_t meshBinds = 0;
+    uint32_t elidedBinds = 0;   // Of the 3 binds per packet an unsorted, unmerged stream would issue
+    double sortMs = 0.0;
+};
+
+/**
+ * DrawQueue - Sort-key draw submission
+ *
+ * Every packet gets a 64-bit key:
+ *
+ *   opaque:        pass:4 | pipeline:12 | material:16 | mesh:16 | depth:16
+ *   backToFront:   pass:4 | ~depth:16 | pipeline:12 | material:16 | mesh:16
+ *
+ * so one radix sort groups opaque draws by state (most expensive change
+ * first, front-to-back within a group) and orders blended draws far to near.
+ * submit() walks the sorted order, skips binds of what is already bound and
+ * merges each run of packets with the same pipeline, material and mesh into
+ * one instanced draw. Instance i of the frame is the packet at sorted
+ * position i, so a run's instances are contiguous; its data comes from
+ * getInstances(), filled by the caller after sort().
+ *
+ * Packets and instances may be written from several threads (distinct
+ * indices); everything else is single-threaded.
+ */
+class DrawQueue {
+public:
+    static constexpr uint32_t MAX_PASSES = 1u << 4;
+    static constexpr uint32_t MAX_PIPELINES = 1u << 12;
+    static constexpr uint32_t MAX_MATERIALS = 1u << 16;
+    static constexpr uint32_t MAX_MESHES = 1u << 16;
+
+    // Throws if an ID does not fit its key field
+    static uint64_t makeKey(const DrawPacket& packet);
+
+    // Order-preserving 16-bit depth: the high half of the float's bits.
+    // Negative depths and NaN map to 0.
+    static uint16_t quantizeDepth(float depth);
+
+    void clear();
+    // Makes room for `count` packets to be filled in with setPacket
+    void resize(uint32_t count);
+    void setPacket(uint32_t index, const DrawPacket& packet);
+    void add(const DrawPacket& packet);
+
+    // Radix sorts the keys and sizes getInstances(); null pool sorts on the
+    // calling thread
+    void sort(ThreadPool* pool);
+
+    // Instance data by sorted position, to fill between sort() and submit()
+    std::vector<DrawInstance>& getInstances() { return instances; }
+
+    // Emits the sorted packets as instanced draws, eliding redundant binds
+    const DrawQueueStats& submit(IDrawBackend& backend);
+
+    uint32_t size() const { return static_cast<uint32_t>(packets.size()); }
+    // Packet at sorted position i (submission order once sorted)
+    const DrawPacket& getSorted(uint32_t i) const { return packets[order[i]]; }
+    const DrawQueueStats& getStats() const { return stats; }
+
+private:
+    std::vector<DrawPacket> packets;
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> order;        // Packet indices, sorted by key
+    std::vector<DrawInstance> instances;
+    RadixSorter sorter;
+    DrawQueueStats stats;
+};
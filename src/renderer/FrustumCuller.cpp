@@ -0,0 +1,375 @@
+#include "FrustumCuller.h"
+#include "Scene.h"
+#include "../utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define HYBRID_CULL_X86 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+// GCC/Clang compile the SIMD kernels for their target without raising the
+// baseline of the whole build; MSVC always accepts the intrinsics
+#if defined(__GNUC__) || defined(__clang__)
+    #define HYBRID_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define HYBRID_TARGET(isa)
+#endif
+
+namespace {
+
+uint32_t countTrailingZeros(uint32_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return index;
+#else
+    return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+}
+
+// Same operation order as the SIMD paths so every level agrees bit for bit
+bool isOutside(const float planes[6][4], float x, float y, float z, float radius) {
+    for (int p = 0; p < 6; p++) {
+        float distance = planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3];
+        if (distance < -radius) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t cullRangeScalar(const float planes[6][4], const SphereStreams& spheres, uint32_t first,
+                         uint32_t base, uint32_t* out) {
+    uint32_t visible = 0;
+    for (uint32_t i = first; i < spheres.count; i++) {
+        if (!isOutside(planes, spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i], spheres.radius[i])) {
+            out[visible++] = base + i;
+        }
+    }
+    return visible;
+}
+
+uint32_t cullScalar(const float planes[6][4], const SphereStreams& spheres, uint32_t base, uint32_t* out) {
+    return cullRangeScalar(planes, spheres, 0, base, out);
+}
+
+#ifdef HYBRID_CULL_X86
+
+HYBRID_TARGET("sse4.1")
+uint32_t cullSse41(const float planes[6][4], const SphereStreams& spheres, uint32_t base, uint32_t* out) {
+    __m128 plane[6][4];
+    for (int p = 0; p < 6; p++) {
+        for (int c = 0; c < 4; c++) {
+            plane[p][c] = _mm_set1_ps(planes[p][c]);
+        }
+    }
+
+    uint32_t visible = 0;
+    uint32_t i = 0;
+    for (; i + 4 <= spheres.count; i += 4) {
+        __m128 x = _mm_loadu_ps(spheres.centerX + i);
+        __m128 y = _mm_loadu_ps(spheres.centerY + i);
+        __m128 z = _mm_loadu_ps(spheres.centerZ + i);
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.radius + i));
+
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(plane[p][0], x), _mm_mul_ps(plane[p][1], y)),
+                _mm_mul_ps(plane[p][2], z)), plane[p][3]);
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negRadius));
+            if (_mm_test_all_ones(_mm_castps_si128(outside))) {
+                break;
+            }
+        }
+
+        uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xFu;
+        while (mask) {
+            out[visible++] = base + i + countTrailingZeros(mask);
+            mask &= mask - 1;
+        }
+    }
+    return visible + cullRangeScalar(planes, spheres, i, base, out + visible);
+}
+
+// For each 8-bit visibility mask: the positions of its set bits packed 3
+// bits apiece, and their count in bits 24..27
+struct CompactionTable {
+    uint32_t entries[256];
+
+    CompactionTable() {
+        for (uint32_t mask = 0; mask < 256; mask++) {
+            uint32_t entry = 0;
+            uint32_t count = 0;
+            for (uint32_t bit = 0; bit < 8; bit++) {
+                if (mask & (1u << bit)) {
+                    entry |= bit << (3 * count);
+                    count++;
+                }
+            }
+            entries[mask] = entry | (count << 24);
+        }
+    }
+};
+
+const CompactionTable compactionTable;
+
+HYBRID_TARGET("avx2")
+uint32_t cullAvx2(const float planes[6][4], const SphereStreams& spheres, uint32_t base, uint32_t* out) {
+    __m256 plane[6][4];
+    for (int p = 0; p < 6; p++) {
+        for (int c = 0; c < 4; c++) {
+            plane[p][c] = _mm256_set1_ps(planes[p][c]);
+        }
+    }
+    const __m256i laneShifts = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    const __m256i laneMask = _mm256_set1_epi32(7);
+
+    uint32_t visible = 0;
+    uint32_t i = 0;
+    for (; i + 8 <= spheres.count; i += 8) {
+        __m256 x = _mm256_loadu_ps(spheres.centerX + i);
+        __m256 y = _mm256_loadu_ps(spheres.centerY + i);
+        __m256 z = _mm256_loadu_ps(spheres.centerZ + i);
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius + i));
+
+        __m256 outside = _mm256_setzero_ps();
+        for (int p = 0; p < 6; p++) {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+                _mm256_mul_ps(plane[p][0], x), _mm256_mul_ps(plane[p][1], y)),
+                _mm256_mul_ps(plane[p][2], z)), plane[p][3]);
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negRadius, _CMP_LT_OQ));
+        }
+
+        // Store all 8 lanes with the visible indices packed to the front;
+        // only the first `count` are kept
+        uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xFFu;
+        uint32_t entry = compactionTable.entries[mask];
+        __m256i lanes = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(entry)), laneShifts),
+                                         laneMask);
+        __m256i indices = _mm256_add_epi32(lanes, _mm256_set1_epi32(static_cast<int>(base + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + visible), indices);
+        visible += entry >> 24;
+    }
+    return visible + cullRangeScalar(planes, spheres, i, base, out + visible);
+}
+
+void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4]) {
+#ifdef _MSC_VER
+    int values[4];
+    __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; i++) {
+        registers[i] = static_cast<uint32_t>(values[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// XCR0: which register state the OS saves on context switches
+uint64_t readXcr0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t eax;
+    uint32_t edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+#endif
+
+SphereStreams offsetStreams(const SphereStreams& spheres, uint32_t first, uint32_t count) {
+    SphereStreams range;
+    range.centerX = spheres.centerX + first;
+    range.centerY = spheres.centerY + first;
+    range.centerZ = spheres.centerZ + first;
+    range.radius = spheres.radius + first;
+    range.count = count;
+    return range;
+}
+
+const uint32_t OUTPUT_PADDING = 8;
+
+}
+
+SimdLevel FrustumCuller::detectSimdLevel() {
+#ifdef HYBRID_CULL_X86
+    uint32_t registers[4];
+    cpuid(0, 0, registers);
+    uint32_t maxLeaf = registers[0];
+    if (maxLeaf < 1) {
+        return SimdLevel::Scalar;
+    }
+
+    cpuid(1, 0, registers);
+    bool sse41 = (registers[2] & (1u << 19)) != 0;
+    bool osxsave = (registers[2] & (1u << 27)) != 0;
+    bool avx = (registers[2] & (1u << 28)) != 0;
+
+    // AVX registers are usable only if the OS saves XMM and YMM state
+    bool ymmState = osxsave && (readXcr0() & 0x6) == 0x6;
+    bool avx2 = false;
+    if (avx && ymmState && maxLeaf >= 7) {
+        cpuid(7, 0, registers);
+        avx2 = (registers[1] & (1u << 5)) != 0;
+    }
+
+    if (avx2) {
+        return SimdLevel::Avx2;
+    }
+    if (sse41) {
+        return SimdLevel::Sse41;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+const char* FrustumCuller::simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::Sse41:  return "SSE4.1";
+    case SimdLevel::Avx2:   return "AVX2";
+    }
+    return "unknown";
+}
+
+FrustumCuller::FrustumCuller(SimdLevel requested)
+    : level(std::min(requested, detectSimdLevel()))
+    , cullFn(cullScalar)
+    , rangeIndices()
+    , rangeObjects()
+{
+#ifdef HYBRID_CULL_X86
+    if (level == SimdLevel::Avx2) {
+        cullFn = cullAvx2;
+    } else if (level == SimdLevel::Sse41) {
+        cullFn = cullSse41;
+    }
+#endif
+}
+
+// ==================== Culling ====================
+
+void FrustumCuller::cull(const float planes[6][4], const SphereStreams& spheres, ThreadPool* pool,
+                         std::vector<uint32_t>& visible) {
+    uint32_t rangeCount = (spheres.count + CULL_RANGE - 1) / CULL_RANGE;
+    if (pool == nullptr || rangeCount <= 1) {
+        visible.resize(spheres.count + OUTPUT_PADDING);
+        visible.resize(cullFn(planes, spheres, 0, visible.data()));
+        return;
+    }
+
+    if (rangeIndices.size() < rangeCount) {
+        rangeIndices.resize(rangeCount);
+    }
+    pool->parallelFor(rangeCount, [&](uint32_t range, uint32_t) {
+        uint32_t first = range * CULL_RANGE;
+        uint32_t count = std::min(CULL_RANGE, spheres.count - first);
+        std::vector<uint32_t>& out = rangeIndices[range];
+        out.resize(count + OUTPUT_PADDING);
+        out.resize(cullFn(planes, offsetStreams(spheres, first, count), first, out.data()));
+    });
+
+    visible.clear();
+    for (uint32_t range = 0; range < rangeCount; range++) {
+        visible.insert(visible.end(), rangeIndices[range].begin(), rangeIndices[range].end());
+    }
+}
+
+void FrustumCuller::cull(const float planes[6][4], Scene& scene, ThreadPool* pool, SceneCullResult& result) {
+    result.chunks = scene.getChunks(componentBit(SceneComponent::Bounds));
+    result.visible.clear();
+    result.testedCount = 0;
+
+    // Whole chunks per task, about CULL_RANGE spheres each
+    std::vector<uint32_t> taskStarts;
+    uint32_t taskSize = CULL_RANGE;
+    for (uint32_t i = 0; i < result.chunks.size(); i++) {
+        if (taskSize >= CULL_RANGE) {
+            taskStarts.push_back(i);
+            taskSize = 0;
+        }
+        taskSize += result.chunks[i]->count;
+        result.testedCount += result.chunks[i]->count;
+    }
+    taskStarts.push_back(static_cast<uint32_t>(result.chunks.size()));
+    uint32_t taskCount = static_cast<uint32_t>(taskStarts.size() - 1);
+
+    if (rangeIndices.size() < taskCount) {
+        rangeIndices.resize(taskCount);
+        rangeObjects.resize(taskCount);
+    }
+
+    auto cullTask = [&](uint32_t task, uint32_t) {
+        std::vector<uint32_t>& rows = rangeIndices[task];
+        std::vector<VisibleObject>& objects = rangeObjects[task];
+        objects.clear();
+        for (uint32_t c = taskStarts[task]; c < taskStarts[task + 1]; c++) {
+            const SceneChunk& chunk = *result.chunks[c];
+            SphereStreams spheres;
+            spheres.centerX = chunk.boundsCenterX;
+            spheres.centerY = chunk.boundsCenterY;
+            spheres.centerZ = chunk.boundsCenterZ;
+            spheres.radius = chunk.boundsRadius;
+            spheres.count = chunk.count;
+
+            rows.resize(chunk.count + OUTPUT_PADDING);
+            uint32_t visibleCount = cullFn(planes, spheres, 0, rows.data());
+            size_t offset = objects.size();
+            objects.resize(offset + visibleCount);
+            for (uint32_t i = 0; i < visibleCount; i++) {
+                objects[offset + i] = { c, rows[i] };
+            }
+        }
+    };
+
+    if (pool == nullptr || taskCount <= 1) {
+        for (uint32_t task = 0; task < taskCount; task++) {
+            cullTask(task, 0);
+        }
+    } else {
+        pool->parallelFor(taskCount, cullTask);
+    }
+
+    for (uint32_t task = 0; task < taskCount; task++) {
+        result.visible.insert(result.visible.end(), rangeObjects[task].begin(), rangeObjects[task].end());
+    }
+}
+
+void FrustumCuller::extractPlanes(const float m[16], float planes[6][4]) {
+    // Gribb/Hartmann on a column-major matrix: row r = (m[r], m[4+r], m[8+r], m[12+r]).
+    // Vulkan clip space has 0 <= z <= w, so the near plane is row 2 alone.
+    for (int c = 0; c < 4; c++) {
+        float row0 = m[c * 4 + 0];
+        float row1 = m[c * 4 + 1];
+        float row2 = m[c * 4 + 2];
+        float row3 = m[c * 4 + 3];
+
+        planes[0][c] = row3 + row0;     // Left
+        planes[1][c] = row3 - row0;     // Right
+        planes[2][c] = row3 + row1;     // Bottom
+        planes[3][c] = row3 - row1;     // Top
+        planes[4][c] = row2;            // Near
+        planes[5][c] = row3 - row2;     // Far
+    }
+
+    for (int i = 0; i < 6; i++) {
+        float length = std::sqrt(planes[i][0] * planes[i][0] +
+                                 planes[i][1] * planes[i][1] +
+                                 planes[i][2] * planes[i][2]);
+        if (length > 0.0f) {
+            for (int c = 0; c < 4; c++) {
+                planes[i][c] /= length;
+            }
+        }
+    }
+}
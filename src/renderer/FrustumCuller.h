@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class Scene;
+class ThreadPool;
+struct SceneChunk;
+
+enum class SimdLevel : uint8_t {
+    Scalar,
+    Sse41,      // 4 spheres per instruction
+    Avx2        // 8 spheres per instruction
+};
+
+// Bounding spheres as separate float streams (SceneChunk layout)
+struct SphereStreams {
+    const float* centerX = nullptr;
+    const float* centerY = nullptr;
+    const float* centerZ = nullptr;
+    const float* radius = nullptr;
+    uint32_t count = 0;
+};
+
+// Row `row` of cull result chunk `chunk`
+struct VisibleObject {
+    uint32_t chunk;
+    uint32_t row;
+};
+
+struct SceneCullResult {
+    std::vector<SceneChunk*> chunks;        // Every chunk tested, indexed by VisibleObject::chunk
+    std::vector<VisibleObject> visible;     // In chunk order
+    uint32_t testedCount = 0;
+};
+
+/**
+ * FrustumCuller - CPU sphere-vs-frustum culling over SoA bounds
+ *
+ * Tests 8 (AVX2) or 4 (SSE4.1) spheres per instruction against all six
+ * planes and compacts the survivors into an index list. The widest level
+ * the CPU and OS support is picked from CPUID at construction; the scalar
+ * path is the reference and the fallback. All levels give identical results.
+ *
+ * With a ThreadPool the input is split into ranges of CULL_RANGE spheres
+ * (64 KiB of bounds, fits L2 alongside the output) or, for a Scene, groups
+ * of whole chunks of about that size. Output order never depends on the
+ * thread count.
+ *
+ * Planes use GpuDrivenRenderer's convention: inward unit normals, a point
+ * p is inside when dot(abc, p) + d >= 0. A sphere is culled only when it
+ * lies entirely outside one plane.
+ *
+ * Not thread-safe: the culler keeps per-range scratch between calls.
+ */
+class FrustumCuller {
+public:
+    static constexpr uint32_t CULL_RANGE = 4096;
+
+    // Widest level the CPU and OS support
+    static SimdLevel detectSimdLevel();
+    static const char* simdLevelName(SimdLevel level);
+
+    // Requested levels above detectSimdLevel() are lowered to it
+    explicit FrustumCuller(SimdLevel level = detectSimdLevel());
+
+    SimdLevel getSimdLevel() const { return level; }
+
+    // Indices in [0, spheres.count) of the visible spheres, ascending
+    void cull(const float planes[6][4], const SphereStreams& spheres, ThreadPool* pool,
+              std::vector<uint32_t>& visible);
+
+    // Every chunk with bounds; null pool culls on the calling thread
+    void cull(const float planes[6][4], Scene& scene, ThreadPool* pool, SceneCullResult& result);
+
+    // Column-major (view-)projection to planes in the convention above,
+    // Vulkan clip space (0 <= z <= w). Order: left, right, bottom, top, near, far.
+    static void extractPlanes(const float matrix[16], float planes[6][4]);
+
+private:
+    // Writes the visible indices of [0, count) plus `base` to out, which must
+    // hold count + 8 elements (the SIMD paths store whole registers)
+    using CullFn = uint32_t (*)(const float planes[6][4], const SphereStreams& spheres,
+                                uint32_t base, uint32_t* out);
+
+    SimdLevel level;
+    CullFn cullFn;
+
+    // Per-range outputs, concatenated in order once every range is done
+    std::vector<std::vector<uint32_t>> rangeIndices;
+    std::vector<std::vector<VisibleObject>> rangeObjects;
+};
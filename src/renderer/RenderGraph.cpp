@@ -0,0 +1,354 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include <stdexcept>
+
+bool isWriteUsage(RenderGraphUsage usage) {
+    switch (usage) {
+    case RenderGraphUsage::ColorAttachment:
+    case RenderGraphUsage::DepthAttachment:
+    case RenderGraphUsage::StorageWrite:
+    case RenderGraphUsage::TransferDst:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// ==================== Declaration ====================
+
+RenderGraphResource RenderGraph::createTexture(const std::string& name, const RenderGraphTextureDesc& desc) {
+    if (desc.width == 0 || desc.height == 0) {
+        throw std::runtime_error("RenderGraph: texture " + name + " has a zero extent!");
+    }
+
+    Resource resource{};
+    resource.name = name;
+    resource.desc = desc;
+    resource.imported = false;
+    resource.initialUsage = RenderGraphUsage::None;
+    resource.finalUsage = RenderGraphUsage::None;
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::importTexture(const std::string& name, RenderGraphUsage initialUsage,
+                                               RenderGraphUsage finalUsage) {
+    Resource resource{};
+    resource.name = name;
+    resource.imported = true;
+    resource.initialUsage = initialUsage;
+    resource.finalUsage = finalUsage;
+    resources.push_back(resource);
+    return static_cast<RenderGraphResource>(resources.size() - 1);
+}
+
+uint32_t RenderGraph::addPass(const std::string& name, bool sideEffects) {
+    Pass pass{};
+    pass.name = name;
+    pass.sideEffects = sideEffects;
+    passes.push_back(pass);
+    return static_cast<uint32_t>(passes.size() - 1);
+}
+
+void RenderGraph::read(uint32_t pass, RenderGraphResource resource, RenderGraphUsage usage) {
+    if (isWriteUsage(usage)) {
+        throw std::runtime_error("RenderGraph: usage cannot be read!");
+    }
+    addAccess(pass, resource, usage, false);
+}
+
+void RenderGraph::write(uint32_t pass, RenderGraphResource resource, RenderGraphUsage usage) {
+    if (!isWriteUsage(usage)) {
+        throw std::runtime_error("RenderGraph: usage cannot be written!");
+    }
+    addAccess(pass, resource, usage, true);
+}
+
+void RenderGraph::addAccess(uint32_t pass, RenderGraphResource resource, RenderGraphUsage usage, bool write) {
+    if (pass >= passes.size() || resource >= resources.size()) {
+        throw std::runtime_error("RenderGraph: unknown pass or resource!");
+    }
+    if (usage == RenderGraphUsage::None || usage == RenderGraphUsage::Present) {
+        throw std::runtime_error("RenderGraph: None and Present are not pass usages!");
+    }
+
+    // One access per texture per pass; a storage read + write is a read-modify-write
+    for (Access& access : passes[pass].accesses) {
+        if (access.resource != resource) {
+            continue;
+        }
+        bool storage = (access.usage == RenderGraphUsage::StorageRead || access.usage == RenderGraphUsage::StorageWrite) &&
+                       (usage == RenderGraphUsage::StorageRead || usage == RenderGraphUsage::StorageWrite);
+        if (access.usage != usage && !storage) {
+            throw std::runtime_error("RenderGraph: pass " + passes[pass].name + " uses " +
+                                     resources[resource].name + " with two different usages!");
+        }
+        if (write) {
+            access.usage = usage;
+            access.write = true;
+        }
+        return;
+    }
+    passes[pass].accesses.push_back({ resource, usage, write });
+}
+
+void RenderGraph::clear() {
+    passes.clear();
+    resources.clear();
+    compiledPasses.clear();
+    finalBarriers.clear();
+    stats = RenderGraphStats{};
+}
+
+// ==================== Compilation ====================
+
+void RenderGraph::compile(const MemoryQuery& query) {
+    compiledPasses.clear();
+    finalBarriers.clear();
+    stats = RenderGraphStats{};
+
+    for (Resource& resource : resources) {
+        resource.used = resource.imported;
+        resource.placement = RenderGraphPlacement{};
+        resource.lastUsage = RenderGraphUsage::None;
+        resource.firstBarrier = UINT32_MAX;
+    }
+
+    cullPasses();
+    buildBarriers();
+    placeTransients(query);
+
+    stats.passCount = static_cast<uint32_t>(compiledPasses.size());
+    stats.culledPassCount = static_cast<uint32_t>(passes.size() - compiledPasses.size());
+    for (const RenderGraphCompiledPass& compiled : compiledPasses) {
+        stats.barrierCount += static_cast<uint32_t>(compiled.barriers.size());
+        stats.barrierBatchCount += compiled.barriers.empty() ? 0 : 1;
+    }
+    stats.barrierCount += static_cast<uint32_t>(finalBarriers.size());
+    stats.barrierBatchCount += finalBarriers.empty() ? 0 : 1;
+}
+
+void RenderGraph::cullPasses() {
+    // Walk backwards from the outputs: a pass survives if it writes something
+    // a surviving pass (or the outside world) reads
+    std::vector<bool> needed(resources.size(), false);
+    for (size_t i = 0; i < resources.size(); i++) {
+        needed[i] = resources[i].imported;
+    }
+
+    for (size_t i = passes.size(); i-- > 0;) {
+        Pass& pass = passes[i];
+        bool live = pass.sideEffects;
+        for (const Access& access : pass.accesses) {
+            live = live || (access.write && needed[access.resource]);
+        }
+
+        pass.culled = !live;
+        if (live) {
+            for (const Access& access : pass.accesses) {
+                needed[access.resource] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::buildBarriers() {
+    struct State {
+        RenderGraphUsage usage;
+        bool written;
+    };
+
+    std::vector<State> states(resources.size());
+    for (size_t i = 0; i < resources.size(); i++) {
+        states[i] = { resources[i].initialUsage, false };
+    }
+
+    for (uint32_t i = 0; i < passes.size(); i++) {
+        const Pass& pass = passes[i];
+        if (pass.culled) {
+            continue;
+        }
+
+        uint32_t position = static_cast<uint32_t>(compiledPasses.size());
+        RenderGraphCompiledPass compiled;
+        compiled.pass = i;
+
+        for (const Access& access : pass.accesses) {
+            Resource& resource = resources[access.resource];
+            State& state = states[access.resource];
+
+            if (!resource.used) {
+                resource.used = true;
+                resource.placement.firstPass = position;
+            }
+            resource.placement.lastPass = position;
+            resource.lastUsage = access.usage;
+
+            if (state.usage == RenderGraphUsage::None) {
+                if (!access.write) {
+                    throw std::runtime_error("RenderGraph: pass " + pass.name + " reads " +
+                                             resource.name + " before anything writes it!");
+                }
+                if (!resource.imported) {
+                    resource.firstBarrier = static_cast<uint32_t>(compiled.barriers.size());
+                }
+                compiled.barriers.push_back({ access.resource, RenderGraphUsage::None, access.usage, true, 0 });
+            } else if (state.usage != access.usage || state.written || access.write) {
+                // Only read-after-read in the same layout needs nothing
+                compiled.barriers.push_back({ access.resource, state.usage, access.usage, false, 0 });
+            }
+
+            state.usage = access.usage;
+            state.written = access.write;
+        }
+
+        compiledPasses.push_back(std::move(compiled));
+    }
+
+    for (RenderGraphResource i = 0; i < resources.size(); i++) {
+        const Resource& resource = resources[i];
+        if (resource.imported && resource.finalUsage != RenderGraphUsage::None &&
+            states[i].usage != resource.finalUsage) {
+            bool discard = states[i].usage == RenderGraphUsage::None;
+            finalBarriers.push_back({ i, states[i].usage, resource.finalUsage, discard, 0 });
+        }
+    }
+}
+
+void RenderGraph::placeTransients(const MemoryQuery& query) {
+    std::vector<RenderGraphResource> transients;
+    for (RenderGraphResource i = 0; i < resources.size(); i++) {
+        if (resources[i].used && !resources[i].imported) {
+            transients.push_back(i);
+        }
+    }
+
+    std::vector<uint64_t> alignments(resources.size(), 1);
+    for (RenderGraphResource i : transients) {
+        RenderGraphMemoryRequirements requirements = query(i);
+        resources[i].placement.size = requirements.size;
+        alignments[i] = std::max<uint64_t>(requirements.alignment, 1);
+        stats.transientBytes += requirements.size;
+    }
+    stats.transientCount = static_cast<uint32_t>(transients.size());
+
+    // Largest first; each goes to the lowest aligned offset that does not
+    // collide with an already placed texture whose lifetime overlaps
+    std::stable_sort(transients.begin(), transients.end(), [this](RenderGraphResource a, RenderGraphResource b) {
+        return resources[a].placement.size > resources[b].placement.size;
+    });
+
+    std::vector<RenderGraphResource> placed;
+    for (RenderGraphResource i : transients) {
+        RenderGraphPlacement& placement = resources[i].placement;
+
+        std::vector<const RenderGraphPlacement*> live;
+        std::vector<uint64_t> candidates = { 0 };
+        for (RenderGraphResource other : placed) {
+            const RenderGraphPlacement& o = resources[other].placement;
+            if (o.firstPass <= placement.lastPass && placement.firstPass <= o.lastPass) {
+                live.push_back(&o);
+                candidates.push_back(o.offset + o.size);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for (uint64_t candidate : candidates) {
+            uint64_t offset = (candidate + alignments[i] - 1) / alignments[i] * alignments[i];
+            bool fits = std::none_of(live.begin(), live.end(), [&](const RenderGraphPlacement* o) {
+                return offset < o->offset + o->size && o->offset < offset + placement.size;
+            });
+            if (fits) {
+                placement.offset = offset;
+                break;
+            }
+        }
+
+        stats.aliasedBytes = std::max(stats.aliasedBytes, placement.offset + placement.size);
+        placed.push_back(i);
+    }
+    stats.savedBytes = stats.transientBytes - stats.aliasedBytes;
+
+    // A texture's first use must wait for whatever used its bytes before it:
+    // earlier textures this frame, and any overlapping one (itself included)
+    // in the previous execution of the graph
+    for (RenderGraphResource i : transients) {
+        const Resource& resource = resources[i];
+        for (RenderGraphResource other : transients) {
+            const Resource& previous = resources[other];
+            bool overlaps = resource.placement.offset < previous.placement.offset + previous.placement.size &&
+                            previous.placement.offset < resource.placement.offset + resource.placement.size;
+            if (overlaps) {
+                compiledPasses[resource.placement.firstPass].barriers[resource.firstBarrier].aliasWaitMask |=
+                    1u << static_cast<uint32_t>(previous.lastUsage);
+            }
+        }
+    }
+}
+
+// ==================== Queries ====================
+
+const RenderGraphPlacement& RenderGraph::getPlacement(RenderGraphResource resource) const {
+    if (resource >= resources.size()) {
+        throw std::runtime_error("RenderGraph: unknown resource!");
+    }
+    return resources[resource].placement;
+}
+
+bool RenderGraph::isPassCulled(uint32_t pass) const {
+    if (pass >= passes.size()) {
+        throw std::runtime_error("RenderGraph: unknown pass!");
+    }
+    return passes[pass].culled;
+}
+
+bool RenderGraph::isResourceUsed(RenderGraphResource resource) const {
+    if (resource >= resources.size()) {
+        throw std::runtime_error("RenderGraph: unknown resource!");
+    }
+    return resources[resource].used;
+}
+
+const std::string& RenderGraph::getPassName(uint32_t pass) const {
+    if (pass >= passes.size()) {
+        throw std::runtime_error("RenderGraph: unknown pass!");
+    }
+    return passes[pass].name;
+}
+
+const std::string& RenderGraph::getResourceName(RenderGraphResource resource) const {
+    if (resource >= resources.size()) {
+        throw std::runtime_error("RenderGraph: unknown resource!");
+    }
+    return resources[resource].name;
+}
+
+const RenderGraphTextureDesc& RenderGraph::getTextureDesc(RenderGraphResource resource) const {
+    if (resource >= resources.size()) {
+        throw std::runtime_error("RenderGraph: unknown resource!");
+    }
+    return resources[resource].desc;
+}
+
+bool RenderGraph::isImported(RenderGraphResource resource) const {
+    if (resource >= resources.size()) {
+        throw std::runtime_error("RenderGraph: unknown resource!");
+    }
+    return resources[resource].imported;
+}
+
+std::vector<RenderGraphUsage> RenderGraph::getUsages(RenderGraphResource resource) const {
+    std::vector<RenderGraphUsage> usages;
+    for (const Pass& pass : passes) {
+        if (pass.culled) {
+            continue;
+        }
+        for (const Access& access : pass.accesses) {
+            if (access.resource == resource &&
+                std::find(usages.begin(), usages.end(), access.usage) == usages.end()) {
+                usages.push_back(access.usage);
+            }
+        }
+    }
+    return usages;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+using RenderGraphResource = uint32_t;
+
+// How a pass touches a texture; each maps to one (stage, access, layout)
+// triple in the backend. Present is only valid as an imported final usage.
+enum class RenderGraphUsage : uint8_t {
+    None,               // Undefined contents (transient first use)
+    ColorAttachment,
+    DepthAttachment,
+    DepthRead,          // Read-only depth test and/or sampling
+    Sampled,
+    StorageRead,
+    StorageWrite,
+    TransferSrc,
+    TransferDst,
+    Present
+};
+
+bool isWriteUsage(RenderGraphUsage usage);
+
+struct RenderGraphTextureDesc {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t format = 0;        // Backend format value (VkFormat)
+};
+
+// Filled in by the backend for each live transient texture
+struct RenderGraphMemoryRequirements {
+    uint64_t size = 0;
+    uint64_t alignment = 1;
+};
+
+// One layout/memory transition; the backend batches a pass's barriers into a single call
+struct RenderGraphBarrier {
+    RenderGraphResource resource = 0;
+    RenderGraphUsage srcUsage = RenderGraphUsage::None;
+    RenderGraphUsage dstUsage = RenderGraphUsage::None;
+    bool discard = false;       // Previous contents are not needed (old layout undefined)
+    uint32_t aliasWaitMask = 0; // 1 << last usage of every texture sharing this memory
+};
+
+struct RenderGraphCompiledPass {
+    uint32_t pass = 0;                          // Index returned by addPass
+    std::vector<RenderGraphBarrier> barriers;   // Issued before the pass runs
+};
+
+// Where a transient texture lives inside the shared transient memory
+struct RenderGraphPlacement {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint32_t firstPass = 0;     // Lifetime, as positions in getCompiledPasses()
+    uint32_t lastPass = 0;
+};
+
+struct RenderGraphStats {
+    uint32_t passCount = 0;
+    uint32_t culledPassCount = 0;
+    uint32_t barrierCount = 0;
+    uint32_t barrierBatchCount = 0;     // Pipeline barrier calls, at most one per pass
+    uint32_t transientCount = 0;
+    uint64_t transientBytes = 0;        // Sum of transient sizes without aliasing
+    uint64_t aliasedBytes = 0;          // Shared memory actually needed
+    uint64_t savedBytes = 0;            // transientBytes - aliasedBytes
+};
+
+/**
+ * RenderGraph - API-independent frame graph compiler
+ *
+ * Passes declare which textures they read and write and how. compile()
+ * then, in declaration order:
+ *
+ *   - culls passes whose results never reach an imported texture or a
+ *     pass marked with side effects
+ *   - derives the transitions each remaining pass needs, skipping
+ *     read-after-read in the same usage, and groups them per pass
+ *   - assigns every transient texture an offset in one shared memory
+ *     range; textures whose lifetimes do not overlap share bytes
+ *
+ * The backend (VulkanRenderGraph) creates the images, answers the memory
+ * query and turns the barriers into vkCmdPipelineBarrier2 calls.
+ */
+class RenderGraph {
+public:
+    using MemoryQuery = std::function<RenderGraphMemoryRequirements(RenderGraphResource resource)>;
+
+    // Transient: created, placed and discarded by the graph
+    RenderGraphResource createTexture(const std::string& name, const RenderGraphTextureDesc& desc);
+
+    // External (e.g. the swapchain image): never culled or aliased, and left
+    // in finalUsage at the end of the graph
+    RenderGraphResource importTexture(const std::string& name, RenderGraphUsage initialUsage,
+                                      RenderGraphUsage finalUsage);
+
+    // Passes run in the order they are added; a side-effect pass is never culled
+    uint32_t addPass(const std::string& name, bool sideEffects = false);
+    void read(uint32_t pass, RenderGraphResource resource, RenderGraphUsage usage);
+    void write(uint32_t pass, RenderGraphResource resource, RenderGraphUsage usage);
+
+    // Throws if a transient texture is read before anything writes it
+    void compile(const MemoryQuery& query);
+    void clear();
+
+    // Results of the last compile()
+    const std::vector<RenderGraphCompiledPass>& getCompiledPasses() const { return compiledPasses; }
+    const std::vector<RenderGraphBarrier>& getFinalBarriers() const { return finalBarriers; }
+    const RenderGraphPlacement& getPlacement(RenderGraphResource resource) const;
+    const RenderGraphStats& getStats() const { return stats; }
+    bool isPassCulled(uint32_t pass) const;
+    bool isResourceUsed(RenderGraphResource resource) const;
+
+    uint32_t getPassCount() const { return static_cast<uint32_t>(passes.size()); }
+    uint32_t getResourceCount() const { return static_cast<uint32_t>(resources.size()); }
+    const std::string& getPassName(uint32_t pass) const;
+    const std::string& getResourceName(RenderGraphResource resource) const;
+    const RenderGraphTextureDesc& getTextureDesc(RenderGraphResource resource) const;
+    bool isImported(RenderGraphResource resource) const;
+
+    // Every usage of a texture by live passes, for image usage flags
+    std::vector<RenderGraphUsage> getUsages(RenderGraphResource resource) const;
+
+private:
+    struct Access {
+        RenderGraphResource resource;
+        RenderGraphUsage usage;
+        bool write;
+    };
+
+    struct Pass {
+        std::string name;
+        bool sideEffects;
+        bool culled;
+        std::vector<Access> accesses;
+    };
+
+    struct Resource {
+        std::string name;
+        RenderGraphTextureDesc desc;
+        bool imported;
+        RenderGraphUsage initialUsage;
+        RenderGraphUsage finalUsage;
+        bool used;
+        RenderGraphPlacement placement;
+        RenderGraphUsage lastUsage;     // Last live access, for alias waits
+        uint32_t firstBarrier;          // Discard barrier in compiledPasses[placement.firstPass]
+    };
+
+    std::vector<Pass> passes;
+    std::vector<Resource> resources;
+
+    std::vector<RenderGraphCompiledPass> compiledPasses;
+    std::vector<RenderGraphBarrier> finalBarriers;
+    RenderGraphStats stats;
+
+    void addAccess(uint32_t pass, RenderGraphResource resource, RenderGraphUsage usage, bool write);
+    void cullPasses();
+    void buildBarriers();
+    void placeTransients(const MemoryQuery& query);
+};
@@ -1,9 +1,31 @@
 #include "Renderer.h"
+#include "../interfaces/IDrawBackend.h"
+#include "../utils/ThreadPool.h"
+#include <chrono>
 #include <iostream>
 
 Renderer::Renderer(IWindow* window, IGraphicsContext* context)
-    : window(window), context(context)
+    : window(window), context(context), scene()
+    , threadPool(nullptr)
+    , culler()
+    , visibleObjects()
+    , drawBackend(nullptr)
+    , materials()
+    , drawableObjects()
+    , drawQueue()
+    , stats()
 {
+    // Planes every sphere is inside of: no culling until a camera is set
+    for (auto& plane : frustumPlanes) {
+        plane[0] = 0.0f;
+        plane[1] = 0.0f;
+        plane[2] = 0.0f;
+        plane[3] = 1.0f;
+    }
+    for (int i = 0; i < 16; i++) {
+        viewProjection[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    }
+    stats.cullSimdLevel = culler.getSimdLevel();
 }
 
 void Renderer::initialize() {
@@ -12,15 +34,132 @@ void Renderer::initialize() {
     std::cout << "Renderer initialized successfully!" << std::endl;
 }
 
+void Renderer::setViewProjection(const float matrix[16]) {
+    FrustumCuller::extractPlanes(matrix, frustumPlanes);
+    for (int i = 0; i < 16; i++) {
+        viewProjection[i] = matrix[i];
+    }
+}
+
+void Renderer::setMaterial(uint32_t materialIndex, const RenderMaterial& material) {
+    if (materialIndex >= materials.size()) {
+        materials.resize(materialIndex + 1);
+    }
+    materials[materialIndex] = material;
+}
+
 void Renderer::renderFrame() {
+    // CPU-side work first, while the GPU may still be busy with older frames
+    cullScene();
+    buildDrawQueue();
+
     context->beginFrame();
-    
-    // TODO: Actual rendering will go here
-    
+    submitDraws();
     context->endFrame();
 }
 
 void Renderer::cleanup() {
     std::cout << "Renderer cleaning up..." << std::endl;
     context->cleanup();
-}
\ No newline at end of file
+}
+
+void Renderer::cullScene() {
+    auto start = std::chrono::high_resolution_clock::now();
+    culler.cull(frustumPlanes, scene, threadPool, visibleObjects);
+
+    stats.objectCount = visibleObjects.testedCount;
+    stats.visibleCount = static_cast<uint32_t>(visibleObjects.visible.size());
+    stats.cullMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void Renderer::buildDrawQueue() {
+    drawQueue.clear();
+    drawableObjects.clear();
+    if (drawBackend == nullptr) {
+        return;
+    }
+
+    const ComponentMask drawable = componentBit(SceneComponent::Transform) |
+        componentBit(SceneComponent::Mesh) | componentBit(SceneComponent::Material);
+    for (uint32_t i = 0; i < visibleObjects.visible.size(); i++) {
+        if (visibleObjects.chunks[visibleObjects.visible[i].chunk]->has(drawable)) {
+            drawableObjects.push_back(i);
+        }
+    }
+
+    // Packets are independent: fill them in parallel ranges
+    const uint32_t count = static_cast<uint32_t>(drawableObjects.size());
+    drawQueue.resize(count);
+    auto fill = [this](uint32_t begin, uint32_t end, uint32_t) {
+        for (uint32_t i = begin; i < end; i++) {
+            const VisibleObject& object = visibleObjects.visible[drawableObjects[i]];
+            const SceneChunk& chunk = *visibleObjects.chunks[object.chunk];
+
+            uint32_t materialIndex = chunk.materials[object.row].materialIndex;
+            RenderMaterial material = materialIndex < materials.size() ? materials[materialIndex] : RenderMaterial();
+
+            DrawPacket packet;
+            packet.pass = material.pass;
+            packet.pipeline = material.pipeline;
+            packet.material = materialIndex;
+            packet.mesh = chunk.meshes[object.row].meshIndex;
+            // Clip-space w of the bounds center: view depth under a perspective projection
+            packet.depth = viewProjection[3] * chunk.boundsCenterX[object.row] +
+                           viewProjection[7] * chunk.boundsCenterY[object.row] +
+                           viewProjection[11] * chunk.boundsCenterZ[object.row] +
+                           viewProjection[15];
+            packet.backToFront = material.backToFront;
+            packet.object = drawableObjects[i];
+            drawQueue.setPacket(i, packet);
+        }
+    };
+    if (threadPool != nullptr) {
+        threadPool->parallelFor(count, FrustumCuller::CULL_RANGE, fill);
+    } else {
+        fill(0, count, 0);
+    }
+
+    drawQueue.sort(threadPool);
+
+    // Instance data in sorted order, so each merged draw reads a contiguous range
+    std::vector<DrawInstance>& instances = drawQueue.getInstances();
+    auto writeInstances = [this, &instances](uint32_t begin, uint32_t end, uint32_t) {
+        for (uint32_t i = begin; i < end; i++) {
+            const VisibleObject& object = visibleObjects.visible[drawQueue.getSorted(i).object];
+            const TransformComponent& transform = visibleObjects.chunks[object.chunk]->transforms[object.row];
+
+            DrawInstance& instance = instances[i];
+            for (int c = 0; c < 3; c++) {
+                instance.position[c] = transform.position[c];
+            }
+            instance.scale = transform.scale;
+            for (int c = 0; c < 4; c++) {
+                instance.rotation[c] = transform.rotation[c];
+            }
+        }
+    };
+    if (threadPool != nullptr) {
+        threadPool->parallelFor(count, FrustumCuller::CULL_RANGE, writeInstances);
+    } else {
+        writeInstances(0, count, 0);
+    }
+}
+
+void Renderer::submitDraws() {
+    if (drawBackend == nullptr) {
+        stats.drawCount = 0;
+        stats.instanceCount = 0;
+        stats.stateChanges = 0;
+        stats.elidedStateChanges = 0;
+        stats.sortMs = 0.0;
+        return;
+    }
+
+    const DrawQueueStats& queueStats = drawQueue.submit(*drawBackend);
+    stats.drawCount = queueStats.draws;
+    stats.instanceCount = queueStats.packets;
+    stats.stateChanges = queueStats.pipelineBinds + queueStats.materialBinds + queueStats.meshBinds;
+    stats.elidedStateChanges = queueStats.elidedBinds;
+    stats.sortMs = queueStats.sortMs;
+}
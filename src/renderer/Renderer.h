@@ -2,6 +2,33 @@
 
 #include "../interfaces/IWindow.h"
 #include "../interfaces/IGraphicsContext.h"
+#include "Scene.h"
+#include "FrustumCuller.h"
+#include "DrawQueue.h"
+#include <vector>
+
+class IDrawBackend;
+class ThreadPool;
+
+// How objects with a given MaterialComponent::materialIndex are drawn
+struct RenderMaterial {
+    uint32_t pipeline = 0;      // Backend pipeline ID
+    uint32_t pass = 0;          // Lower passes draw first
+    bool backToFront = false;   // Blended: sorted by depth, not state
+};
+
+struct RendererStats {
+    uint32_t objectCount = 0;           // Objects with bounds tested this frame
+    uint32_t visibleCount = 0;
+    double cullMs = 0.0;
+    SimdLevel cullSimdLevel = SimdLevel::Scalar;
+
+    uint32_t drawCount = 0;             // Instanced draw calls
+    uint32_t instanceCount = 0;         // Objects drawn by them
+    uint32_t stateChanges = 0;          // Pipeline, material and mesh binds issued
+    uint32_t elidedStateChanges = 0;    // Binds skipped because the state was already bound
+    double sortMs = 0.0;
+};
 
 class Renderer {
 public:
@@ -10,8 +37,47 @@ public:
     void initialize();
     void renderFrame();
     void cleanup();
+
+    // Objects to draw; systems iterate its chunks directly
+    Scene& getScene() { return scene; }
+
+    // Per-frame CPU work (culling) is split across the pool; without one it
+    // runs on the calling thread. Not owned.
+    void setThreadPool(ThreadPool* pool) { threadPool = pool; }
+
+    // Column-major; objects outside its frustum are skipped from the next
+    // frame on. Until set, nothing is culled.
+    void setViewProjection(const float matrix[16]);
+
+    // Visible objects with a transform, mesh and material are drawn through
+    // the backend each frame, sorted by state, one instanced draw per run of
+    // the same mesh and material; without one nothing is submitted. Not owned.
+    void setDrawBackend(IDrawBackend* backend) { drawBackend = backend; }
+    // Materials never set draw with RenderMaterial's defaults
+    void setMaterial(uint32_t materialIndex, const RenderMaterial& material);
+
+    // Objects that passed culling in the last renderFrame
+    const SceneCullResult& getVisibleObjects() const { return visibleObjects; }
+    RendererStats getStats() const { return stats; }
     
 private:
     IWindow* window;
     IGraphicsContext* context;
+    Scene scene;
+
+    ThreadPool* threadPool;
+    FrustumCuller culler;
+    float frustumPlanes[6][4];
+    float viewProjection[16];
+    SceneCullResult visibleObjects;
+
+    IDrawBackend* drawBackend;
+    std::vector<RenderMaterial> materials;
+    std::vector<uint32_t> drawableObjects;     // Indices into visibleObjects.visible
+    DrawQueue drawQueue;
+    RendererStats stats;
+
+    void cullScene();
+    void buildDrawQueue();
+    void submitDraws();
 };
\ No newline at end of file
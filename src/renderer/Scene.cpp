@@ -0,0 +1,350 @@
+#include "Scene.h"
+#include "../utils/ThreadPool.h"
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+const ComponentMask ALL_COMPONENTS = (1u << static_cast<uint32_t>(SceneComponent::Count)) - 1;
+const uint32_t SIMD_WIDTH = 8;
+const uint32_t INVALID_INDEX = UINT32_MAX;
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Places every column of the archetype in `base` (may be null to measure)
+// and returns the bytes used
+size_t layoutChunk(ComponentMask mask, uint32_t capacity, uint8_t* base, SceneChunk& view) {
+    size_t offset = 0;
+    auto column = [&](size_t elementSize) -> uint8_t* {
+        uint8_t* pointer = base ? base + offset : nullptr;
+        offset += alignUp(elementSize * capacity, Scene::CHUNK_ALIGNMENT);
+        return pointer;
+    };
+
+    view = SceneChunk{};
+    view.mask = mask;
+    view.capacity = capacity;
+    view.entities = reinterpret_cast<Entity*>(column(sizeof(Entity)));
+    if (mask & componentBit(SceneComponent::Transform)) {
+        view.transforms = reinterpret_cast<TransformComponent*>(column(sizeof(TransformComponent)));
+    }
+    if (mask & componentBit(SceneComponent::Bounds)) {
+        view.boundsCenterX = reinterpret_cast<float*>(column(sizeof(float)));
+        view.boundsCenterY = reinterpret_cast<float*>(column(sizeof(float)));
+        view.boundsCenterZ = reinterpret_cast<float*>(column(sizeof(float)));
+        view.boundsRadius = reinterpret_cast<float*>(column(sizeof(float)));
+    }
+    if (mask & componentBit(SceneComponent::Mesh)) {
+        view.meshes = reinterpret_cast<MeshComponent*>(column(sizeof(MeshComponent)));
+    }
+    if (mask & componentBit(SceneComponent::Material)) {
+        view.materials = reinterpret_cast<MaterialComponent*>(column(sizeof(MaterialComponent)));
+    }
+    return offset;
+}
+
+void writeBounds(SceneChunk& chunk, uint32_t row, const BoundsComponent& bounds) {
+    chunk.boundsCenterX[row] = bounds.center[0];
+    chunk.boundsCenterY[row] = bounds.center[1];
+    chunk.boundsCenterZ[row] = bounds.center[2];
+    chunk.boundsRadius[row] = bounds.radius;
+}
+
+BoundsComponent readBounds(const SceneChunk& chunk, uint32_t row) {
+    BoundsComponent bounds;
+    bounds.center[0] = chunk.boundsCenterX[row];
+    bounds.center[1] = chunk.boundsCenterY[row];
+    bounds.center[2] = chunk.boundsCenterZ[row];
+    bounds.radius = chunk.boundsRadius[row];
+    return bounds;
+}
+
+// Copies the components both chunks have; the rest of dst's row is reset
+void copyRow(const SceneChunk& src, uint32_t srcRow, SceneChunk& dst, uint32_t dstRow) {
+    dst.entities[dstRow] = src.entities[srcRow];
+    if (dst.transforms) {
+        dst.transforms[dstRow] = src.transforms ? src.transforms[srcRow] : TransformComponent{};
+    }
+    if (dst.boundsRadius) {
+        writeBounds(dst, dstRow, src.boundsRadius ? readBounds(src, srcRow) : BoundsComponent{});
+    }
+    if (dst.meshes) {
+        dst.meshes[dstRow] = src.meshes ? src.meshes[srcRow] : MeshComponent{};
+    }
+    if (dst.materials) {
+        dst.materials[dstRow] = src.materials ? src.materials[srcRow] : MaterialComponent{};
+    }
+}
+
+}
+
+void Scene::ChunkDeleter::operator()(uint8_t* memory) const {
+    ::operator delete(memory, std::align_val_t(CHUNK_ALIGNMENT));
+}
+
+Scene::Scene()
+    : archetypes()
+    , records()
+    , freeIndices()
+    , entityCount(0)
+{
+}
+
+Scene::~Scene() = default;
+
+uint32_t Scene::chunkCapacity(ComponentMask components) {
+    // Largest multiple of the SIMD width whose aligned columns fit
+    // (CHUNK_ALIGNMENT rows keep every column aligned, so this is exact)
+    SceneChunk view;
+    size_t perEntity = layoutChunk(components, CHUNK_ALIGNMENT, nullptr, view) / CHUNK_ALIGNMENT;
+    uint32_t capacity = static_cast<uint32_t>(CHUNK_SIZE / perEntity) / SIMD_WIDTH * SIMD_WIDTH;
+    while (capacity > SIMD_WIDTH && layoutChunk(components, capacity, nullptr, view) > CHUNK_SIZE) {
+        capacity -= SIMD_WIDTH;
+    }
+    return std::max(capacity, SIMD_WIDTH);
+}
+
+// ==================== Entities ====================
+
+Entity Scene::createEntity(ComponentMask components) {
+    if (components & ~ALL_COMPONENTS) {
+        throw std::runtime_error("Scene: unknown component in mask!");
+    }
+
+    Entity entity;
+    if (!freeIndices.empty()) {
+        entity.index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        entity.index = static_cast<uint32_t>(records.size());
+        records.push_back({ 0, INVALID_INDEX, 0, 0 });
+    }
+
+    EntityRecord& record = records[entity.index];
+    entity.generation = record.generation;
+    record.archetype = findOrCreateArchetype(components);
+    allocateRow(record.archetype, record.chunk, record.row);
+
+    // A chunk with no components: everything but the handle is defaulted
+    SceneChunk defaults;
+    defaults.entities = &entity;
+    copyRow(defaults, 0, getChunk(record), record.row);
+
+    entityCount++;
+    return entity;
+}
+
+void Scene::destroyEntity(Entity entity) {
+    EntityRecord record = getRecord(entity);
+    releaseRow(record.archetype, record.chunk, record.row);
+
+    EntityRecord& freed = records[entity.index];
+    freed.generation++;
+    freed.archetype = INVALID_INDEX;
+    freeIndices.push_back(entity.index);
+    entityCount--;
+}
+
+bool Scene::isAlive(Entity entity) const {
+    return entity.index < records.size() &&
+           records[entity.index].archetype != INVALID_INDEX &&
+           records[entity.index].generation == entity.generation;
+}
+
+void Scene::addComponents(Entity entity, ComponentMask components) {
+    moveEntity(entity, getComponents(entity) | components);
+}
+
+void Scene::removeComponents(Entity entity, ComponentMask components) {
+    moveEntity(entity, getComponents(entity) & ~components);
+}
+
+ComponentMask Scene::getComponents(Entity entity) const {
+    return archetypes[getRecord(entity).archetype].mask;
+}
+
+void Scene::clear() {
+    archetypes.clear();
+
+    // Records are kept and every live one retired as in destroyEntity, so
+    // handles from before the clear stay invalid once indices are reused
+    freeIndices.clear();
+    for (uint32_t index = static_cast<uint32_t>(records.size()); index-- > 0;) {
+        EntityRecord& record = records[index];
+        if (record.archetype != INVALID_INDEX) {
+            record.generation++;
+            record.archetype = INVALID_INDEX;
+        }
+        freeIndices.push_back(index);
+    }
+    entityCount = 0;
+}
+
+// ==================== Components ====================
+
+TransformComponent& Scene::getTransform(Entity entity) {
+    uint32_t row;
+    return requireComponent(entity, SceneComponent::Transform, row).transforms[row];
+}
+
+MeshComponent& Scene::getMesh(Entity entity) {
+    uint32_t row;
+    return requireComponent(entity, SceneComponent::Mesh, row).meshes[row];
+}
+
+MaterialComponent& Scene::getMaterial(Entity entity) {
+    uint32_t row;
+    return requireComponent(entity, SceneComponent::Material, row).materials[row];
+}
+
+BoundsComponent Scene::getBounds(Entity entity) const {
+    uint32_t row;
+    const SceneChunk& chunk = requireComponent(entity, SceneComponent::Bounds, row);
+    return readBounds(chunk, row);
+}
+
+void Scene::setBounds(Entity entity, const BoundsComponent& bounds) {
+    uint32_t row;
+    SceneChunk& chunk = requireComponent(entity, SceneComponent::Bounds, row);
+    writeBounds(chunk, row, bounds);
+}
+
+// ==================== Iteration ====================
+
+void Scene::forEachChunk(ComponentMask components, const ChunkFn& fn) {
+    for (SceneChunk* chunk : getChunks(components)) {
+        fn(*chunk);
+    }
+}
+
+void Scene::parallelForEachChunk(ThreadPool& pool, ComponentMask components, const ParallelChunkFn& fn) {
+    std::vector<SceneChunk*> chunks = getChunks(components);
+    pool.parallelFor(static_cast<uint32_t>(chunks.size()), [&](uint32_t index, uint32_t threadSlot) {
+        fn(*chunks[index], threadSlot);
+    });
+}
+
+std::vector<SceneChunk*> Scene::getChunks(ComponentMask components) {
+    std::vector<SceneChunk*> result;
+    for (Archetype& archetype : archetypes) {
+        if ((archetype.mask & components) != components) {
+            continue;
+        }
+        for (std::unique_ptr<Chunk>& chunk : archetype.chunks) {
+            if (chunk->view.count > 0) {
+                result.push_back(&chunk->view);
+            }
+        }
+    }
+    return result;
+}
+
+SceneStats Scene::getStats() const {
+    SceneStats stats;
+    stats.entityCount = entityCount;
+    stats.archetypeCount = static_cast<uint32_t>(archetypes.size());
+    for (const Archetype& archetype : archetypes) {
+        stats.chunkCount += static_cast<uint32_t>(archetype.chunks.size());
+    }
+    stats.chunkBytes = static_cast<uint64_t>(stats.chunkCount) * CHUNK_SIZE;
+    return stats;
+}
+
+// ==================== Storage ====================
+
+uint32_t Scene::findOrCreateArchetype(ComponentMask mask) {
+    // At most 2^Count archetypes; a linear search beats hashing here
+    for (uint32_t i = 0; i < archetypes.size(); i++) {
+        if (archetypes[i].mask == mask) {
+            return i;
+        }
+    }
+
+    Archetype archetype;
+    archetype.mask = mask;
+    archetype.capacity = chunkCapacity(mask);
+    archetypes.push_back(std::move(archetype));
+    return static_cast<uint32_t>(archetypes.size() - 1);
+}
+
+void Scene::allocateRow(uint32_t archetypeIndex, uint32_t& chunk, uint32_t& row) {
+    Archetype& archetype = archetypes[archetypeIndex];
+    if (archetype.chunks.empty() || archetype.chunks.back()->view.count == archetype.capacity) {
+        auto created = std::make_unique<Chunk>();
+        created->memory.reset(static_cast<uint8_t*>(
+            ::operator new(CHUNK_SIZE, std::align_val_t(CHUNK_ALIGNMENT))));
+        layoutChunk(archetype.mask, archetype.capacity, created->memory.get(), created->view);
+        archetype.chunks.push_back(std::move(created));
+    }
+
+    chunk = static_cast<uint32_t>(archetype.chunks.size() - 1);
+    row = archetype.chunks.back()->view.count++;
+}
+
+void Scene::releaseRow(uint32_t archetypeIndex, uint32_t chunk, uint32_t row) {
+    // Fill the hole with the archetype's very last entity so every chunk but
+    // the last stays full
+    Archetype& archetype = archetypes[archetypeIndex];
+    SceneChunk& last = archetype.chunks.back()->view;
+    uint32_t lastRow = last.count - 1;
+
+    SceneChunk& target = archetype.chunks[chunk]->view;
+    if (&target != &last || row != lastRow) {
+        copyRow(last, lastRow, target, row);
+        EntityRecord& moved = records[target.entities[row].index];
+        moved.chunk = chunk;
+        moved.row = row;
+    }
+
+    if (--last.count == 0) {
+        archetype.chunks.pop_back();
+    }
+}
+
+void Scene::moveEntity(Entity entity, ComponentMask mask) {
+    if (mask & ~ALL_COMPONENTS) {
+        throw std::runtime_error("Scene: unknown component in mask!");
+    }
+
+    EntityRecord from = getRecord(entity);
+    if (archetypes[from.archetype].mask == mask) {
+        return;
+    }
+
+    // Copy first: releasing the old row may move another entity into it
+    uint32_t archetype = findOrCreateArchetype(mask);
+    uint32_t chunk;
+    uint32_t row;
+    allocateRow(archetype, chunk, row);
+    copyRow(getChunk(from), from.row, archetypes[archetype].chunks[chunk]->view, row);
+    releaseRow(from.archetype, from.chunk, from.row);
+
+    EntityRecord& record = records[entity.index];
+    record.archetype = archetype;
+    record.chunk = chunk;
+    record.row = row;
+}
+
+const Scene::EntityRecord& Scene::getRecord(Entity entity) const {
+    if (!isAlive(entity)) {
+        throw std::runtime_error("Scene: entity is not alive!");
+    }
+    return records[entity.index];
+}
+
+SceneChunk& Scene::getChunk(const EntityRecord& record) const {
+    return archetypes[record.archetype].chunks[record.chunk]->view;
+}
+
+SceneChunk& Scene::requireComponent(Entity entity, SceneComponent component, uint32_t& row) const {
+    const EntityRecord& record = getRecord(entity);
+    SceneChunk& chunk = getChunk(record);
+    if (!chunk.has(componentBit(component))) {
+        throw std::runtime_error("Scene: entity lacks the requested component!");
+    }
+    row = record.row;
+    return chunk;
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class ThreadPool;
+
+// Generational handle; stale handles of destroyed entities are detected
+struct Entity {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+enum class SceneComponent : uint8_t {
+    Transform,
+    Bounds,
+    Mesh,
+    Material,
+    Count
+};
+
+using ComponentMask = uint32_t;
+
+constexpr ComponentMask componentBit(SceneComponent component) {
+    return 1u << static_cast<uint32_t>(component);
+}
+
+// The archetype every renderable object has
+constexpr ComponentMask RENDERABLE_COMPONENTS =
+    componentBit(SceneComponent::Transform) | componentBit(SceneComponent::Bounds) |
+    componentBit(SceneComponent::Mesh) | componentBit(SceneComponent::Material);
+
+struct TransformComponent {
+    float position[3] = { 0.0f, 0.0f, 0.0f };
+    float scale = 1.0f;
+    float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };    // Quaternion xyzw
+};
+
+// World-space bounding sphere
+struct BoundsComponent {
+    float center[3] = { 0.0f, 0.0f, 0.0f };
+    float radius = 0.0f;
+};
+
+struct MeshComponent {
+    uint32_t meshIndex = 0;
+};
+
+struct MaterialComponent {
+    uint32_t materialIndex = 0;
+};
+
+/**
+ * SceneChunk - Fixed-size block of entities sharing one archetype
+ *
+ * Each component is a separate array of `capacity` elements; bounds are
+ * split further into four float streams so culling can load 8 spheres per
+ * AVX register. Arrays start on a 64-byte boundary and capacity is a
+ * multiple of 8. Entities [0, count) are live and densely packed.
+ *
+ * Arrays of components outside the archetype are null.
+ */
+struct SceneChunk {
+    ComponentMask mask = 0;
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+
+    Entity* entities = nullptr;
+    TransformComponent* transforms = nullptr;
+    float* boundsCenterX = nullptr;
+    float* boundsCenterY = nullptr;
+    float* boundsCenterZ = nullptr;
+    float* boundsRadius = nullptr;
+    MeshComponent* meshes = nullptr;
+    MaterialComponent* materials = nullptr;
+
+    bool has(ComponentMask components) const { return (mask & components) == components; }
+};
+
+struct SceneStats {
+    uint32_t entityCount = 0;
+    uint32_t archetypeCount = 0;
+    uint32_t chunkCount = 0;
+    uint64_t chunkBytes = 0;            // chunkCount * Scene::CHUNK_SIZE
+};
+
+/**
+ * Scene - Archetype-based entity storage
+ *
+ * Entities with the same set of components (archetype) live together in
+ * 16 KiB SceneChunks, so a system touching N objects walks N contiguous
+ * elements per component instead of N heap nodes. Destroying an entity
+ * moves the chunk's last entity into its row; adding or removing
+ * components moves it to another archetype. Either invalidates pointers
+ * into chunks, but not Entity handles.
+ *
+ * Structural changes (create, destroy, add/remove components) are not
+ * thread-safe. Component data of different chunks may be written from
+ * different threads, e.g. inside parallelForEachChunk.
+ */
+class Scene {
+public:
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+    static constexpr size_t CHUNK_ALIGNMENT = 64;
+
+    using ChunkFn = std::function<void(SceneChunk& chunk)>;
+    using ParallelChunkFn = std::function<void(SceneChunk& chunk, uint32_t threadSlot)>;
+
+    Scene();
+    ~Scene();
+
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    // Components start default-initialized
+    Entity createEntity(ComponentMask components);
+    void destroyEntity(Entity entity);
+    bool isAlive(Entity entity) const;
+
+    void addComponents(Entity entity, ComponentMask components);
+    void removeComponents(Entity entity, ComponentMask components);
+    ComponentMask getComponents(Entity entity) const;
+
+    // Throw if the entity is dead or lacks the component
+    TransformComponent& getTransform(Entity entity);
+    MeshComponent& getMesh(Entity entity);
+    MaterialComponent& getMaterial(Entity entity);
+    BoundsComponent getBounds(Entity entity) const;
+    void setBounds(Entity entity, const BoundsComponent& bounds);
+
+    // Visits every non-empty chunk whose archetype contains `components`
+    void forEachChunk(ComponentMask components, const ChunkFn& fn);
+
+    // Same, one chunk per task on the pool; blocks until all chunks ran
+    void parallelForEachChunk(ThreadPool& pool, ComponentMask components, const ParallelChunkFn& fn);
+
+    // Chunks matching `components`, for systems that schedule work themselves
+    std::vector<SceneChunk*> getChunks(ComponentMask components);
+
+    uint32_t getEntityCount() const { return entityCount; }
+    SceneStats getStats() const;
+
+    // Entities one chunk holds for an archetype
+    static uint32_t chunkCapacity(ComponentMask components);
+
+    // Destroys every entity; existing handles stay dead
+    void clear();
+
+private:
+    struct ChunkDeleter {
+        void operator()(uint8_t* memory) const;
+    };
+
+    struct Chunk {
+        std::unique_ptr<uint8_t, ChunkDeleter> memory;
+        SceneChunk view;
+    };
+
+    struct Archetype {
+        ComponentMask mask;
+        uint32_t capacity;
+        std::vector<std::unique_ptr<Chunk>> chunks;    // All full except the last
+    };
+
+    struct EntityRecord {
+        uint32_t generation;
+        uint32_t archetype;     // UINT32_MAX when the index is free
+        uint32_t chunk;
+        uint32_t row;
+    };
+
+    std::vector<Archetype> archetypes;
+    std::vector<EntityRecord> records;
+    std::vector<uint32_t> freeIndices;
+    uint32_t entityCount;
+
+    uint32_t findOrCreateArchetype(ComponentMask mask);
+    void allocateRow(uint32_t archetype, uint32_t& chunk, uint32_t& row);
+    void releaseRow(uint32_t archetype, uint32_t chunk, uint32_t row);
+    void moveEntity(Entity entity, ComponentMask mask);
+    const EntityRecord& getRecord(Entity entity) const;
+    SceneChunk& getChunk(const EntityRecord& record) const;
+    SceneChunk& requireComponent(Entity entity, SceneComponent component, uint32_t& row) const;
+};
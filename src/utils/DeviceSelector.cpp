@@ -0,0 +1,137 @@
+#include "DeviceSelector.h"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace {
+
+const int64_t MAX_VRAM_SCORE = 32768;      // 1 per MiB, capped at 32 GiB
+const int64_t QUEUE_SCORE = 1000;
+const int64_t FEATURE_SCORE = 1000;
+const int64_t FEATURE_COUNT = 6;
+
+// Everything below the device type: VRAM, a transfer queue (2x), an async
+// compute queue and each optional feature
+const int64_t MAX_TIEBREAK_SCORE = MAX_VRAM_SCORE + 3 * QUEUE_SCORE + FEATURE_COUNT * FEATURE_SCORE;
+
+// Type ranks step past the largest tie-break total, so the worst device of
+// one type still outscores the best device of the type below it
+const int64_t TYPE_STEP = 100000;
+static_assert(TYPE_STEP > MAX_TIEBREAK_SCORE, "device type must dominate every tie-break");
+
+int64_t typeScore(DeviceType type) {
+    switch (type) {
+    case DeviceType::Discrete:   return 4 * TYPE_STEP;
+    case DeviceType::Integrated: return 3 * TYPE_STEP;
+    case DeviceType::Virtual:    return 2 * TYPE_STEP;
+    case DeviceType::Other:      return 1 * TYPE_STEP;
+    case DeviceType::Cpu:        return 0;
+    }
+    return 0;
+}
+
+std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+bool isIndex(const std::string& text) {
+    return !text.empty() && std::all_of(text.begin(), text.end(),
+                                        [](unsigned char c) { return std::isdigit(c) != 0; });
+}
+
+}
+
+std::string DeviceSelector::rejectReason(const DeviceProfile& profile) {
+    if (!profile.suitable) {
+        return "missing queue families, extensions or swapchain support";
+    }
+    if (profile.apiVersion < API_VERSION_1_2) {
+        return "Vulkan 1.2 not supported";
+    }
+    if (!profile.timelineSemaphore) {
+        return "timeline semaphores not supported";
+    }
+    return "";
+}
+
+int64_t DeviceSelector::score(const DeviceProfile& profile) {
+    if (!rejectReason(profile).empty()) {
+        return -1;
+    }
+
+    int64_t score = typeScore(profile.type);
+    score += std::min<int64_t>(static_cast<int64_t>(profile.deviceLocalBytes >> 20), MAX_VRAM_SCORE);
+
+    // Streaming and async compute overlap with graphics only on their own queues
+    score += profile.dedicatedTransferQueue ? 2 * QUEUE_SCORE : 0;
+    score += profile.asyncComputeQueue ? QUEUE_SCORE : 0;
+
+    const bool features[] = {
+        profile.bindless, profile.drawIndirectCount, profile.multiDrawIndirect,
+        profile.synchronization2, profile.dynamicRendering, profile.presentWait
+    };
+    static_assert(sizeof(features) / sizeof(features[0]) == FEATURE_COUNT, "FEATURE_COUNT is out of date");
+    for (bool feature : features) {
+        score += feature ? FEATURE_SCORE : 0;
+    }
+    return score;
+}
+
+size_t DeviceSelector::select(const std::vector<DeviceProfile>& profiles, const std::string& override) {
+    bool byIndex = isIndex(override);
+    std::string pattern = toLower(override);
+    auto matches = [&](const DeviceProfile& profile) {
+        return byIndex ? std::to_string(profile.index) == override
+                       : toLower(profile.name).find(pattern) != std::string::npos;
+    };
+
+    size_t best = profiles.size();
+    int64_t bestScore = -1;
+    bool matched = false;
+    for (size_t i = 0; i < profiles.size(); i++) {
+        const DeviceProfile& profile = profiles[i];
+        if (!override.empty()) {
+            if (!matches(profile)) {
+                continue;
+            }
+            matched = true;
+        }
+
+        // Strictly greater: ties go to the first enumerated device
+        int64_t deviceScore = score(profile);
+        if (deviceScore > bestScore) {
+            bestScore = deviceScore;
+            best = i;
+        }
+    }
+
+    if (!override.empty() && !matched) {
+        throw std::runtime_error("DeviceSelector: no device matches override \"" + override + "\"!");
+    }
+    if (best == profiles.size()) {
+        if (!override.empty()) {
+            // Report why the (first) match was rejected
+            for (const DeviceProfile& profile : profiles) {
+                if (matches(profile)) {
+                    throw std::runtime_error("DeviceSelector: " + profile.name + " cannot run the renderer: " +
+                                             rejectReason(profile) + "!");
+                }
+            }
+        }
+        throw std::runtime_error("Failed to find a suitable GPU!");
+    }
+    return best;
+}
+
+const char* DeviceSelector::typeName(DeviceType type) {
+    switch (type) {
+    case DeviceType::Discrete:   return "discrete";
+    case DeviceType::Integrated: return "integrated";
+    case DeviceType::Virtual:    return "virtual";
+    case DeviceType::Cpu:        return "cpu";
+    case DeviceType::Other:      return "other";
+    }
+    return "unknown";
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class DeviceType : uint8_t {
+    Other,
+    Integrated,
+    Discrete,
+    Virtual,
+    Cpu                 // Software rasterizer (lavapipe, SwiftShader)
+};
+
+// Everything the selector needs to know about one adapter, filled in by the
+// graphics backend (VulkanContext::pickPhysicalDevice)
+struct DeviceProfile {
+    uint32_t index = 0;                 // Enumeration order, for overrides
+    std::string name;
+    DeviceType type = DeviceType::Other;
+    uint32_t apiVersion = 0;            // VK_MAKE_API_VERSION encoding
+    uint64_t deviceLocalBytes = 0;      // Largest device-local heap
+
+    // Queues, extensions and (unless headless) swapchain support are present
+    bool suitable = false;
+    bool dedicatedTransferQueue = false;
+    bool asyncComputeQueue = false;     // Compute family without graphics
+
+    // Required
+    bool timelineSemaphore = false;
+
+    // Optional fast paths, as they would be enabled on this device
+    bool bindless = false;
+    bool drawIndirectCount = false;
+    bool multiDrawIndirect = false;
+    bool synchronization2 = false;
+    bool dynamicRendering = false;
+    bool presentWait = false;
+};
+
+/**
+ * DeviceSelector - Ranks adapters so multi-GPU hosts pick the fast one
+ *
+ * Device type dominates (a discrete card beats an integrated one with every
+ * feature), then VRAM, queue topology and optional features break ties.
+ * Devices missing a required feature are never picked, not even by
+ * override.
+ *
+ * An override is either an enumeration index ("1") or a case-insensitive
+ * substring of the device name ("nvidia", "llvmpipe"); several name matches
+ * go to the best scoring one.
+ */
+class DeviceSelector {
+public:
+    // VK_API_VERSION_1_2, without depending on the Vulkan headers
+    static constexpr uint32_t API_VERSION_1_2 = (1u << 22) | (2u << 12);
+
+    // Why the renderer cannot run on the device; empty if it can
+    static std::string rejectReason(const DeviceProfile& profile);
+
+    // Higher is better; -1 for rejected devices
+    static int64_t score(const DeviceProfile& profile);
+
+    // Position in `profiles` of the chosen device. Throws if no device is
+    // usable or the override matches no usable device.
+    static size_t select(const std::vector<DeviceProfile>& profiles, const std::string& override = "");
+
+    static const char* typeName(DeviceType type);
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Fnv1a - 64-bit FNV-1a for cache keys
+ *
+ * Feed keys field by field so struct padding never leaks into the hash.
+ */
+struct Fnv1a {
+    uint64_t value = 14695981039346656037ull;
+
+    template <typename T>
+    void add(const T& field) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&field);
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value ^= bytes[i];
+            value *= 1099511628211ull;
+        }
+    }
+};
@@ -0,0 +1,134 @@
+#include "LatencyTracker.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+double toMs(LatencyTracker::TimePoint from, LatencyTracker::TimePoint to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+double average(const std::vector<double>& values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    double total = 0.0;
+    for (double value : values) {
+        total += value;
+    }
+    return total / values.size();
+}
+
+// Nearest-rank percentile; sorts `values`
+double percentile(std::vector<double>& values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(fraction * values.size() + 0.5);
+    rank = std::min(std::max<size_t>(rank, 1), values.size());
+    return values[rank - 1];
+}
+
+}
+
+LatencyTracker::LatencyTracker(size_t historySize)
+    : historySize(std::max<size_t>(historySize, 1))
+    , hasInput(false)
+{
+}
+
+void LatencyTracker::markInput(TimePoint time) {
+    lastInput = time;
+    hasInput = true;
+}
+
+void LatencyTracker::markSubmit(uint64_t frameId, TimePoint time) {
+    Frame frame{};
+    frame.frameId = frameId;
+    frame.input = hasInput ? lastInput : time;
+    frame.submit = time;
+    frames.push_back(frame);
+
+    while (frames.size() > historySize) {
+        frames.pop_front();
+    }
+}
+
+void LatencyTracker::markPresent(uint64_t frameId, TimePoint time) {
+    if (Frame* frame = find(frameId)) {
+        frame->present = time;
+        frame->presented = true;
+    }
+}
+
+void LatencyTracker::markDisplayed(uint64_t frameId, TimePoint time) {
+    if (Frame* frame = find(frameId)) {
+        frame->displayed = time;
+        frame->hasDisplayed = true;
+    }
+}
+
+LatencyTracker::Frame* LatencyTracker::find(uint64_t frameId) {
+    // Marks arrive for recent frames, so search from the back
+    for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+        if (it->frameId == frameId) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+LatencySample LatencyTracker::toSample(const Frame& frame) {
+    LatencySample sample;
+    sample.frameId = frame.frameId;
+    sample.inputToSubmitMs = toMs(frame.input, frame.submit);
+    if (frame.presented) {
+        sample.inputToPresentMs = toMs(frame.input, frame.present);
+    }
+    if (frame.hasDisplayed) {
+        sample.inputToDisplayMs = toMs(frame.input, frame.displayed);
+    }
+    return sample;
+}
+
+LatencySample LatencyTracker::getLastSample() const {
+    for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+        if (it->presented) {
+            return toSample(*it);
+        }
+    }
+    return LatencySample{};
+}
+
+LatencyStats LatencyTracker::getStats() const {
+    std::vector<double> toSubmit;
+    std::vector<double> toPresent;
+    std::vector<double> toDisplay;
+
+    for (const Frame& frame : frames) {
+        LatencySample sample = toSample(frame);
+        toSubmit.push_back(sample.inputToSubmitMs);
+        if (frame.presented) {
+            toPresent.push_back(sample.inputToPresentMs);
+        }
+        if (frame.hasDisplayed) {
+            toDisplay.push_back(sample.inputToDisplayMs);
+        }
+    }
+
+    LatencyStats stats;
+    stats.frames = frames.size();
+    stats.displayedFrames = toDisplay.size();
+    stats.averageInputToSubmitMs = average(toSubmit);
+    stats.averageInputToPresentMs = average(toPresent);
+    stats.averageInputToDisplayMs = average(toDisplay);
+    stats.p95InputToPresentMs = percentile(toPresent, 0.95);
+    stats.p95InputToDisplayMs = percentile(toDisplay, 0.95);
+    return stats;
+}
+
+void LatencyTracker::reset() {
+    frames.clear();
+    hasInput = false;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// Milliseconds from the input sample a frame was built from; -1 when unknown
+struct LatencySample {
+    uint64_t frameId = 0;
+    double inputToSubmitMs = -1.0;
+    double inputToPresentMs = -1.0;     // vkQueuePresentKHR returned
+    double inputToDisplayMs = -1.0;     // Image reached the screen (present wait)
+};
+
+struct LatencyStats {
+    uint64_t frames = 0;                // Samples in the history window
+    uint64_t displayedFrames = 0;       // ... of which have a display time
+    double averageInputToSubmitMs = 0.0;
+    double averageInputToPresentMs = 0.0;
+    double averageInputToDisplayMs = 0.0;
+    double p95InputToPresentMs = 0.0;
+    double p95InputToDisplayMs = 0.0;
+};
+
+/**
+ * LatencyTracker - Input-to-photon latency per frame
+ *
+ * markInput() records when input was last sampled (right after pollEvents);
+ * the next markSubmit() binds that time to a frame id. markPresent() and,
+ * where the driver can report it (VK_KHR_present_wait), markDisplayed()
+ * complete the frame's sample. Statistics cover the last historySize frames.
+ *
+ * Not thread-safe; call from the render thread.
+ */
+class LatencyTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    explicit LatencyTracker(size_t historySize = 240);
+
+    void markInput(TimePoint time = Clock::now());
+    void markSubmit(uint64_t frameId, TimePoint time = Clock::now());
+    void markPresent(uint64_t frameId, TimePoint time = Clock::now());
+    void markDisplayed(uint64_t frameId, TimePoint time = Clock::now());
+
+    // Newest frame that was at least presented (frameId 0 if none)
+    LatencySample getLastSample() const;
+    LatencyStats getStats() const;
+
+    void reset();
+
+private:
+    struct Frame {
+        uint64_t frameId;
+        TimePoint input;
+        TimePoint submit;
+        TimePoint present;
+        TimePoint displayed;
+        bool presented;
+        bool hasDisplayed;
+    };
+
+    size_t historySize;
+    std::deque<Frame> frames;           // Submission order
+    TimePoint lastInput;
+    bool hasInput;
+
+    Frame* find(uint64_t frameId);
+    static LatencySample toSample(const Frame& frame);
+};
@@ -0,0 +1,95 @@
+#include "RadixSorter.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+void RadixSorter::sort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, ThreadPool* pool) {
+    if (keys.size() != values.size()) {
+        throw std::runtime_error("RadixSorter: key and value counts differ!");
+    }
+    lastPassCount = 0;
+
+    const uint32_t count = static_cast<uint32_t>(keys.size());
+    if (count < 2) {
+        return;
+    }
+
+    uint32_t blockCount = 1;
+    if (pool != nullptr) {
+        blockCount = std::max(1u, std::min(pool->getThreadSlotCount(), count / MIN_BLOCK_SIZE));
+    }
+    const uint32_t blockSize = (count + blockCount - 1) / blockCount;
+
+    keyScratch.resize(count);
+    valueScratch.resize(count);
+    blockHistograms.resize(static_cast<size_t>(blockCount) * RADIX);
+
+    // Bits that differ between any two keys; passes over constant digits are skipped
+    uint64_t varyingBits = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        varyingBits |= keys[i] ^ keys[0];
+    }
+
+    uint64_t* sourceKeys = keys.data();
+    uint32_t* sourceValues = values.data();
+    uint64_t* targetKeys = keyScratch.data();
+    uint32_t* targetValues = valueScratch.data();
+
+    auto forEachBlock = [&](const std::function<void(uint32_t block, uint32_t begin, uint32_t end)>& fn) {
+        auto run = [&](uint32_t block, uint32_t) {
+            uint32_t begin = block * blockSize;
+            fn(block, begin, std::min(begin + blockSize, count));
+        };
+        if (blockCount == 1) {
+            run(0, 0);
+        } else {
+            pool->parallelFor(blockCount, run);
+        }
+    };
+
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        if (((varyingBits >> shift) & 0xFF) == 0) {
+            continue;
+        }
+        lastPassCount++;
+
+        forEachBlock([&](uint32_t block, uint32_t begin, uint32_t end) {
+            uint32_t* histogram = &blockHistograms[static_cast<size_t>(block) * RADIX];
+            std::fill(histogram, histogram + RADIX, 0u);
+            for (uint32_t i = begin; i < end; i++) {
+                histogram[(sourceKeys[i] >> shift) & 0xFF]++;
+            }
+        });
+
+        // Exclusive prefix sum, digit-major then block order: block b's keys
+        // with digit d go right after block b-1's keys with digit d
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit < RADIX; digit++) {
+            for (uint32_t block = 0; block < blockCount; block++) {
+                uint32_t& slot = blockHistograms[static_cast<size_t>(block) * RADIX + digit];
+                uint32_t digitCount = slot;
+                slot = offset;
+                offset += digitCount;
+            }
+        }
+
+        forEachBlock([&](uint32_t block, uint32_t begin, uint32_t end) {
+            uint32_t* offsets = &blockHistograms[static_cast<size_t>(block) * RADIX];
+            for (uint32_t i = begin; i < end; i++) {
+                uint32_t position = offsets[(sourceKeys[i] >> shift) & 0xFF]++;
+                targetKeys[position] = sourceKeys[i];
+                targetValues[position] = sourceValues[i];
+            }
+        });
+
+        std::swap(sourceKeys, targetKeys);
+        std::swap(sourceValues, targetValues);
+    }
+
+    // An odd number of passes leaves the result in the scratch buffers
+    if (sourceKeys != keys.data()) {
+        keys.swap(keyScratch);
+        values.swap(valueScratch);
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * RadixSorter - Stable LSD radix sort of 64-bit keys with 32-bit payloads
+ *
+ * Eight passes of 8-bit digits; a pass is skipped when every key has the
+ * same digit there (unused high bits of sort keys cost nothing). With a
+ * ThreadPool each pass splits the keys into blocks: blocks histogram in
+ * parallel, a prefix sum over (digit, block) keeps the sort stable, and
+ * blocks scatter in parallel into the other buffer.
+ *
+ * Keeps its scratch buffers between calls; not thread-safe.
+ */
+class RadixSorter {
+public:
+    // Below this many keys per block a pass is not worth splitting
+    static constexpr uint32_t MIN_BLOCK_SIZE = 16 * 1024;
+
+    // Sorts keys ascending and moves values along with them
+    void sort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, ThreadPool* pool = nullptr);
+
+    // Passes the last sort() actually ran (0..8)
+    uint32_t getLastPassCount() const { return lastPassCount; }
+
+private:
+    static constexpr uint32_t RADIX = 256;
+
+    std::vector<uint64_t> keyScratch;
+    std::vector<uint32_t> valueScratch;
+    std::vector<uint32_t> blockHistograms;     // [block][digit]
+    uint32_t lastPassCount = 0;
+};
@@ -0,0 +1,239 @@
+#include "ShaderWatcher.h"
+#include "logger.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace {
+
+// Editors save in several steps (truncate, write, rename); wait for quiet
+constexpr auto DEBOUNCE = std::chrono::milliseconds(50);
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(100);
+
+std::string quote(const std::string& path) {
+    return "\"" + path + "\"";
+}
+
+}
+
+ShaderWatcher::ShaderWatcher(const std::string& sourceDir, const std::string& binaryDir, const std::string& compiler)
+    : sourceDir(sourceDir)
+    , binaryDir(binaryDir)
+    , compiler(compiler)
+    , running(false)
+    , inotifyFd(-1)
+    , watchDescriptor(-1)
+{
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    stop();
+}
+
+bool ShaderWatcher::isShaderSource(const std::string& fileName) {
+    static const char* extensions[] = { ".vert", ".frag", ".comp", ".geom", ".tesc", ".tese" };
+
+    std::string extension = std::filesystem::path(fileName).extension().string();
+    return std::find(std::begin(extensions), std::end(extensions), extension) != std::end(extensions);
+}
+
+// ==================== Thread ====================
+
+void ShaderWatcher::start() {
+    if (running) {
+        return;
+    }
+    if (!std::filesystem::is_directory(sourceDir)) {
+        throw std::runtime_error("ShaderWatcher: source directory not found: " + sourceDir + "!");
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(binaryDir, error);
+
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd >= 0) {
+        watchDescriptor = inotify_add_watch(inotifyFd, sourceDir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (watchDescriptor < 0) {
+            close(inotifyFd);
+            inotifyFd = -1;
+        }
+    }
+#endif
+    if (inotifyFd < 0) {
+        pollTimestamps(true);
+    }
+
+    running = true;
+    thread = std::thread(&ShaderWatcher::run, this);
+
+    Logger::info("Watching " + sourceDir + " for shader changes (" +
+                 (usesInotify() ? "inotify" : "polling") + ")");
+}
+
+void ShaderWatcher::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+#ifdef __linux__
+    if (inotifyFd >= 0) {
+        close(inotifyFd);     // Drops the watch as well
+        inotifyFd = -1;
+        watchDescriptor = -1;
+    }
+#endif
+}
+
+void ShaderWatcher::run() {
+    while (running) {
+        if (usesInotify()) {
+            readEvents();
+        } else {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+            pollTimestamps(false);
+        }
+
+        if (pending.empty() || Clock::now() - lastEvent < DEBOUNCE) {
+            continue;
+        }
+
+        std::vector<std::string> files;
+        files.swap(pending);
+        for (const std::string& file : files) {
+            ShaderCompileResult result = compile(file);
+
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            results.push_back(std::move(result));
+        }
+    }
+}
+
+std::vector<ShaderCompileResult> ShaderWatcher::takeResults() {
+    std::lock_guard<std::mutex> lock(resultsMutex);
+
+    std::vector<ShaderCompileResult> taken;
+    taken.swap(results);
+    return taken;
+}
+
+// ==================== Change Detection ====================
+
+void ShaderWatcher::readEvents() {
+#ifdef __linux__
+    // Wake up regularly so stop() is never blocked for long
+    pollfd descriptor{ inotifyFd, POLLIN, 0 };
+    int timeoutMs = static_cast<int>(pending.empty() ? POLL_INTERVAL.count() : DEBOUNCE.count());
+    if (poll(&descriptor, 1, timeoutMs) <= 0) {
+        return;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+            if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+                queue(event->name);
+            }
+            ptr += sizeof(inotify_event) + event->len;
+        }
+    }
+#endif
+}
+
+void ShaderWatcher::pollTimestamps(bool initial) {
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(sourceDir, error)) {
+        std::string fileName = entry.path().filename().string();
+        if (!entry.is_regular_file(error) || !isShaderSource(fileName)) {
+            continue;
+        }
+
+        auto writeTime = entry.last_write_time(error);
+        auto it = std::find_if(timestamps.begin(), timestamps.end(),
+            [&](const auto& known) { return known.first == fileName; });
+
+        if (it == timestamps.end()) {
+            timestamps.emplace_back(fileName, writeTime);
+            if (!initial) {
+                queue(fileName);
+            }
+        } else if (it->second != writeTime) {
+            it->second = writeTime;
+            queue(fileName);
+        }
+    }
+}
+
+void ShaderWatcher::queue(const std::string& fileName) {
+    if (!isShaderSource(fileName)) {
+        return;
+    }
+
+    lastEvent = Clock::now();
+    if (std::find(pending.begin(), pending.end(), fileName) == pending.end()) {
+        pending.push_back(fileName);
+    }
+}
+
+// ==================== Compilation ====================
+
+ShaderCompileResult ShaderWatcher::compile(const std::string& fileName) {
+    auto start = Clock::now();
+
+    ShaderCompileResult result;
+    result.sourcePath = (std::filesystem::path(sourceDir) / fileName).string();
+    result.outputPath = (std::filesystem::path(binaryDir) / (fileName + ".spv")).string();
+    std::string tempPath = result.outputPath + ".tmp";
+
+    std::string command = quote(compiler) + " " + quote(result.sourcePath) + " -o " + quote(tempPath) + " 2>&1";
+#ifdef _WIN32
+    command = "\"" + command + "\"";     // cmd.exe strips the outer quotes
+#endif
+
+    FILE* pipe = popen(command.c_str(), "r");
+    if (pipe == nullptr) {
+        result.log = "failed to run " + compiler;
+    } else {
+        std::array<char, 256> chunk;
+        while (std::fgets(chunk.data(), static_cast<int>(chunk.size()), pipe) != nullptr) {
+            result.log += chunk.data();
+        }
+        result.success = pclose(pipe) == 0;
+    }
+
+    std::error_code error;
+    if (result.success) {
+        std::filesystem::rename(tempPath, result.outputPath, error);
+        if (error) {
+            result.success = false;
+            result.log += "failed to replace " + result.outputPath + ": " + error.message();
+        }
+    }
+    if (!result.success) {
+        std::filesystem::remove(tempPath, error);
+    }
+
+    result.compileMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    if (result.success) {
+        Logger::info("Recompiled " + fileName + " (" + std::to_string(result.compileMs) + " ms)");
+    } else {
+        Logger::error("Failed to recompile " + fileName + ":\n" + result.log);
+    }
+    return result;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ShaderCompileResult {
+    std::string sourcePath;         // GLSL file that changed
+    std::string outputPath;         // <binaryDir>/<file>.spv, replaced only on success
+    bool success = false;
+    std::string log;                // Compiler output (errors and warnings)
+    double compileMs = 0.0;
+};
+
+/**
+ * ShaderWatcher - Development-time GLSL hot reload
+ *
+ * Watches a shader source directory (inotify on Linux, timestamp polling
+ * elsewhere) and recompiles changed files on its own thread by running
+ * `<compiler> <source> -o <output>`, the same invocation the build uses.
+ * Bursts of events from one save are debounced into a single compile.
+ * Output is written to a temporary file and renamed, so a failed compile
+ * leaves the previous SPIR-V in place.
+ *
+ * The render thread drains takeResults() at a frame boundary and swaps in
+ * the affected pipelines; the watcher itself never touches Vulkan.
+ */
+class ShaderWatcher {
+public:
+    ShaderWatcher(const std::string& sourceDir, const std::string& binaryDir,
+                  const std::string& compiler = "glslc");
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    void start();
+    void stop();
+    bool isRunning() const { return running; }
+    bool usesInotify() const { return inotifyFd >= 0; }
+
+    // Compiles finished since the last call, oldest first
+    std::vector<ShaderCompileResult> takeResults();
+
+    // .vert, .frag, .comp, .geom, .tesc, .tese
+    static bool isShaderSource(const std::string& fileName);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::string sourceDir;
+    std::string binaryDir;
+    std::string compiler;
+
+    std::thread thread;
+    std::atomic<bool> running;
+    int inotifyFd;
+    int watchDescriptor;
+
+    // Watcher thread only
+    std::vector<std::string> pending;
+    Clock::time_point lastEvent;
+    std::vector<std::pair<std::string, std::filesystem::file_time_type>> timestamps;
+
+    std::vector<ShaderCompileResult> results;
+    std::mutex resultsMutex;
+
+    void run();
+    void readEvents();
+    void pollTimestamps(bool initial);
+    void queue(const std::string& fileName);
+    ShaderCompileResult compile(const std::string& fileName);
+};
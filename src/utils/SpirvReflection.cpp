@@ -0,0 +1,613 @@
+#include "SpirvReflection.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+constexpr size_t HEADER_WORDS = 5;
+constexpr uint32_t NONE = UINT32_MAX;
+
+// Opcodes
+enum : uint32_t {
+    OpName = 5,
+    OpEntryPoint = 15,
+    OpExecutionMode = 16,
+    OpTypeBool = 20,
+    OpTypeInt = 21,
+    OpTypeFloat = 22,
+    OpTypeVector = 23,
+    OpTypeMatrix = 24,
+    OpTypeImage = 25,
+    OpTypeSampler = 26,
+    OpTypeSampledImage = 27,
+    OpTypeArray = 28,
+    OpTypeRuntimeArray = 29,
+    OpTypeStruct = 30,
+    OpTypePointer = 32,
+    OpConstant = 43,
+    OpSpecConstantTrue = 48,
+    OpSpecConstantFalse = 49,
+    OpSpecConstant = 50,
+    OpVariable = 59,
+    OpDecorate = 71,
+    OpMemberDecorate = 72,
+    OpTypeAccelerationStructureKHR = 5341
+};
+
+// Decorations
+enum : uint32_t {
+    DecorationSpecId = 1,
+    DecorationBlock = 2,
+    DecorationBufferBlock = 3,
+    DecorationArrayStride = 6,
+    DecorationMatrixStride = 7,
+    DecorationBuiltIn = 11,
+    DecorationLocation = 30,
+    DecorationBinding = 33,
+    DecorationDescriptorSet = 34,
+    DecorationOffset = 35
+};
+
+// Storage classes
+enum : uint32_t {
+    StorageUniformConstant = 0,
+    StorageInput = 1,
+    StorageUniform = 2,
+    StoragePushConstant = 9,
+    StorageStorageBuffer = 12
+};
+
+constexpr uint32_t ExecutionModeLocalSize = 17;
+constexpr uint32_t DimBuffer = 5;
+constexpr uint32_t DimSubpassData = 6;
+
+struct Decorations {
+    uint32_t set = NONE;
+    uint32_t binding = NONE;
+    uint32_t location = NONE;
+    uint32_t specId = NONE;
+    uint32_t arrayStride = 0;
+    bool builtIn = false;
+    bool block = false;
+    bool bufferBlock = false;
+};
+
+struct MemberDecorations {
+    uint32_t offset = NONE;
+    uint32_t matrixStride = 0;
+};
+
+// One OpType*; operands keep their SPIR-V order
+struct Type {
+    uint32_t opcode = 0;
+    std::vector<uint32_t> operands;
+};
+
+struct Variable {
+    uint32_t id;
+    uint32_t typeId;
+    uint32_t storageClass;
+};
+
+struct Module {
+    uint32_t bound = 0;
+    uint32_t executionModel = NONE;
+    uint32_t entryPointId = NONE;
+    std::string entryPoint;
+    uint32_t localSize[3] = { 0, 0, 0 };
+
+    std::unordered_map<uint32_t, std::string> names;
+    std::unordered_map<uint32_t, Decorations> decorations;
+    std::unordered_map<uint32_t, std::vector<MemberDecorations>> memberDecorations;
+    std::unordered_map<uint32_t, Type> types;
+    std::unordered_map<uint32_t, uint32_t> constants;
+    std::vector<std::pair<uint32_t, Type>> specConstants;   // (id, opcode + result type + value)
+    std::vector<Variable> variables;
+
+    const Type& type(uint32_t id) const {
+        auto it = types.find(id);
+        if (it == types.end()) {
+            throw std::runtime_error("SpirvReflection: reference to unknown type!");
+        }
+        return it->second;
+    }
+
+    Decorations decorationsOf(uint32_t id) const {
+        auto it = decorations.find(id);
+        return it != decorations.end() ? it->second : Decorations{};
+    }
+
+    std::string nameOf(uint32_t id) const {
+        auto it = names.find(id);
+        return it != names.end() ? it->second : std::string();
+    }
+};
+
+std::string readString(const uint32_t* words, size_t count) {
+    std::string text(reinterpret_cast<const char*>(words), count * sizeof(uint32_t));
+    return text.substr(0, text.find('\0'));
+}
+
+uint32_t stageFromExecutionModel(uint32_t model) {
+    switch (model) {
+    case 0: return SPIRV_STAGE_VERTEX;
+    case 1: return SPIRV_STAGE_TESSELLATION_CONTROL;
+    case 2: return SPIRV_STAGE_TESSELLATION_EVALUATION;
+    case 3: return SPIRV_STAGE_GEOMETRY;
+    case 4: return SPIRV_STAGE_FRAGMENT;
+    case 5: return SPIRV_STAGE_COMPUTE;
+    default: return 0;
+    }
+}
+
+void parseInstruction(Module& module, uint32_t opcode, const uint32_t* operands, size_t count) {
+    auto require = [count](size_t words) {
+        if (count < words) {
+            throw std::runtime_error("SpirvReflection: truncated instruction!");
+        }
+    };
+
+    switch (opcode) {
+    case OpName:
+        require(2);
+        module.names[operands[0]] = readString(operands + 1, count - 1);
+        break;
+
+    case OpEntryPoint:
+        require(3);
+        if (module.entryPointId == NONE) {
+            module.executionModel = operands[0];
+            module.entryPointId = operands[1];
+            module.entryPoint = readString(operands + 2, count - 2);
+        }
+        break;
+
+    case OpExecutionMode:
+        require(2);
+        if (operands[0] == module.entryPointId && operands[1] == ExecutionModeLocalSize) {
+            require(5);
+            std::memcpy(module.localSize, operands + 2, sizeof(module.localSize));
+        }
+        break;
+
+    case OpDecorate: {
+        require(2);
+        Decorations& decoration = module.decorations[operands[0]];
+        uint32_t value = count > 2 ? operands[2] : 0;
+        switch (operands[1]) {
+        case DecorationSpecId:        decoration.specId = value; break;
+        case DecorationBlock:         decoration.block = true; break;
+        case DecorationBufferBlock:   decoration.bufferBlock = true; break;
+        case DecorationArrayStride:   decoration.arrayStride = value; break;
+        case DecorationBuiltIn:       decoration.builtIn = true; break;
+        case DecorationLocation:      decoration.location = value; break;
+        case DecorationBinding:       decoration.binding = value; break;
+        case DecorationDescriptorSet: decoration.set = value; break;
+        default: break;
+        }
+        break;
+    }
+
+    case OpMemberDecorate: {
+        require(3);
+        std::vector<MemberDecorations>& members = module.memberDecorations[operands[0]];
+        if (members.size() <= operands[1]) {
+            members.resize(operands[1] + 1);
+        }
+        uint32_t value = count > 3 ? operands[3] : 0;
+        if (operands[2] == DecorationOffset) {
+            members[operands[1]].offset = value;
+        } else if (operands[2] == DecorationMatrixStride) {
+            members[operands[1]].matrixStride = value;
+        }
+        break;
+    }
+
+    case OpTypeBool:
+    case OpTypeInt:
+    case OpTypeFloat:
+    case OpTypeVector:
+    case OpTypeMatrix:
+    case OpTypeImage:
+    case OpTypeSampler:
+    case OpTypeSampledImage:
+    case OpTypeArray:
+    case OpTypeRuntimeArray:
+    case OpTypeStruct:
+    case OpTypeAccelerationStructureKHR: {
+        require(1);
+        Type type;
+        type.opcode = opcode;
+        type.operands.assign(operands + 1, operands + count);
+        module.types[operands[0]] = std::move(type);
+        break;
+    }
+
+    case OpTypePointer: {
+        require(3);
+        Type type;
+        type.opcode = opcode;
+        type.operands = { operands[1], operands[2] };     // storage class, pointee
+        module.types[operands[0]] = std::move(type);
+        break;
+    }
+
+    case OpConstant:
+        require(3);
+        module.constants[operands[1]] = operands[2];
+        break;
+
+    case OpSpecConstantTrue:
+    case OpSpecConstantFalse:
+    case OpSpecConstant: {
+        require(2);
+        Type constant;
+        constant.opcode = opcode;
+        constant.operands.push_back(operands[0]);
+        constant.operands.push_back(opcode == OpSpecConstant && count > 2 ? operands[2]
+                                    : opcode == OpSpecConstantTrue ? 1u : 0u);
+        module.specConstants.emplace_back(operands[1], std::move(constant));
+        break;
+    }
+
+    case OpVariable:
+        require(3);
+        module.variables.push_back({ operands[1], operands[0], operands[2] });
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Byte size of a type as laid out in a block (explicit offsets/strides win)
+uint32_t typeSize(const Module& module, uint32_t typeId, uint32_t matrixStride = 0) {
+    const Type& type = module.type(typeId);
+    switch (type.opcode) {
+    case OpTypeBool:
+        return 4;
+    case OpTypeInt:
+    case OpTypeFloat:
+        return type.operands.at(0) / 8;
+    case OpTypeVector:
+        return type.operands.at(1) * typeSize(module, type.operands.at(0));
+    case OpTypeMatrix: {
+        uint32_t columnSize = matrixStride != 0 ? matrixStride : typeSize(module, type.operands.at(0));
+        return type.operands.at(1) * columnSize;
+    }
+    case OpTypeArray: {
+        auto length = module.constants.find(type.operands.at(1));
+        if (length == module.constants.end()) {
+            return 0;   // Sized by a specialization constant
+        }
+        uint32_t stride = module.decorationsOf(typeId).arrayStride;
+        return length->second * (stride != 0 ? stride : typeSize(module, type.operands.at(0)));
+    }
+    case OpTypeStruct: {
+        auto members = module.memberDecorations.find(typeId);
+        uint32_t size = 0;
+        for (size_t i = 0; i < type.operands.size(); i++) {
+            MemberDecorations member;
+            if (members != module.memberDecorations.end() && i < members->second.size()) {
+                member = members->second[i];
+            }
+            uint32_t offset = member.offset != NONE ? member.offset : size;
+            size = std::max(size, offset + typeSize(module, type.operands[i], member.matrixStride));
+        }
+        return size;
+    }
+    default:
+        return 0;
+    }
+}
+
+SpirvScalarType scalarType(const Module& module, uint32_t typeId, uint32_t& width) {
+    const Type& type = module.type(typeId);
+    switch (type.opcode) {
+    case OpTypeBool:
+        width = 32;
+        return SpirvScalarType::Bool;
+    case OpTypeInt:
+        width = type.operands.at(0);
+        return type.operands.at(1) != 0 ? SpirvScalarType::Int : SpirvScalarType::Uint;
+    case OpTypeFloat:
+        width = type.operands.at(0);
+        return SpirvScalarType::Float;
+    default:
+        width = 0;
+        return SpirvScalarType::Unknown;
+    }
+}
+
+bool descriptorType(const Module& module, uint32_t typeId, uint32_t storageClass, SpirvDescriptorType& result) {
+    const Type& type = module.type(typeId);
+    Decorations decorations = module.decorationsOf(typeId);
+
+    if (storageClass == StorageStorageBuffer) {
+        result = SpirvDescriptorType::StorageBuffer;
+        return true;
+    }
+    if (storageClass == StorageUniform) {
+        if (decorations.bufferBlock) {
+            result = SpirvDescriptorType::StorageBuffer;    // Pre-1.3 SSBO
+        } else {
+            result = SpirvDescriptorType::UniformBuffer;
+        }
+        return true;
+    }
+
+    switch (type.opcode) {
+    case OpTypeSampler:
+        result = SpirvDescriptorType::Sampler;
+        return true;
+    case OpTypeSampledImage:
+        result = SpirvDescriptorType::CombinedImageSampler;
+        return true;
+    case OpTypeAccelerationStructureKHR:
+        result = SpirvDescriptorType::AccelerationStructure;
+        return true;
+    case OpTypeImage: {
+        // Operands: sampled type, dim, depth, arrayed, ms, sampled (1 = with sampler, 2 = storage)
+        uint32_t dim = type.operands.at(1);
+        uint32_t sampled = type.operands.at(5);
+        if (dim == DimBuffer) {
+            result = sampled == 2 ? SpirvDescriptorType::StorageTexelBuffer : SpirvDescriptorType::UniformTexelBuffer;
+        } else if (dim == DimSubpassData) {
+            result = SpirvDescriptorType::InputAttachment;
+        } else {
+            result = sampled == 2 ? SpirvDescriptorType::StorageImage : SpirvDescriptorType::SampledImage;
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void reflectDescriptor(const Module& module, const Variable& variable, uint32_t pointee, ShaderReflection& reflection) {
+    Decorations decorations = module.decorationsOf(variable.id);
+    if (decorations.binding == NONE) {
+        return;
+    }
+
+    SpirvDescriptorBinding binding;
+    binding.set = decorations.set != NONE ? decorations.set : 0;
+    binding.binding = decorations.binding;
+    binding.stageFlags = reflection.stageFlags;
+    binding.name = module.nameOf(variable.id);
+
+    // Arrays of descriptors: peel off every dimension
+    uint32_t typeId = pointee;
+    for (;;) {
+        const Type& type = module.type(typeId);
+        if (type.opcode == OpTypeArray) {
+            auto length = module.constants.find(type.operands.at(1));
+            binding.count *= length != module.constants.end() ? length->second : 1;
+            typeId = type.operands.at(0);
+        } else if (type.opcode == OpTypeRuntimeArray) {
+            binding.count = 0;
+            typeId = type.operands.at(0);
+        } else {
+            break;
+        }
+    }
+
+    if (binding.name.empty()) {
+        binding.name = module.nameOf(typeId);   // Blocks carry the useful name
+    }
+
+    if (descriptorType(module, typeId, variable.storageClass, binding.type)) {
+        reflection.bindings.push_back(std::move(binding));
+    }
+}
+
+void reflectVertexInput(const Module& module, const Variable& variable, uint32_t pointee, ShaderReflection& reflection) {
+    Decorations decorations = module.decorationsOf(variable.id);
+    if (decorations.builtIn || decorations.location == NONE) {
+        return;
+    }
+
+    const Type& type = module.type(pointee);
+    uint32_t componentType = pointee;
+    uint32_t componentCount = 1;
+    uint32_t locations = 1;
+
+    if (type.opcode == OpTypeVector) {
+        componentType = type.operands.at(0);
+        componentCount = type.operands.at(1);
+    } else if (type.opcode == OpTypeMatrix) {
+        // One location per column
+        const Type& column = module.type(type.operands.at(0));
+        componentType = column.operands.at(0);
+        componentCount = column.operands.at(1);
+        locations = type.operands.at(1);
+    }
+
+    for (uint32_t i = 0; i < locations; i++) {
+        SpirvVertexInput input;
+        input.location = decorations.location + i;
+        input.type = scalarType(module, componentType, input.width);
+        input.componentCount = componentCount;
+        input.name = module.nameOf(variable.id);
+        reflection.vertexInputs.push_back(std::move(input));
+    }
+}
+
+}
+
+uint32_t ShaderReflection::getSetCount() const {
+    uint32_t count = 0;
+    for (const auto& binding : bindings) {
+        count = std::max(count, binding.set + 1);
+    }
+    return count;
+}
+
+ShaderReflection SpirvReflection::reflect(const std::vector<char>& code) {
+    if (code.size() % sizeof(uint32_t) != 0) {
+        throw std::runtime_error("SpirvReflection: code size is not a multiple of 4!");
+    }
+
+    std::vector<uint32_t> words(code.size() / sizeof(uint32_t));
+    std::memcpy(words.data(), code.data(), code.size());
+    return reflect(words.data(), words.size());
+}
+
+ShaderReflection SpirvReflection::reflect(const uint32_t* words, size_t wordCount) {
+    if (words == nullptr || wordCount < HEADER_WORDS || words[0] != SPIRV_MAGIC) {
+        throw std::runtime_error("SpirvReflection: not a SPIR-V module!");
+    }
+
+    Module module;
+    module.bound = words[3];
+
+    for (size_t position = HEADER_WORDS; position < wordCount;) {
+        uint32_t instruction = words[position];
+        uint32_t length = instruction >> 16;
+        uint32_t opcode = instruction & 0xFFFF;
+
+        if (length == 0 || position + length > wordCount) {
+            throw std::runtime_error("SpirvReflection: bad instruction length!");
+        }
+
+        parseInstruction(module, opcode, words + position + 1, length - 1);
+        position += length;
+    }
+
+    if (module.entryPointId == NONE) {
+        throw std::runtime_error("SpirvReflection: module has no entry point!");
+    }
+
+    ShaderReflection reflection;
+    reflection.stageFlags = stageFromExecutionModel(module.executionModel);
+    reflection.entryPoint = module.entryPoint;
+    std::memcpy(reflection.localSize, module.localSize, sizeof(reflection.localSize));
+
+    for (const Variable& variable : module.variables) {
+        const Type& pointer = module.type(variable.typeId);
+        if (pointer.opcode != OpTypePointer) {
+            continue;
+        }
+        uint32_t pointee = pointer.operands.at(1);
+
+        switch (variable.storageClass) {
+        case StorageUniformConstant:
+        case StorageUniform:
+        case StorageStorageBuffer:
+            reflectDescriptor(module, variable, pointee, reflection);
+            break;
+
+        case StoragePushConstant: {
+            const Type& block = module.type(pointee);
+            auto members = module.memberDecorations.find(pointee);
+            uint32_t offset = 0;
+            if (block.opcode == OpTypeStruct && members != module.memberDecorations.end() && !members->second.empty()) {
+                offset = NONE;
+                for (const auto& member : members->second) {
+                    offset = std::min(offset, member.offset);
+                }
+                offset = offset != NONE ? offset : 0;
+            }
+
+            SpirvPushConstantRange range;
+            range.offset = offset;
+            range.size = typeSize(module, pointee) - offset;
+            range.stageFlags = reflection.stageFlags;
+            if (range.size > 0) {
+                reflection.pushConstants.push_back(range);
+            }
+            break;
+        }
+
+        case StorageInput:
+            if (reflection.stageFlags == SPIRV_STAGE_VERTEX) {
+                reflectVertexInput(module, variable, pointee, reflection);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    for (const auto& [id, constant] : module.specConstants) {
+        Decorations decorations = module.decorationsOf(id);
+        if (decorations.specId == NONE) {
+            continue;
+        }
+
+        SpirvSpecConstant spec;
+        spec.specId = decorations.specId;
+        uint32_t width = 0;
+        spec.type = scalarType(module, constant.operands[0], width);
+        spec.defaultValue = constant.operands[1];
+        spec.name = module.nameOf(id);
+        reflection.specConstants.push_back(std::move(spec));
+    }
+
+    std::sort(reflection.bindings.begin(), reflection.bindings.end(),
+        [](const SpirvDescriptorBinding& a, const SpirvDescriptorBinding& b) {
+            return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+        });
+    std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(),
+        [](const SpirvVertexInput& a, const SpirvVertexInput& b) { return a.location < b.location; });
+    std::sort(reflection.specConstants.begin(), reflection.specConstants.end(),
+        [](const SpirvSpecConstant& a, const SpirvSpecConstant& b) { return a.specId < b.specId; });
+
+    return reflection;
+}
+
+ShaderReflection SpirvReflection::merge(const std::vector<ShaderReflection>& stages) {
+    ShaderReflection merged;
+
+    for (const ShaderReflection& stage : stages) {
+        merged.stageFlags |= stage.stageFlags;
+        if (merged.entryPoint.empty()) {
+            merged.entryPoint = stage.entryPoint;
+        }
+        if (stage.stageFlags & SPIRV_STAGE_COMPUTE) {
+            std::memcpy(merged.localSize, stage.localSize, sizeof(merged.localSize));
+        }
+        if (stage.stageFlags & SPIRV_STAGE_VERTEX) {
+            merged.vertexInputs = stage.vertexInputs;
+        }
+
+        for (const SpirvDescriptorBinding& binding : stage.bindings) {
+            auto existing = std::find_if(merged.bindings.begin(), merged.bindings.end(),
+                [&](const SpirvDescriptorBinding& other) {
+                    return other.set == binding.set && other.binding == binding.binding;
+                });
+
+            if (existing == merged.bindings.end()) {
+                merged.bindings.push_back(binding);
+            } else if (existing->type != binding.type || existing->count != binding.count) {
+                throw std::runtime_error("SpirvReflection: stages disagree on set " + std::to_string(binding.set) +
+                                         " binding " + std::to_string(binding.binding) + "!");
+            } else {
+                existing->stageFlags |= binding.stageFlags;
+            }
+        }
+
+        merged.pushConstants.insert(merged.pushConstants.end(), stage.pushConstants.begin(), stage.pushConstants.end());
+
+        for (const SpirvSpecConstant& spec : stage.specConstants) {
+            auto existing = std::find_if(merged.specConstants.begin(), merged.specConstants.end(),
+                [&](const SpirvSpecConstant& other) { return other.specId == spec.specId; });
+            if (existing == merged.specConstants.end()) {
+                merged.specConstants.push_back(spec);
+            }
+        }
+    }
+
+    std::sort(merged.bindings.begin(), merged.bindings.end(),
+        [](const SpirvDescriptorBinding& a, const SpirvDescriptorBinding& b) {
+            return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+        });
+    std::sort(merged.specConstants.begin(), merged.specConstants.end(),
+        [](const SpirvSpecConstant& a, const SpirvSpecConstant& b) { return a.specId < b.specId; });
+
+    return merged;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Values match VkDescriptorType, so the Vulkan layer can cast directly
+enum class SpirvDescriptorType : uint32_t {
+    Sampler = 0,
+    CombinedImageSampler = 1,
+    SampledImage = 2,
+    StorageImage = 3,
+    UniformTexelBuffer = 4,
+    StorageTexelBuffer = 5,
+    UniformBuffer = 6,
+    StorageBuffer = 7,
+    InputAttachment = 10,
+    AccelerationStructure = 1000150000
+};
+
+// Values match VkShaderStageFlagBits
+enum SpirvStageFlags : uint32_t {
+    SPIRV_STAGE_VERTEX = 0x01,
+    SPIRV_STAGE_TESSELLATION_CONTROL = 0x02,
+    SPIRV_STAGE_TESSELLATION_EVALUATION = 0x04,
+    SPIRV_STAGE_GEOMETRY = 0x08,
+    SPIRV_STAGE_FRAGMENT = 0x10,
+    SPIRV_STAGE_COMPUTE = 0x20
+};
+
+enum class SpirvScalarType : uint8_t {
+    Unknown,
+    Bool,
+    Int,
+    Uint,
+    Float
+};
+
+struct SpirvDescriptorBinding {
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    SpirvDescriptorType type = SpirvDescriptorType::UniformBuffer;
+    uint32_t count = 1;             // Array size; 0 for a runtime-sized array
+    uint32_t stageFlags = 0;
+    std::string name;
+};
+
+struct SpirvPushConstantRange {
+    uint32_t offset = 0;
+    uint32_t size = 0;
+    uint32_t stageFlags = 0;
+};
+
+struct SpirvVertexInput {
+    uint32_t location = 0;
+    SpirvScalarType type = SpirvScalarType::Float;
+    uint32_t componentCount = 1;
+    uint32_t width = 32;            // Bits per component
+    std::string name;
+};
+
+struct SpirvSpecConstant {
+    uint32_t specId = 0;
+    SpirvScalarType type = SpirvScalarType::Uint;
+    uint32_t defaultValue = 0;      // Raw bits (bool: 0/1)
+    std::string name;
+};
+
+struct ShaderReflection {
+    uint32_t stageFlags = 0;
+    std::string entryPoint;
+    uint32_t localSize[3] = { 0, 0, 0 };               // Compute only
+
+    std::vector<SpirvDescriptorBinding> bindings;       // Sorted by (set, binding)
+    std::vector<SpirvPushConstantRange> pushConstants;  // At most one per stage
+    std::vector<SpirvVertexInput> vertexInputs;         // Vertex stage, sorted by location
+    std::vector<SpirvSpecConstant> specConstants;       // Sorted by specId
+
+    // Highest set index used plus one
+    uint32_t getSetCount() const;
+};
+
+/**
+ * SpirvReflection - Minimal SPIR-V parser for pipeline layout generation
+ *
+ * Walks the instruction stream of one module (the same words handed to
+ * vkCreateShaderModule) and extracts what a pipeline layout and vertex
+ * input state need: descriptor bindings, push constant block size, vertex
+ * stage inputs and specialization constants. Only the first entry point is
+ * reflected. Throws std::runtime_error on malformed input.
+ *
+ * merge() combines the stages of one pipeline: bindings declared by
+ * several stages are OR-ed together and must agree on type and count.
+ */
+class SpirvReflection {
+public:
+    static ShaderReflection reflect(const uint32_t* words, size_t wordCount);
+    static ShaderReflection reflect(const std::vector<char>& code);
+
+    static ShaderReflection merge(const std::vector<ShaderReflection>& stages);
+};
@@ -0,0 +1,151 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace {
+
+// Slot of the current thread inside the pool that owns it
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local uint32_t currentSlot = 0;
+
+}
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+    : stopping(false)
+{
+    if (threadCount == 0) {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+uint32_t ThreadPool::getCurrentThreadSlot() const {
+    return currentPool == this ? currentSlot : getWorkerCount();
+}
+
+void ThreadPool::workerLoop(uint32_t slot) {
+    currentPool = this;
+    currentSlot = slot;
+
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+// ==================== Parallel For ====================
+
+void ThreadPool::parallelFor(uint32_t count, uint32_t grain, const RangeFn& fn) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max(grain, 1u);
+
+    const uint32_t chunkCount = (count + grain - 1) / grain;
+    const uint32_t callerSlot = getCurrentThreadSlot();
+
+    if (chunkCount == 1 || workers.empty()) {
+        fn(0, count, callerSlot);
+        return;
+    }
+
+    // Shared so helpers that start after the loop finished can still exit cleanly
+    struct Job {
+        std::atomic<uint32_t> nextChunk{0};
+        std::atomic<uint32_t> doneChunks{0};
+        std::mutex doneMutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+    auto job = std::make_shared<Job>();
+
+    // Claims chunks until none are left; completion counts chunks, not helpers,
+    // so nested parallelFor calls cannot wait on helpers that never started
+    auto runChunks = [job, count, grain, chunkCount, &fn](uint32_t slot) {
+        uint32_t chunk;
+        while ((chunk = job->nextChunk.fetch_add(1)) < chunkCount) {
+            uint32_t begin = chunk * grain;
+            uint32_t end = std::min(begin + grain, count);
+            try {
+                fn(begin, end, slot);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job->doneMutex);
+                if (!job->error) {
+                    job->error = std::current_exception();
+                }
+            }
+            if (job->doneChunks.fetch_add(1) + 1 == chunkCount) {
+                std::lock_guard<std::mutex> lock(job->doneMutex);
+                job->done.notify_all();
+            }
+        }
+    };
+
+    uint32_t helperCount = std::min(getWorkerCount(), chunkCount - 1);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t i = 0; i < helperCount; i++) {
+            // fn is only dereferenced while chunks remain, i.e. before we return
+            tasks.emplace_back([runChunks] { runChunks(currentSlot); });
+        }
+    }
+    taskAvailable.notify_all();
+
+    runChunks(callerSlot);
+
+    std::unique_lock<std::mutex> lock(job->doneMutex);
+    job->done.wait(lock, [&job, chunkCount] { return job->doneChunks.load() == chunkCount; });
+
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+void ThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t index, uint32_t threadSlot)>& fn) {
+    parallelFor(count, 1, [&fn](uint32_t begin, uint32_t end, uint32_t slot) {
+        for (uint32_t i = begin; i < end; i++) {
+            fn(i, slot);
+        }
+    });
+}
+
+// ==================== Background Tasks ====================
+
+std::future<void> ThreadPool::submit(std::function<void()> task) {
+    auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    std::future<void> result = packaged->get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.emplace_back([packaged] { (*packaged)(); });
+    }
+    taskAvailable.notify_one();
+    return result;
+}
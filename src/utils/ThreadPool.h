@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * ThreadPool - Fixed set of worker threads for frame-parallel work
+ *
+ * parallelFor() splits an index range across the workers and the calling
+ * thread, and passes each invocation a stable "thread slot" so callers can
+ * keep per-thread resources (command pools, scratch buffers) without locks:
+ *
+ *   slot 0 .. getWorkerCount()-1  -> pool worker threads
+ *   slot getWorkerCount()         -> any thread that is not a pool worker
+ *
+ * submit() queues background tasks (asset loads, shader compiles) that run
+ * on the same workers; its future reports completion and exceptions.
+ */
+class ThreadPool {
+public:
+    using RangeFn = std::function<void(uint32_t begin, uint32_t end, uint32_t threadSlot)>;
+
+    // threadCount 0 = one worker per hardware thread, minus the caller
+    explicit ThreadPool(uint32_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+    uint32_t getThreadSlotCount() const { return getWorkerCount() + 1; }
+
+    // Calls fn(begin, end, slot) over [0, count) in chunks of `grain`.
+    // Blocks until every chunk ran; rethrows the first exception thrown.
+    void parallelFor(uint32_t count, uint32_t grain, const RangeFn& fn);
+
+    // Per-index convenience wrapper
+    void parallelFor(uint32_t count, const std::function<void(uint32_t index, uint32_t threadSlot)>& fn);
+
+    std::future<void> submit(std::function<void()> task);
+
+    // Slot of the calling thread (see class comment)
+    uint32_t getCurrentThreadSlot() const;
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    bool stopping;
+
+    void workerLoop(uint32_t slot);
+};
@@ -0,0 +1,246 @@
+#include "BindlessDescriptorHeap.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+VkPhysicalDeviceDescriptorIndexingProperties queryIndexingProperties(VkPhysicalDevice physicalDevice) {
+    VkPhysicalDeviceDescriptorIndexingProperties indexing{};
+    indexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &indexing;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    return indexing;
+}
+
+// Keep headroom for the descriptors other sets bind alongside the heap
+constexpr uint32_t RESERVED_PER_STAGE = 64;
+
+uint32_t clampToLimit(uint32_t requested, uint32_t limit) {
+    uint32_t usable = limit > RESERVED_PER_STAGE ? limit - RESERVED_PER_STAGE : limit;
+    return std::max(1u, std::min(requested, usable));
+}
+
+}
+
+uint32_t BindlessDescriptorHeap::clampTextures(VkPhysicalDevice physicalDevice, uint32_t requested) {
+    VkPhysicalDeviceDescriptorIndexingProperties indexing = queryIndexingProperties(physicalDevice);
+    uint32_t limit = std::min({ indexing.maxDescriptorSetUpdateAfterBindSampledImages,
+                                indexing.maxDescriptorSetUpdateAfterBindSamplers,
+                                indexing.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                indexing.maxPerStageDescriptorUpdateAfterBindSamplers });
+    return clampToLimit(requested, limit);
+}
+
+uint32_t BindlessDescriptorHeap::clampBuffers(VkPhysicalDevice physicalDevice, uint32_t requested) {
+    VkPhysicalDeviceDescriptorIndexingProperties indexing = queryIndexingProperties(physicalDevice);
+    uint32_t limit = std::min(indexing.maxDescriptorSetUpdateAfterBindStorageBuffers,
+                              indexing.maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+    return clampToLimit(requested, limit);
+}
+
+BindlessDescriptorHeap::BindlessDescriptorHeap(VkPhysicalDevice physicalDevice, VkDevice device,
+                                               uint32_t maxTextures, uint32_t maxBuffers)
+    : device(device)
+    , setLayout(VK_NULL_HANDLE)
+    , pool(VK_NULL_HANDLE)
+    , descriptorSet(VK_NULL_HANDLE)
+    , textureSlots(clampTextures(physicalDevice, maxTextures))
+    , bufferSlots(clampBuffers(physicalDevice, maxBuffers))
+    , descriptorWrites(0)
+{
+    uint32_t textureCount = textureSlots.getCapacity();
+    uint32_t bufferCount = bufferSlots.getCapacity();
+
+    VkDescriptorSetLayoutBinding bindings[2]{};
+    bindings[0].binding = TEXTURE_BINDING;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = textureCount;
+    bindings[0].stageFlags = VK_SHADER_STAGE_ALL;
+    bindings[1].binding = BUFFER_BINDING;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = bufferCount;
+    bindings[1].stageFlags = VK_SHADER_STAGE_ALL;
+
+    // Unwritten slots are legal as long as shaders never read them
+    VkDescriptorBindingFlags bindingFlags[2] = {
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+    };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+    flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flagsInfo.bindingCount = 2;
+    flagsInfo.pBindingFlags = bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &flagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = bindings;
+
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create bindless descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSizes[2]{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[0].descriptorCount = textureCount;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = bufferCount;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes = poolSizes;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        destroy();
+        throw std::runtime_error("Failed to create bindless descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        destroy();
+        throw std::runtime_error("Failed to allocate bindless descriptor set!");
+    }
+
+    Logger::verbose("Bindless heap: " + std::to_string(textureCount) + " textures, " +
+                    std::to_string(bufferCount) + " buffers");
+}
+
+BindlessDescriptorHeap::~BindlessDescriptorHeap() {
+    destroy();
+}
+
+// ==================== Slots ====================
+
+uint32_t BindlessDescriptorHeap::addTexture(VkImageView view, VkSampler sampler, VkImageLayout layout) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint32_t index = textureSlots.allocate();
+    if (index != INVALID_INDEX) {
+        writeTexture(index, view, sampler, layout);
+    }
+    return index;
+}
+
+uint32_t BindlessDescriptorHeap::addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint32_t index = bufferSlots.allocate();
+    if (index != INVALID_INDEX) {
+        writeBuffer(index, buffer, offset, range);
+    }
+    return index;
+}
+
+void BindlessDescriptorHeap::updateTexture(uint32_t index, VkImageView view, VkSampler sampler, VkImageLayout layout) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!textureSlots.isAllocated(index)) {
+        throw std::runtime_error("Failed to update bindless texture: slot not allocated!");
+    }
+    writeTexture(index, view, sampler, layout);
+}
+
+void BindlessDescriptorHeap::updateBuffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!bufferSlots.isAllocated(index)) {
+        throw std::runtime_error("Failed to update bindless buffer: slot not allocated!");
+    }
+    writeBuffer(index, buffer, offset, range);
+}
+
+void BindlessDescriptorHeap::removeTexture(uint32_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    textureSlots.free(index);
+}
+
+void BindlessDescriptorHeap::removeBuffer(uint32_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bufferSlots.free(index);
+}
+
+void BindlessDescriptorHeap::writeTexture(uint32_t index, VkImageView view, VkSampler sampler, VkImageLayout layout) {
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = sampler;
+    imageInfo.imageView = view;
+    imageInfo.imageLayout = layout;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = TEXTURE_BINDING;
+    write.dstArrayElement = index;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+    descriptorWrites++;
+}
+
+void BindlessDescriptorHeap::writeBuffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = offset;
+    bufferInfo.range = range;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = BUFFER_BINDING;
+    write.dstArrayElement = index;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+    descriptorWrites++;
+}
+
+// ==================== Binding ====================
+
+void BindlessDescriptorHeap::bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                                  VkPipelineLayout layout, uint32_t setIndex) const {
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, layout, setIndex, 1, &descriptorSet, 0, nullptr);
+}
+
+BindlessHeapStats BindlessDescriptorHeap::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    BindlessHeapStats stats;
+    stats.textureCapacity = textureSlots.getCapacity();
+    stats.bufferCapacity = bufferSlots.getCapacity();
+    stats.texturesInUse = textureSlots.getUsedCount();
+    stats.buffersInUse = bufferSlots.getUsedCount();
+    stats.descriptorWrites = descriptorWrites;
+    return stats;
+}
+
+void BindlessDescriptorHeap::destroy() {
+    if (pool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, pool, nullptr);     // Frees the set
+        pool = VK_NULL_HANDLE;
+        descriptorSet = VK_NULL_HANDLE;
+    }
+    if (setLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        setLayout = VK_NULL_HANDLE;
+    }
+}
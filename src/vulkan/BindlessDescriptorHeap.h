@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../memory/SlotAllocator.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+
+struct BindlessHeapStats {
+    uint32_t textureCapacity = 0;
+    uint32_t bufferCapacity = 0;
+    uint32_t texturesInUse = 0;
+    uint32_t buffersInUse = 0;
+    uint64_t descriptorWrites = 0;
+};
+
+/**
+ * BindlessDescriptorHeap - One update-after-bind set for every resource
+ *
+ * Binding 0 is an array of combined image samplers, binding 1 an array of
+ * storage buffers; slots are handed out by a free-list. The set is bound
+ * once per command buffer and shaders pick resources by index, so changing
+ * material is a push constant instead of a vkCmdBindDescriptorSets:
+ *
+ *   layout(set = 0, binding = 0) uniform sampler2D textures[];
+ *   layout(set = 0, binding = 1) buffer Buffers { uint data[]; } buffers[];
+ *   ... texture(textures[nonuniformEXT(materialId)], uv)
+ *
+ * Slots may be written while the set is bound (update-after-bind), but a
+ * slot still read by a frame in flight must not be rewritten: free slots
+ * through VulkanContext::deferDestroy. Thread-safe.
+ */
+class BindlessDescriptorHeap {
+public:
+    static constexpr uint32_t TEXTURE_BINDING = 0;
+    static constexpr uint32_t BUFFER_BINDING = 1;
+    static constexpr uint32_t INVALID_INDEX = SlotAllocator::INVALID_SLOT;
+
+    // Capacities are clamped to the device's update-after-bind limits
+    BindlessDescriptorHeap(VkPhysicalDevice physicalDevice, VkDevice device,
+                           uint32_t maxTextures = 16384, uint32_t maxBuffers = 4096);
+    ~BindlessDescriptorHeap();
+
+    BindlessDescriptorHeap(const BindlessDescriptorHeap&) = delete;
+    BindlessDescriptorHeap& operator=(const BindlessDescriptorHeap&) = delete;
+
+    // Returns the shader-visible index, or INVALID_INDEX when full
+    uint32_t addTexture(VkImageView view, VkSampler sampler,
+                        VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uint32_t addBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+    // Rewrites a slot in place (e.g. after streaming in a higher mip chain)
+    void updateTexture(uint32_t index, VkImageView view, VkSampler sampler,
+                       VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    void updateBuffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+    void removeTexture(uint32_t index);
+    void removeBuffer(uint32_t index);
+
+    VkDescriptorSetLayout getSetLayout() const { return setLayout; }
+    VkDescriptorSet getDescriptorSet() const { return descriptorSet; }
+
+    void bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+              VkPipelineLayout layout, uint32_t setIndex = 0) const;
+
+    BindlessHeapStats getStats() const;
+    void destroy();
+
+private:
+    VkDevice device;
+    VkDescriptorSetLayout setLayout;
+    VkDescriptorPool pool;
+    VkDescriptorSet descriptorSet;
+
+    SlotAllocator textureSlots;
+    SlotAllocator bufferSlots;
+    uint64_t descriptorWrites;
+    mutable std::mutex mutex;
+
+    void writeTexture(uint32_t index, VkImageView view, VkSampler sampler, VkImageLayout layout);
+    void writeBuffer(uint32_t index, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+
+    static uint32_t clampTextures(VkPhysicalDevice physicalDevice, uint32_t requested);
+    static uint32_t clampBuffers(VkPhysicalDevice physicalDevice, uint32_t requested);
+};
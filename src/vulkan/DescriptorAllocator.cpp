@@ -0,0 +1,269 @@
+#include "DescriptorAllocator.h"
+#include "../utils/Hash.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// ==================== DescriptorLayoutCache ====================
+
+bool DescriptorLayoutCache::LayoutKey::operator==(const LayoutKey& other) const {
+    if (flags != other.flags ||
+        bindings.size() != other.bindings.size() ||
+        immutableSamplers != other.immutableSamplers) {
+        return false;
+    }
+
+    for (size_t i = 0; i < bindings.size(); i++) {
+        const auto& a = bindings[i];
+        const auto& b = other.bindings[i];
+        if (a.binding != b.binding || a.descriptorType != b.descriptorType ||
+            a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags ||
+            (a.pImmutableSamplers == nullptr) != (b.pImmutableSamplers == nullptr)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t DescriptorLayoutCache::LayoutKey::hash() const {
+    Fnv1a h;
+    h.add(flags);
+    for (const auto& binding : bindings) {
+        h.add(binding.binding);
+        h.add(binding.descriptorType);
+        h.add(binding.descriptorCount);
+        h.add(binding.stageFlags);
+    }
+    for (VkSampler sampler : immutableSamplers) {
+        h.add(sampler);
+    }
+    return static_cast<size_t>(h.value);
+}
+
+DescriptorLayoutCache::DescriptorLayoutCache(VkDevice device)
+    : device(device)
+{
+}
+
+DescriptorLayoutCache::~DescriptorLayoutCache() {
+    destroy();
+}
+
+VkDescriptorSetLayout DescriptorLayoutCache::getLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings,
+                                                       VkDescriptorSetLayoutCreateFlags flags) {
+    LayoutKey key;
+    key.flags = flags;
+    key.bindings = bindings;
+
+    // Declaration order must not produce distinct layouts
+    std::sort(key.bindings.begin(), key.bindings.end(),
+        [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+            return a.binding < b.binding;
+        });
+    for (const auto& binding : key.bindings) {
+        if (binding.pImmutableSamplers != nullptr) {
+            key.immutableSamplers.insert(key.immutableSamplers.end(), binding.pImmutableSamplers,
+                                         binding.pImmutableSamplers + binding.descriptorCount);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.lookups++;
+
+    auto it = layouts.find(key);
+    if (it != layouts.end()) {
+        stats.hits++;
+        return it->second;
+    }
+
+    VkDescriptorSetLayoutCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    createInfo.flags = flags;
+    createInfo.bindingCount = static_cast<uint32_t>(key.bindings.size());
+    createInfo.pBindings = key.bindings.data();
+
+    VkDescriptorSetLayout layout;
+    if (vkCreateDescriptorSetLayout(device, &createInfo, nullptr, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor set layout!");
+    }
+
+    layouts.emplace(std::move(key), layout);
+    stats.layoutCount = layouts.size();
+    return layout;
+}
+
+DescriptorLayoutCacheStats DescriptorLayoutCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void DescriptorLayoutCache::destroy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [key, layout] : layouts) {
+        vkDestroyDescriptorSetLayout(device, layout, nullptr);
+    }
+    layouts.clear();
+    stats.layoutCount = 0;
+}
+
+// ==================== DescriptorAllocator ====================
+
+DescriptorAllocator::DescriptorAllocator(VkDevice device, uint32_t framesInFlight, uint32_t setsPerPool)
+    : device(device)
+    , setsPerPool(setsPerPool)
+    , currentFrame(0)
+    , ratios{
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f },
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f },
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f },
+        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f },
+        { VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f },
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f },
+        { VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.5f }
+      }
+    , frames(framesInFlight)
+{
+    if (framesInFlight == 0 || setsPerPool == 0) {
+        throw std::runtime_error("DescriptorAllocator: invalid configuration!");
+    }
+}
+
+DescriptorAllocator::~DescriptorAllocator() {
+    destroy();
+}
+
+void DescriptorAllocator::beginFrame(uint32_t frameIndex) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (frameIndex >= frames.size()) {
+        throw std::runtime_error("DescriptorAllocator: frame index out of range!");
+    }
+
+    stats.lastFrameSets = frames[currentFrame].setsAllocated;
+    currentFrame = frameIndex;
+    releasePools(frames[frameIndex], true);
+}
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return allocateFrom(frames[currentFrame], layout);
+}
+
+VkDescriptorSet DescriptorAllocator::allocatePersistent(VkDescriptorSetLayout layout) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return allocateFrom(persistent, layout);
+}
+
+VkDescriptorSet DescriptorAllocator::allocateFrom(PoolList& list, VkDescriptorSetLayout layout) {
+    if (list.current == VK_NULL_HANDLE) {
+        list.current = acquirePool();
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = list.current;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    VkDescriptorSet set;
+    VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &set);
+
+    // Exhausted: retire the pool to the list and retry once in a fresh one
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+        stats.poolExhaustions++;
+        list.full.push_back(list.current);
+        list.current = acquirePool();
+
+        allocInfo.descriptorPool = list.current;
+        result = vkAllocateDescriptorSets(device, &allocInfo, &set);
+    }
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate descriptor set!");
+    }
+
+    list.setsAllocated++;
+    stats.setsAllocated++;
+    return set;
+}
+
+VkDescriptorPool DescriptorAllocator::acquirePool() {
+    stats.poolsInUse++;
+
+    if (!freePools.empty()) {
+        VkDescriptorPool pool = freePools.back();
+        freePools.pop_back();
+        stats.freePools = freePools.size();
+        return pool;
+    }
+
+    std::vector<VkDescriptorPoolSize> sizes;
+    sizes.reserve(ratios.size());
+    for (const PoolRatio& ratio : ratios) {
+        uint32_t count = std::max(1u, static_cast<uint32_t>(ratio.perSet * setsPerPool));
+        sizes.push_back({ ratio.type, count });
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = setsPerPool;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(sizes.size());
+    poolInfo.pPoolSizes = sizes.data();
+
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        stats.poolsInUse--;
+        throw std::runtime_error("Failed to create descriptor pool!");
+    }
+
+    stats.poolsCreated++;
+    Logger::verbose("DescriptorAllocator: created pool " + std::to_string(stats.poolsCreated) +
+                    " (" + std::to_string(setsPerPool) + " sets)");
+    return pool;
+}
+
+void DescriptorAllocator::releasePools(PoolList& list, bool reset) {
+    if (list.current != VK_NULL_HANDLE) {
+        list.full.push_back(list.current);
+        list.current = VK_NULL_HANDLE;
+    }
+
+    for (VkDescriptorPool pool : list.full) {
+        if (reset) {
+            vkResetDescriptorPool(device, pool, 0);     // Frees all its sets at once
+            stats.poolResets++;
+            freePools.push_back(pool);
+        } else {
+            vkDestroyDescriptorPool(device, pool, nullptr);
+        }
+    }
+
+    stats.poolsInUse -= list.full.size();
+    stats.freePools = freePools.size();
+    list.full.clear();
+    list.setsAllocated = 0;
+}
+
+DescriptorAllocatorStats DescriptorAllocator::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void DescriptorAllocator::destroy() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (PoolList& list : frames) {
+        releasePools(list, false);
+    }
+    releasePools(persistent, false);
+
+    for (VkDescriptorPool pool : freePools) {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+    freePools.clear();
+    stats.freePools = 0;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct DescriptorAllocatorStats {
+    uint64_t setsAllocated = 0;         // transient + persistent allocations
+    uint64_t poolsCreated = 0;          // vkCreateDescriptorPool calls
+    uint64_t poolExhaustions = 0;       // allocations that had to move to another pool
+    uint64_t poolResets = 0;            // vkResetDescriptorPool calls
+    uint64_t lastFrameSets = 0;         // transient sets allocated by the last finished frame
+    size_t poolsInUse = 0;              // pools holding live sets
+    size_t freePools = 0;               // reset pools waiting for reuse
+};
+
+struct DescriptorLayoutCacheStats {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    size_t layoutCount = 0;
+};
+
+/**
+ * DescriptorLayoutCache - Deduplicating VkDescriptorSetLayout cache
+ *
+ * Keyed by the bindings (sorted by binding number), their immutable
+ * samplers and the create flags, so identical layouts declared by
+ * different materials share one handle. Owns every layout it hands out.
+ */
+class DescriptorLayoutCache {
+public:
+    explicit DescriptorLayoutCache(VkDevice device);
+    ~DescriptorLayoutCache();
+
+    DescriptorLayoutCache(const DescriptorLayoutCache&) = delete;
+    DescriptorLayoutCache& operator=(const DescriptorLayoutCache&) = delete;
+
+    VkDescriptorSetLayout getLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings,
+                                    VkDescriptorSetLayoutCreateFlags flags = 0);
+
+    DescriptorLayoutCacheStats getStats() const;
+    void destroy();
+
+private:
+    struct LayoutKey {
+        VkDescriptorSetLayoutCreateFlags flags = 0;
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+        std::vector<VkSampler> immutableSamplers;   // Flattened in binding order
+
+        bool operator==(const LayoutKey& other) const;
+        size_t hash() const;
+    };
+
+    struct LayoutKeyHash {
+        size_t operator()(const LayoutKey& key) const { return key.hash(); }
+    };
+
+    VkDevice device;
+    std::unordered_map<LayoutKey, VkDescriptorSetLayout, LayoutKeyHash> layouts;
+    DescriptorLayoutCacheStats stats;
+    mutable std::mutex mutex;
+};
+
+/**
+ * DescriptorAllocator - Growable descriptor pools for the non-bindless path
+ *
+ * Pools are created on demand with fixed per-set ratios; when one runs out
+ * (OUT_OF_POOL_MEMORY / FRAGMENTED_POOL) allocation moves to a recycled or
+ * new pool. Transient sets belong to a frame slot and are released all at
+ * once by beginFrame(), which resets the slot's pools with
+ * vkResetDescriptorPool instead of freeing sets one by one. Persistent
+ * sets live until destroy(). Thread-safe.
+ */
+class DescriptorAllocator {
+public:
+    struct PoolRatio {
+        VkDescriptorType type;
+        float perSet;       // Descriptors of this type reserved per set
+    };
+
+    DescriptorAllocator(VkDevice device, uint32_t framesInFlight, uint32_t setsPerPool = 256);
+    ~DescriptorAllocator();
+
+    DescriptorAllocator(const DescriptorAllocator&) = delete;
+    DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+    // Resets every pool of this frame; the frame's previous submit must have completed
+    void beginFrame(uint32_t frameIndex);
+
+    // Valid until the current frame slot comes round again
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+    // Valid until destroy()
+    VkDescriptorSet allocatePersistent(VkDescriptorSetLayout layout);
+
+    DescriptorAllocatorStats getStats() const;
+    void destroy();
+
+private:
+    struct PoolList {
+        VkDescriptorPool current = VK_NULL_HANDLE;
+        std::vector<VkDescriptorPool> full;
+        uint64_t setsAllocated = 0;
+    };
+
+    VkDevice device;
+    uint32_t setsPerPool;
+    uint32_t currentFrame;
+    std::vector<PoolRatio> ratios;
+
+    std::vector<PoolList> frames;
+    PoolList persistent;
+    std::vector<VkDescriptorPool> freePools;
+
+    DescriptorAllocatorStats stats;
+    mutable std::mutex mutex;
+
+    VkDescriptorSet allocateFrom(PoolList& list, VkDescriptorSetLayout layout);
+    VkDescriptorPool acquirePool();
+    void releasePools(PoolList& list, bool reset);
+};
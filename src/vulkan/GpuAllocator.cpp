@@ -0,0 +1,541 @@
+#include "GpuAllocator.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// ==================== Construction ====================
+
+GpuAllocator::GpuAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize preferredBlockSize)
+    : physicalDevice(physicalDevice)
+    , device(device)
+    , memoryProperties{}
+    , preferredBlockSize(preferredBlockSize)
+    , maxAllocationCount(0)
+    , deviceMemoryCount(0)
+{
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+    pools.resize(memoryProperties.memoryTypeCount * 2);
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        pools[i * 2].memoryTypeIndex = i;
+        pools[i * 2].linear = true;
+        pools[i * 2 + 1].memoryTypeIndex = i;
+        pools[i * 2 + 1].linear = false;
+    }
+}
+
+GpuAllocator::~GpuAllocator() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint32_t leaked = 0;
+    for (auto& pool : pools) {
+        for (auto& block : pool.blocks) {
+            if (block.memory != VK_NULL_HANDLE) {
+                leaked += block.placement->getAllocationCount();
+                vkFreeMemory(device, block.memory, nullptr);
+            }
+        }
+    }
+    for (auto& entry : dedicated) {
+        leaked++;
+        vkFreeMemory(device, entry.second.memory, nullptr);
+    }
+
+    if (leaked > 0) {
+        Logger::error("GpuAllocator destroyed with " + std::to_string(leaked) + " live allocations");
+    }
+}
+
+// ==================== Memory Types ====================
+
+uint32_t GpuAllocator::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags requiredFlags) const {
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if ((typeBits & (1u << i)) &&
+            (memoryProperties.memoryTypes[i].propertyFlags & requiredFlags) == requiredFlags) {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+bool GpuAllocator::isHostVisible(uint32_t memoryTypeIndex) const {
+    return (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags &
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+}
+
+VkDeviceSize GpuAllocator::blockSizeForType(uint32_t memoryTypeIndex) const {
+    // Small heaps (e.g. the 256MB BAR window) get proportionally smaller blocks
+    uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    VkDeviceSize heapSize = memoryProperties.memoryHeaps[heapIndex].size;
+    return std::min(preferredBlockSize, heapSize / 8);
+}
+
+VkDeviceMemory GpuAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex,
+                                                  const void* pNext, void** mappedData) {
+    if (deviceMemoryCount >= maxAllocationCount) {
+        throw std::runtime_error("GpuAllocator: maxMemoryAllocationCount reached!");
+    }
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext = pNext;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+
+    *mappedData = nullptr;
+    if (isHostVisible(memoryTypeIndex)) {
+        // Persistently mapped for the lifetime of the block
+        if (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mappedData) != VK_SUCCESS) {
+            vkFreeMemory(device, memory, nullptr);
+            throw std::runtime_error("Failed to map device memory!");
+        }
+    }
+
+    deviceMemoryCount++;
+    return memory;
+}
+
+// ==================== Allocation ====================
+
+GpuAllocation GpuAllocator::allocate(const VkMemoryRequirements& requirements,
+                                     VkMemoryPropertyFlags requiredFlags,
+                                     bool linearResource,
+                                     uint32_t flags,
+                                     void* userData) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, requiredFlags);
+
+    if ((flags & GPU_ALLOCATION_DEDICATED) || requirements.size > blockSizeForType(memoryTypeIndex) / 2) {
+        return allocateDedicated(requirements, memoryTypeIndex, VK_NULL_HANDLE, VK_NULL_HANDLE, userData);
+    }
+
+    uint32_t poolIndex = memoryTypeIndex * 2 + (linearResource ? 0 : 1);
+    return allocateFromPool(poolIndex, requirements, flags, userData);
+}
+
+GpuAllocation GpuAllocator::allocateFromPool(uint32_t poolIndex, const VkMemoryRequirements& requirements,
+                                             uint32_t flags, void* userData) {
+    MemoryPool& pool = pools[poolIndex];
+
+    auto place = [&](uint32_t blockIndex) -> GpuAllocation {
+        MemoryBlock& block = pool.blocks[blockIndex];
+        TlsfAllocator::Allocation range = block.placement->allocate(requirements.size, requirements.alignment);
+        if (!range.isValid()) {
+            return GpuAllocation{};
+        }
+
+        if (flags & GPU_ALLOCATION_MOVABLE) {
+            block.movable[range.handle] = MovableInfo{ userData, requirements.alignment };
+        }
+
+        GpuAllocation allocation;
+        allocation.memory = block.memory;
+        allocation.offset = range.offset;
+        allocation.size = requirements.size;
+        allocation.mappedData = block.mappedData
+            ? static_cast<char*>(block.mappedData) + range.offset
+            : nullptr;
+        allocation.memoryTypeIndex = pool.memoryTypeIndex;
+        allocation.poolIndex = poolIndex;
+        allocation.blockIndex = blockIndex;
+        allocation.handle = range.handle;
+        allocation.userData = userData;
+        return allocation;
+    };
+
+    // Try existing blocks first
+    for (uint32_t i = 0; i < pool.blocks.size(); i++) {
+        if (pool.blocks[i].memory == VK_NULL_HANDLE) {
+            continue;
+        }
+        GpuAllocation allocation = place(i);
+        if (allocation.isValid()) {
+            return allocation;
+        }
+    }
+
+    // Need a new block; shrink the request if the heap is under pressure,
+    // but never below what the allocation needs with worst-case alignment padding
+    const VkDeviceSize minimumBlockSize = requirements.size + requirements.alignment - 1;
+    VkDeviceSize blockSize = blockSizeForType(pool.memoryTypeIndex);
+    void* mapped = nullptr;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    while (blockSize >= minimumBlockSize) {
+        memory = allocateDeviceMemory(blockSize, pool.memoryTypeIndex, nullptr, &mapped);
+        if (memory != VK_NULL_HANDLE) {
+            break;
+        }
+        blockSize /= 2;
+    }
+
+    if (memory == VK_NULL_HANDLE) {
+        throw std::runtime_error("Failed to allocate device memory block!");
+    }
+
+    uint32_t blockIndex = static_cast<uint32_t>(pool.blocks.size());
+    for (uint32_t i = 0; i < pool.blocks.size(); i++) {
+        if (pool.blocks[i].memory == VK_NULL_HANDLE) {
+            blockIndex = i;  // Reuse released slot so block indices stay stable
+            break;
+        }
+    }
+    if (blockIndex == pool.blocks.size()) {
+        pool.blocks.emplace_back();
+    }
+
+    MemoryBlock& block = pool.blocks[blockIndex];
+    block.memory = memory;
+    block.mappedData = mapped;
+    block.placement = std::make_unique<TlsfAllocator>(blockSize);
+    block.movable.clear();
+
+    Logger::verbose("GpuAllocator: new " + std::to_string(blockSize >> 20) +
+                    "MB block for memory type " + std::to_string(pool.memoryTypeIndex));
+
+    GpuAllocation allocation = place(blockIndex);
+    if (!allocation.isValid()) {
+        throw std::runtime_error("Failed to place allocation in a new device memory block!");
+    }
+    return allocation;
+}
+
+GpuAllocation GpuAllocator::allocateDedicated(const VkMemoryRequirements& requirements, uint32_t memoryTypeIndex,
+                                              VkBuffer buffer, VkImage image, void* userData) {
+    VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+    dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+    dedicatedInfo.buffer = buffer;
+    dedicatedInfo.image = image;
+
+    bool hasResource = buffer != VK_NULL_HANDLE || image != VK_NULL_HANDLE;
+
+    void* mapped = nullptr;
+    VkDeviceMemory memory = allocateDeviceMemory(requirements.size, memoryTypeIndex,
+                                                 hasResource ? &dedicatedInfo : nullptr, &mapped);
+    if (memory == VK_NULL_HANDLE) {
+        throw std::runtime_error("Failed to allocate dedicated device memory!");
+    }
+
+    dedicated[memory] = DedicatedAllocation{ memory, requirements.size, memoryTypeIndex };
+
+    GpuAllocation allocation;
+    allocation.memory = memory;
+    allocation.offset = 0;
+    allocation.size = requirements.size;
+    allocation.mappedData = mapped;
+    allocation.memoryTypeIndex = memoryTypeIndex;
+    allocation.userData = userData;
+    return allocation;
+}
+
+void GpuAllocator::free(GpuAllocation& allocation) {
+    if (!allocation.isValid()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    freeLocked(allocation);
+}
+
+void GpuAllocator::freeLocked(GpuAllocation& allocation) {
+    if (allocation.isDedicated()) {
+        dedicated.erase(allocation.memory);
+        vkFreeMemory(device, allocation.memory, nullptr);
+        deviceMemoryCount--;
+    } else {
+        MemoryPool& pool = pools[allocation.poolIndex];
+        MemoryBlock& block = pool.blocks[allocation.blockIndex];
+        block.placement->free(allocation.handle);
+        block.movable.erase(allocation.handle);
+
+        if (block.placement->isEmpty()) {
+            releaseEmptyBlocks(pool, true);
+        }
+    }
+
+    allocation = GpuAllocation{};
+}
+
+void GpuAllocator::releaseEmptyBlocks(MemoryPool& pool, bool keepOne) {
+    // Keeping one empty block around avoids vkAllocateMemory/vkFreeMemory
+    // ping-pong when a single resource is created and destroyed repeatedly
+    bool kept = !keepOne;
+    for (auto& block : pool.blocks) {
+        if (block.memory == VK_NULL_HANDLE || !block.placement->isEmpty()) {
+            continue;
+        }
+        if (!kept) {
+            kept = true;
+            continue;
+        }
+
+        vkFreeMemory(device, block.memory, nullptr);
+        deviceMemoryCount--;
+        block.memory = VK_NULL_HANDLE;
+        block.mappedData = nullptr;
+        block.placement.reset();
+        block.movable.clear();
+    }
+}
+
+// ==================== Buffers & Images ====================
+
+GpuBuffer GpuAllocator::createBuffer(const VkBufferCreateInfo& createInfo,
+                                     VkMemoryPropertyFlags requiredFlags,
+                                     uint32_t flags) {
+    GpuBuffer result;
+
+    if (vkCreateBuffer(device, &createInfo, nullptr, &result.buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create buffer!");
+    }
+
+    VkBufferMemoryRequirementsInfo2 requirementsInfo{};
+    requirementsInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+    requirementsInfo.buffer = result.buffer;
+
+    VkMemoryDedicatedRequirements dedicatedRequirements{};
+    dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+    VkMemoryRequirements2 requirements{};
+    requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    requirements.pNext = &dedicatedRequirements;
+    vkGetBufferMemoryRequirements2(device, &requirementsInfo, &requirements);
+
+    try {
+        std::lock_guard<std::mutex> lock(mutex);
+        const VkMemoryRequirements& memReqs = requirements.memoryRequirements;
+        uint32_t memoryTypeIndex = findMemoryType(memReqs.memoryTypeBits, requiredFlags);
+
+        if ((flags & GPU_ALLOCATION_DEDICATED) ||
+            dedicatedRequirements.prefersDedicatedAllocation ||
+            memReqs.size > blockSizeForType(memoryTypeIndex) / 2) {
+            result.allocation = allocateDedicated(memReqs, memoryTypeIndex, result.buffer, VK_NULL_HANDLE, nullptr);
+        } else {
+            result.allocation = allocateFromPool(memoryTypeIndex * 2, memReqs, flags, nullptr);
+        }
+    } catch (...) {
+        vkDestroyBuffer(device, result.buffer, nullptr);
+        throw;
+    }
+
+    if (vkBindBufferMemory(device, result.buffer, result.allocation.memory, result.allocation.offset) != VK_SUCCESS) {
+        destroyBuffer(result);
+        throw std::runtime_error("Failed to bind buffer memory!");
+    }
+
+    return result;
+}
+
+void GpuAllocator::destroyBuffer(GpuBuffer& buffer) {
+    if (buffer.buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, buffer.buffer, nullptr);
+        buffer.buffer = VK_NULL_HANDLE;
+    }
+    free(buffer.allocation);
+}
+
+GpuImage GpuAllocator::createImage(const VkImageCreateInfo& createInfo,
+                                   VkMemoryPropertyFlags requiredFlags,
+                                   uint32_t flags) {
+    GpuImage result;
+
+    if (vkCreateImage(device, &createInfo, nullptr, &result.image) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create image!");
+    }
+
+    VkImageMemoryRequirementsInfo2 requirementsInfo{};
+    requirementsInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+    requirementsInfo.image = result.image;
+
+    VkMemoryDedicatedRequirements dedicatedRequirements{};
+    dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+    VkMemoryRequirements2 requirements{};
+    requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    requirements.pNext = &dedicatedRequirements;
+    vkGetImageMemoryRequirements2(device, &requirementsInfo, &requirements);
+
+    bool linear = createInfo.tiling == VK_IMAGE_TILING_LINEAR;
+
+    try {
+        std::lock_guard<std::mutex> lock(mutex);
+        const VkMemoryRequirements& memReqs = requirements.memoryRequirements;
+        uint32_t memoryTypeIndex = findMemoryType(memReqs.memoryTypeBits, requiredFlags);
+
+        // Render targets and big textures are best kept dedicated
+        if ((flags & GPU_ALLOCATION_DEDICATED) ||
+            dedicatedRequirements.prefersDedicatedAllocation ||
+            memReqs.size > blockSizeForType(memoryTypeIndex) / 2) {
+            result.allocation = allocateDedicated(memReqs, memoryTypeIndex, VK_NULL_HANDLE, result.image, nullptr);
+        } else {
+            result.allocation = allocateFromPool(memoryTypeIndex * 2 + (linear ? 0 : 1),
+                                                 memReqs, flags, nullptr);
+        }
+    } catch (...) {
+        vkDestroyImage(device, result.image, nullptr);
+        throw;
+    }
+
+    if (vkBindImageMemory(device, result.image, result.allocation.memory, result.allocation.offset) != VK_SUCCESS) {
+        destroyImage(result);
+        throw std::runtime_error("Failed to bind image memory!");
+    }
+
+    return result;
+}
+
+void GpuAllocator::destroyImage(GpuImage& image) {
+    if (image.image != VK_NULL_HANDLE) {
+        vkDestroyImage(device, image.image, nullptr);
+        image.image = VK_NULL_HANDLE;
+    }
+    free(image.allocation);
+}
+
+// ==================== Defragmentation ====================
+
+uint32_t GpuAllocator::defragment(const DefragmentationCallback& move, uint32_t maxMoves) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint32_t moves = 0;
+
+    for (uint32_t poolIndex = 0; poolIndex < pools.size() && moves < maxMoves; poolIndex++) {
+        MemoryPool& pool = pools[poolIndex];
+
+        std::vector<uint32_t> order;
+        for (uint32_t i = 0; i < pool.blocks.size(); i++) {
+            if (pool.blocks[i].memory != VK_NULL_HANDLE) {
+                order.push_back(i);
+            }
+        }
+        if (order.size() < 2) {
+            continue;
+        }
+
+        // Evacuate the emptiest blocks into the fullest ones
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return pool.blocks[a].placement->getUsedBytes() < pool.blocks[b].placement->getUsedBytes();
+        });
+
+        for (size_t s = 0; s + 1 < order.size() && moves < maxMoves; s++) {
+            MemoryBlock& source = pool.blocks[order[s]];
+            if (source.movable.empty()) {
+                continue;
+            }
+
+            struct Candidate { uint32_t handle; uint64_t offset; uint64_t size; MovableInfo info; };
+            std::vector<Candidate> candidates;
+            source.placement->forEachAllocation([&](uint32_t handle, uint64_t offset, uint64_t size) {
+                auto it = source.movable.find(handle);
+                if (it != source.movable.end()) {
+                    candidates.push_back({ handle, offset, size, it->second });
+                }
+            });
+
+            for (const auto& candidate : candidates) {
+                if (moves >= maxMoves) {
+                    break;
+                }
+
+                GpuAllocation from;
+                from.memory = source.memory;
+                from.offset = candidate.offset;
+                from.size = candidate.size;
+                from.mappedData = source.mappedData ? static_cast<char*>(source.mappedData) + candidate.offset : nullptr;
+                from.memoryTypeIndex = pool.memoryTypeIndex;
+                from.poolIndex = poolIndex;
+                from.blockIndex = order[s];
+                from.handle = candidate.handle;
+                from.userData = candidate.info.userData;
+
+                for (size_t t = order.size() - 1; t > s; t--) {
+                    MemoryBlock& target = pool.blocks[order[t]];
+                    TlsfAllocator::Allocation range = target.placement->allocate(candidate.size, candidate.info.alignment);
+                    if (!range.isValid()) {
+                        continue;
+                    }
+
+                    GpuAllocation to = from;
+                    to.memory = target.memory;
+                    to.offset = range.offset;
+                    to.mappedData = target.mappedData ? static_cast<char*>(target.mappedData) + range.offset : nullptr;
+                    to.blockIndex = order[t];
+                    to.handle = range.handle;
+
+                    if (!move(from, to)) {
+                        target.placement->free(range.handle);
+                        break;
+                    }
+
+                    target.movable[range.handle] = candidate.info;
+                    source.placement->free(candidate.handle);
+                    source.movable.erase(candidate.handle);
+                    moves++;
+                    break;
+                }
+            }
+        }
+
+        releaseEmptyBlocks(pool, true);
+    }
+
+    if (moves > 0) {
+        Logger::verbose("GpuAllocator: defragmentation moved " + std::to_string(moves) + " allocations");
+    }
+
+    return moves;
+}
+
+// ==================== Statistics ====================
+
+std::vector<GpuHeapStats> GpuAllocator::getHeapStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<GpuHeapStats> stats(memoryProperties.memoryHeapCount);
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+        stats[i].heapIndex = i;
+        stats[i].heapSize = memoryProperties.memoryHeaps[i].size;
+        stats[i].flags = memoryProperties.memoryHeaps[i].flags;
+    }
+
+    for (const auto& pool : pools) {
+        GpuHeapStats& heap = stats[memoryProperties.memoryTypes[pool.memoryTypeIndex].heapIndex];
+        for (const auto& block : pool.blocks) {
+            if (block.memory == VK_NULL_HANDLE) {
+                continue;
+            }
+            heap.blockCount++;
+            heap.allocationCount += block.placement->getAllocationCount();
+            heap.reservedBytes += block.placement->getCapacity();
+            heap.usedBytes += block.placement->getUsedBytes();
+            heap.largestFreeRegion = std::max<VkDeviceSize>(heap.largestFreeRegion,
+                                                            block.placement->getLargestFreeRegion());
+        }
+    }
+
+    for (const auto& entry : dedicated) {
+        GpuHeapStats& heap = stats[memoryProperties.memoryTypes[entry.second.memoryTypeIndex].heapIndex];
+        heap.dedicatedCount++;
+        heap.allocationCount++;
+        heap.reservedBytes += entry.second.size;
+        heap.usedBytes += entry.second.size;
+    }
+
+    return stats;
+}
+
+uint32_t GpuAllocator::getDeviceMemoryAllocationCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return deviceMemoryCount;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "../memory/TlsfAllocator.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * GpuAllocation - A sub-range of a VkDeviceMemory block (or a whole
+ * dedicated allocation). Plain value type; hand it back to GpuAllocator::free.
+ */
+struct GpuAllocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void* mappedData = nullptr;       // Non-null for host-visible memory
+    uint32_t memoryTypeIndex = 0;
+    uint32_t poolIndex = UINT32_MAX;  // UINT32_MAX for dedicated allocations
+    uint32_t blockIndex = UINT32_MAX;
+    uint32_t handle = UINT32_MAX;
+    void* userData = nullptr;
+
+    bool isValid() const { return memory != VK_NULL_HANDLE; }
+    bool isDedicated() const { return poolIndex == UINT32_MAX; }
+};
+
+struct GpuBuffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    GpuAllocation allocation;
+};
+
+struct GpuImage {
+    VkImage image = VK_NULL_HANDLE;
+    GpuAllocation allocation;
+};
+
+enum GpuAllocationFlags : uint32_t {
+    GPU_ALLOCATION_NONE = 0,
+    GPU_ALLOCATION_DEDICATED = 1 << 0,  // Always get its own VkDeviceMemory
+    GPU_ALLOCATION_MOVABLE = 1 << 1     // May be relocated by defragment()
+};
+
+// Usage statistics for one VkMemoryHeap
+struct GpuHeapStats {
+    uint32_t heapIndex = 0;
+    VkDeviceSize heapSize = 0;
+    VkMemoryHeapFlags flags = 0;
+    uint32_t blockCount = 0;            // Pooled VkDeviceMemory blocks
+    uint32_t dedicatedCount = 0;        // Dedicated VkDeviceMemory objects
+    uint32_t allocationCount = 0;       // Live sub-allocations + dedicated
+    VkDeviceSize reservedBytes = 0;     // Total VkDeviceMemory owned
+    VkDeviceSize usedBytes = 0;         // Bytes handed out to resources
+    VkDeviceSize largestFreeRegion = 0;
+};
+
+/**
+ * GpuAllocator - Device memory sub-allocator
+ *
+ * Allocates large VkDeviceMemory blocks per memory type and places buffers
+ * and images inside them with a TLSF allocator, so thousands of resources
+ * cost a handful of vkAllocateMemory calls. Large or driver-preferred
+ * resources get dedicated allocations. Linear (buffers) and optimal
+ * (images) resources live in separate pools, which sidesteps
+ * bufferImageGranularity entirely.
+ *
+ * Thread-safe: every public call takes an internal lock.
+ */
+class GpuAllocator {
+public:
+    // Called once per planned move; copy the contents, re-create/re-bind the
+    // resource on `to` and return true, or return false to skip the move.
+    using DefragmentationCallback = std::function<bool(const GpuAllocation& from, const GpuAllocation& to)>;
+
+    GpuAllocator(VkPhysicalDevice physicalDevice, VkDevice device,
+                 VkDeviceSize preferredBlockSize = 256ull * 1024 * 1024);
+    ~GpuAllocator();
+
+    GpuAllocator(const GpuAllocator&) = delete;
+    GpuAllocator& operator=(const GpuAllocator&) = delete;
+
+    GpuAllocation allocate(const VkMemoryRequirements& requirements,
+                           VkMemoryPropertyFlags requiredFlags,
+                           bool linearResource,
+                           uint32_t flags = GPU_ALLOCATION_NONE,
+                           void* userData = nullptr);
+    void free(GpuAllocation& allocation);
+
+    // Convenience wrappers: create the resource, allocate and bind
+    GpuBuffer createBuffer(const VkBufferCreateInfo& createInfo,
+                           VkMemoryPropertyFlags requiredFlags,
+                           uint32_t flags = GPU_ALLOCATION_NONE);
+    void destroyBuffer(GpuBuffer& buffer);
+
+    GpuImage createImage(const VkImageCreateInfo& createInfo,
+                         VkMemoryPropertyFlags requiredFlags,
+                         uint32_t flags = GPU_ALLOCATION_NONE);
+    void destroyImage(GpuImage& image);
+
+    // Moves MOVABLE allocations out of the emptiest blocks into fuller ones,
+    // then releases blocks that became empty. Returns the number of moves.
+    // The caller must make sure the GPU no longer uses the old ranges.
+    uint32_t defragment(const DefragmentationCallback& move, uint32_t maxMoves = UINT32_MAX);
+
+    std::vector<GpuHeapStats> getHeapStats() const;
+    uint32_t getDeviceMemoryAllocationCount() const;
+
+    uint32_t findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags requiredFlags) const;
+
+private:
+    struct MovableInfo {
+        void* userData;
+        VkDeviceSize alignment;
+    };
+
+    struct MemoryBlock {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mappedData = nullptr;
+        std::unique_ptr<TlsfAllocator> placement;
+        std::unordered_map<uint32_t, MovableInfo> movable;  // keyed by placement handle
+    };
+
+    struct MemoryPool {
+        uint32_t memoryTypeIndex = 0;
+        bool linear = true;
+        std::vector<MemoryBlock> blocks;
+    };
+
+    struct DedicatedAllocation {
+        VkDeviceMemory memory;
+        VkDeviceSize size;
+        uint32_t memoryTypeIndex;
+    };
+
+    VkPhysicalDevice physicalDevice;
+    VkDevice device;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    VkDeviceSize preferredBlockSize;
+    uint32_t maxAllocationCount;
+
+    std::vector<MemoryPool> pools;  // [memoryType * 2 + (linear ? 0 : 1)]
+    std::unordered_map<VkDeviceMemory, DedicatedAllocation> dedicated;
+    uint32_t deviceMemoryCount;
+    mutable std::mutex mutex;
+
+    VkDeviceSize blockSizeForType(uint32_t memoryTypeIndex) const;
+    bool isHostVisible(uint32_t memoryTypeIndex) const;
+    VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex,
+                                        const void* pNext, void** mappedData);
+    GpuAllocation allocateFromPool(uint32_t poolIndex, const VkMemoryRequirements& requirements,
+                                   uint32_t flags, void* userData);
+    GpuAllocation allocateDedicated(const VkMemoryRequirements& requirements, uint32_t memoryTypeIndex,
+                                    VkBuffer buffer, VkImage image, void* userData);
+    void freeLocked(GpuAllocation& allocation);
+    void releaseEmptyBlocks(MemoryPool& pool, bool keepOne);
+};
@@ -0,0 +1,392 @@
+#include "GpuDrivenRenderer.h"
+#include "VulkanContext.h"
+#include "../renderer/FrustumCuller.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint32_t CULL_GROUP_SIZE = 64;    // local_size_x in cull.comp
+
+}
+
+GpuDrivenRenderer::GpuDrivenRenderer(VulkanContext& context, uint32_t maxInstances)
+    : context(context)
+    , device(context.getDevice())
+    , maxInstances(std::max(maxInstances, 1u))
+    , drawIndirectCount(context.getEnabledFeatures().drawIndirectCount)
+    , multiDrawIndirect(context.getEnabledFeatures().multiDrawIndirect)
+    , uploadedInstanceCount(0)
+    , uploadedMeshCount(0)
+    , geometryVersion(0)
+    , descriptorSetLayout(VK_NULL_HANDLE)
+    , descriptorPool(VK_NULL_HANDLE)
+    , cullLayout(VK_NULL_HANDLE)
+    , drawLayout(VK_NULL_HANDLE)
+    , cullPipeline(VK_NULL_HANDLE)
+    , drawPipeline(VK_NULL_HANDLE)
+    , cullShader(UINT32_MAX)
+    , vertexShader(UINT32_MAX)
+    , fragmentShader(UINT32_MAX)
+    , viewProjection{}
+    , frustumPlanes{}
+    , lastVisibleCount(0)
+{
+    // Every draw addresses its instance through firstInstance
+    if (!context.getEnabledFeatures().drawIndirectFirstInstance) {
+        throw std::runtime_error("Failed to create GPU-driven renderer: drawIndirectFirstInstance not supported!");
+    }
+
+    static const float identity[16] = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+    setViewProjection(identity);
+
+    instanceBuffer = context.createBuffer(sizeof(GpuInstance) * this->maxInstances,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    frames.resize(context.getFrameSlotCount());
+    for (FrameResources& frame : frames) {
+        frame.drawBuffer = context.createBuffer(sizeof(VkDrawIndexedIndirectCommand) * this->maxInstances,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        frame.countBuffer = context.createBuffer(sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        std::memset(frame.countBuffer.allocation.mappedData, 0, sizeof(uint32_t));
+    }
+
+    createDescriptors();
+    createPipelines();
+
+    context.addRenderFeature(this);
+
+    Logger::verbose("GPU-driven renderer: " + std::to_string(this->maxInstances) + " instances, " +
+                    (drawIndirectCount ? "drawIndirectCount" :
+                     multiDrawIndirect ? "multiDrawIndirect" : "single indirect draws"));
+}
+
+GpuDrivenRenderer::~GpuDrivenRenderer() {
+    context.removeRenderFeature(this);
+    destroy();
+}
+
+// ==================== Scene Data ====================
+
+uint32_t GpuDrivenRenderer::addMesh(const std::vector<float>& positions, const std::vector<uint32_t>& meshIndices) {
+    if (positions.empty() || positions.size() % 3 != 0 || meshIndices.empty()) {
+        throw std::runtime_error("Failed to add mesh: expected xyz positions and indices!");
+    }
+
+    float radiusSquared = 0.0f;
+    for (size_t i = 0; i < positions.size(); i += 3) {
+        float lengthSquared = positions[i] * positions[i] +
+                              positions[i + 1] * positions[i + 1] +
+                              positions[i + 2] * positions[i + 2];
+        radiusSquared = std::max(radiusSquared, lengthSquared);
+    }
+
+    GpuMeshInfo mesh{};
+    mesh.indexCount = static_cast<uint32_t>(meshIndices.size());
+    mesh.firstIndex = static_cast<uint32_t>(indices.size());
+    mesh.vertexOffset = static_cast<int32_t>(vertices.size() / 3);
+    mesh.boundingRadius = std::sqrt(radiusSquared);
+
+    vertices.insert(vertices.end(), positions.begin(), positions.end());
+    indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+    meshes.push_back(mesh);
+
+    return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+uint32_t GpuDrivenRenderer::addInstance(const GpuInstance& instance) {
+    if (instances.size() >= maxInstances) {
+        throw std::runtime_error("Failed to add instance: maxInstances reached!");
+    }
+    if (instance.meshIndex >= meshes.size()) {
+        throw std::runtime_error("Failed to add instance: unknown mesh index!");
+    }
+
+    instances.push_back(instance);
+    return static_cast<uint32_t>(instances.size() - 1);
+}
+
+void GpuDrivenRenderer::upload() {
+    StagingUploader& uploader = context.getStagingUploader();
+
+    if (meshes.size() != uploadedMeshCount) {
+        // Geometry buffers are sized to fit; frames in flight may still read the old ones
+        context.deferDestroy(vertexBuffer);
+        context.deferDestroy(indexBuffer);
+        context.deferDestroy(meshBuffer);
+
+        VkDeviceSize vertexSize = vertices.size() * sizeof(float);
+        VkDeviceSize indexSize = indices.size() * sizeof(uint32_t);
+        VkDeviceSize meshSize = meshes.size() * sizeof(GpuMeshInfo);
+
+        vertexBuffer = context.createBuffer(vertexSize,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        indexBuffer = context.createBuffer(indexSize,
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        meshBuffer = context.createBuffer(meshSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        uploader.uploadBuffer(vertexBuffer.buffer, 0, vertices.data(), vertexSize);
+        uploader.uploadBuffer(indexBuffer.buffer, 0, indices.data(), indexSize);
+        uploader.uploadBuffer(meshBuffer.buffer, 0, meshes.data(), meshSize);
+
+        uploadedMeshCount = static_cast<uint32_t>(meshes.size());
+        geometryVersion++;
+    }
+
+    if (instances.size() != uploadedInstanceCount && !instances.empty()) {
+        // Only append: instances already on the GPU may be in use by frames in flight
+        VkDeviceSize offset = uploadedInstanceCount * sizeof(GpuInstance);
+        uploader.uploadBuffer(instanceBuffer.buffer, offset, instances.data() + uploadedInstanceCount,
+                              (instances.size() - uploadedInstanceCount) * sizeof(GpuInstance));
+        uploadedInstanceCount = static_cast<uint32_t>(instances.size());
+    }
+}
+
+void GpuDrivenRenderer::setViewProjection(const float matrix[16]) {
+    std::memcpy(viewProjection, matrix, sizeof(viewProjection));
+    extractFrustumPlanes(matrix, frustumPlanes);
+}
+
+void GpuDrivenRenderer::extractFrustumPlanes(const float m[16], float planes[6][4]) {
+    FrustumCuller::extractPlanes(m, planes);
+}
+
+// ==================== Per Frame ====================
+
+void GpuDrivenRenderer::prepare(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    FrameResources& frame = frames[frameIndex];
+
+    // This slot's previous frame has completed, so last cull's count is final
+    lastVisibleCount = *static_cast<const uint32_t*>(frame.countBuffer.allocation.mappedData);
+
+    // Re-resolved every frame so a recreated render pass or reloaded shader is picked up
+    PipelineManager& pipelines = context.getPipelineManager();
+    cullPipeline = pipelines.getComputePipeline(cullShader, cullLayout);
+
+    PipelineStateDesc desc;
+    desc.vertexShader = vertexShader;
+    desc.fragmentShader = fragmentShader;
+    desc.setVertexInputs(pipelines.getShaderReflection(vertexShader));
+    desc.cullMode = VK_CULL_MODE_NONE;
+    desc.layout = drawLayout;
+    context.setMainPassTarget(desc);
+    // No fallback shares drawLayout: draw() skips until the compile lands
+    drawPipeline = pipelines.getPipelineAsync(desc);
+
+    if (uploadedInstanceCount == 0 || uploadedMeshCount == 0) {
+        return;
+    }
+
+    // Sets of frames still in flight are left alone until their slot comes around
+    if (frame.geometryVersion != geometryVersion) {
+        writeDescriptors(frame);
+    }
+
+    GpuProfiler::Scope scope(context.getGpuProfiler(), commandBuffer, "cull");
+
+    vkCmdFillBuffer(commandBuffer, frame.countBuffer.buffer, 0, sizeof(uint32_t), 0);
+
+    VkMemoryBarrier clearBarrier{};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    CullPushConstants push{};
+    std::memcpy(push.frustumPlanes, frustumPlanes, sizeof(push.frustumPlanes));
+    push.instanceCount = uploadedInstanceCount;
+    push.compact = drawIndirectCount ? 1u : 0u;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullLayout,
+                            0, 1, &frame.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, cullLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+    vkCmdDispatch(commandBuffer, (uploadedInstanceCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+    // Draw commands feed the indirect stage; the count is also read on the host
+    VkMemoryBarrier cullBarrier{};
+    cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+}
+
+void GpuDrivenRenderer::draw(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    if (uploadedInstanceCount == 0 || uploadedMeshCount == 0 || drawPipeline == VK_NULL_HANDLE) {
+        return;
+    }
+
+    FrameResources& frame = frames[frameIndex];
+    VkDeviceSize vertexOffset = 0;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, drawLayout,
+                            0, 1, &frame.descriptorSet, 0, nullptr);
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer.buffer, &vertexOffset);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdPushConstants(commandBuffer, drawLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                       sizeof(viewProjection), viewProjection);
+
+    const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    if (drawIndirectCount) {
+        vkCmdDrawIndexedIndirectCount(commandBuffer, frame.drawBuffer.buffer, 0,
+                                      frame.countBuffer.buffer, 0, uploadedInstanceCount, stride);
+    } else if (multiDrawIndirect) {
+        // Culled slots carry instanceCount 0
+        vkCmdDrawIndexedIndirect(commandBuffer, frame.drawBuffer.buffer, 0, uploadedInstanceCount, stride);
+    } else {
+        for (uint32_t i = 0; i < uploadedInstanceCount; i++) {
+            vkCmdDrawIndexedIndirect(commandBuffer, frame.drawBuffer.buffer, i * stride, 1, stride);
+        }
+    }
+}
+
+GpuDrivenStats GpuDrivenRenderer::getStats() const {
+    GpuDrivenStats stats;
+    stats.instanceCount = uploadedInstanceCount;
+    stats.meshCount = uploadedMeshCount;
+    stats.lastVisibleCount = lastVisibleCount;
+    stats.drawIndirectCount = drawIndirectCount;
+    stats.multiDrawIndirect = multiDrawIndirect;
+    return stats;
+}
+
+// ==================== Setup ====================
+
+void GpuDrivenRenderer::createDescriptors() {
+    PipelineManager& pipelines = context.getPipelineManager();
+    cullShader = pipelines.loadShader("shaders/cull.comp.spv");
+    vertexShader = pipelines.loadShader("shaders/indirect.vert.spv");
+    fragmentShader = pipelines.loadShader("shaders/triangle.frag.spv");
+
+    // Set 0 is shared by culling and drawing (indirect.vert fetches instances),
+    // so its layout is reflected from both; owned by the context's cache
+    ShaderReflection shared = SpirvReflection::merge({
+        pipelines.getShaderReflection(cullShader),
+        pipelines.getShaderReflection(vertexShader)
+    });
+    descriptorSetLayout = context.getDescriptorLayoutCache().getLayout(PipelineLayoutCache::getSetBindings(shared, 0));
+
+    uint32_t frameCount = static_cast<uint32_t>(frames.size());
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 4 * frameCount;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = frameCount;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create GPU-driven descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(frameCount, descriptorSetLayout);
+    std::vector<VkDescriptorSet> sets(frameCount);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = frameCount;
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate GPU-driven descriptor sets!");
+    }
+    for (uint32_t i = 0; i < frameCount; i++) {
+        frames[i].descriptorSet = sets[i];
+    }
+}
+
+void GpuDrivenRenderer::createPipelines() {
+    PipelineManager& pipelines = context.getPipelineManager();
+
+    // Push constant ranges are reflected; set 0 is forced to the shared layout
+    PipelineLayoutOverrides overrides;
+    overrides.sets.emplace_back(0, descriptorSetLayout);
+
+    PipelineLayoutCache& layouts = context.getPipelineLayoutCache();
+    cullLayout = layouts.getLayout(pipelines.getShaderReflection(cullShader), overrides);
+    drawLayout = layouts.getLayout(SpirvReflection::merge({
+        pipelines.getShaderReflection(vertexShader),
+        pipelines.getShaderReflection(fragmentShader)
+    }), overrides);
+
+    cullPipeline = pipelines.getComputePipeline(cullShader, cullLayout);
+}
+
+void GpuDrivenRenderer::writeDescriptors(FrameResources& frame) {
+    VkDescriptorBufferInfo bufferInfos[4]{};
+    bufferInfos[0] = { instanceBuffer.buffer, 0, VK_WHOLE_SIZE };
+    bufferInfos[1] = { meshBuffer.buffer, 0, VK_WHOLE_SIZE };
+    bufferInfos[2] = { frame.drawBuffer.buffer, 0, VK_WHOLE_SIZE };
+    bufferInfos[3] = { frame.countBuffer.buffer, 0, VK_WHOLE_SIZE };
+
+    VkWriteDescriptorSet writes[4]{};
+    for (uint32_t i = 0; i < 4; i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = frame.descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(device, 4, writes, 0, nullptr);
+    frame.geometryVersion = geometryVersion;
+}
+
+void GpuDrivenRenderer::destroy() {
+    if (device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    // Frames in flight may still read the buffers; pipelines belong to the PipelineManager
+    vkDeviceWaitIdle(device);
+
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+    }
+
+    // Layouts belong to the context's layout caches
+    descriptorSetLayout = VK_NULL_HANDLE;
+    cullLayout = VK_NULL_HANDLE;
+    drawLayout = VK_NULL_HANDLE;
+
+    for (FrameResources& frame : frames) {
+        context.destroyBuffer(frame.drawBuffer);
+        context.destroyBuffer(frame.countBuffer);
+    }
+    frames.clear();
+
+    context.destroyBuffer(vertexBuffer);
+    context.destroyBuffer(indexBuffer);
+    context.destroyBuffer(meshBuffer);
+    context.destroyBuffer(instanceBuffer);
+
+    cullPipeline = VK_NULL_HANDLE;
+    drawPipeline = VK_NULL_HANDLE;
+    device = VK_NULL_HANDLE;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "IRenderFeature.h"
+#include "GpuAllocator.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+class VulkanContext;
+
+// std430 layout shared with shaders/cull.comp and shaders/indirect.vert
+struct GpuInstance {
+    float position[3] = { 0.0f, 0.0f, 0.0f };
+    float scale = 1.0f;
+    float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    uint32_t meshIndex = 0;
+    uint32_t padding[3] = {};
+};
+
+struct GpuMeshInfo {
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    float boundingRadius;       // Around the mesh origin
+};
+
+struct GpuDrivenStats {
+    uint32_t instanceCount = 0;
+    uint32_t meshCount = 0;
+    uint32_t lastVisibleCount = 0;      // From this frame slot's previous cull
+    bool drawIndirectCount = false;     // Compacted list + GPU draw count
+    bool multiDrawIndirect = false;     // Else one vkCmdDrawIndexedIndirect per instance
+};
+
+/**
+ * GpuDrivenRenderer - Compute-culled, indirect-drawn static geometry
+ *
+ * Meshes share one vertex/index buffer; instances and mesh descriptors live
+ * in storage buffers. Every frame cull.comp frustum-culls all instances and
+ * writes VkDrawIndexedIndirectCommands, consumed by a single
+ * vkCmdDrawIndexedIndirectCount. Without drawIndirectCount every instance
+ * keeps its own slot (instanceCount 0 when culled) and the array is drawn
+ * with vkCmdDrawIndexedIndirect. CPU cost is independent of instance count.
+ *
+ * Registers itself with the context; destroy before the context.
+ */
+class GpuDrivenRenderer : public IRenderFeature {
+public:
+    GpuDrivenRenderer(VulkanContext& context, uint32_t maxInstances);
+    ~GpuDrivenRenderer() override;
+
+    GpuDrivenRenderer(const GpuDrivenRenderer&) = delete;
+    GpuDrivenRenderer& operator=(const GpuDrivenRenderer&) = delete;
+
+    // positions: xyz per vertex. Returns the mesh index for GpuInstance.
+    uint32_t addMesh(const std::vector<float>& positions, const std::vector<uint32_t>& indices);
+    uint32_t addInstance(const GpuInstance& instance);
+
+    // Streams meshes and instances added so far to the GPU (via the staging
+    // ring); they become visible from the next frame on. Call between frames.
+    // Replaced geometry buffers are released through the deletion queue.
+    void upload();
+
+    // Column-major view-projection, also used to extract the cull frustum
+    void setViewProjection(const float matrix[16]);
+
+    void prepare(VkCommandBuffer commandBuffer, uint32_t frameIndex) override;
+    void draw(VkCommandBuffer commandBuffer, uint32_t frameIndex) override;
+
+    GpuDrivenStats getStats() const;
+    void destroy();
+
+    // Plane i = (a, b, c, d) with inward unit normal; point p is inside when
+    // dot(abc, p) + d >= 0. Order: left, right, bottom, top, near, far.
+    static void extractFrustumPlanes(const float matrix[16], float planes[6][4]);
+
+private:
+    struct CullPushConstants {
+        float frustumPlanes[6][4];
+        uint32_t instanceCount;
+        uint32_t compact;
+    };
+
+    struct FrameResources {
+        GpuBuffer drawBuffer;
+        GpuBuffer countBuffer;          // Host-visible so culling stats can be read back
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        uint32_t geometryVersion = 0;   // Mesh buffer the set points at
+    };
+
+    VulkanContext& context;
+    VkDevice device;
+    uint32_t maxInstances;
+    bool drawIndirectCount;
+    bool multiDrawIndirect;
+
+    // CPU copies until upload()
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<GpuMeshInfo> meshes;
+    std::vector<GpuInstance> instances;
+
+    GpuBuffer vertexBuffer;
+    GpuBuffer indexBuffer;
+    GpuBuffer meshBuffer;
+    GpuBuffer instanceBuffer;
+    uint32_t uploadedInstanceCount;
+    uint32_t uploadedMeshCount;
+    uint32_t geometryVersion;       // Bumped whenever the mesh buffers are replaced
+
+    std::vector<FrameResources> frames;
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkDescriptorPool descriptorPool;
+    VkPipelineLayout cullLayout;
+    VkPipelineLayout drawLayout;
+    VkPipeline cullPipeline;        // Both resolved in prepare(): the render pass or
+    VkPipeline drawPipeline;        // a hot-reloaded shader may have replaced them;
+                                    // draw is null while compiling in the background
+    uint32_t cullShader;
+    uint32_t vertexShader;
+    uint32_t fragmentShader;
+
+    float viewProjection[16];
+    float frustumPlanes[6][4];
+    uint32_t lastVisibleCount;
+
+    void createDescriptors();
+    void createPipelines();
+    void writeDescriptors(FrameResources& frame);
+};
@@ -0,0 +1,230 @@
+#include "GpuProfiler.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            escaped += buffer;
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+}
+
+GpuProfiler::GpuProfiler(VkPhysicalDevice physicalDevice, VkDevice device,
+                         uint32_t queueFamilyIndex, uint32_t framesInFlight)
+    : device(device)
+    , supported(false)
+    , timestampPeriodNs(0.0)
+    , timestampMask(0)
+    , frames(framesInFlight)
+    , currentFrame(0)
+    , frameCounter(0)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+    uint32_t validBits = queueFamilyIndex < familyCount ? families[queueFamilyIndex].timestampValidBits : 0;
+    timestampPeriodNs = properties.limits.timestampPeriod;
+    supported = validBits > 0 && timestampPeriodNs > 0.0;
+
+    if (!supported) {
+        Logger::verbose("GPU timestamps not supported on this queue; profiler disabled");
+        return;
+    }
+
+    timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = MAX_SCOPES_PER_FRAME * 2;
+
+    for (auto& frame : frames) {
+        if (vkCreateQueryPool(device, &poolInfo, nullptr, &frame.pool) != VK_SUCCESS) {
+            destroy();
+            throw std::runtime_error("Failed to create timestamp query pool!");
+        }
+        frame.names.resize(MAX_SCOPES_PER_FRAME);
+    }
+}
+
+GpuProfiler::~GpuProfiler() {
+    destroy();
+}
+
+void GpuProfiler::destroy() {
+    for (auto& frame : frames) {
+        if (frame.pool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device, frame.pool, nullptr);
+            frame.pool = VK_NULL_HANDLE;
+        }
+    }
+    supported = false;
+}
+
+// ==================== Frame ====================
+
+void GpuProfiler::beginFrame(uint32_t frameIndex, VkCommandBuffer commandBuffer) {
+    if (!supported) {
+        return;
+    }
+
+    currentFrame = frameIndex;
+    FrameQueries& frame = frames[frameIndex];
+
+    if (frame.recorded) {
+        harvest(frame);
+    }
+
+    vkCmdResetQueryPool(commandBuffer, frame.pool, 0, MAX_SCOPES_PER_FRAME * 2);
+    frame.scopeCount = 0;
+    frame.frameNumber = frameCounter++;
+    frame.recorded = true;
+}
+
+void GpuProfiler::harvest(FrameQueries& frame) {
+    frame.recorded = false;
+
+    uint32_t scopeCount = std::min(frame.scopeCount.load(), MAX_SCOPES_PER_FRAME);
+    if (scopeCount == 0) {
+        return;
+    }
+
+    // [begin, beginAvailable, end, endAvailable] per scope. The frame slot's
+    // timeline serial has been reached, so no WAIT flag: unwritten queries
+    // just report unavailable.
+    std::vector<uint64_t> data(scopeCount * 4);
+    vkGetQueryPoolResults(device, frame.pool, 0, scopeCount * 2,
+                          data.size() * sizeof(uint64_t), data.data(), 2 * sizeof(uint64_t),
+                          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    lastResults.frameNumber = frame.frameNumber;
+    lastResults.passes.clear();
+
+    for (uint32_t i = 0; i < scopeCount; i++) {
+        const uint64_t* query = &data[i * 4];
+        if (query[1] == 0 || query[3] == 0) {
+            continue;  // Scope was opened but never closed
+        }
+
+        uint64_t ticks = (query[2] - query[0]) & timestampMask;
+        double ms = static_cast<double>(ticks) * timestampPeriodNs / 1e6;
+
+        lastResults.passes.push_back({ frame.names[i], ms });
+
+        PassAverage& average = averages[frame.names[i]];
+        average.totalMs += ms;
+        average.samples++;
+    }
+}
+
+// ==================== Scopes ====================
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char* name) {
+    if (!supported) {
+        return INVALID_SCOPE;
+    }
+
+    FrameQueries& frame = frames[currentFrame];
+    uint32_t scope = frame.scopeCount.fetch_add(1);
+    if (scope >= MAX_SCOPES_PER_FRAME) {
+        return INVALID_SCOPE;
+    }
+
+    frame.names[scope] = name;
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.pool, scope * 2);
+    return scope;
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+    if (!supported || scope == INVALID_SCOPE) {
+        return;
+    }
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        frames[currentFrame].pool, scope * 2 + 1);
+}
+
+GpuProfiler::Scope::Scope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name)
+    : profiler(profiler)
+    , commandBuffer(commandBuffer)
+    , scope(profiler.beginScope(commandBuffer, name))
+{
+}
+
+GpuProfiler::Scope::~Scope() {
+    profiler.endScope(commandBuffer, scope);
+}
+
+// ==================== Results ====================
+
+double GpuProfiler::getPassMs(const std::string& name) const {
+    for (const auto& pass : lastResults.passes) {
+        if (pass.name == name) {
+            return pass.gpuMs;
+        }
+    }
+    return 0.0;
+}
+
+double GpuProfiler::getAveragePassMs(const std::string& name) const {
+    auto it = averages.find(name);
+    if (it == averages.end() || it->second.samples == 0) {
+        return 0.0;
+    }
+    return it->second.totalMs / static_cast<double>(it->second.samples);
+}
+
+std::string GpuProfiler::toJson() const {
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"supported\": " << (supported ? "true" : "false") << ",\n";
+    json << "  \"timestampPeriodNs\": " << timestampPeriodNs << ",\n";
+    json << "  \"frame\": " << lastResults.frameNumber << ",\n";
+    json << "  \"passes\": [";
+
+    for (size_t i = 0; i < lastResults.passes.size(); i++) {
+        const GpuPassTiming& pass = lastResults.passes[i];
+        json << (i == 0 ? "\n" : ",\n");
+        json << "    { \"name\": \"" << escapeJson(pass.name) << "\""
+             << ", \"gpuMs\": " << pass.gpuMs
+             << ", \"avgMs\": " << getAveragePassMs(pass.name) << " }";
+    }
+
+    json << (lastResults.passes.empty() ? "]\n" : "\n  ]\n");
+    json << "}\n";
+    return json.str();
+}
+
+bool GpuProfiler::writeJson(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        Logger::error("Failed to open " + path + " for writing");
+        return false;
+    }
+    file << toJson();
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct GpuPassTiming {
+    std::string name;
+    double gpuMs = 0.0;
+};
+
+struct GpuFrameTimings {
+    uint64_t frameNumber = 0;                   // Frame the timings belong to
+    std::vector<GpuPassTiming> passes;          // In scope begin order
+};
+
+/**
+ * GpuProfiler - Timestamp queries around GPU passes
+ *
+ * One VkQueryPool per frame in flight. A frame's queries are read back when
+ * that frame slot comes around again and its previous frame has completed,
+ * so harvesting never stalls. Scopes may be opened from worker threads
+ * recording secondaries; query slots are handed out atomically.
+ *
+ * Usage:
+ *   GpuProfiler::Scope scope(profiler, commandBuffer, "shadows");
+ */
+class GpuProfiler {
+public:
+    static constexpr uint32_t MAX_SCOPES_PER_FRAME = 64;
+    static constexpr uint32_t INVALID_SCOPE = UINT32_MAX;
+
+    class Scope {
+    public:
+        Scope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        GpuProfiler& profiler;
+        VkCommandBuffer commandBuffer;
+        uint32_t scope;
+    };
+
+    GpuProfiler(VkPhysicalDevice physicalDevice, VkDevice device,
+                uint32_t queueFamilyIndex, uint32_t framesInFlight);
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    bool isSupported() const { return supported; }
+
+    // Call once the slot's previous frame has completed, with its primary command
+    // buffer in the recording state and outside any render pass. Harvests
+    // the results this slot produced last time, then resets its queries.
+    void beginFrame(uint32_t frameIndex, VkCommandBuffer commandBuffer);
+
+    // Timestamps at the bottom of the pipe; INVALID_SCOPE when out of slots
+    uint32_t beginScope(VkCommandBuffer commandBuffer, const char* name);
+    void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+    // Most recently harvested frame
+    const GpuFrameTimings& getLastResults() const { return lastResults; }
+
+    // Latest and running-average GPU time of a named pass (0 if unknown)
+    double getPassMs(const std::string& name) const;
+    double getAveragePassMs(const std::string& name) const;
+
+    std::string toJson() const;
+    bool writeJson(const std::string& path) const;
+
+    void destroy();
+
+private:
+    struct FrameQueries {
+        VkQueryPool pool = VK_NULL_HANDLE;
+        std::atomic<uint32_t> scopeCount{0};
+        std::vector<std::string> names;          // [scope]
+        uint64_t frameNumber = 0;
+        bool recorded = false;
+    };
+
+    struct PassAverage {
+        double totalMs = 0.0;
+        uint64_t samples = 0;
+    };
+
+    VkDevice device;
+    bool supported;
+    double timestampPeriodNs;
+    uint64_t timestampMask;
+
+    std::vector<FrameQueries> frames;
+    uint32_t currentFrame;
+    uint64_t frameCounter;
+
+    GpuFrameTimings lastResults;
+    std::map<std::string, PassAverage> averages;
+
+    void harvest(FrameQueries& frame);
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+/**
+ * IRenderFeature - Pluggable per-frame rendering work for VulkanContext
+ *
+ * prepare() runs on the render thread with the frame's primary command
+ * buffer, outside any render pass (compute dispatches, copies, barriers).
+ * draw() records into a secondary command buffer inside the main render
+ * pass, possibly on a worker thread; viewport and scissor are already set.
+ */
+class IRenderFeature {
+public:
+    virtual ~IRenderFeature() = default;
+
+    virtual void prepare(VkCommandBuffer commandBuffer, uint32_t frameIndex) = 0;
+    virtual void draw(VkCommandBuffer commandBuffer, uint32_t frameIndex) = 0;
+};
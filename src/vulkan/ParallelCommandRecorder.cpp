@@ -0,0 +1,157 @@
+#include "ParallelCommandRecorder.h"
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+
+// Secondaries allocated per vkAllocateCommandBuffers when a pool runs dry
+constexpr uint32_t SECONDARY_ALLOCATION_BATCH = 16;
+
+}
+
+ParallelCommandRecorder::ParallelCommandRecorder(VkDevice device, uint32_t queueFamilyIndex,
+                                                 uint32_t framesInFlight, ThreadPool& threadPool)
+    : device(device)
+    , threadPool(threadPool)
+    , framesInFlight(framesInFlight)
+    , threadSlots(threadPool.getThreadSlotCount())
+    , currentFrame(0)
+{
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;  // Reset as a whole every frame
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+
+    pools.resize(framesInFlight * threadSlots);
+    for (auto& pool : pools) {
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &pool.pool) != VK_SUCCESS) {
+            destroy();
+            throw std::runtime_error("Failed to create worker command pool!");
+        }
+    }
+
+    // Primaries live in the render thread's pool
+    primaries.resize(framesInFlight);
+    uint32_t renderThreadSlot = threadPool.getCurrentThreadSlot();
+    for (uint32_t frame = 0; frame < framesInFlight; frame++) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = getPool(frame, renderThreadSlot).pool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(device, &allocInfo, &primaries[frame]) != VK_SUCCESS) {
+            destroy();
+            throw std::runtime_error("Failed to allocate primary command buffer!");
+        }
+    }
+
+    stats.threadSlots = threadSlots;
+    stats.commandPools = static_cast<uint32_t>(pools.size());
+}
+
+ParallelCommandRecorder::~ParallelCommandRecorder() {
+    destroy();
+}
+
+void ParallelCommandRecorder::destroy() {
+    // Command buffers are freed with their pool
+    for (auto& pool : pools) {
+        if (pool.pool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(device, pool.pool, nullptr);
+        }
+    }
+    pools.clear();
+    primaries.clear();
+}
+
+ParallelCommandRecorder::WorkerCommandPool& ParallelCommandRecorder::getPool(uint32_t frameIndex, uint32_t slot) {
+    return pools[frameIndex * threadSlots + slot];
+}
+
+VkCommandBuffer ParallelCommandRecorder::getPrimary(uint32_t frameIndex) const {
+    return primaries[frameIndex];
+}
+
+// ==================== Frame ====================
+
+void ParallelCommandRecorder::beginFrame(uint32_t frameIndex) {
+    currentFrame = frameIndex;
+
+    for (uint32_t slot = 0; slot < threadSlots; slot++) {
+        WorkerCommandPool& pool = getPool(frameIndex, slot);
+        vkResetCommandPool(device, pool.pool, 0);
+        pool.used = 0;
+    }
+
+    stats.lastFrameSecondaries = 0;
+    stats.lastFrameRecordMs = 0.0;
+}
+
+VkCommandBuffer ParallelCommandRecorder::acquireSecondary(WorkerCommandPool& pool) {
+    if (pool.used == pool.secondaries.size()) {
+        size_t first = pool.secondaries.size();
+        pool.secondaries.resize(first + SECONDARY_ALLOCATION_BATCH);
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = pool.pool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = SECONDARY_ALLOCATION_BATCH;
+
+        if (vkAllocateCommandBuffers(device, &allocInfo, &pool.secondaries[first]) != VK_SUCCESS) {
+            pool.secondaries.resize(first);
+            throw std::runtime_error("Failed to allocate secondary command buffers!");
+        }
+    }
+
+    return pool.secondaries[pool.used++];
+}
+
+void ParallelCommandRecorder::record(uint32_t taskCount, const VkCommandBufferInheritanceInfo& inheritance,
+                                     const RecordFn& fn, std::vector<VkCommandBuffer>& out) {
+    if (taskCount == 0) {
+        return;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    recorded.assign(taskCount, VK_NULL_HANDLE);
+
+    threadPool.parallelFor(taskCount, [&](uint32_t taskIndex, uint32_t slot) {
+        VkCommandBuffer commandBuffer = acquireSecondary(getPool(currentFrame, slot));
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+                          VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = &inheritance;
+
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to begin secondary command buffer!");
+        }
+
+        fn(commandBuffer, taskIndex);
+
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to record secondary command buffer!");
+        }
+
+        recorded[taskIndex] = commandBuffer;
+    });
+
+    out.insert(out.end(), recorded.begin(), recorded.end());
+
+    // Pools are only touched by their own thread, so totals are summed here
+    uint32_t allocated = 0;
+    for (const auto& pool : pools) {
+        allocated += static_cast<uint32_t>(pool.secondaries.size());
+    }
+    stats.secondaryBuffers = allocated;
+    stats.lastFrameSecondaries += taskCount;
+    stats.lastFrameRecordMs += std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+ParallelRecorderStats ParallelCommandRecorder::getStats() const {
+    return stats;
+}
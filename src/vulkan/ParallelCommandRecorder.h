@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../utils/ThreadPool.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct ParallelRecorderStats {
+    uint32_t threadSlots = 0;           // worker threads + the render thread
+    uint32_t commandPools = 0;          // threadSlots * framesInFlight
+    uint32_t secondaryBuffers = 0;      // secondaries allocated across all pools
+    uint32_t lastFrameSecondaries = 0;  // secondaries recorded in the last frame
+    double lastFrameRecordMs = 0.0;     // wall time of record() calls in the last frame
+};
+
+/**
+ * ParallelCommandRecorder - Secondary command buffer recording on worker threads
+ *
+ * Owns one VkCommandPool per (frame in flight, thread slot). A thread only
+ * ever allocates from its own slot's pool, so recording needs no locks.
+ * Pools are reset wholesale in beginFrame() instead of resetting individual
+ * buffers, and their buffers are reused across frames.
+ *
+ * The render thread's pool also holds the frame's primary command buffer.
+ */
+class ParallelCommandRecorder {
+public:
+    using RecordFn = std::function<void(VkCommandBuffer commandBuffer, uint32_t taskIndex)>;
+
+    ParallelCommandRecorder(VkDevice device, uint32_t queueFamilyIndex,
+                            uint32_t framesInFlight, ThreadPool& threadPool);
+    ~ParallelCommandRecorder();
+
+    ParallelCommandRecorder(const ParallelCommandRecorder&) = delete;
+    ParallelCommandRecorder& operator=(const ParallelCommandRecorder&) = delete;
+
+    // Resets every pool of this frame; the frame's previous submit must have completed
+    void beginFrame(uint32_t frameIndex);
+
+    // Primary command buffer of a frame, reset together with its pool
+    VkCommandBuffer getPrimary(uint32_t frameIndex) const;
+
+    // Records taskCount secondaries in parallel and appends them to `out`
+    // in task order. Call from the render thread only.
+    void record(uint32_t taskCount, const VkCommandBufferInheritanceInfo& inheritance,
+                const RecordFn& fn, std::vector<VkCommandBuffer>& out);
+
+    ParallelRecorderStats getStats() const;
+    void destroy();
+
+private:
+    struct WorkerCommandPool {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> secondaries;
+        uint32_t used = 0;
+    };
+
+    VkDevice device;
+    ThreadPool& threadPool;
+    uint32_t framesInFlight;
+    uint32_t threadSlots;
+    uint32_t currentFrame;
+
+    std::vector<WorkerCommandPool> pools;     // [frame * threadSlots + slot]
+    std::vector<VkCommandBuffer> primaries;   // [frame]
+    std::vector<VkCommandBuffer> recorded;    // scratch, indexed by task
+
+    ParallelRecorderStats stats;
+
+    WorkerCommandPool& getPool(uint32_t frameIndex, uint32_t slot);
+    VkCommandBuffer acquireSecondary(WorkerCommandPool& pool);
+};
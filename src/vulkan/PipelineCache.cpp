@@ -0,0 +1,255 @@
+#include "PipelineCache.h"
+#include "../utils/logger.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+double elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}
+
+PipelineCache::PipelineCache(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& directory)
+    : device(device)
+    , properties{}
+    , cache(VK_NULL_HANDLE)
+    , creationFeedbackSupported(false)
+{
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    // VkPipelineCreationFeedback is core since 1.3
+    creationFeedbackSupported = properties.apiVersion >= VK_API_VERSION_1_3;
+
+    char fileName[64];
+    std::snprintf(fileName, sizeof(fileName), "pipeline_cache_%04x_%04x.bin",
+                  properties.vendorID, properties.deviceID);
+    path = (std::filesystem::path(directory) / fileName).string();
+}
+
+PipelineCache::~PipelineCache() {
+    destroy();
+}
+
+// ==================== Load / Save ====================
+
+bool PipelineCache::validateHeader(const std::vector<char>& data,
+                                   const VkPhysicalDeviceProperties& properties,
+                                   std::string& reason) {
+    VkPipelineCacheHeaderVersionOne header{};
+    if (data.size() < sizeof(header)) {
+        reason = "file too small for header";
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    if (header.headerSize < sizeof(header) || header.headerSize > data.size()) {
+        reason = "bad header size";
+        return false;
+    }
+    if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+        reason = "unknown header version";
+        return false;
+    }
+    if (header.vendorID != properties.vendorID) {
+        reason = "vendor ID mismatch";
+        return false;
+    }
+    if (header.deviceID != properties.deviceID) {
+        reason = "device ID mismatch";
+        return false;
+    }
+    if (std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        reason = "pipelineCacheUUID mismatch (driver changed)";
+        return false;
+    }
+
+    return true;
+}
+
+void PipelineCache::load() {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<char> data;
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (file.is_open()) {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(data.data(), data.size());
+
+        if (!validateHeader(data, properties, stats.rejectReason)) {
+            Logger::verbose("Ignoring pipeline cache " + path + ": " + stats.rejectReason);
+            data.clear();
+        }
+    } else {
+        stats.rejectReason = "no cache file";
+    }
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(device, &createInfo, nullptr, &cache) != VK_SUCCESS) {
+        // Drivers may still reject data that passed header validation
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+        data.clear();
+        stats.rejectReason = "rejected by driver";
+
+        if (vkCreatePipelineCache(device, &createInfo, nullptr, &cache) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create pipeline cache!");
+        }
+    }
+
+    stats.loadedFromDisk = !data.empty();
+    stats.loadedBytes = data.size();
+    if (stats.loadedFromDisk) {
+        stats.rejectReason.clear();
+    }
+    stats.loadMs = elapsedMs(start);
+
+    Logger::verbose("Pipeline cache " + std::string(stats.loadedFromDisk ? "loaded" : "created empty") +
+                    " (" + std::to_string(stats.loadedBytes) + " bytes, " +
+                    std::to_string(stats.loadMs) + " ms)");
+}
+
+void PipelineCache::save() {
+    if (cache == VK_NULL_HANDLE) {
+        return;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS || size == 0) {
+        return;
+    }
+
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS) {
+        Logger::error("Failed to read pipeline cache data");
+        return;
+    }
+    data.resize(size);
+
+    // Write next to the target and rename, so readers never see a partial file
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            Logger::error("Failed to open " + tempPath + " for writing");
+            return;
+        }
+        file.write(data.data(), data.size());
+        file.flush();
+        if (!file) {
+            Logger::error("Failed to write " + tempPath);
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        Logger::error("Failed to replace pipeline cache: " + error.message());
+        std::filesystem::remove(tempPath, error);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.savedBytes = data.size();
+        stats.saveMs = elapsedMs(start);
+    }
+
+    Logger::verbose("Pipeline cache saved to " + path + " (" + std::to_string(data.size()) + " bytes)");
+}
+
+void PipelineCache::destroy() {
+    if (cache != VK_NULL_HANDLE) {
+        vkDestroyPipelineCache(device, cache, nullptr);
+        cache = VK_NULL_HANDLE;
+    }
+}
+
+// ==================== Pipeline Creation ====================
+
+VkResult PipelineCache::createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline* pipeline) {
+    VkGraphicsPipelineCreateInfo info = createInfo;
+
+    VkPipelineCreationFeedback feedback{};
+    std::vector<VkPipelineCreationFeedback> stageFeedback(info.stageCount);
+    VkPipelineCreationFeedbackCreateInfo feedbackInfo{};
+    if (creationFeedbackSupported) {
+        feedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+        feedbackInfo.pNext = info.pNext;
+        feedbackInfo.pPipelineCreationFeedback = &feedback;
+        feedbackInfo.pipelineStageCreationFeedbackCount = info.stageCount;
+        feedbackInfo.pPipelineStageCreationFeedbacks = stageFeedback.data();
+        info.pNext = &feedbackInfo;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    VkResult result = vkCreateGraphicsPipelines(device, cache, 1, &info, nullptr, pipeline);
+    double ms = elapsedMs(start);
+
+    if (result == VK_SUCCESS) {
+        recordResult(feedback, ms);
+    }
+    return result;
+}
+
+VkResult PipelineCache::createComputePipeline(const VkComputePipelineCreateInfo& createInfo, VkPipeline* pipeline) {
+    VkComputePipelineCreateInfo info = createInfo;
+
+    VkPipelineCreationFeedback feedback{};
+    VkPipelineCreationFeedback stageFeedback{};
+    VkPipelineCreationFeedbackCreateInfo feedbackInfo{};
+    if (creationFeedbackSupported) {
+        feedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+        feedbackInfo.pNext = info.pNext;
+        feedbackInfo.pPipelineCreationFeedback = &feedback;
+        feedbackInfo.pipelineStageCreationFeedbackCount = 1;
+        feedbackInfo.pPipelineStageCreationFeedbacks = &stageFeedback;
+        info.pNext = &feedbackInfo;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    VkResult result = vkCreateComputePipelines(device, cache, 1, &info, nullptr, pipeline);
+    double ms = elapsedMs(start);
+
+    if (result == VK_SUCCESS) {
+        recordResult(feedback, ms);
+    }
+    return result;
+}
+
+PipelineCacheStats PipelineCache::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void PipelineCache::recordResult(const VkPipelineCreationFeedback& feedback, double ms) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+
+    // Without feedback, assume a warm cache served every pipeline
+    bool hit = stats.loadedFromDisk;
+    if (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) {
+        hit = (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) != 0;
+    }
+
+    if (hit) {
+        stats.hits++;
+        stats.hitCreateMs += ms;
+    } else {
+        stats.misses++;
+        stats.missCreateMs += ms;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct PipelineCacheStats {
+    bool loadedFromDisk = false;
+    std::string rejectReason;       // Why the on-disk cache was ignored, if it was
+    size_t loadedBytes = 0;
+    size_t savedBytes = 0;
+    double loadMs = 0.0;
+    double saveMs = 0.0;
+
+    // Per-pipeline results (from VkPipelineCreationFeedback when available)
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    double hitCreateMs = 0.0;       // Total vkCreate*Pipelines time for hits
+    double missCreateMs = 0.0;      // Total vkCreate*Pipelines time for misses
+};
+
+/**
+ * PipelineCache - VkPipelineCache persisted to disk between runs
+ *
+ * The file is keyed by vendor/device ID in its name and validated against
+ * the VkPipelineCacheHeaderVersionOne fields (vendor ID, device ID and
+ * pipelineCacheUUID) before being handed to the driver, so a driver update
+ * or a different GPU silently falls back to an empty cache. Saving writes
+ * a temporary file and renames it over the old one, so a crash mid-write
+ * never leaves a truncated cache behind. Pipelines may be created from
+ * several threads at once (async compiles); stats are guarded internally.
+ */
+class PipelineCache {
+public:
+    PipelineCache(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& directory = ".");
+    ~PipelineCache();
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    void load();
+    void save();
+    void destroy();
+
+    VkPipelineCache getHandle() const { return cache; }
+    const std::string& getPath() const { return path; }
+    PipelineCacheStats getStats() const;
+
+    // vkCreateGraphicsPipelines through the cache, recording hit/miss timing
+    VkResult createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline* pipeline);
+    VkResult createComputePipeline(const VkComputePipelineCreateInfo& createInfo, VkPipeline* pipeline);
+
+    static bool validateHeader(const std::vector<char>& data,
+                               const VkPhysicalDeviceProperties& properties,
+                               std::string& reason);
+
+private:
+    VkDevice device;
+    VkPhysicalDeviceProperties properties;
+    std::string path;
+    VkPipelineCache cache;
+    bool creationFeedbackSupported;
+    PipelineCacheStats stats;
+    mutable std::mutex statsMutex;
+
+    void recordResult(const VkPipelineCreationFeedback& feedback, double ms);
+};
@@ -0,0 +1,157 @@
+#include "PipelineLayoutCache.h"
+#include "../utils/Hash.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+bool PipelineLayoutCache::LayoutKey::operator==(const LayoutKey& other) const {
+    if (setLayouts != other.setLayouts || pushConstants.size() != other.pushConstants.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < pushConstants.size(); i++) {
+        const auto& a = pushConstants[i];
+        const auto& b = other.pushConstants[i];
+        if (a.stageFlags != b.stageFlags || a.offset != b.offset || a.size != b.size) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t PipelineLayoutCache::LayoutKey::hash() const {
+    Fnv1a h;
+    for (VkDescriptorSetLayout layout : setLayouts) {
+        h.add(layout);
+    }
+    for (const auto& range : pushConstants) {
+        h.add(range.stageFlags);
+        h.add(range.offset);
+        h.add(range.size);
+    }
+    return static_cast<size_t>(h.value);
+}
+
+PipelineLayoutCache::PipelineLayoutCache(VkDevice device, DescriptorLayoutCache& setLayouts)
+    : device(device)
+    , setLayouts(setLayouts)
+{
+}
+
+PipelineLayoutCache::~PipelineLayoutCache() {
+    destroy();
+}
+
+VkPipelineLayout PipelineLayoutCache::getLayout(const std::vector<VkDescriptorSetLayout>& setLayoutHandles,
+                                                const std::vector<VkPushConstantRange>& pushConstants) {
+    LayoutKey key{ setLayoutHandles, pushConstants };
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.lookups++;
+
+    auto it = layouts.find(key);
+    if (it != layouts.end()) {
+        stats.hits++;
+        return it->second;
+    }
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = static_cast<uint32_t>(key.setLayouts.size());
+    layoutInfo.pSetLayouts = key.setLayouts.data();
+    layoutInfo.pushConstantRangeCount = static_cast<uint32_t>(key.pushConstants.size());
+    layoutInfo.pPushConstantRanges = key.pushConstants.data();
+
+    VkPipelineLayout layout;
+    if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline layout!");
+    }
+
+    layouts.emplace(std::move(key), layout);
+    stats.layoutCount = layouts.size();
+    return layout;
+}
+
+std::vector<VkDescriptorSetLayoutBinding> PipelineLayoutCache::getSetBindings(const ShaderReflection& reflection,
+                                                                               uint32_t set) {
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+    for (const SpirvDescriptorBinding& reflected : reflection.bindings) {
+        if (reflected.set != set) {
+            continue;
+        }
+        if (reflected.count == 0) {
+            throw std::runtime_error("PipelineLayoutCache: runtime array at set " + std::to_string(set) +
+                                     " binding " + std::to_string(reflected.binding) + " needs a layout override!");
+        }
+
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding = reflected.binding;
+        binding.descriptorType = static_cast<VkDescriptorType>(reflected.type);
+        binding.descriptorCount = reflected.count;
+        binding.stageFlags = static_cast<VkShaderStageFlags>(reflected.stageFlags);
+        bindings.push_back(binding);
+    }
+    return bindings;
+}
+
+VkPipelineLayout PipelineLayoutCache::getLayout(const ShaderReflection& reflection,
+                                                const PipelineLayoutOverrides& overrides) {
+    uint32_t setCount = reflection.getSetCount();
+    for (const auto& [set, layout] : overrides.sets) {
+        setCount = std::max(setCount, set + 1);
+    }
+
+    // Unused indices below the highest set still need a (empty) layout
+    std::vector<VkDescriptorSetLayout> setLayoutHandles(setCount, VK_NULL_HANDLE);
+    for (const auto& [set, layout] : overrides.sets) {
+        setLayoutHandles[set] = layout;
+    }
+    for (uint32_t set = 0; set < setCount; set++) {
+        if (setLayoutHandles[set] == VK_NULL_HANDLE) {
+            setLayoutHandles[set] = setLayouts.getLayout(getSetBindings(reflection, set));
+        }
+    }
+
+    // Vulkan allows each stage in one range only: cover every block with one
+    std::vector<VkPushConstantRange> pushConstants;
+    if (!reflection.pushConstants.empty()) {
+        VkPushConstantRange merged{};
+        merged.offset = UINT32_MAX;
+        uint32_t end = 0;
+        for (const SpirvPushConstantRange& range : reflection.pushConstants) {
+            merged.stageFlags |= range.stageFlags;
+            merged.offset = std::min(merged.offset, range.offset);
+            end = std::max(end, range.offset + range.size);
+        }
+        merged.size = end - merged.offset;
+        pushConstants.push_back(merged);
+    }
+
+    if (!overrides.pushConstants.empty()) {
+        uint32_t overrideEnd = 0;
+        for (const VkPushConstantRange& range : overrides.pushConstants) {
+            overrideEnd = std::max(overrideEnd, range.offset + range.size);
+        }
+        if (!pushConstants.empty() && pushConstants[0].offset + pushConstants[0].size > overrideEnd) {
+            throw std::runtime_error("PipelineLayoutCache: shader push constants exceed the override range!");
+        }
+        pushConstants = overrides.pushConstants;
+    }
+
+    return getLayout(setLayoutHandles, pushConstants);
+}
+
+PipelineLayoutCacheStats PipelineLayoutCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void PipelineLayoutCache::destroy() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [key, layout] : layouts) {
+        vkDestroyPipelineLayout(device, layout, nullptr);
+    }
+    layouts.clear();
+    stats.layoutCount = 0;
+}
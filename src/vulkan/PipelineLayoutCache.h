@@ -0,0 +1,78 @@
+#pragma once
+
+#include "DescriptorAllocator.h"
+#include "../utils/SpirvReflection.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Parts of a layout that reflection cannot describe
+struct PipelineLayoutOverrides {
+    // Replace the reflected set at this index (e.g. the bindless heap's
+    // update-after-bind layout, which plain SPIR-V cannot express)
+    std::vector<std::pair<uint32_t, VkDescriptorSetLayout>> sets;
+
+    // Replace the reflected ranges; the shaders' blocks must fit inside them.
+    // Keeping one fixed range lets differently reflected pipelines stay
+    // compatible for sets bound once per command buffer.
+    std::vector<VkPushConstantRange> pushConstants;
+};
+
+struct PipelineLayoutCacheStats {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    size_t layoutCount = 0;
+};
+
+/**
+ * PipelineLayoutCache - Deduplicating VkPipelineLayout cache
+ *
+ * Keyed by set layouts and push constant ranges, so every pipeline whose
+ * shaders declare the same interface shares one layout and descriptor
+ * sets stay bound across pipeline switches. Layouts can be built straight
+ * from SPIR-V reflection; their set layouts come from the shared
+ * DescriptorLayoutCache. Owns every pipeline layout it hands out.
+ */
+class PipelineLayoutCache {
+public:
+    PipelineLayoutCache(VkDevice device, DescriptorLayoutCache& setLayouts);
+    ~PipelineLayoutCache();
+
+    PipelineLayoutCache(const PipelineLayoutCache&) = delete;
+    PipelineLayoutCache& operator=(const PipelineLayoutCache&) = delete;
+
+    VkPipelineLayout getLayout(const std::vector<VkDescriptorSetLayout>& setLayouts,
+                               const std::vector<VkPushConstantRange>& pushConstants);
+
+    // reflection is usually SpirvReflection::merge() of the pipeline's stages
+    VkPipelineLayout getLayout(const ShaderReflection& reflection,
+                               const PipelineLayoutOverrides& overrides = {});
+
+    // Bindings of one set, ready for DescriptorLayoutCache::getLayout
+    static std::vector<VkDescriptorSetLayoutBinding> getSetBindings(const ShaderReflection& reflection, uint32_t set);
+
+    PipelineLayoutCacheStats getStats() const;
+    void destroy();
+
+private:
+    struct LayoutKey {
+        std::vector<VkDescriptorSetLayout> setLayouts;
+        std::vector<VkPushConstantRange> pushConstants;
+
+        bool operator==(const LayoutKey& other) const;
+        size_t hash() const;
+    };
+
+    struct LayoutKeyHash {
+        size_t operator()(const LayoutKey& key) const { return key.hash(); }
+    };
+
+    VkDevice device;
+    DescriptorLayoutCache& setLayouts;
+    std::unordered_map<LayoutKey, VkPipelineLayout, LayoutKeyHash> layouts;
+    PipelineLayoutCacheStats stats;
+    mutable std::mutex mutex;
+};
@@ -0,0 +1,669 @@
+#include "PipelineManager.h"
+#include "../utils/Hash.h"
+#include "../utils/logger.h"
+#include "../utils/ThreadPool.h"
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+// ==================== PipelineStateDesc ====================
+
+void PipelineStateDesc::addVertexBinding(uint32_t binding, uint32_t stride, VkVertexInputRate inputRate) {
+    if (vertexBindingCount >= MAX_VERTEX_BINDINGS) {
+        throw std::runtime_error("PipelineStateDesc: too many vertex bindings!");
+    }
+    vertexBindings[vertexBindingCount++] = { binding, stride, inputRate };
+}
+
+void PipelineStateDesc::addVertexAttribute(uint32_t location, uint32_t binding, VkFormat format, uint32_t offset) {
+    if (vertexAttributeCount >= MAX_VERTEX_ATTRIBUTES) {
+        throw std::runtime_error("PipelineStateDesc: too many vertex attributes!");
+    }
+    vertexAttributes[vertexAttributeCount++] = { location, binding, format, offset };
+}
+
+void PipelineStateDesc::setVertexInputs(const ShaderReflection& vertexReflection, uint32_t binding) {
+    vertexBindingCount = 0;
+    vertexAttributeCount = 0;
+    if (vertexReflection.vertexInputs.empty()) {
+        return;
+    }
+
+    uint32_t offset = 0;
+    for (const SpirvVertexInput& input : vertexReflection.vertexInputs) {
+        if (input.width != 32 || input.componentCount < 1 || input.componentCount > 4) {
+            throw std::runtime_error("PipelineStateDesc: unsupported vertex input at location " +
+                                     std::to_string(input.location) + "!");
+        }
+
+        static const VkFormat floatFormats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT,
+                                                 VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+        static const VkFormat intFormats[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT,
+                                               VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+        static const VkFormat uintFormats[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT,
+                                                VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+        const VkFormat* formats = input.type == SpirvScalarType::Int ? intFormats
+                                : input.type == SpirvScalarType::Uint ? uintFormats : floatFormats;
+        addVertexAttribute(input.location, binding, formats[input.componentCount - 1], offset);
+        offset += input.componentCount * sizeof(uint32_t);
+    }
+
+    addVertexBinding(binding, offset);
+}
+
+bool PipelineStateDesc::operator==(const PipelineStateDesc& other) const {
+    if (vertexShader != other.vertexShader ||
+        fragmentShader != other.fragmentShader ||
+        vertexBindingCount != other.vertexBindingCount ||
+        vertexAttributeCount != other.vertexAttributeCount ||
+        topology != other.topology ||
+        polygonMode != other.polygonMode ||
+        cullMode != other.cullMode ||
+        frontFace != other.frontFace ||
+        depthTest != other.depthTest ||
+        depthWrite != other.depthWrite ||
+        depthCompare != other.depthCompare ||
+        blend != other.blend ||
+        layout != other.layout ||
+        renderPass != other.renderPass ||
+        subpass != other.subpass ||
+        colorFormat != other.colorFormat ||
+        depthFormat != other.depthFormat) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < vertexBindingCount; i++) {
+        const auto& a = vertexBindings[i];
+        const auto& b = other.vertexBindings[i];
+        if (a.binding != b.binding || a.stride != b.stride || a.inputRate != b.inputRate) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < vertexAttributeCount; i++) {
+        const auto& a = vertexAttributes[i];
+        const auto& b = other.vertexAttributes[i];
+        if (a.location != b.location || a.binding != b.binding || a.format != b.format || a.offset != b.offset) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t PipelineStateDesc::hash() const {
+    Fnv1a h;
+    h.add(vertexShader);
+    h.add(fragmentShader);
+    h.add(vertexBindingCount);
+    h.add(vertexAttributeCount);
+    for (uint32_t i = 0; i < vertexBindingCount; i++) {
+        h.add(vertexBindings[i].binding);
+        h.add(vertexBindings[i].stride);
+        h.add(vertexBindings[i].inputRate);
+    }
+    for (uint32_t i = 0; i < vertexAttributeCount; i++) {
+        h.add(vertexAttributes[i].location);
+        h.add(vertexAttributes[i].binding);
+        h.add(vertexAttributes[i].format);
+        h.add(vertexAttributes[i].offset);
+    }
+    h.add(topology);
+    h.add(polygonMode);
+    h.add(cullMode);
+    h.add(frontFace);
+    h.add(depthTest);
+    h.add(depthWrite);
+    h.add(depthCompare);
+    h.add(blend);
+    h.add(layout);
+    h.add(renderPass);
+    h.add(subpass);
+    h.add(colorFormat);
+    h.add(depthFormat);
+    return static_cast<size_t>(h.value);
+}
+
+// ==================== PipelineManager ====================
+
+PipelineManager::PipelineManager(VkDevice device, PipelineCache* pipelineCache)
+    : device(device)
+    , pipelineCache(pipelineCache)
+    , threadPool(nullptr)
+    , generation(0)
+{
+}
+
+PipelineManager::~PipelineManager() {
+    destroy();
+}
+
+void PipelineManager::destroy() {
+    // Workers insert into the maps below when they finish
+    waitForPendingCompiles();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto& entry : pipelines) {
+        vkDestroyPipeline(device, entry.second, nullptr);
+    }
+    pipelines.clear();
+
+    for (auto& entry : computePipelines) {
+        vkDestroyPipeline(device, entry.second, nullptr);
+    }
+    computePipelines.clear();
+
+    for (VkShaderModule module : shaderModules) {
+        vkDestroyShaderModule(device, module, nullptr);
+    }
+    shaderModules.clear();
+    shaderReflections.clear();
+    shaderIds.clear();
+    failedCompiles.clear();
+    fallbacks.clear();
+}
+
+std::vector<char> PipelineManager::readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    file.close();
+
+    return buffer;
+}
+
+uint32_t PipelineManager::loadShader(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = shaderIds.find(path);
+    if (it != shaderIds.end()) {
+        return it->second;
+    }
+
+    ShaderReflection reflection;
+    VkShaderModule shaderModule = createShaderModule(path, reflection);
+
+    uint32_t id = static_cast<uint32_t>(shaderModules.size());
+    shaderModules.push_back(shaderModule);
+    shaderReflections.push_back(std::move(reflection));
+    shaderIds[path] = id;
+    return id;
+}
+
+ShaderReflection PipelineManager::getShaderReflection(uint32_t shaderId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (shaderId >= shaderReflections.size()) {
+        throw std::runtime_error("PipelineManager: unknown shader id!");
+    }
+    return shaderReflections[shaderId];
+}
+
+VkShaderModule PipelineManager::createShaderModule(const std::string& path, ShaderReflection& reflection) {
+    std::vector<char> code = readFile(path);
+
+    // The driver gets the final say on validity; reflection only informs layouts
+    try {
+        reflection = SpirvReflection::reflect(code);
+    }
+    catch (const std::exception& e) {
+        Logger::error("Failed to reflect " + path + ": " + e.what());
+        reflection = ShaderReflection{};
+    }
+
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shader module: " + path);
+    }
+    return shaderModule;
+}
+
+bool PipelineManager::reloadShader(const std::string& path, RetiredShaderObjects& retired) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = shaderIds.find(path);
+    if (it == shaderIds.end()) {
+        return false;
+    }
+    uint32_t id = it->second;
+
+    // Created first, so a bad file leaves the running shader untouched
+    ShaderReflection reflection;
+    VkShaderModule shaderModule = createShaderModule(path, reflection);
+    retired.module = shaderModules[id];
+    shaderModules[id] = shaderModule;
+    shaderReflections[id] = std::move(reflection);
+
+    for (auto entry = pipelines.begin(); entry != pipelines.end();) {
+        if (entry->first.vertexShader == id || entry->first.fragmentShader == id) {
+            retired.pipelines.push_back(entry->second);
+            entry = pipelines.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+    for (auto entry = computePipelines.begin(); entry != computePipelines.end();) {
+        if (entry->first.first == id) {
+            retired.pipelines.push_back(entry->second);
+            entry = computePipelines.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+
+    // An edit may have fixed a shader that failed to compile
+    failedCompiles.clear();
+
+    stats.shaderReloads++;
+    generation++;
+
+    Logger::verbose("PipelineManager: reloaded " + path + ", evicted " +
+                    std::to_string(retired.pipelines.size()) + " pipeline(s)");
+    return true;
+}
+
+VkPipeline PipelineManager::getPipeline(const PipelineStateDesc& desc) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    stats.lookups++;
+
+    while (true) {
+        auto it = pipelines.find(desc);
+        if (it != pipelines.end()) {
+            stats.hits++;
+            return it->second;
+        }
+
+        if (desc.vertexShader >= shaderModules.size() || desc.fragmentShader >= shaderModules.size()) {
+            throw std::runtime_error("PipelineManager: unknown shader id!");
+        }
+
+        // Compiled unlocked like queueCompile, so other lookups and async
+        // results are not held up behind the driver
+        VkShaderModule vertexModule = shaderModules[desc.vertexShader];
+        VkShaderModule fragmentModule = shaderModules[desc.fragmentShader];
+        uint64_t compileGeneration = generation;
+        lock.unlock();
+
+        double ms = 0.0;
+        VkPipeline pipeline = compile(desc, vertexModule, fragmentModule, ms);
+
+        lock.lock();
+        stats.stallMs += ms;
+
+        // Another thread published this state first, or a reload made the
+        // modules stale: keep the map's pipeline, or compile again
+        if (generation != compileGeneration || pipelines.count(desc) != 0) {
+            vkDestroyPipeline(device, pipeline, nullptr);
+            continue;
+        }
+
+        stats.compiles++;
+        stats.compileMs += ms;
+        pipelines.emplace(desc, pipeline);
+        return pipeline;
+    }
+}
+
+VkPipeline PipelineManager::getPipelineAsync(const PipelineStateDesc& desc) {
+    if (!threadPool) {
+        return getPipeline(desc);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    stats.lookups++;
+
+    auto it = pipelines.find(desc);
+    if (it != pipelines.end()) {
+        stats.hits++;
+        return it->second;
+    }
+
+    if (failedCompiles.count(desc) == 0) {
+        queueCompile(desc);
+    }
+
+    auto fallback = fallbacks.find(std::make_tuple(desc.layout, desc.renderPass, desc.colorFormat));
+    if (fallback != fallbacks.end()) {
+        auto fallbackPipeline = pipelines.find(fallback->second);
+        if (fallbackPipeline != pipelines.end()) {
+            stats.fallbackDraws++;
+            return fallbackPipeline->second;
+        }
+        // Evicted by a shader reload; rebuilt like any other pipeline
+        queueCompile(fallback->second);
+    }
+
+    stats.skippedDraws++;
+    return VK_NULL_HANDLE;
+}
+
+void PipelineManager::registerFallback(const PipelineStateDesc& fallback) {
+    getPipeline(fallback);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    fallbacks[std::make_tuple(fallback.layout, fallback.renderPass, fallback.colorFormat)] = fallback;
+}
+
+void PipelineManager::setThreadPool(ThreadPool* pool) {
+    std::lock_guard<std::mutex> lock(mutex);
+    threadPool = pool;
+}
+
+void PipelineManager::waitForPendingCompiles() {
+    std::unique_lock<std::mutex> lock(mutex);
+    compileFinished.wait(lock, [this] { return pendingCompiles.empty(); });
+}
+
+void PipelineManager::queueCompile(const PipelineStateDesc& desc) {
+    if (pendingCompiles.count(desc) != 0) {
+        return;
+    }
+    if (desc.vertexShader >= shaderModules.size() || desc.fragmentShader >= shaderModules.size()) {
+        throw std::runtime_error("PipelineManager: unknown shader id!");
+    }
+    pendingCompiles.insert(desc);
+
+    // Modules are captured now; a reload retires them only after the frames
+    // in flight, and bumps the generation so this result is discarded
+    VkShaderModule vertexModule = shaderModules[desc.vertexShader];
+    VkShaderModule fragmentModule = shaderModules[desc.fragmentShader];
+    uint64_t queuedGeneration = generation;
+
+    threadPool->submit([this, desc, vertexModule, fragmentModule, queuedGeneration]() {
+        double ms = 0.0;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        try {
+            pipeline = compile(desc, vertexModule, fragmentModule, ms);
+        }
+        catch (const std::exception& e) {
+            Logger::error(std::string("PipelineManager: async compile failed: ") + e.what());
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingCompiles.erase(desc);
+
+        if (generation != queuedGeneration || pipelines.count(desc) != 0) {
+            if (pipeline != VK_NULL_HANDLE) {
+                vkDestroyPipeline(device, pipeline, nullptr);
+            }
+        } else if (pipeline == VK_NULL_HANDLE) {
+            failedCompiles.insert(desc);
+        } else {
+            pipelines.emplace(desc, pipeline);
+            stats.compiles++;
+            stats.asyncCompiles++;
+            stats.compileMs += ms;
+        }
+        compileFinished.notify_all();
+    });
+}
+
+VkPipeline PipelineManager::getComputePipeline(uint32_t computeShader, VkPipelineLayout layout) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    stats.lookups++;
+
+    auto key = std::make_pair(computeShader, layout);
+    auto it = computePipelines.find(key);
+    if (it != computePipelines.end()) {
+        stats.hits++;
+        return it->second;
+    }
+
+    if (computeShader >= shaderModules.size()) {
+        throw std::runtime_error("PipelineManager: unknown shader id!");
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModules[computeShader];
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = layout;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = pipelineCache
+        ? pipelineCache->createComputePipeline(pipelineInfo, &pipeline)
+        : vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute pipeline!");
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    stats.compiles++;
+    stats.compileMs += ms;
+    stats.stallMs += ms;
+
+    computePipelines.emplace(key, pipeline);
+    return pipeline;
+}
+
+void PipelineManager::evictRenderPass(VkRenderPass renderPass) {
+    // Null is every dynamic rendering pipeline, which outlives render targets
+    if (renderPass == VK_NULL_HANDLE) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto it = pipelines.begin(); it != pipelines.end();) {
+        if (it->first.renderPass == renderPass) {
+            vkDestroyPipeline(device, it->second, nullptr);
+            it = pipelines.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = fallbacks.begin(); it != fallbacks.end();) {
+        if (std::get<1>(it->first) == renderPass) {
+            it = fallbacks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+PipelineManagerStats PipelineManager::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    PipelineManagerStats result = stats;
+    result.pipelineCount = pipelines.size() + computePipelines.size();
+    result.shaderCount = shaderModules.size();
+    result.pendingCompiles = pendingCompiles.size();
+    return result;
+}
+
+// ==================== Compilation ====================
+
+// Touches no manager state, so it runs on worker threads without the mutex
+VkPipeline PipelineManager::compile(const PipelineStateDesc& desc, VkShaderModule vertexModule,
+                                    VkShaderModule fragmentModule, double& ms) const {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Shader stages
+    VkPipelineShaderStageCreateInfo shaderStages[2]{};
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = vertexModule;
+    shaderStages[0].pName = "main";
+
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = fragmentModule;
+    shaderStages[1].pName = "main";
+
+    // Vertex input
+    VkVertexInputBindingDescription bindings[PipelineStateDesc::MAX_VERTEX_BINDINGS];
+    for (uint32_t i = 0; i < desc.vertexBindingCount; i++) {
+        bindings[i].binding = desc.vertexBindings[i].binding;
+        bindings[i].stride = desc.vertexBindings[i].stride;
+        bindings[i].inputRate = desc.vertexBindings[i].inputRate;
+    }
+
+    VkVertexInputAttributeDescription attributes[PipelineStateDesc::MAX_VERTEX_ATTRIBUTES];
+    for (uint32_t i = 0; i < desc.vertexAttributeCount; i++) {
+        attributes[i].location = desc.vertexAttributes[i].location;
+        attributes[i].binding = desc.vertexAttributes[i].binding;
+        attributes[i].format = desc.vertexAttributes[i].format;
+        attributes[i].offset = desc.vertexAttributes[i].offset;
+    }
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = desc.vertexBindingCount;
+    vertexInputInfo.pVertexBindingDescriptions = bindings;
+    vertexInputInfo.vertexAttributeDescriptionCount = desc.vertexAttributeCount;
+    vertexInputInfo.pVertexAttributeDescriptions = attributes;
+
+    // Input assembly
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = desc.topology;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    // Viewport (dynamic)
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkDynamicState dynamicStates[] = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = desc.polygonMode;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = desc.cullMode;
+    rasterizer.frontFace = desc.frontFace;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    // Depth
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = desc.depthTest ? VK_TRUE : VK_FALSE;
+    depthStencil.depthWriteEnable = desc.depthWrite ? VK_TRUE : VK_FALSE;
+    depthStencil.depthCompareOp = desc.depthCompare;
+
+    // Color blending
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
+        VK_COLOR_COMPONENT_G_BIT |
+        VK_COLOR_COMPONENT_B_BIT |
+        VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+
+    switch (desc.blend) {
+    case BlendMode::Opaque:
+        colorBlendAttachment.blendEnable = VK_FALSE;
+        break;
+    case BlendMode::AlphaBlend:
+        colorBlendAttachment.blendEnable = VK_TRUE;
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        break;
+    case BlendMode::Additive:
+        colorBlendAttachment.blendEnable = VK_TRUE;
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        break;
+    case BlendMode::Premultiplied:
+        colorBlendAttachment.blendEnable = VK_TRUE;
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        break;
+    }
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    // Graphics pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = desc.layout;
+    pipelineInfo.renderPass = desc.renderPass;
+    pipelineInfo.subpass = desc.subpass;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    // Dynamic rendering: attachment formats instead of a render pass
+    VkPipelineRenderingCreateInfo renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    renderingInfo.colorAttachmentCount = desc.colorFormat != VK_FORMAT_UNDEFINED ? 1 : 0;
+    renderingInfo.pColorAttachmentFormats = &desc.colorFormat;
+    renderingInfo.depthAttachmentFormat = desc.depthFormat;
+    if (desc.renderPass == VK_NULL_HANDLE) {
+        pipelineInfo.pNext = &renderingInfo;
+        colorBlending.attachmentCount = renderingInfo.colorAttachmentCount;
+    }
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = pipelineCache
+        ? pipelineCache->createGraphicsPipeline(pipelineInfo, &pipeline)
+        : vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create graphics pipeline!");
+    }
+
+    ms = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    Logger::verbose("PipelineManager: compiled pipeline " + std::to_string(desc.hash()) +
+                    " in " + std::to_string(ms) + " ms");
+
+    return pipeline;
+}
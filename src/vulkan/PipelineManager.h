@@ -0,0 +1,207 @@
+#pragma once
+
+#include "PipelineCache.h"
+#include "../utils/SpirvReflection.h"
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class ThreadPool;
+
+enum class BlendMode : uint8_t {
+    Opaque,
+    AlphaBlend,
+    Additive,
+    Premultiplied
+};
+
+/**
+ * PipelineStateDesc - Compact, hashable description of a graphics pipeline
+ *
+ * Fixed-size POD so it can be hashed and compared field by field. Shaders
+ * are referenced by the id returned from PipelineManager::loadShader.
+ * Viewport and scissor are always dynamic and therefore not part of the key.
+ */
+struct PipelineStateDesc {
+    static constexpr uint32_t MAX_VERTEX_BINDINGS = 4;
+    static constexpr uint32_t MAX_VERTEX_ATTRIBUTES = 8;
+
+    struct VertexBinding {
+        uint32_t binding;
+        uint32_t stride;
+        VkVertexInputRate inputRate;
+    };
+
+    struct VertexAttribute {
+        uint32_t location;
+        uint32_t binding;
+        VkFormat format;
+        uint32_t offset;
+    };
+
+    // Shaders
+    uint32_t vertexShader = UINT32_MAX;
+    uint32_t fragmentShader = UINT32_MAX;
+
+    // Vertex layout
+    uint32_t vertexBindingCount = 0;
+    uint32_t vertexAttributeCount = 0;
+    VertexBinding vertexBindings[MAX_VERTEX_BINDINGS] = {};
+    VertexAttribute vertexAttributes[MAX_VERTEX_ATTRIBUTES] = {};
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    // Raster
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+
+    // Depth
+    bool depthTest = false;
+    bool depthWrite = false;
+    VkCompareOp depthCompare = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+    // Blend
+    BlendMode blend = BlendMode::Opaque;
+
+    // Layout and render pass compatibility. With renderPass left null the
+    // pipeline targets dynamic rendering and only the attachment formats
+    // matter, so one pipeline serves every render target of those formats.
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+    VkFormat colorFormat = VK_FORMAT_UNDEFINED;     // Dynamic rendering only
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+
+    void addVertexBinding(uint32_t binding, uint32_t stride, VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX);
+    void addVertexAttribute(uint32_t location, uint32_t binding, VkFormat format, uint32_t offset);
+
+    // Replaces the vertex layout with the shader's inputs, tightly packed
+    // in location order into one interleaved binding
+    void setVertexInputs(const ShaderReflection& vertexReflection, uint32_t binding = 0);
+
+    bool operator==(const PipelineStateDesc& other) const;
+    bool operator!=(const PipelineStateDesc& other) const { return !(*this == other); }
+    size_t hash() const;
+};
+
+struct PipelineStateDescHash {
+    size_t operator()(const PipelineStateDesc& desc) const { return desc.hash(); }
+};
+
+struct PipelineManagerStats {
+    uint64_t lookups = 0;       // getPipeline calls
+    uint64_t hits = 0;          // served from the in-memory map
+    uint64_t compiles = 0;      // vkCreateGraphicsPipelines calls
+    double compileMs = 0.0;     // total time spent compiling
+    size_t pipelineCount = 0;   // unique pipelines alive
+    size_t shaderCount = 0;     // unique shader modules alive
+    uint64_t shaderReloads = 0; // reloadShader calls that swapped a module
+
+    // Async compilation
+    uint64_t asyncCompiles = 0;     // compiles finished on worker threads
+    size_t pendingCompiles = 0;     // queued or running right now
+    uint64_t fallbackDraws = 0;     // async misses served by a fallback pipeline
+    uint64_t skippedDraws = 0;      // async misses with no fallback (draw skipped)
+    double stallMs = 0.0;           // compile time spent blocking callers of getPipeline
+};
+
+// Objects replaced by a shader reload; destroy once no frame in flight uses them
+struct RetiredShaderObjects {
+    VkShaderModule module = VK_NULL_HANDLE;
+    std::vector<VkPipeline> pipelines;
+};
+
+/**
+ * PipelineManager - Deduplicating pipeline state object cache
+ *
+ * Maps PipelineStateDesc -> VkPipeline, so 5,000 materials sharing one
+ * state compile one pipeline. Compiles go through the persistent
+ * PipelineCache. Owns every pipeline and shader module it hands out.
+ *
+ * getPipelineAsync() never blocks on the driver: a miss is queued on the
+ * thread pool and the caller draws with a registered fallback (or skips
+ * the draw) until the real pipeline lands in the map.
+ */
+class PipelineManager {
+public:
+    PipelineManager(VkDevice device, PipelineCache* pipelineCache);
+    ~PipelineManager();
+
+    PipelineManager(const PipelineManager&) = delete;
+    PipelineManager& operator=(const PipelineManager&) = delete;
+
+    // Loads a SPIR-V file once; the same path returns the same id
+    uint32_t loadShader(const std::string& path);
+
+    // Interface of a loaded shader, reflected from its SPIR-V on load
+    ShaderReflection getShaderReflection(uint32_t shaderId) const;
+
+    // Returns the pipeline for this state, compiling it on first request
+    VkPipeline getPipeline(const PipelineStateDesc& desc);
+
+    // Returns the pipeline if it is built; otherwise queues a background
+    // compile and returns the fallback registered for desc's layout and
+    // render target, or VK_NULL_HANDLE if there is none (skip the draw).
+    // Later lookups return the real pipeline once its compile finished.
+    VkPipeline getPipelineAsync(const PipelineStateDesc& desc);
+
+    // Compiles a stand-in for getPipelineAsync misses sharing its layout and
+    // render target; it must accept the same vertex input as those draws
+    void registerFallback(const PipelineStateDesc& fallback);
+
+    // Worker threads for getPipelineAsync; without a pool misses compile inline
+    void setThreadPool(ThreadPool* threadPool);
+    void waitForPendingCompiles();
+
+    // Compute pipelines are keyed by (shader id, layout)
+    VkPipeline getComputePipeline(uint32_t computeShader, VkPipelineLayout layout);
+
+    // Drops pipelines built against a render pass that is being destroyed
+    void evictRenderPass(VkRenderPass renderPass);
+
+    // Re-reads a loaded shader's SPIR-V under the same id and evicts every
+    // pipeline using it; they recompile on their next lookup. Callers that
+    // keep VkPipeline handles must re-resolve them when getGeneration() changes.
+    // Returns false (and changes nothing) if the path was never loaded.
+    bool reloadShader(const std::string& path, RetiredShaderObjects& retired);
+    uint64_t getGeneration() const { return generation; }
+
+    PipelineManagerStats getStats() const;
+    void destroy();
+
+    static std::vector<char> readFile(const std::string& filename);
+
+private:
+    VkDevice device;
+    PipelineCache* pipelineCache;
+    ThreadPool* threadPool;
+
+    std::vector<VkShaderModule> shaderModules;
+    std::vector<ShaderReflection> shaderReflections;    // Parallel to shaderModules
+    std::unordered_map<std::string, uint32_t> shaderIds;
+    std::unordered_map<PipelineStateDesc, VkPipeline, PipelineStateDescHash> pipelines;
+    std::map<std::pair<uint32_t, VkPipelineLayout>, VkPipeline> computePipelines;
+
+    // Async compilation
+    std::unordered_set<PipelineStateDesc, PipelineStateDescHash> pendingCompiles;
+    std::unordered_set<PipelineStateDesc, PipelineStateDescHash> failedCompiles;
+    std::map<std::tuple<VkPipelineLayout, VkRenderPass, VkFormat>, PipelineStateDesc> fallbacks;
+    std::condition_variable compileFinished;
+
+    PipelineManagerStats stats;
+    std::atomic<uint64_t> generation;
+    mutable std::mutex mutex;
+
+    VkShaderModule createShaderModule(const std::string& path, ShaderReflection& reflection);
+    void queueCompile(const PipelineStateDesc& desc);
+    VkPipeline compile(const PipelineStateDesc& desc, VkShaderModule vertexModule,
+                       VkShaderModule fragmentModule, double& ms) const;
+};
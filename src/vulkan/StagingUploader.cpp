@@ -0,0 +1,484 @@
+#include "StagingUploader.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Where uploaded data is consumed; also the frame's semaphore wait stage
+constexpr VkPipelineStageFlags CONSUMER_STAGES =
+    VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+    VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+    VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+constexpr VkAccessFlags BUFFER_CONSUMER_ACCESS =
+    VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+    VK_ACCESS_INDEX_READ_BIT |
+    VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+    VK_ACCESS_UNIFORM_READ_BIT |
+    VK_ACCESS_SHADER_READ_BIT;
+
+constexpr VkDeviceSize BUFFER_COPY_ALIGNMENT = 4;
+constexpr VkDeviceSize IMAGE_COPY_ALIGNMENT = 16;   // Covers texel size and optimal copy alignment
+
+}
+
+StagingUploader::StagingUploader(VkDevice device, GpuAllocator& allocator,
+                                 VkQueue transferQueue, uint32_t transferFamily,
+                                 uint32_t graphicsFamily, uint32_t framesInFlight,
+                                 VkDeviceSize ringSize)
+    : device(device)
+    , allocator(allocator)
+    , transferQueue(transferQueue)
+    , transferFamily(transferFamily)
+    , graphicsFamily(graphicsFamily)
+    , ownershipTransfer(transferFamily != graphicsFamily)
+    , ringData(nullptr)
+    , ring(ringSize)
+    , commandPool(VK_NULL_HANDLE)
+    , nextSerial(1)
+{
+    stats.dedicatedTransferQueue = ownershipTransfer;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = ringSize;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    ringBuffer = allocator.createBuffer(bufferInfo,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        GPU_ALLOCATION_DEDICATED);
+    ringData = static_cast<uint8_t*>(ringBuffer.allocation.mappedData);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = transferFamily;
+
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+        destroy();
+        throw std::runtime_error("Failed to create staging command pool!");
+    }
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    frameSemaphores.resize(framesInFlight, VK_NULL_HANDLE);
+    for (auto& semaphore : frameSemaphores) {
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+            destroy();
+            throw std::runtime_error("Failed to create staging semaphore!");
+        }
+    }
+}
+
+StagingUploader::~StagingUploader() {
+    destroy();
+}
+
+void StagingUploader::destroy() {
+    for (auto& batch : inFlight) {
+        vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+        freeBatches.push_back(batch);
+    }
+    inFlight.clear();
+
+    for (auto& batch : freeBatches) {
+        vkDestroyFence(device, batch.fence, nullptr);
+    }
+    freeBatches.clear();
+
+    for (auto semaphore : frameSemaphores) {
+        if (semaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, semaphore, nullptr);
+        }
+    }
+    frameSemaphores.clear();
+
+    if (commandPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(device, commandPool, nullptr);
+        commandPool = VK_NULL_HANDLE;
+    }
+
+    if (ringBuffer.buffer != VK_NULL_HANDLE) {
+        allocator.destroyBuffer(ringBuffer);
+        ringData = nullptr;
+    }
+}
+
+VkPipelineStageFlags StagingUploader::getWaitStage() {
+    return CONSUMER_STAGES;
+}
+
+// ==================== Uploads ====================
+
+uint64_t StagingUploader::allocateStaging(VkDeviceSize size, VkDeviceSize alignment) {
+    while (true) {
+        uint64_t offset = ring.allocate(size, alignment);
+        if (offset != RingAllocator::INVALID_OFFSET) {
+            return offset;
+        }
+
+        reclaim(false);
+        offset = ring.allocate(size, alignment);
+        if (offset != RingAllocator::INVALID_OFFSET) {
+            return offset;
+        }
+
+        // Ring is full: push queued copies out so their space can come back
+        if (hasPendingUploads()) {
+            submitBatch(VK_NULL_HANDLE);
+        }
+        if (inFlight.empty()) {
+            throw std::runtime_error("Staging upload does not fit in the ring!");
+        }
+
+        stats.ringStalls++;
+        reclaim(true);
+    }
+}
+
+void StagingUploader::uploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    const VkDeviceSize maxChunk = std::max<VkDeviceSize>(ring.getCapacity() / 4, BUFFER_COPY_ALIGNMENT);
+
+    VkDeviceSize done = 0;
+    while (done < size) {
+        VkDeviceSize chunk = std::min(size - done, maxChunk);
+        uint64_t offset = allocateStaging(chunk, BUFFER_COPY_ALIGNMENT);
+        std::memcpy(ringData + offset, bytes + done, chunk);
+
+        BufferCopy copy{};
+        copy.dst = dst;
+        copy.region.srcOffset = offset;
+        copy.region.dstOffset = dstOffset + done;
+        copy.region.size = chunk;
+        bufferCopies.push_back(copy);
+
+        done += chunk;
+    }
+
+    stats.uploads++;
+    stats.bytesUploaded += size;
+}
+
+void StagingUploader::uploadImage(VkImage dst, VkExtent3D extent, const void* data, VkDeviceSize size,
+                                  VkImageLayout finalLayout, uint32_t mipLevel, uint32_t arrayLayer) {
+    if (size > ring.getCapacity()) {
+        throw std::runtime_error("Image upload larger than the staging ring!");
+    }
+
+    uint64_t offset = allocateStaging(size, IMAGE_COPY_ALIGNMENT);
+    std::memcpy(ringData + offset, data, size);
+
+    ImageCopy copy{};
+    copy.dst = dst;
+    copy.finalLayout = finalLayout;
+    copy.region.bufferOffset = offset;
+    copy.region.bufferRowLength = 0;     // Tightly packed
+    copy.region.bufferImageHeight = 0;
+    copy.region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copy.region.imageSubresource.mipLevel = mipLevel;
+    copy.region.imageSubresource.baseArrayLayer = arrayLayer;
+    copy.region.imageSubresource.layerCount = 1;
+    copy.region.imageOffset = { 0, 0, 0 };
+    copy.region.imageExtent = extent;
+    imageCopies.push_back(copy);
+
+    stats.uploads++;
+    stats.bytesUploaded += size;
+}
+
+// ==================== Submission ====================
+
+VkSemaphore StagingUploader::flush(uint32_t frameIndex, VkCommandBuffer graphicsCommandBuffer) {
+    reclaim(false);
+
+    bool hasAcquires = !pendingBufferAcquires.empty() || !pendingImageAcquires.empty();
+    bool needsSemaphore = ownershipTransfer && (hasPendingUploads() || hasAcquires);
+    VkSemaphore signalSemaphore = needsSemaphore ? frameSemaphores[frameIndex] : VK_NULL_HANDLE;
+
+    if (hasPendingUploads() || signalSemaphore != VK_NULL_HANDLE) {
+        submitBatch(signalSemaphore);
+    }
+
+    recordAcquires(graphicsCommandBuffer);
+    return signalSemaphore;
+}
+
+void StagingUploader::reclaim(bool waitForOldest) {
+    if (waitForOldest && !inFlight.empty()) {
+        vkWaitForFences(device, 1, &inFlight.front().fence, VK_TRUE, UINT64_MAX);
+    }
+
+    // Batches finish in submission order; stop at the first busy one
+    while (!inFlight.empty() && vkGetFenceStatus(device, inFlight.front().fence) == VK_SUCCESS) {
+        Batch batch = inFlight.front();
+        inFlight.pop_front();
+
+        ring.release(batch.serial);
+        vkResetFences(device, 1, &batch.fence);
+        freeBatches.push_back(batch);
+    }
+}
+
+StagingUploader::Batch StagingUploader::acquireBatch() {
+    if (!freeBatches.empty()) {
+        Batch batch = freeBatches.back();
+        freeBatches.pop_back();
+        return batch;
+    }
+
+    Batch batch;
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(device, &allocInfo, &batch.commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate staging command buffer!");
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    if (vkCreateFence(device, &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS) {
+        vkFreeCommandBuffers(device, commandPool, 1, &batch.commandBuffer);
+        throw std::runtime_error("Failed to create staging fence!");
+    }
+
+    return batch;
+}
+
+void StagingUploader::submitBatch(VkSemaphore signalSemaphore) {
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.signalSemaphoreCount = signalSemaphore != VK_NULL_HANDLE ? 1 : 0;
+    submitInfo.pSignalSemaphores = &signalSemaphore;
+
+    // Earlier batches were already submitted on this queue; a bare signal
+    // still orders after them
+    if (!hasPendingUploads()) {
+        if (vkQueueSubmit(transferQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit staging semaphore!");
+        }
+        return;
+    }
+
+    Batch batch = acquireBatch();
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(batch.commandBuffer, &beginInfo) != VK_SUCCESS) {
+        freeBatches.push_back(batch);
+        throw std::runtime_error("Failed to begin staging command buffer!");
+    }
+
+    recordCopies(batch.commandBuffer);
+
+    if (vkEndCommandBuffer(batch.commandBuffer) != VK_SUCCESS) {
+        freeBatches.push_back(batch);
+        throw std::runtime_error("Failed to record staging command buffer!");
+    }
+
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+
+    if (vkQueueSubmit(transferQueue, 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+        freeBatches.push_back(batch);
+        throw std::runtime_error("Failed to submit staging copies!");
+    }
+
+    batch.serial = nextSerial++;
+    ring.endSubmission(batch.serial);
+    inFlight.push_back(batch);
+
+    stats.batches++;
+}
+
+void StagingUploader::recordCopies(VkCommandBuffer commandBuffer) {
+    // Group by destination and merge regions contiguous on both sides
+    std::stable_sort(bufferCopies.begin(), bufferCopies.end(), [](const BufferCopy& a, const BufferCopy& b) {
+        return a.dst != b.dst ? a.dst < b.dst : a.region.dstOffset < b.region.dstOffset;
+    });
+
+    std::vector<BufferCopy> merged;
+    merged.reserve(bufferCopies.size());
+    for (const auto& copy : bufferCopies) {
+        if (!merged.empty()) {
+            BufferCopy& last = merged.back();
+            if (last.dst == copy.dst &&
+                last.region.srcOffset + last.region.size == copy.region.srcOffset &&
+                last.region.dstOffset + last.region.size == copy.region.dstOffset) {
+                last.region.size += copy.region.size;
+                continue;
+            }
+        }
+        merged.push_back(copy);
+    }
+
+    std::stable_sort(imageCopies.begin(), imageCopies.end(), [](const ImageCopy& a, const ImageCopy& b) {
+        return a.dst < b.dst;
+    });
+
+    // Images: UNDEFINED -> TRANSFER_DST (uploads replace the whole level)
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    imageBarriers.reserve(imageCopies.size());
+    for (const auto& copy : imageCopies) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = copy.dst;
+        barrier.subresourceRange.aspectMask = copy.region.imageSubresource.aspectMask;
+        barrier.subresourceRange.baseMipLevel = copy.region.imageSubresource.mipLevel;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = copy.region.imageSubresource.baseArrayLayer;
+        barrier.subresourceRange.layerCount = 1;
+        imageBarriers.push_back(barrier);
+    }
+    if (!imageBarriers.empty()) {
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr,
+                             static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+    }
+
+    // One vkCmdCopyBuffer per destination buffer
+    std::vector<VkBufferCopy> regions;
+    for (size_t i = 0; i < merged.size();) {
+        regions.clear();
+        size_t end = i;
+        while (end < merged.size() && merged[end].dst == merged[i].dst) {
+            regions.push_back(merged[end].region);
+            end++;
+        }
+        vkCmdCopyBuffer(commandBuffer, ringBuffer.buffer, merged[i].dst,
+                        static_cast<uint32_t>(regions.size()), regions.data());
+        stats.copyCommands++;
+        stats.copyRegions += regions.size();
+        i = end;
+    }
+
+    // One vkCmdCopyBufferToImage per destination image
+    std::vector<VkBufferImageCopy> imageRegions;
+    for (size_t i = 0; i < imageCopies.size();) {
+        imageRegions.clear();
+        size_t end = i;
+        while (end < imageCopies.size() && imageCopies[end].dst == imageCopies[i].dst) {
+            imageRegions.push_back(imageCopies[end].region);
+            end++;
+        }
+        vkCmdCopyBufferToImage(commandBuffer, ringBuffer.buffer, imageCopies[i].dst,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(imageRegions.size()), imageRegions.data());
+        stats.copyCommands++;
+        stats.copyRegions += imageRegions.size();
+        i = end;
+    }
+
+    // Release to the graphics family; the matching acquire is in recordAcquires
+    if (ownershipTransfer) {
+        std::vector<VkBufferMemoryBarrier> releaseBuffers;
+        for (const auto& copy : merged) {
+            VkBufferMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0;
+            barrier.srcQueueFamilyIndex = transferFamily;
+            barrier.dstQueueFamilyIndex = graphicsFamily;
+            barrier.buffer = copy.dst;
+            barrier.offset = copy.region.dstOffset;
+            barrier.size = copy.region.size;
+            releaseBuffers.push_back(barrier);
+        }
+
+        for (auto& barrier : imageBarriers) {
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0;
+            barrier.srcQueueFamilyIndex = transferFamily;
+            barrier.dstQueueFamilyIndex = graphicsFamily;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        }
+        for (size_t i = 0; i < imageBarriers.size(); i++) {
+            imageBarriers[i].newLayout = imageCopies[i].finalLayout;
+        }
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr,
+                             static_cast<uint32_t>(releaseBuffers.size()), releaseBuffers.data(),
+                             static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+    }
+
+    pendingBufferAcquires.insert(pendingBufferAcquires.end(), merged.begin(), merged.end());
+    pendingImageAcquires.insert(pendingImageAcquires.end(), imageCopies.begin(), imageCopies.end());
+    bufferCopies.clear();
+    imageCopies.clear();
+}
+
+void StagingUploader::recordAcquires(VkCommandBuffer commandBuffer) {
+    if (pendingBufferAcquires.empty() && pendingImageAcquires.empty()) {
+        return;
+    }
+
+    // Same family: a plain transfer -> consumer dependency (same queue, so
+    // submission order covers the earlier batch). Dedicated family: the
+    // acquire half of the ownership transfer, chained to the semaphore wait.
+    uint32_t srcFamily = ownershipTransfer ? transferFamily : VK_QUEUE_FAMILY_IGNORED;
+    uint32_t dstFamily = ownershipTransfer ? graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+    VkAccessFlags srcAccess = ownershipTransfer ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT;
+    VkPipelineStageFlags srcStage = ownershipTransfer ? CONSUMER_STAGES : VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+    std::vector<VkBufferMemoryBarrier> bufferBarriers;
+    bufferBarriers.reserve(pendingBufferAcquires.size());
+    for (const auto& copy : pendingBufferAcquires) {
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = BUFFER_CONSUMER_ACCESS;
+        barrier.srcQueueFamilyIndex = srcFamily;
+        barrier.dstQueueFamilyIndex = dstFamily;
+        barrier.buffer = copy.dst;
+        barrier.offset = copy.region.dstOffset;
+        barrier.size = copy.region.size;
+        bufferBarriers.push_back(barrier);
+    }
+
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    imageBarriers.reserve(pendingImageAcquires.size());
+    for (const auto& copy : pendingImageAcquires) {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = copy.finalLayout;
+        barrier.srcQueueFamilyIndex = srcFamily;
+        barrier.dstQueueFamilyIndex = dstFamily;
+        barrier.image = copy.dst;
+        barrier.subresourceRange.aspectMask = copy.region.imageSubresource.aspectMask;
+        barrier.subresourceRange.baseMipLevel = copy.region.imageSubresource.mipLevel;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = copy.region.imageSubresource.baseArrayLayer;
+        barrier.subresourceRange.layerCount = 1;
+        imageBarriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, srcStage, CONSUMER_STAGES,
+                         0, 0, nullptr,
+                         static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+                         static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+    pendingBufferAcquires.clear();
+    pendingImageAcquires.clear();
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "GpuAllocator.h"
+#include "../memory/RingAllocator.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+struct StagingUploaderStats {
+    uint64_t uploads = 0;           // uploadBuffer/uploadImage calls
+    uint64_t bytesUploaded = 0;
+    uint64_t batches = 0;           // transfer queue submissions
+    uint64_t copyCommands = 0;      // vkCmdCopyBuffer + vkCmdCopyBufferToImage
+    uint64_t copyRegions = 0;       // regions after coalescing
+    uint64_t ringStalls = 0;        // uploads that had to wait for the GPU
+    bool dedicatedTransferQueue = false;
+};
+
+/**
+ * StagingUploader - Persistently mapped staging ring for runtime streaming
+ *
+ * upload*() memcpy's into the ring right away and queues the copy. flush()
+ * (once per frame) records every queued copy into a single transfer
+ * command buffer: regions are grouped per destination, so N small uploads
+ * into one buffer become one vkCmdCopyBuffer. Adjacent regions are merged.
+ *
+ * With a dedicated transfer family the batch runs on that queue, releases
+ * ownership, and the frame's graphics command buffer acquires it after
+ * waiting on a semaphore. Ring space is reclaimed by polling the batch
+ * fences, so the render thread only blocks when the ring is actually full.
+ *
+ * Uploads replace whole destination ranges / mip levels. The caller must
+ * not overwrite data a frame in flight is still reading, nor upload
+ * overlapping ranges within one frame. Not thread-safe; use from the
+ * render thread.
+ */
+class StagingUploader {
+public:
+    StagingUploader(VkDevice device, GpuAllocator& allocator,
+                    VkQueue transferQueue, uint32_t transferFamily,
+                    uint32_t graphicsFamily, uint32_t framesInFlight,
+                    VkDeviceSize ringSize = 64ull * 1024 * 1024);
+    ~StagingUploader();
+
+    StagingUploader(const StagingUploader&) = delete;
+    StagingUploader& operator=(const StagingUploader&) = delete;
+
+    // Large buffer uploads are split across several ring allocations
+    void uploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+    // Uploads tightly packed texels into mip `mipLevel` of a 2D color image,
+    // leaving it in finalLayout for the graphics queue
+    void uploadImage(VkImage dst, VkExtent3D extent, const void* data, VkDeviceSize size,
+                     VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     uint32_t mipLevel = 0, uint32_t arrayLayer = 0);
+
+    // Submits queued copies and records the matching acquire barriers into
+    // graphicsCommandBuffer (recording, outside a render pass). Returns the
+    // semaphore that frame's submit must wait on at getWaitStage(), or
+    // VK_NULL_HANDLE. frameIndex's previous submit must have completed.
+    VkSemaphore flush(uint32_t frameIndex, VkCommandBuffer graphicsCommandBuffer);
+
+    static VkPipelineStageFlags getWaitStage();
+
+    bool hasPendingUploads() const { return !bufferCopies.empty() || !imageCopies.empty(); }
+    const StagingUploaderStats& getStats() const { return stats; }
+    VkDeviceSize getRingSize() const { return ring.getCapacity(); }
+
+    void destroy();
+
+private:
+    struct BufferCopy {
+        VkBuffer dst;
+        VkBufferCopy region;
+    };
+
+    struct ImageCopy {
+        VkImage dst;
+        VkBufferImageCopy region;
+        VkImageLayout finalLayout;
+    };
+
+    struct Batch {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        uint64_t serial = 0;
+    };
+
+    VkDevice device;
+    GpuAllocator& allocator;
+    VkQueue transferQueue;
+    uint32_t transferFamily;
+    uint32_t graphicsFamily;
+    bool ownershipTransfer;
+
+    GpuBuffer ringBuffer;
+    uint8_t* ringData;
+    RingAllocator ring;
+
+    VkCommandPool commandPool;
+    std::deque<Batch> inFlight;         // Submission order
+    std::vector<Batch> freeBatches;
+    std::vector<VkSemaphore> frameSemaphores;
+    uint64_t nextSerial;
+
+    // Queued for the next submit
+    std::vector<BufferCopy> bufferCopies;
+    std::vector<ImageCopy> imageCopies;
+
+    // Submitted but not yet acquired by the graphics queue
+    std::vector<BufferCopy> pendingBufferAcquires;
+    std::vector<ImageCopy> pendingImageAcquires;
+
+    StagingUploaderStats stats;
+
+    uint64_t allocateStaging(VkDeviceSize size, VkDeviceSize alignment);
+    void reclaim(bool waitForOldest);
+    void submitBatch(VkSemaphore signalSemaphore);
+    void recordCopies(VkCommandBuffer commandBuffer);
+    void recordAcquires(VkCommandBuffer commandBuffer);
+    Batch acquireBatch();
+};
@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <limits>
 #include <cstring>
+#include <chrono>
+#include <filesystem>
 
 #ifdef VK_USE_PLATFORM_WIN32_KHR
     // Windows-specific
@@ -28,6 +30,21 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+namespace {
+
+// Everything BindlessDescriptorHeap needs; enabled all or nothing
+bool supportsBindless(const VkPhysicalDeviceVulkan12Features& features) {
+    return features.descriptorIndexing == VK_TRUE &&
+        features.runtimeDescriptorArray == VK_TRUE &&
+        features.descriptorBindingPartiallyBound == VK_TRUE &&
+        features.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+        features.descriptorBindingStorageBufferUpdateAfterBind == VK_TRUE &&
+        features.shaderSampledImageArrayNonUniformIndexing == VK_TRUE &&
+        features.shaderStorageBufferArrayNonUniformIndexing == VK_TRUE;
+}
+
+}
+
 VKAPI_ATTR VkBool32 VKAPI_CALL VulkanContext::debugCallback(
     VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
     VkDebugUtilsMessageTypeFlagsEXT messageType,
@@ -77,8 +94,9 @@ VKAPI_ATTR VkBool32 VKAPI_CALL VulkanContext::debugCallback(
     return VK_FALSE;
 }
 
-VulkanContext::VulkanContext(IWindow* window)
+VulkanContext::VulkanContext(IWindow* window, const VulkanContextConfig& config)
     : window(window)
+    , config(config)
     , instance(VK_NULL_HANDLE)
     , surface(VK_NULL_HANDLE)
 	, debugMessenger(VK_NULL_HANDLE)
@@ -86,15 +104,32 @@ VulkanContext::VulkanContext(IWindow* window)
     , device(VK_NULL_HANDLE)
     , graphicsQueue(VK_NULL_HANDLE)
     , presentQueue(VK_NULL_HANDLE)
+    , transferQueue(VK_NULL_HANDLE)
     , swapChain(VK_NULL_HANDLE)
     , swapChainImageFormat(VK_FORMAT_UNDEFINED)
     , swapChainExtent{ 0, 0 }  // Initialize to zero
+    , presentMode(VK_PRESENT_MODE_FIFO_KHR)
+    , presentModeDirty(false)
     , renderPass(VK_NULL_HANDLE)
     , pipelineLayout(VK_NULL_HANDLE)    
     , graphicsPipeline(VK_NULL_HANDLE)  
+    , lastSubmittedFrame(UINT32_MAX)
     , commandPool(VK_NULL_HANDLE)
+    , frameStarted(false)
+    , frameScope(GpuProfiler::INVALID_SCOPE)
+    , mainPassScope(GpuProfiler::INVALID_SCOPE)
+    , uploadWaitSemaphore(VK_NULL_HANDLE)
+    , compileStallMsAtFrameStart(0.0)
+    , lastFrameCompileStallMs(0.0)
+    , frameTimeline(VK_NULL_HANDLE)
+    , submittedFrameSerial(0)
+    , shaderReloadCount(0)
+    , waitForPresent(nullptr)
     , currentFrame(0)
     , currentImageIndex(0)
+    , framesInFlight(config.framesInFlight)
+    , pendingFramesInFlight(0)
+    , lastSwapChainRecreateMs(0.0)
 {
     std::cout << "VulkanContext constructor" << std::endl;
 }
@@ -106,19 +141,39 @@ VulkanContext::~VulkanContext() {
 void VulkanContext::initialize() {
     Logger::verbose("Initializing Vulkan...");
 
+    if (!config.headless && window == nullptr) {
+        throw std::runtime_error("A window is required unless running headless!");
+    }
+    setFramesInFlight(config.framesInFlight);
+
     createInstance();
 	setupDebugMessenger();
-    createSurface();
+    if (!config.headless) {
+        createSurface();
+    }
     pickPhysicalDevice();
     createLogicalDevice();
-    createSwapChain();
+    createAllocator();
+    createPipelineCache();
+    createPipelineManager();
+    createBindlessHeap();
+    createDescriptorAllocator();
+    if (config.headless) {
+        createOffscreenTargets();
+    } else {
+        createSwapChain();
+    }
     createImageViews();
     createRenderPass();
     createGraphicsPipeline();
     createFramebuffers();
     createCommandPool();
+    createCommandRecorder();
     createCommandBuffers();
+    createGpuProfiler();
+    createStagingUploader();
     createSyncObjects();
+    createShaderWatcher();
 
     Logger::info("Vulkan initialized successfully");
 }
@@ -149,10 +204,14 @@ bool VulkanContext::checkValidationLayerSupport() {
 }
 
 std::vector<const char*> VulkanContext::getRequiredExtensions() {
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-    
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    std::vector<const char*> extensions;
+
+    // Headless needs no surface extensions (and GLFW may not be initialized)
+    if (!config.headless) {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
     
     if (enableValidationLayers) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -278,20 +337,89 @@ void VulkanContext::pickPhysicalDevice() {
     std::vector<VkPhysicalDevice> devices(deviceCount);
     vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
 
-    for (const auto& device : devices) {
-        if (isDeviceSuitable(device)) {
-            physicalDevice = device;
-            break;
+    std::vector<DeviceProfile> profiles;
+    for (uint32_t i = 0; i < deviceCount; i++) {
+        profiles.push_back(queryDeviceProfile(devices[i], i));
+    }
+
+    for (const DeviceProfile& profile : profiles) {
+        std::string reason = DeviceSelector::rejectReason(profile);
+        Logger::verbose("  [" + std::to_string(profile.index) + "] " + profile.name + " (" +
+                        DeviceSelector::typeName(profile.type) + ", " +
+                        std::to_string(profile.deviceLocalBytes >> 20) + " MiB): " +
+                        (reason.empty() ? "score " + std::to_string(DeviceSelector::score(profile)) : reason));
+    }
+
+    size_t selected = DeviceSelector::select(profiles, config.device);
+    physicalDevice = devices[selected];
+    deviceProfile = profiles[selected];
+
+    std::cout << "  Physical device: " << deviceProfile.name << std::endl;
+}
+
+DeviceProfile VulkanContext::queryDeviceProfile(VkPhysicalDevice device, uint32_t index) {
+    DeviceProfile profile;
+    profile.index = index;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+    profile.name = properties.deviceName;
+    profile.apiVersion = properties.apiVersion;
+    switch (properties.deviceType) {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:   profile.type = DeviceType::Discrete; break;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: profile.type = DeviceType::Integrated; break;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:    profile.type = DeviceType::Virtual; break;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:            profile.type = DeviceType::Cpu; break;
+    default:                                     profile.type = DeviceType::Other; break;
+    }
+
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+        const VkMemoryHeap& heap = memoryProperties.memoryHeaps[i];
+        if (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            profile.deviceLocalBytes = std::max<uint64_t>(profile.deviceLocalBytes, heap.size);
         }
     }
 
-    if (physicalDevice == VK_NULL_HANDLE) {
-        throw std::runtime_error("Failed to find a suitable GPU!");
+    profile.suitable = isDeviceSuitable(device);
+    profile.dedicatedTransferQueue = findQueueFamilies(device).transferFamily.has_value();
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+    for (const VkQueueFamilyProperties& family : queueFamilies) {
+        if ((family.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(family.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+            profile.asyncComputeQueue = true;
+        }
     }
 
-    VkPhysicalDeviceProperties deviceProperties;
-    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
-    std::cout << "  Physical device: " << deviceProperties.deviceName << std::endl;
+    // Same feature chain createLogicalDevice enables from
+    bool vulkan12 = properties.apiVersion >= VK_API_VERSION_1_2;
+    bool vulkan13 = properties.apiVersion >= VK_API_VERSION_1_3;
+
+    VkPhysicalDeviceVulkan13Features supported13{};
+    supported13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    VkPhysicalDeviceVulkan12Features supported12{};
+    supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    supported12.pNext = vulkan13 ? &supported13 : nullptr;
+    VkPhysicalDeviceFeatures2 supported{};
+    supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported.pNext = vulkan12 ? &supported12 : nullptr;
+    vkGetPhysicalDeviceFeatures2(device, &supported);
+
+    profile.timelineSemaphore = vulkan12 && supported12.timelineSemaphore == VK_TRUE;
+    profile.bindless = vulkan12 && supportsBindless(supported12);
+    profile.drawIndirectCount = vulkan12 && supported12.drawIndirectCount == VK_TRUE;
+    profile.multiDrawIndirect = supported.features.multiDrawIndirect == VK_TRUE;
+    profile.synchronization2 = vulkan13 && supported13.synchronization2 == VK_TRUE;
+    profile.dynamicRendering = vulkan13 && config.dynamicRendering && supported13.dynamicRendering == VK_TRUE;
+    profile.presentWait = !config.headless &&
+        isDeviceExtensionAvailable(device, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+        isDeviceExtensionAvailable(device, VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+
+    return profile;
 }
 
 bool VulkanContext::isDeviceSuitable(VkPhysicalDevice device) {
@@ -299,8 +427,8 @@ bool VulkanContext::isDeviceSuitable(VkPhysicalDevice device) {
 
     bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported) {
+    bool swapChainAdequate = config.headless;
+    if (extensionsSupported && !config.headless) {
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
         swapChainAdequate = !swapChainSupport.formats.empty() &&
             !swapChainSupport.presentModes.empty();
@@ -322,13 +450,20 @@ QueueFamilyIndices VulkanContext::findQueueFamilies(VkPhysicalDevice device) {
     for (const auto& queueFamily : queueFamilies) {
         if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
             indices.graphicsFamily = i;
+
+            // Nothing is presented headless; alias present onto graphics
+            if (config.headless) {
+                indices.presentFamily = i;
+            }
         }
 
-        VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        if (!config.headless) {
+            VkBool32 presentSupport = false;
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
 
-        if (presentSupport) {
-            indices.presentFamily = i;
+            if (presentSupport) {
+                indices.presentFamily = i;
+            }
         }
 
         if (indices.isComplete()) {
@@ -338,6 +473,22 @@ QueueFamilyIndices VulkanContext::findQueueFamilies(VkPhysicalDevice device) {
         i++;
     }
 
+    // Dedicated transfer family for streaming: prefer a pure DMA queue,
+    // then any transfer-capable family without graphics
+    int bestScore = 0;
+    for (uint32_t family = 0; family < queueFamilyCount; family++) {
+        VkQueueFlags flags = queueFamilies[family].queueFlags;
+        if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT)) {
+            continue;
+        }
+
+        int score = (flags & VK_QUEUE_COMPUTE_BIT) ? 1 : 2;
+        if (score > bestScore) {
+            bestScore = score;
+            indices.transferFamily = family;
+        }
+    }
+
     return indices;
 }
 
@@ -348,7 +499,8 @@ bool VulkanContext::checkDeviceExtensionSupport(VkPhysicalDevice device) {
     std::vector<VkExtensionProperties> availableExtensions(extensionCount);
     vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
+    std::vector<const char*> required = getRequiredDeviceExtensions();
+    std::set<std::string> requiredExtensions(required.begin(), required.end());
 
     for (const auto& extension : availableExtensions) {
         requiredExtensions.erase(extension.extensionName);
@@ -357,6 +509,29 @@ bool VulkanContext::checkDeviceExtensionSupport(VkPhysicalDevice device) {
     return requiredExtensions.empty();
 }
 
+bool VulkanContext::isDeviceExtensionAvailable(VkPhysicalDevice device, const char* name) {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto& extension : availableExtensions) {
+        if (std::strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<const char*> VulkanContext::getRequiredDeviceExtensions() const {
+    // VK_KHR_swapchain is only needed when presenting
+    if (config.headless) {
+        return {};
+    }
+    return deviceExtensions;
+}
+
 // ==================== Logical Device Creation ====================
 
 void VulkanContext::createLogicalDevice() {
@@ -367,6 +542,9 @@ void VulkanContext::createLogicalDevice() {
         indices.graphicsFamily.value(),
         indices.presentFamily.value()
     };
+    if (indices.transferFamily.has_value()) {
+        uniqueQueueFamilies.insert(indices.transferFamily.value());
+    }
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -378,15 +556,104 @@ void VulkanContext::createLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures{};
+    // Enable the optional features the fast paths use, where supported
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    bool vulkan12 = properties.apiVersion >= VK_API_VERSION_1_2;
+    bool vulkan13 = properties.apiVersion >= VK_API_VERSION_1_3;
+
+    // Present timing for the latency tracker; both extensions or neither
+    bool presentWaitExtensions = !config.headless &&
+        isDeviceExtensionAvailable(physicalDevice, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+        isDeviceExtensionAvailable(physicalDevice, VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+
+    VkPhysicalDevicePresentWaitFeaturesKHR supportedPresentWait{};
+    supportedPresentWait.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    VkPhysicalDevicePresentIdFeaturesKHR supportedPresentId{};
+    supportedPresentId.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    supportedPresentId.pNext = &supportedPresentWait;
+
+    VkPhysicalDeviceVulkan13Features supported13{};
+    supported13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    supported13.pNext = presentWaitExtensions ? &supportedPresentId : nullptr;
+    VkPhysicalDeviceVulkan12Features supported12{};
+    supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    supported12.pNext = vulkan13 ? static_cast<void*>(&supported13) : supported13.pNext;
+    VkPhysicalDeviceFeatures2 supported{};
+    supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported.pNext = vulkan12 ? &supported12 : nullptr;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+
+    // Frame pacing is built on a timeline semaphore (core since 1.2)
+    if (!vulkan12 || supported12.timelineSemaphore != VK_TRUE) {
+        throw std::runtime_error("Failed to create logical device: timeline semaphores not supported!");
+    }
+
+    VkPhysicalDeviceVulkan12Features deviceFeatures12{};
+    deviceFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    deviceFeatures12.timelineSemaphore = VK_TRUE;
+    deviceFeatures12.drawIndirectCount = supported12.drawIndirectCount;
+
+    // Bindless heap: update-after-bind arrays indexed non-uniformly; all or nothing
+    bool bindless = supportsBindless(supported12);
+    if (bindless) {
+        deviceFeatures12.descriptorIndexing = VK_TRUE;
+        deviceFeatures12.runtimeDescriptorArray = VK_TRUE;
+        deviceFeatures12.descriptorBindingPartiallyBound = VK_TRUE;
+        deviceFeatures12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        deviceFeatures12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+        deviceFeatures12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        deviceFeatures12.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+    }
+
+    // vkCmdPipelineBarrier2 for the render graph, vkCmdBeginRendering for the main pass (core in 1.3)
+    VkPhysicalDeviceVulkan13Features deviceFeatures13{};
+    deviceFeatures13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    deviceFeatures13.synchronization2 = supported13.synchronization2;
+    deviceFeatures13.dynamicRendering = config.dynamicRendering ? supported13.dynamicRendering : VK_FALSE;
+    if (vulkan13) {
+        deviceFeatures12.pNext = &deviceFeatures13;
+    }
+
+    VkPhysicalDeviceFeatures2 deviceFeatures{};
+    deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    deviceFeatures.pNext = &deviceFeatures12;
+    deviceFeatures.features.multiDrawIndirect = supported.features.multiDrawIndirect;
+    deviceFeatures.features.drawIndirectFirstInstance = supported.features.drawIndirectFirstInstance;
+
+    enabledFeatures.drawIndirectCount = deviceFeatures12.drawIndirectCount == VK_TRUE;
+    enabledFeatures.multiDrawIndirect = deviceFeatures.features.multiDrawIndirect == VK_TRUE;
+    enabledFeatures.drawIndirectFirstInstance = deviceFeatures.features.drawIndirectFirstInstance == VK_TRUE;
+    enabledFeatures.bindless = bindless;
+    enabledFeatures.synchronization2 = vulkan13 && deviceFeatures13.synchronization2 == VK_TRUE;
+    enabledFeatures.dynamicRendering = vulkan13 && deviceFeatures13.dynamicRendering == VK_TRUE;
+
+    std::vector<const char*> extensions = getRequiredDeviceExtensions();
+
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    presentWaitFeatures.presentWait = VK_TRUE;
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    presentIdFeatures.pNext = &presentWaitFeatures;
+    presentIdFeatures.presentId = VK_TRUE;
+
+    enabledFeatures.presentWait = presentWaitExtensions &&
+        supportedPresentId.presentId == VK_TRUE && supportedPresentWait.presentWait == VK_TRUE;
+    if (enabledFeatures.presentWait) {
+        (vulkan13 ? deviceFeatures13.pNext : deviceFeatures12.pNext) = &presentIdFeatures;
+        extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+        extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    }
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
-    createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.pNext = &deviceFeatures;
+    createInfo.pEnabledFeatures = nullptr;
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
     createInfo.enabledLayerCount = 0;
 
     if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device) != VK_SUCCESS) {
@@ -396,9 +663,148 @@ void VulkanContext::createLogicalDevice() {
     vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
 
+    if (enabledFeatures.presentWait) {
+        waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+            vkGetDeviceProcAddr(device, "vkWaitForPresentKHR"));
+        enabledFeatures.presentWait = waitForPresent != nullptr;
+    }
+
+    // Without a dedicated family, uploads share the graphics queue
+    if (indices.transferFamily.has_value()) {
+        vkGetDeviceQueue(device, indices.transferFamily.value(), 0, &transferQueue);
+    } else {
+        transferQueue = graphicsQueue;
+    }
+
+    // What the fast paths will actually use; getEnabledFeatures() gates them
+    std::string features;
+    const std::pair<bool, const char*> flags[] = {
+        { enabledFeatures.drawIndirectCount, " drawIndirectCount" },
+        { enabledFeatures.multiDrawIndirect, " multiDrawIndirect" },
+        { enabledFeatures.drawIndirectFirstInstance, " drawIndirectFirstInstance" },
+        { enabledFeatures.presentWait, " presentWait" },
+        { enabledFeatures.bindless, " bindless" },
+        { enabledFeatures.synchronization2, " synchronization2" },
+        { enabledFeatures.dynamicRendering, " dynamicRendering" },
+    };
+    for (const auto& flag : flags) {
+        features += flag.first ? flag.second : "";
+    }
+    Logger::verbose("  Enabled features:" + (features.empty() ? std::string(" none") : features));
+
     std::cout << "  Logical device created" << std::endl;
 }
 
+// ==================== Device Memory ====================
+
+void VulkanContext::createAllocator() {
+    allocator = std::make_unique<GpuAllocator>(physicalDevice, device);
+
+    std::cout << "  Memory allocator created" << std::endl;
+}
+
+GpuAllocator& VulkanContext::getAllocator() {
+    if (!allocator) {
+        throw std::runtime_error("Memory allocator not initialized!");
+    }
+    return *allocator;
+}
+
+GpuBuffer VulkanContext::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                      VkMemoryPropertyFlags properties, uint32_t allocationFlags) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    return getAllocator().createBuffer(bufferInfo, properties, allocationFlags);
+}
+
+void VulkanContext::destroyBuffer(GpuBuffer& buffer) {
+    getAllocator().destroyBuffer(buffer);
+}
+
+GpuImage VulkanContext::createImage(const VkImageCreateInfo& imageInfo,
+                                    VkMemoryPropertyFlags properties, uint32_t allocationFlags) {
+    return getAllocator().createImage(imageInfo, properties, allocationFlags);
+}
+
+void VulkanContext::destroyImage(GpuImage& image) {
+    getAllocator().destroyImage(image);
+}
+
+// ==================== Deferred Destruction ====================
+
+void VulkanContext::deferDestroy(DeletionQueue::Deleter deleter) {
+    deletionQueue.push(getLastUseFrameSerial(), std::move(deleter));
+}
+
+void VulkanContext::deferDestroy(GpuBuffer& buffer) {
+    if (buffer.buffer == VK_NULL_HANDLE) {
+        return;
+    }
+    GpuAllocator* gpuAllocator = &getAllocator();
+    GpuBuffer pending = buffer;
+    buffer = GpuBuffer{};
+    deferDestroy([gpuAllocator, pending]() mutable { gpuAllocator->destroyBuffer(pending); });
+}
+
+void VulkanContext::deferDestroy(GpuImage& image) {
+    if (image.image == VK_NULL_HANDLE) {
+        return;
+    }
+    GpuAllocator* gpuAllocator = &getAllocator();
+    GpuImage pending = image;
+    image = GpuImage{};
+    deferDestroy([gpuAllocator, pending]() mutable { gpuAllocator->destroyImage(pending); });
+}
+
+void VulkanContext::deferDestroy(VkPipeline pipeline) {
+    if (pipeline == VK_NULL_HANDLE) {
+        return;
+    }
+    VkDevice device = this->device;
+    deferDestroy([device, pipeline]() { vkDestroyPipeline(device, pipeline, nullptr); });
+}
+
+void VulkanContext::deferDestroy(VkDescriptorPool pool) {
+    if (pool == VK_NULL_HANDLE) {
+        return;
+    }
+    VkDevice device = this->device;
+    deferDestroy([device, pool]() { vkDestroyDescriptorPool(device, pool, nullptr); });
+}
+
+std::vector<GpuHeapStats> VulkanContext::getMemoryStats() const {
+    if (!allocator) {
+        return {};
+    }
+    return allocator->getHeapStats();
+}
+
+// ==================== Pipeline Cache ====================
+
+void VulkanContext::createPipelineCache() {
+    pipelineCache = std::make_unique<PipelineCache>(physicalDevice, device);
+    pipelineCache->load();
+
+    const PipelineCacheStats& stats = pipelineCache->getStats();
+    if (stats.loadedFromDisk) {
+        std::cout << "  Pipeline cache loaded (" << stats.loadedBytes << " bytes, "
+                  << stats.loadMs << " ms)" << std::endl;
+    } else {
+        std::cout << "  Pipeline cache created empty (" << stats.rejectReason << ")" << std::endl;
+    }
+}
+
+PipelineCacheStats VulkanContext::getPipelineCacheStats() const {
+    if (!pipelineCache) {
+        return {};
+    }
+    return pipelineCache->getStats();
+}
+
 // ==================== Swapchain Creation ====================
 
 SwapChainSupportDetails VulkanContext::querySwapChainSupport(VkPhysicalDevice device) {
@@ -438,12 +844,39 @@ VkSurfaceFormatKHR VulkanContext::chooseSwapSurfaceFormat(const std::vector<VkSu
 
 VkPresentModeKHR VulkanContext::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
     for (const auto& availablePresentMode : availablePresentModes) {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+        if (availablePresentMode == config.presentMode) {
             return availablePresentMode;
         }
     }
 
-    return VK_PRESENT_MODE_FIFO_KHR; // VSync
+    Logger::verbose("Present mode " + std::to_string(config.presentMode) + " unsupported, using FIFO");
+    return VK_PRESENT_MODE_FIFO_KHR; // VSync, always available
+}
+
+std::vector<VkPresentModeKHR> VulkanContext::getSupportedPresentModes() {
+    if (config.headless || surface == VK_NULL_HANDLE) {
+        return {};
+    }
+    return querySwapChainSupport(physicalDevice).presentModes;
+}
+
+bool VulkanContext::setPresentMode(VkPresentModeKHR mode) {
+    config.presentMode = mode;
+
+    // Applied when the swapchain is (re)built
+    if (config.headless || swapChain == VK_NULL_HANDLE || mode == presentMode) {
+        return true;
+    }
+
+    // The open frame still renders to the current swapchain's images
+    if (frameStarted) {
+        presentModeDirty = true;
+        std::vector<VkPresentModeKHR> modes = getSupportedPresentModes();
+        return std::find(modes.begin(), modes.end(), mode) != modes.end();
+    }
+
+    recreateSwapChain();
+    return presentMode == mode;
 }
 
 VkExtent2D VulkanContext::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) {
@@ -509,12 +942,16 @@ void VulkanContext::createSwapChain() {
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+
+    // Lets the driver recycle the old images and keep presenting during a resize
+    createInfo.oldSwapchain = swapChain;
 
     if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create swap chain!");
     }
 
+    this->presentMode = presentMode;
+
     vkGetSwapchainImagesKHR(device, swapChain, &imageCount, nullptr);
     swapChainImages.resize(imageCount);
     vkGetSwapchainImagesKHR(device, swapChain, &imageCount, swapChainImages.data());
@@ -525,6 +962,67 @@ void VulkanContext::createSwapChain() {
     std::cout << "  Swapchain created (" << imageCount << " images)" << std::endl;
 }
 
+// ==================== Offscreen Targets (Headless) ====================
+
+void VulkanContext::createOffscreenTargets() {
+    if (config.width == 0 || config.height == 0) {
+        throw std::runtime_error("Headless mode needs a non-zero extent!");
+    }
+
+    bool fourBytesPerPixel =
+        config.offscreenFormat == VK_FORMAT_R8G8B8A8_UNORM || config.offscreenFormat == VK_FORMAT_R8G8B8A8_SRGB ||
+        config.offscreenFormat == VK_FORMAT_B8G8R8A8_UNORM || config.offscreenFormat == VK_FORMAT_B8G8R8A8_SRGB;
+    if (config.enableReadback && !fourBytesPerPixel) {
+        throw std::runtime_error("Readback requires an 8-bit RGBA/BGRA offscreen format!");
+    }
+
+    swapChainImageFormat = config.offscreenFormat;
+    swapChainExtent = { config.width, config.height };
+
+    // One target per frame in flight, so frames never wait on each other's image
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = swapChainImageFormat;
+    imageInfo.extent = { swapChainExtent.width, swapChainExtent.height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VkDeviceSize readbackSize = static_cast<VkDeviceSize>(swapChainExtent.width) * swapChainExtent.height * 4;
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        offscreenImages.push_back(createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+        swapChainImages.push_back(offscreenImages.back().image);
+
+        if (config.enableReadback) {
+            readbackBuffers.push_back(createBuffer(readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+        }
+    }
+
+    std::cout << "  Offscreen targets created (" << swapChainExtent.width << "x" << swapChainExtent.height
+              << ", " << offscreenImages.size() << " images"
+              << (config.enableReadback ? ", readback" : "") << ")" << std::endl;
+}
+
+bool VulkanContext::readbackLastFrame(std::vector<uint8_t>& pixels) {
+    if (readbackBuffers.empty() || lastSubmittedFrame == UINT32_MAX) {
+        return false;
+    }
+
+    waitForFrameSerial(frameSlotSerials[lastSubmittedFrame]);
+
+    const GpuBuffer& buffer = readbackBuffers[lastSubmittedFrame];
+    const uint8_t* data = static_cast<const uint8_t*>(buffer.allocation.mappedData);
+    pixels.assign(data, data + static_cast<size_t>(swapChainExtent.width) * swapChainExtent.height * 4);
+    return true;
+}
+
 // ==================== Image Views ====================
 
 void VulkanContext::createImageViews() {
@@ -557,6 +1055,12 @@ void VulkanContext::createImageViews() {
 // ==================== Render Pass ====================
 
 void VulkanContext::createRenderPass() {
+    // Dynamic rendering describes attachments at vkCmdBeginRendering time
+    if (enabledFeatures.dynamicRendering) {
+        std::cout << "  Dynamic rendering enabled, no render pass" << std::endl;
+        return;
+    }
+
     VkAttachmentDescription colorAttachment{};
     colorAttachment.format = swapChainImageFormat;
     colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
@@ -565,7 +1069,8 @@ void VulkanContext::createRenderPass() {
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = config.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                                  : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -584,14 +1089,25 @@ void VulkanContext::createRenderPass() {
     dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
+    // Headless: rendering must finish before the readback copy
+    VkSubpassDependency readbackDependency{};
+    readbackDependency.srcSubpass = 0;
+    readbackDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+    readbackDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    readbackDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    readbackDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    readbackDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    VkSubpassDependency dependencies[] = { dependency, readbackDependency };
+
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = 1;
     renderPassInfo.pAttachments = &colorAttachment;
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
+    renderPassInfo.dependencyCount = config.headless ? 2 : 1;
+    renderPassInfo.pDependencies = dependencies;
 
     if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create render pass!");
@@ -603,6 +1119,10 @@ void VulkanContext::createRenderPass() {
 // ==================== Framebuffers ====================
 
 void VulkanContext::createFramebuffers() {
+    if (enabledFeatures.dynamicRendering) {
+        return;
+    }
+
     swapChainFramebuffers.resize(swapChainImageViews.size());
 
     for (size_t i = 0; i < swapChainImageViews.size(); i++) {
@@ -642,20 +1162,103 @@ void VulkanContext::createCommandPool() {
     std::cout << "  Command pool created" << std::endl;
 }
 
+void VulkanContext::createDescriptorAllocator() {
+    descriptorLayoutCache = std::make_unique<DescriptorLayoutCache>(device);
+    pipelineLayoutCache = std::make_unique<PipelineLayoutCache>(device, *descriptorLayoutCache);
+    descriptorAllocator = std::make_unique<DescriptorAllocator>(device, MAX_FRAMES_IN_FLIGHT);
+}
+
+DescriptorAllocator& VulkanContext::getDescriptorAllocator() {
+    if (!descriptorAllocator) {
+        throw std::runtime_error("Descriptor allocator not initialized!");
+    }
+    return *descriptorAllocator;
+}
+
+DescriptorLayoutCache& VulkanContext::getDescriptorLayoutCache() {
+    if (!descriptorLayoutCache) {
+        throw std::runtime_error("Descriptor layout cache not initialized!");
+    }
+    return *descriptorLayoutCache;
+}
+
+PipelineLayoutCache& VulkanContext::getPipelineLayoutCache() {
+    if (!pipelineLayoutCache) {
+        throw std::runtime_error("Pipeline layout cache not initialized!");
+    }
+    return *pipelineLayoutCache;
+}
+
+void VulkanContext::createCommandRecorder() {
+    QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+
+    commandRecorder = std::make_unique<ParallelCommandRecorder>(
+        device, queueFamilyIndices.graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT, *threadPool);
+
+    std::cout << "  Command recorder created (" << threadPool->getThreadSlotCount()
+              << " threads x " << MAX_FRAMES_IN_FLIGHT << " frames)" << std::endl;
+}
+
 void VulkanContext::createCommandBuffers() {
+    // Primaries live in the render thread's per-frame pool and are reset with it
     commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    for (size_t i = 0; i < commandBuffers.size(); i++) {
+        commandBuffers[i] = commandRecorder->getPrimary(static_cast<uint32_t>(i));
+    }
+
+    std::cout << "  Command buffers created" << std::endl;
+}
+
+// ==================== GPU Profiler ====================
+
+void VulkanContext::createGpuProfiler() {
+    QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+
+    gpuProfiler = std::make_unique<GpuProfiler>(
+        physicalDevice, device, queueFamilyIndices.graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT);
 
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = commandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+    std::cout << "  GPU profiler created" << (gpuProfiler->isSupported() ? "" : " (timestamps unsupported)")
+              << std::endl;
+}
+
+// ==================== Staging Uploads ====================
+
+void VulkanContext::createStagingUploader() {
+    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    uint32_t graphicsFamily = indices.graphicsFamily.value();
+    uint32_t transferFamily = indices.transferFamily.value_or(graphicsFamily);
+
+    stagingUploader = std::make_unique<StagingUploader>(
+        device, getAllocator(), transferQueue, transferFamily, graphicsFamily, MAX_FRAMES_IN_FLIGHT);
+
+    std::cout << "  Staging uploader created (" << (stagingUploader->getRingSize() >> 20) << " MB ring, "
+              << (indices.transferFamily.has_value() ? "dedicated transfer queue" : "graphics queue")
+              << ")" << std::endl;
+}
 
-    if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to allocate command buffers!");
+StagingUploader& VulkanContext::getStagingUploader() {
+    if (!stagingUploader) {
+        throw std::runtime_error("Staging uploader not initialized!");
     }
+    return *stagingUploader;
+}
 
-    std::cout << "  Command buffers created" << std::endl;
+GpuProfiler& VulkanContext::getGpuProfiler() {
+    if (!gpuProfiler) {
+        throw std::runtime_error("GPU profiler not initialized!");
+    }
+    return *gpuProfiler;
+}
+
+ThreadPool& VulkanContext::getThreadPool() {
+    if (!threadPool) {
+        throw std::runtime_error("Thread pool not initialized!");
+    }
+    return *threadPool;
+}
+
+ParallelRecorderStats VulkanContext::getRecorderStats() const {
+    return commandRecorder ? commandRecorder->getStats() : ParallelRecorderStats{};
 }
 
 // ==================== Synchronization ====================
@@ -663,23 +1266,30 @@ void VulkanContext::createCommandBuffers() {
 void VulkanContext::createSyncObjects() {
     imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
     renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+    frameSlotSerials.assign(MAX_FRAMES_IN_FLIGHT, 0);
 
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
+    // Binary semaphores for acquire/present, which cannot use timelines
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
         if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create synchronization objects!");
         }
     }
 
+    // Counts completed frames: frame N signals value N
+    VkSemaphoreTypeCreateInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+    semaphoreInfo.pNext = &timelineInfo;
+
+    if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &frameTimeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create frame timeline semaphore!");
+    }
+
     std::cout << "  Synchronization objects created" << std::endl;
 }
 
@@ -687,7 +1297,7 @@ void VulkanContext::createSyncObjects() {
 
 void VulkanContext::beginFrame() {
     // Safety checks
-    if (device == VK_NULL_HANDLE || swapChain == VK_NULL_HANDLE) {
+    if (device == VK_NULL_HANDLE || (!config.headless && swapChain == VK_NULL_HANDLE)) {
         return;
     }
 
@@ -698,107 +1308,412 @@ void VulkanContext::beginFrame() {
     }
 
     // Check framebuffers exist
-    if (swapChainFramebuffers.empty()) {
+    if (!enabledFeatures.dynamicRendering && swapChainFramebuffers.empty()) {
         std::cerr << "ERROR: swapChainFramebuffers not created!" << std::endl;
         return;
     }
 
-    // Wait for previous frame to finish
-    vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    // Throttle to framesInFlight frames ahead of the GPU; the slot's own
+    // last frame must be done as well
+    uint64_t waitSerial = std::max(frameSlotSerials[currentFrame],
+        submittedFrameSerial >= framesInFlight ? submittedFrameSerial + 1 - framesInFlight : 0);
+    waitForFrameSerial(waitSerial);
+
+    // A depth change from setFramesInFlight: throttle to the new depth, and
+    // the remapped slot's own last frame must be done before its resources
+    // are reused
+    if (pendingFramesInFlight != 0) {
+        framesInFlight = pendingFramesInFlight;
+        pendingFramesInFlight = 0;
+        currentFrame %= framesInFlight;
+        waitForFrameSerial(std::max(frameSlotSerials[currentFrame],
+            submittedFrameSerial >= framesInFlight ? submittedFrameSerial + 1 - framesInFlight : 0));
+    }
+
+    // Resources released by frames that have finished on the GPU
+    deletionQueue.flush(getCompletedFrameSerial());
+    pollPresentedFrames();
+
+    double compileStallMs = pipelineManager->getStats().stallMs;
+    lastFrameCompileStallMs = compileStallMs - compileStallMsAtFrameStart;
+    compileStallMsAtFrameStart = compileStallMs;
 
-    // Acquire next image from swapchain
-    VkResult result = vkAcquireNextImageKHR(
-        device,
-        swapChain,
-        UINT64_MAX,
-        imageAvailableSemaphores[currentFrame],
-        VK_NULL_HANDLE,
-        &currentImageIndex  // Store it!
-    );
+    applyShaderReloads();
 
-    // Handle out-of-date swapchain
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+    // Present mode requested while the previous frame was recording
+    if (presentModeDirty) {
         recreateSwapChain();
-        return;
-    }
-    else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        throw std::runtime_error("Failed to acquire swap chain image!");
     }
 
-    // Only reset fence if we're submitting work
-    vkResetFences(device, 1, &inFlightFences[currentFrame]);
+    if (config.headless) {
+        // Each frame in flight owns its offscreen target
+        currentImageIndex = currentFrame;
+    } else {
+        // Acquire next image from swapchain
+        VkResult result = vkAcquireNextImageKHR(
+            device,
+            swapChain,
+            UINT64_MAX,
+            imageAvailableSemaphores[currentFrame],
+            VK_NULL_HANDLE,
+            &currentImageIndex  // Store it!
+        );
+
+        // Handle out-of-date swapchain
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            recreateSwapChain();
+            return;
+        }
+        else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            throw std::runtime_error("Failed to acquire swap chain image!");
+        }
+    }
 
-    // Reset command buffer
-    vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+    // The timeline wait guarantees this slot's pools are idle; reset them wholesale
+    commandRecorder->beginFrame(currentFrame);
+    descriptorAllocator->beginFrame(currentFrame);
+    pendingSecondaries.clear();
 
     // Begin command buffer
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
     if (vkBeginCommandBuffer(commandBuffers[currentFrame], &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("Failed to begin recording command buffer!");
     }
 
-    // Begin render pass
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = renderPass;
-    renderPassInfo.framebuffer = swapChainFramebuffers[currentImageIndex];  // Use stored index
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = swapChainExtent;
+    // The slot's last frame has completed, so harvesting its timings never blocks
+    gpuProfiler->beginFrame(currentFrame, commandBuffers[currentFrame]);
+    frameScope = gpuProfiler->beginScope(commandBuffers[currentFrame], "frame");
 
-    VkClearValue clearColor = { {{0.0f, 0.0f, 0.0f, 1.0f}} };  // Black
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
+    // Submit this frame's uploads and make them visible to the draws below
+    uploadWaitSemaphore = stagingUploader->flush(currentFrame, commandBuffers[currentFrame]);
 
-    vkCmdBeginRenderPass(commandBuffers[currentFrame], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    // Compute and transfer work that must precede the render pass
+    for (IRenderFeature* feature : renderFeatures) {
+        feature->prepare(commandBuffers[currentFrame], currentFrame);
+    }
 
+    // Timestamps may not be written in a subpass with secondary contents,
+    // so the pass scope brackets the whole render pass from the primary
+    mainPassScope = gpuProfiler->beginScope(commandBuffers[currentFrame], "main_pass");
+
+    // Draws are recorded into secondaries and executed in endFrame
+    beginMainPass(commandBuffers[currentFrame]);
+    frameStarted = true;
 
     // BIND PIPELINE AND DRAW
-    vkCmdBindPipeline(commandBuffers[currentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-    vkCmdDraw(commandBuffers[currentFrame], 3, 1, 0, 0);  // Draw 3 vertices
+    VkPipeline pipeline = graphicsPipeline;
+    recordSecondary(1, [pipeline](VkCommandBuffer commandBuffer, uint32_t) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);  // Draw 3 vertices
+    });
+
+    // One secondary per feature, recorded in parallel
+    uint32_t frameIndex = currentFrame;
+    recordSecondary(static_cast<uint32_t>(renderFeatures.size()),
+        [this, frameIndex](VkCommandBuffer commandBuffer, uint32_t featureIndex) {
+            renderFeatures[featureIndex]->draw(commandBuffer, frameIndex);
+        });
+}
 
+void VulkanContext::beginMainPass(VkCommandBuffer commandBuffer) {
+    VkClearValue clearColor = { {{0.0f, 0.0f, 0.0f, 1.0f}} };  // Black
 
-    vkCmdEndRenderPass(commandBuffers[currentFrame]);
+    if (!enabledFeatures.dynamicRendering) {
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = renderPass;
+        renderPassInfo.framebuffer = swapChainFramebuffers[currentImageIndex];  // Use stored index
+        renderPassInfo.renderArea.offset = { 0, 0 };
+        renderPassInfo.renderArea.extent = swapChainExtent;
+        renderPassInfo.clearValueCount = 1;
+        renderPassInfo.pClearValues = &clearColor;
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        return;
+    }
 
-    if (vkEndCommandBuffer(commandBuffers[currentFrame]) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to record command buffer!");
+    // The render pass's initial layout and external dependency, by hand.
+    // Waits at color output, the stage the acquire semaphore is waited on.
+    VkImageMemoryBarrier toAttachment{};
+    toAttachment.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toAttachment.srcAccessMask = 0;
+    toAttachment.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    toAttachment.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    toAttachment.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    toAttachment.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toAttachment.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toAttachment.image = swapChainImages[currentImageIndex];
+    toAttachment.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &toAttachment);
+
+    VkRenderingAttachmentInfo colorAttachment{};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    colorAttachment.imageView = swapChainImageViews[currentImageIndex];
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.clearValue = clearColor;
+
+    VkRenderingInfo renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+    renderingInfo.renderArea.offset = { 0, 0 };
+    renderingInfo.renderArea.extent = swapChainExtent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+
+    vkCmdBeginRendering(commandBuffer, &renderingInfo);
+}
+
+void VulkanContext::endMainPass(VkCommandBuffer commandBuffer) {
+    if (!enabledFeatures.dynamicRendering) {
+        vkCmdEndRenderPass(commandBuffer);
+        return;
+    }
+
+    vkCmdEndRendering(commandBuffer);
+
+    // The render pass's final layout: presentable, or ready for the readback copy
+    VkImageMemoryBarrier toFinal{};
+    toFinal.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toFinal.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    toFinal.dstAccessMask = config.headless ? VK_ACCESS_TRANSFER_READ_BIT : 0;
+    toFinal.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    toFinal.newLayout = config.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    toFinal.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toFinal.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toFinal.image = swapChainImages[currentImageIndex];
+    toFinal.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         config.headless ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &toFinal);
+}
+
+void VulkanContext::setMainPassTarget(PipelineStateDesc& desc) const {
+    desc.renderPass = renderPass;
+    desc.subpass = 0;
+    desc.colorFormat = enabledFeatures.dynamicRendering ? swapChainImageFormat : VK_FORMAT_UNDEFINED;
+    desc.depthFormat = VK_FORMAT_UNDEFINED;
+}
+
+void VulkanContext::addRenderFeature(IRenderFeature* feature) {
+    if (std::find(renderFeatures.begin(), renderFeatures.end(), feature) == renderFeatures.end()) {
+        renderFeatures.push_back(feature);
     }
 }
 
+void VulkanContext::removeRenderFeature(IRenderFeature* feature) {
+    renderFeatures.erase(std::remove(renderFeatures.begin(), renderFeatures.end(), feature), renderFeatures.end());
+}
+
+void VulkanContext::recordSecondary(uint32_t taskCount, const ParallelCommandRecorder::RecordFn& fn) {
+    if (!frameStarted) {
+        return;
+    }
+
+    VkCommandBufferInheritanceInfo inheritance{};
+    inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.renderPass = renderPass;
+    inheritance.subpass = 0;
+
+    // Dynamic rendering: secondaries inherit the attachment formats instead
+    VkCommandBufferInheritanceRenderingInfo renderingInheritance{};
+    renderingInheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    renderingInheritance.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+    renderingInheritance.colorAttachmentCount = 1;
+    renderingInheritance.pColorAttachmentFormats = &swapChainImageFormat;
+    renderingInheritance.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    if (enabledFeatures.dynamicRendering) {
+        inheritance.pNext = &renderingInheritance;
+    } else {
+        inheritance.framebuffer = swapChainFramebuffers[currentImageIndex];
+    }
+
+    // Viewport and scissor are dynamic state, which secondaries do not inherit
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float)swapChainExtent.width;
+    viewport.height = (float)swapChainExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+
+    VkRect2D scissor{};
+    scissor.offset = { 0, 0 };
+    scissor.extent = swapChainExtent;
+
+    commandRecorder->record(taskCount, inheritance,
+        [&](VkCommandBuffer commandBuffer, uint32_t taskIndex) {
+            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+            // Bound once per secondary; materials then only push their indices
+            if (bindlessHeap) {
+                bindlessHeap->bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0);
+            }
+            fn(commandBuffer, taskIndex);
+        },
+        pendingSecondaries);
+}
+
 void VulkanContext::endFrame() {
+    // beginFrame bailed out (e.g. swapchain out of date): nothing to submit
+    if (!frameStarted) {
+        return;
+    }
+    frameStarted = false;
+
+    if (!pendingSecondaries.empty()) {
+        vkCmdExecuteCommands(commandBuffers[currentFrame],
+                             static_cast<uint32_t>(pendingSecondaries.size()), pendingSecondaries.data());
+        pendingSecondaries.clear();
+    }
+
+    endMainPass(commandBuffers[currentFrame]);
+    gpuProfiler->endScope(commandBuffers[currentFrame], mainPassScope);
+
+    // The main pass left the target in TRANSFER_SRC_OPTIMAL
+    if (!readbackBuffers.empty()) {
+        GpuProfiler::Scope readbackScope(*gpuProfiler, commandBuffers[currentFrame], "readback");
+
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = { swapChainExtent.width, swapChainExtent.height, 1 };
+
+        vkCmdCopyImageToBuffer(commandBuffers[currentFrame], swapChainImages[currentImageIndex],
+                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               readbackBuffers[currentFrame].buffer, 1, &region);
+
+        VkBufferMemoryBarrier hostBarrier{};
+        hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.buffer = readbackBuffers[currentFrame].buffer;
+        hostBarrier.offset = 0;
+        hostBarrier.size = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(commandBuffers[currentFrame],
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+    }
+
+    gpuProfiler->endScope(commandBuffers[currentFrame], frameScope);
+
+    if (vkEndCommandBuffer(commandBuffers[currentFrame]) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to record command buffer!");
+    }
+
+    if (config.headless) {
+        // No acquire/present: only uploads to wait on, only the timeline to signal
+        VkPipelineStageFlags uploadWaitStage = StagingUploader::getWaitStage();
+
+        uint64_t frameSerial = submittedFrameSerial + 1;
+        uint64_t waitValue = 0;     // Ignored for binary semaphores
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.waitSemaphoreValueCount = uploadWaitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+        timelineInfo.pWaitSemaphoreValues = &waitValue;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &frameSerial;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.waitSemaphoreCount = uploadWaitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+        submitInfo.pWaitSemaphores = &uploadWaitSemaphore;
+        submitInfo.pWaitDstStageMask = &uploadWaitStage;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &frameTimeline;
+
+        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit draw command buffer!");
+        }
+        submittedFrameSerial = frameSerial;
+        frameSlotSerials[currentFrame] = frameSerial;
+        latencyTracker.markSubmit(frameSerial);
+
+        lastSubmittedFrame = currentFrame;
+        currentFrame = (currentFrame + 1) % framesInFlight;
+        return;
+    }
+
     // Submit command buffer
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame] };
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submitInfo.waitSemaphoreCount = 1;
+    VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame], uploadWaitSemaphore };
+    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                          StagingUploader::getWaitStage() };
+    submitInfo.waitSemaphoreCount = uploadWaitSemaphore != VK_NULL_HANDLE ? 2 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
 
-    VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
-    submitInfo.signalSemaphoreCount = 1;
+    // renderFinished (binary) feeds present; the timeline marks the frame complete
+    uint64_t frameSerial = submittedFrameSerial + 1;
+    uint64_t waitValues[] = { 0, 0 };
+    uint64_t signalValues[] = { 0, frameSerial };
+    VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame], frameTimeline };
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = submitInfo.waitSemaphoreCount;
+    timelineInfo.pWaitSemaphoreValues = waitValues;
+    timelineInfo.signalSemaphoreValueCount = 2;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.signalSemaphoreCount = 2;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+    if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
         throw std::runtime_error("Failed to submit draw command buffer!");
     }
+    submittedFrameSerial = frameSerial;
+    frameSlotSerials[currentFrame] = frameSerial;
+    latencyTracker.markSubmit(frameSerial);
 
     // Present
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.pWaitSemaphores = &renderFinishedSemaphores[currentFrame];
 
     VkSwapchainKHR swapChains[] = { swapChain };
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = swapChains;
     presentInfo.pImageIndices = &currentImageIndex;  // Use stored index
 
+    // Tag the present with the frame serial so its display time can be queried
+    VkPresentIdKHR presentId{};
+    presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+    presentId.swapchainCount = 1;
+    presentId.pPresentIds = &frameSerial;
+    if (enabledFeatures.presentWait) {
+        presentInfo.pNext = &presentId;
+    }
+
     VkResult result = vkQueuePresentKHR(presentQueue, &presentInfo);
+    latencyTracker.markPresent(frameSerial);
+    if (enabledFeatures.presentWait && (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)) {
+        pendingPresentIds.push_back(frameSerial);
+    }
 
     // Handle out-of-date or suboptimal swapchain
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
@@ -809,7 +1724,7 @@ void VulkanContext::endFrame() {
     }
 
     // Move to next frame
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    currentFrame = (currentFrame + 1) % framesInFlight;
 }
 
 void VulkanContext::waitIdle()
@@ -826,42 +1741,166 @@ void VulkanContext::cleanupSwapChain() {
     for (auto framebuffer : swapChainFramebuffers) {
         vkDestroyFramebuffer(device, framebuffer, nullptr);
     }
+    swapChainFramebuffers.clear();
 
     for (auto imageView : swapChainImageViews) {
         vkDestroyImageView(device, imageView, nullptr);
     }
+    swapChainImageViews.clear();
+
+    if (config.headless) {
+        for (auto& image : offscreenImages) {
+            destroyImage(image);
+        }
+        for (auto& buffer : readbackBuffers) {
+            destroyBuffer(buffer);
+        }
+        offscreenImages.clear();
+        readbackBuffers.clear();
+        swapChainImages.clear();
+        lastSubmittedFrame = UINT32_MAX;
+        return;
+    }
 
     vkDestroySwapchainKHR(device, swapChain, nullptr);
+    swapChain = VK_NULL_HANDLE;
 }
 
 void VulkanContext::recreateSwapChain() {
-    int width = 0, height = 0;
-    width = window->getWidth();
-    height = window->getHeight();
+    // Offscreen targets have a fixed, configured extent
+    if (config.headless) {
+        return;
+    }
+    presentModeDirty = false;       // The rebuild picks up config.presentMode
 
-    while (width == 0 || height == 0) {
+    // Minimized: sleep until the window is restored instead of spinning
+    int width = window->getWidth();
+    int height = window->getHeight();
+
+    while ((width == 0 || height == 0) && !window->shouldClose()) {
+        window->waitEvents();
         width = window->getWidth();
         height = window->getHeight();
-        window->pollEvents();
     }
 
-    vkDeviceWaitIdle(device);
-
-    // Destroy old pipeline (viewport size depends on swapchain extent)
-    if (graphicsPipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(device, graphicsPipeline, nullptr);
-        graphicsPipeline = VK_NULL_HANDLE;
+    if (width == 0 || height == 0) {
+        return;
     }
 
-    cleanupSwapChain();
+    auto start = std::chrono::high_resolution_clock::now();
+    VkFormat oldFormat = swapChainImageFormat;
+
+    // Frames in flight may still render into the old views and framebuffers
+    VkSwapchainKHR oldSwapChain = swapChain;
+    std::vector<VkImageView> oldImageViews = std::move(swapChainImageViews);
+    std::vector<VkFramebuffer> oldFramebuffers = std::move(swapChainFramebuffers);
+    swapChainImageViews.clear();
+    swapChainFramebuffers.clear();
 
-    // Recreate with new size
+    // Passes the current swapchain as oldSwapchain; present ids are per swapchain
     createSwapChain();
+    pendingPresentIds.clear();
+
+    VkDevice device = this->device;
+    deferDestroy([device, oldSwapChain, oldImageViews, oldFramebuffers]() {
+        for (VkFramebuffer framebuffer : oldFramebuffers) {
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+        }
+        for (VkImageView imageView : oldImageViews) {
+            vkDestroyImageView(device, imageView, nullptr);
+        }
+        vkDestroySwapchainKHR(device, oldSwapChain, nullptr);
+    });
+
     createImageViews();
-    createGraphicsPipeline();  // ← Recreate with new viewport size
+
+    // Only a surface format change invalidates the render pass and pipeline.
+    // Dynamic rendering pipelines are keyed by format, so that path just looks
+    // up (or compiles) the pipeline for the new one. The render pass path is
+    // rare enough to justify a full wait.
+    if (swapChainImageFormat != oldFormat && enabledFeatures.dynamicRendering) {
+        createGraphicsPipeline();
+    } else if (swapChainImageFormat != oldFormat) {
+        vkDeviceWaitIdle(device);
+        deletionQueue.flushAll();
+
+        pipelineManager->evictRenderPass(renderPass);
+        vkDestroyRenderPass(device, renderPass, nullptr);
+        createRenderPass();
+        createGraphicsPipeline();
+    }
+
     createFramebuffers();
 
-    std::cout << "Swapchain recreated (" << width << "x" << height << ")" << std::endl;
+    lastSwapChainRecreateMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "Swapchain recreated (" << width << "x" << height << ", "
+              << lastSwapChainRecreateMs << " ms)" << std::endl;
+}
+
+void VulkanContext::pollPresentedFrames() {
+    // Non-blocking: display times are taken when noticed here, so they may
+    // lag the real scanout by up to one frame
+    while (!pendingPresentIds.empty()) {
+        VkResult result = waitForPresent(device, swapChain, pendingPresentIds.front(), 0);
+        if (result == VK_TIMEOUT) {
+            break;
+        }
+        if (result == VK_SUCCESS) {
+            latencyTracker.markDisplayed(pendingPresentIds.front());
+        }
+        pendingPresentIds.pop_front();
+    }
+}
+
+uint64_t VulkanContext::getCompletedFrameSerial() const {
+    uint64_t completed = 0;
+    vkGetSemaphoreCounterValue(device, frameTimeline, &completed);
+    return completed;
+}
+
+void VulkanContext::waitForFrameSerial(uint64_t serial) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (serial > 0) {
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &frameTimeline;
+        waitInfo.pValues = &serial;
+        vkWaitSemaphores(device, &waitInfo, UINT64_MAX);
+    }
+
+    pacingStats.lastCpuWaitMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    pacingStats.totalCpuWaitMs += pacingStats.lastCpuWaitMs;
+    pacingStats.waits++;
+}
+
+void VulkanContext::setFramesInFlight(uint32_t count) {
+    if (count < 1 || count > MAX_FRAMES_IN_FLIGHT) {
+        throw std::runtime_error("Frames in flight must be between 1 and " +
+                                 std::to_string(MAX_FRAMES_IN_FLIGHT) + "!");
+    }
+
+    // Per-frame resources exist for every slot; beginFrame applies the new
+    // depth and waits on the new slot's own last frame, so a frame being
+    // recorded keeps the slot and timeline values it began with
+    pendingFramesInFlight = count;
+}
+
+FramePacingStats VulkanContext::getFramePacingStats() const {
+    FramePacingStats stats = pacingStats;
+    stats.framesInFlight = framesInFlight;
+    stats.submittedFrames = submittedFrameSerial;
+    stats.completedFrames = device != VK_NULL_HANDLE ? getCompletedFrameSerial() : submittedFrameSerial;
+    return stats;
+}
+
+uint64_t VulkanContext::getLastUseFrameSerial() const {
+    // The frame being recorded has not been submitted yet
+    return frameStarted ? submittedFrameSerial + 1 : submittedFrameSerial;
 }
 
 // ==================== Cleanup ====================
@@ -878,29 +1917,59 @@ void VulkanContext::cleanup() {
     // CRITICAL: Wait for GPU before destroying anything
     vkDeviceWaitIdle(device);  // ← THIS LINE MUST BE FIRST
 
+    // Everything deferred is now unused; needs the allocator and surface alive
+    deletionQueue.flushAll();
+
     // Now safe to destroy sync objects
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < renderFinishedSemaphores.size(); i++) {
         if (renderFinishedSemaphores[i] != VK_NULL_HANDLE) {
             vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
         }
         if (imageAvailableSemaphores[i] != VK_NULL_HANDLE) {
             vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
         }
-        if (inFlightFences[i] != VK_NULL_HANDLE) {
-            vkDestroyFence(device, inFlightFences[i], nullptr);
-        }
     }
 
+    if (frameTimeline != VK_NULL_HANDLE) {
+        vkDestroySemaphore(device, frameTimeline, nullptr);
+        frameTimeline = VK_NULL_HANDLE;
+    }
+
+    gpuProfiler.reset();
+    stagingUploader.reset();
+
+    // Frees the per-frame primaries as well
+    if (commandRecorder) {
+        commandRecorder->destroy();
+        commandRecorder.reset();
+    }
+    commandBuffers.clear();
+
+    shaderWatcher.reset();
+
     if (commandPool != VK_NULL_HANDLE) {
         vkDestroyCommandPool(device, commandPool, nullptr);
     }
 
-    if (graphicsPipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    descriptorAllocator.reset();
+
+    // Owns graphicsPipeline and every other pipeline/shader module
+    if (pipelineManager) {
+        pipelineManager->destroy();
+        pipelineManager.reset();
+        graphicsPipeline = VK_NULL_HANDLE;
     }
 
-    if (pipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    // Owns pipelineLayout; set layouts go after the pipeline layouts using them
+    pipelineLayoutCache.reset();
+    pipelineLayout = VK_NULL_HANDLE;
+    descriptorLayoutCache.reset();
+
+    bindlessHeap.reset();
+
+    if (pipelineCache) {
+        pipelineCache->save();
+        pipelineCache.reset();
     }
 
     cleanupSwapChain();
@@ -909,8 +1978,13 @@ void VulkanContext::cleanup() {
         vkDestroyRenderPass(device, renderPass, nullptr);
     }
 
+    // Frees every remaining memory block
+    allocator.reset();
+
     vkDestroyDevice(device, nullptr);
     device = VK_NULL_HANDLE;  // ← Mark as cleaned
+
+    threadPool.reset();
 	
 	// Cleanup debug messenger if it was created
     if (enableValidationLayers && debugMessenger != VK_NULL_HANDLE) {
@@ -938,160 +2012,155 @@ void VulkanContext::cleanup() {
 
 // ==================== PipeLine ===================
 
+void VulkanContext::createPipelineManager() {
+    // Shared with the command recorder; also runs async pipeline compiles
+    threadPool = std::make_unique<ThreadPool>();
+
+    pipelineManager = std::make_unique<PipelineManager>(device, pipelineCache.get());
+    pipelineManager->setThreadPool(threadPool.get());
+}
+
+void VulkanContext::createBindlessHeap() {
+    if (!enabledFeatures.bindless) {
+        Logger::verbose("Descriptor indexing not supported, bindless heap disabled");
+        return;
+    }
+    bindlessHeap = std::make_unique<BindlessDescriptorHeap>(physicalDevice, device);
+}
+
+BindlessDescriptorHeap& VulkanContext::getBindlessHeap() {
+    if (!bindlessHeap) {
+        throw std::runtime_error("Bindless descriptor heap not supported!");
+    }
+    return *bindlessHeap;
+}
+
+void VulkanContext::createShaderWatcher() {
+    if (!config.shaderHotReload) {
+        return;
+    }
+
+    shaderWatcher = std::make_unique<ShaderWatcher>(config.shaderSourceDir, "shaders", config.shaderCompiler);
+    try {
+        shaderWatcher->start();
+    }
+    catch (const std::exception& e) {
+        // Hot reload is a convenience; run without it
+        Logger::error(std::string("Shader hot reload disabled: ") + e.what());
+        shaderWatcher.reset();
+    }
+}
+
+void VulkanContext::applyShaderReloads() {
+    if (!shaderWatcher) {
+        return;
+    }
+
+    for (const ShaderCompileResult& result : shaderWatcher->takeResults()) {
+        // A failed compile keeps the previous SPIR-V running
+        if (result.success) {
+            reloadShader("shaders/" + std::filesystem::path(result.outputPath).filename().string());
+        }
+    }
+}
+
+bool VulkanContext::reloadShader(const std::string& path) {
+    // Background compiles may still reference the module being replaced
+    pipelineManager->waitForPendingCompiles();
+
+    RetiredShaderObjects retired;
+    try {
+        if (!pipelineManager->reloadShader(path, retired)) {
+            return false;
+        }
+    }
+    catch (const std::exception& e) {
+        Logger::error(std::string("Failed to reload shader: ") + e.what());
+        return false;
+    }
+
+    // Frames still in flight may be executing the old pipelines
+    for (VkPipeline pipeline : retired.pipelines) {
+        deferDestroy(pipeline);
+    }
+    VkDevice device = this->device;
+    VkShaderModule module = retired.module;
+    deferDestroy([device, module]() { vkDestroyShaderModule(device, module, nullptr); });
+
+    // Features re-resolve their pipelines in prepare(); the built-in one is cached
+    // here. The layout is re-reflected too, and stays the same handle unless the
+    // shader's interface changed.
+    pipelineLayout = VK_NULL_HANDLE;
+    createGraphicsPipeline();
+    shaderReloadCount++;
+    return true;
+}
+
 void VulkanContext::createGraphicsPipeline() {
     std::cout << "  Creating graphics pipeline..." << std::endl;
 
-    // Load shaders
-    auto vertShaderCode = readFile("shaders/triangle.vert.spv");
-    auto fragShaderCode = readFile("shaders/triangle.frag.spv");
-
-    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
-
-    // Shader stages
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule;
-    vertShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule;
-    fragShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
-
-    // Vertex input (none - hardcoded in shader)
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 0;
-    vertexInputInfo.vertexAttributeDescriptionCount = 0;
-
-    // Input assembly
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-    // Viewport
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)swapChainExtent.width;
-    viewport.height = (float)swapChainExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
+    uint32_t vertexShader = pipelineManager->loadShader("shaders/triangle.vert.spv");
+    uint32_t fragmentShader = pipelineManager->loadShader("shaders/triangle.frag.spv");
+
+    // Pipeline layout reflected from the shaders. With bindless, the heap is
+    // set 0 and per-draw indices (material ID, ...) are push constants, so
+    // material switches never rebind descriptor sets.
+    if (pipelineLayout == VK_NULL_HANDLE) {
+        ShaderReflection reflection = SpirvReflection::merge({
+            pipelineManager->getShaderReflection(vertexShader),
+            pipelineManager->getShaderReflection(fragmentShader)
+        });
+
+        PipelineLayoutOverrides overrides;
+        if (bindlessHeap) {
+            VkPushConstantRange pushConstantRange{};
+            pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+            pushConstantRange.offset = 0;
+            pushConstantRange.size = BINDLESS_PUSH_CONSTANT_SIZE;
+
+            overrides.sets.emplace_back(0, bindlessHeap->getSetLayout());
+            overrides.pushConstants.push_back(pushConstantRange);
+        }
 
-    VkRect2D scissor{};
-    scissor.offset = { 0, 0 };
-    scissor.extent = swapChainExtent;
+        pipelineLayout = pipelineLayoutCache->getLayout(reflection, overrides);
+    }
+
+    // Vertex layout from the shader's inputs (none: triangle.vert hardcodes its vertices)
+    PipelineStateDesc desc;
+    desc.vertexShader = vertexShader;
+    desc.fragmentShader = fragmentShader;
+    desc.setVertexInputs(pipelineManager->getShaderReflection(vertexShader));
+    desc.cullMode = VK_CULL_MODE_BACK_BIT;
+    desc.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    desc.blend = BlendMode::Opaque;
+    desc.layout = pipelineLayout;
+    setMainPassTarget(desc);
+
+    uint64_t compilesBefore = pipelineManager->getStats().compiles;
+    uint32_t hitsBefore = pipelineCache->getStats().hits;
+    auto compileStart = std::chrono::high_resolution_clock::now();
+
+    // Compiled up front: it is also what getPipelineAsync draws with for
+    // pipelines on this layout and render pass that are still compiling
+    pipelineManager->registerFallback(desc);
+    graphicsPipeline = pipelineManager->getPipeline(desc);
+
+    double compileMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - compileStart).count();
+
+    if (pipelineManager->getStats().compiles == compilesBefore) {
+        std::cout << "  ✓ Graphics pipeline reused" << std::endl;
+        return;
+    }
+
+    bool cacheHit = pipelineCache->getStats().hits > hitsBefore;
+    std::cout << "  ✓ Graphics pipeline created (cache " << (cacheHit ? "hit" : "miss")
+              << ", " << compileMs << " ms)" << std::endl;
+}
 
-    VkPipelineViewportStateCreateInfo viewportState{};
-    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
-    viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
-
-    // Rasterizer
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-
-    // Multisampling
-    VkPipelineMultisampleStateCreateInfo multisampling{};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-    // Color blending
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-        VK_COLOR_COMPONENT_G_BIT |
-        VK_COLOR_COMPONENT_B_BIT |
-        VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-
-    VkPipelineColorBlendStateCreateInfo colorBlending{};
-    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.logicOpEnable = VK_FALSE;
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
-
-    // Pipeline layout
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-
-    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create pipeline layout!");
-    }
-
-    // Graphics pipeline
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
-    pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pDepthStencilState = nullptr;
-    pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.pDynamicState = nullptr;
-    pipelineInfo.layout = pipelineLayout;
-    pipelineInfo.renderPass = renderPass;
-    pipelineInfo.subpass = 0;
-    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create graphics pipeline!");
-    }
-
-    // Cleanup shader modules (no longer needed after pipeline creation)
-    vkDestroyShaderModule(device, fragShaderModule, nullptr);
-    vkDestroyShaderModule(device, vertShaderModule, nullptr);
-
-    std::cout << "  ✓ Graphics pipeline created" << std::endl;
-}
-
-std::vector<char> VulkanContext::readFile(const std::string& filename) {
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
-
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open file: " + filename);
-    }
-
-    size_t fileSize = (size_t)file.tellg();
-    std::vector<char> buffer(fileSize);
-
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-    file.close();
-
-    return buffer;
-}
-
-VkShaderModule VulkanContext::createShaderModule(const std::vector<char>& code) {
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-
-    VkShaderModule shaderModule;
-    if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to create shader module!");
-    }
-
-    return shaderModule;
-}
\ No newline at end of file
+PipelineManager& VulkanContext::getPipelineManager() {
+    if (!pipelineManager) {
+        throw std::runtime_error("Pipeline manager not initialized!");
+    }
+    return *pipelineManager;
+}
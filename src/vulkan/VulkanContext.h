@@ -2,29 +2,96 @@
 
 #include "../interfaces/IGraphicsContext.h"
 #include "../interfaces/IWindow.h"
+#include "GpuAllocator.h"
+#include "PipelineCache.h"
+#include "PipelineManager.h"
+#include "ParallelCommandRecorder.h"
+#include "GpuProfiler.h"
+#include "StagingUploader.h"
+#include "IRenderFeature.h"
+#include "BindlessDescriptorHeap.h"
+#include "DescriptorAllocator.h"
+#include "PipelineLayoutCache.h"
+#include "../memory/DeletionQueue.h"
+#include "../utils/ThreadPool.h"
+#include "../utils/LatencyTracker.h"
+#include "../utils/ShaderWatcher.h"
+#include "../utils/DeviceSelector.h"
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <string>
 #include <optional>
+#include <deque>
+#include <memory>
 
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    std::optional<uint32_t> transferFamily;     // Non-graphics transfer family, if any
 
     bool isComplete() const {
         return graphicsFamily.has_value() && presentFamily.has_value();
     }
 };
 
+// Optional device features, enabled at device creation when supported
+struct EnabledFeatures {
+    bool drawIndirectCount = false;             // vkCmdDrawIndexedIndirectCount (1.2)
+    bool multiDrawIndirect = false;             // drawCount > 1 in vkCmdDraw*Indirect
+    bool drawIndirectFirstInstance = false;     // non-zero firstInstance in indirect draws
+    bool presentWait = false;                   // VK_KHR_present_id + VK_KHR_present_wait
+    bool bindless = false;                      // descriptor indexing for BindlessDescriptorHeap
+    bool synchronization2 = false;              // vkCmdPipelineBarrier2 (1.3) for VulkanRenderGraph
+    bool dynamicRendering = false;              // vkCmdBeginRendering (1.3) instead of render pass objects
+};
+
 struct SwapChainSupportDetails {
     VkSurfaceCapabilitiesKHR capabilities;
     std::vector<VkSurfaceFormatKHR> formats;
     std::vector<VkPresentModeKHR> presentModes;
 };
 
+/**
+ * VulkanContextConfig - Startup options for VulkanContext
+ *
+ * In headless mode no surface or swapchain is created: frames render into
+ * device-local images sized by width/height, and the window may be null.
+ * This runs on display-less machines and software ICDs such as lavapipe.
+ */
+struct VulkanContextConfig {
+    bool headless = false;
+    uint32_t width = 1280;                              // Offscreen extent (headless only)
+    uint32_t height = 720;
+    VkFormat offscreenFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    bool enableReadback = false;                        // Copy each frame to host memory
+    uint32_t framesInFlight = 2;                        // 1..VulkanContext::MAX_FRAMES_IN_FLIGHT
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;  // Falls back to FIFO
+    bool dynamicRendering = true;                       // Falls back to VkRenderPass + VkFramebuffer
+    std::string device;                                 // Adapter index or name substring; empty = best score
+
+    // Development: recompile shaders/ sources on save and swap pipelines in
+    bool shaderHotReload = false;
+    std::string shaderSourceDir = "../shaders";        // GLSL sources, relative to the working dir
+    std::string shaderCompiler = "glslc";
+};
+
+struct FramePacingStats {
+    uint32_t framesInFlight = 0;
+    uint64_t submittedFrames = 0;       // Timeline value of the newest submit
+    uint64_t completedFrames = 0;       // Timeline value the GPU has reached
+    double lastCpuWaitMs = 0.0;         // beginFrame's wait for the GPU
+    double totalCpuWaitMs = 0.0;
+    uint64_t waits = 0;
+
+    double averageCpuWaitMs() const { return waits > 0 ? totalCpuWaitMs / waits : 0.0; }
+};
+
 class VulkanContext : public IGraphicsContext {
 public:
-    VulkanContext(IWindow* window);
+    // Per-frame resources are created for this many slots
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+    VulkanContext(IWindow* window, const VulkanContextConfig& config = VulkanContextConfig{});
     ~VulkanContext() override;
 
     void initialize() override;
@@ -33,8 +100,130 @@ public:
     void waitIdle();
     void cleanup() override;
 
+    // Resource creation (sub-allocated from GpuAllocator blocks)
+    GpuBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                           VkMemoryPropertyFlags properties, uint32_t allocationFlags = GPU_ALLOCATION_NONE);
+    void destroyBuffer(GpuBuffer& buffer);
+    GpuImage createImage(const VkImageCreateInfo& imageInfo,
+                         VkMemoryPropertyFlags properties, uint32_t allocationFlags = GPU_ALLOCATION_NONE);
+    void destroyImage(GpuImage& image);
+
+    // Destroy once every frame that may reference the resource has completed
+    // on the GPU; no device-wide wait. Safe to call mid-frame.
+    void deferDestroy(GpuBuffer& buffer);
+    void deferDestroy(GpuImage& image);
+    void deferDestroy(VkPipeline pipeline);
+    void deferDestroy(VkDescriptorPool pool);
+    void deferDestroy(DeletionQueue::Deleter deleter);
+    size_t getPendingDeletionCount() const { return deletionQueue.size(); }
+
+    GpuAllocator& getAllocator();
+    std::vector<GpuHeapStats> getMemoryStats() const;
+
+    PipelineCacheStats getPipelineCacheStats() const;
+
+    // Rebuilds swapchain, image views and (without dynamic rendering) framebuffers for the current window
+    // size. Called automatically on OUT_OF_DATE/SUBOPTIMAL. Does not wait for
+    // the GPU: the old swapchain is handed to the new one and retired later.
+    void recreateSwapChain();
+    double getLastSwapChainRecreateMs() const { return lastSwapChainRecreateMs; }
+    VkPipeline getGraphicsPipeline() const { return graphicsPipeline; }
+
+    // Deduplicated pipeline creation for materials
+    PipelineManager& getPipelineManager();
+    // VK_NULL_HANDLE under dynamic rendering; use setMainPassTarget instead
+    VkRenderPass getRenderPass() const { return renderPass; }
+    // Points a pipeline at the main pass: its render pass, or its attachment
+    // formats under dynamic rendering
+    void setMainPassTarget(PipelineStateDesc& desc) const;
+    VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
+
+    // Shared texture/buffer heap, bound at set 0 of getPipelineLayout() in
+    // every secondary. Throws unless getEnabledFeatures().bindless.
+    BindlessDescriptorHeap& getBindlessHeap();
+    static constexpr uint32_t BINDLESS_PUSH_CONSTANT_SIZE = 16;    // Per-draw indices (material ID, ...)
+
+    // Non-bindless descriptors: allocate() sets live until this frame slot's
+    // next beginFrame; layouts are deduplicated by their bindings
+    DescriptorAllocator& getDescriptorAllocator();
+    DescriptorLayoutCache& getDescriptorLayoutCache();
+
+    // Pipeline layouts built from shader reflection, shared between pipelines
+    // with the same interface
+    PipelineLayoutCache& getPipelineLayoutCache();
+
+    // Records taskCount secondary command buffers on the thread pool and
+    // executes them inside the current frame's render pass. Only valid
+    // between beginFrame() and endFrame(); viewport and scissor are already
+    // set when fn runs. fn is called concurrently from several threads.
+    void recordSecondary(uint32_t taskCount, const ParallelCommandRecorder::RecordFn& fn);
+
+    // Features are prepared on the frame's primary before the render pass and
+    // draw in their own secondary inside it. Not owned; remove before deleting.
+    void addRenderFeature(IRenderFeature* feature);
+    void removeRenderFeature(IRenderFeature* feature);
+
+    VkDevice getDevice() const { return device; }
+
+    // How many frames the CPU may run ahead of the GPU (1..MAX_FRAMES_IN_FLIGHT).
+    // Lower trades throughput for latency; takes effect at the next beginFrame.
+    void setFramesInFlight(uint32_t count);
+    // The depth frames are currently recorded with (not a pending change)
+    uint32_t getFramesInFlight() const { return framesInFlight; }
+
+    // Size per-frame resources by this; frame indices are always below it
+    uint32_t getFrameSlotCount() const { return MAX_FRAMES_IN_FLIGHT; }
+    // Slot of the frame being recorded; after beginFrame its previous GPU use is complete
+    uint32_t getCurrentFrameIndex() const { return currentFrame; }
+
+    // CPU time blocked on the GPU: high = GPU bound, ~0 = CPU bound
+    FramePacingStats getFramePacingStats() const;
+    const EnabledFeatures& getEnabledFeatures() const { return enabledFeatures; }
+    // The adapter pickPhysicalDevice chose and what it was scored on
+    const DeviceProfile& getDeviceProfile() const { return deviceProfile; }
+
+    // IMMEDIATE, MAILBOX, FIFO or FIFO_RELAXED; rebuilds the swapchain when it
+    // changes, at the next beginFrame if a frame is being recorded. Returns
+    // false if the mode is unsupported and FIFO is used instead.
+    bool setPresentMode(VkPresentModeKHR mode);
+    VkPresentModeKHR getPresentMode() const { return presentMode; }
+    std::vector<VkPresentModeKHR> getSupportedPresentModes();
+
+    // Call markInput() right after polling window events; submit, present and
+    // (with presentWait) display times are recorded by the context
+    LatencyTracker& getLatencyTracker() { return latencyTracker; }
+
+    // Swaps in a recompiled .spv (as passed to loadShader) between frames.
+    // Hot reload (config.shaderHotReload) calls this from beginFrame.
+    bool reloadShader(const std::string& path);
+    uint64_t getShaderReloadCount() const { return shaderReloadCount; }
+
+    // Time the previous frame spent blocked compiling pipelines synchronously
+    // (PipelineManager::getPipeline); getPipelineAsync misses never stall
+    double getLastFrameCompileStallMs() const { return lastFrameCompileStallMs; }
+
+    // Headless mode
+    bool isHeadless() const { return config.headless; }
+    VkExtent2D getExtent() const { return swapChainExtent; }
+
+    // Copies the most recently submitted frame into `pixels` (tightly packed,
+    // 4 bytes per pixel), waiting for that frame to finish on the GPU.
+    // Returns false unless headless readback is enabled and a frame was rendered.
+    bool readbackLastFrame(std::vector<uint8_t>& pixels);
+    ThreadPool& getThreadPool();
+
+    // Per-pass GPU timings ("frame", "main_pass", ...); open extra scopes
+    // with GpuProfiler::Scope inside recordSecondary callbacks
+    GpuProfiler& getGpuProfiler();
+
+    // Streams data into device-local buffers/images; queued copies are
+    // submitted in one batch at the next beginFrame()
+    StagingUploader& getStagingUploader();
+    ParallelRecorderStats getRecorderStats() const;
+
 private:
     IWindow* window;
+    VulkanContextConfig config;
 
     // Vulkan objects
     VkInstance instance;
@@ -44,25 +233,79 @@ private:
     VkDevice device;
     VkQueue graphicsQueue;
     VkQueue presentQueue;
+    VkQueue transferQueue;      // == graphicsQueue without a dedicated family
     VkSwapchainKHR swapChain;
     std::vector<VkImage> swapChainImages;
     VkFormat swapChainImageFormat;
     VkExtent2D swapChainExtent;
+    VkPresentModeKHR presentMode;
+    bool presentModeDirty;                      // config.presentMode changed mid-frame
     std::vector<VkImageView> swapChainImageViews;
-    VkRenderPass renderPass;
+    VkRenderPass renderPass;                    // Null under dynamic rendering
     VkPipelineLayout pipelineLayout;
     VkPipeline graphicsPipeline;
-    std::vector<VkFramebuffer> swapChainFramebuffers;
-    VkCommandPool commandPool;
-    std::vector<VkCommandBuffer> commandBuffers;
+    std::vector<VkFramebuffer> swapChainFramebuffers;  // Empty under dynamic rendering
+
+    // Headless render targets; their images are mirrored in swapChainImages
+    std::vector<GpuImage> offscreenImages;
+    std::vector<GpuBuffer> readbackBuffers;   // One per frame in flight
+    uint32_t lastSubmittedFrame;
+    VkCommandPool commandPool;                      // One-off commands; frames use commandRecorder
+    std::unique_ptr<DescriptorAllocator> descriptorAllocator;       // Reset per frame slot
+    std::unique_ptr<DescriptorLayoutCache> descriptorLayoutCache;
+    std::unique_ptr<PipelineLayoutCache> pipelineLayoutCache;     // Owns pipelineLayout
+    std::vector<VkCommandBuffer> commandBuffers;    // Per-frame primaries owned by commandRecorder
+
+    // Parallel recording (per-thread, per-frame command pools)
+    std::unique_ptr<ThreadPool> threadPool;
+    std::unique_ptr<ParallelCommandRecorder> commandRecorder;
+    std::vector<VkCommandBuffer> pendingSecondaries;
+    bool frameStarted;
+
+    // GPU timestamps
+    std::unique_ptr<GpuProfiler> gpuProfiler;
+    uint32_t frameScope;
+    uint32_t mainPassScope;
+
+    // Runtime streaming
+    std::unique_ptr<StagingUploader> stagingUploader;
+    VkSemaphore uploadWaitSemaphore;
+
+    std::vector<IRenderFeature*> renderFeatures;
+    EnabledFeatures enabledFeatures;
+    DeviceProfile deviceProfile;
+
+    // Device memory
+    std::unique_ptr<GpuAllocator> allocator;
+
+    // Persistent pipeline cache (loaded in initialize, saved in cleanup)
+    std::unique_ptr<PipelineCache> pipelineCache;
+    std::unique_ptr<PipelineManager> pipelineManager;
+    double compileStallMsAtFrameStart;          // PipelineManagerStats::stallMs at the last beginFrame
+    double lastFrameCompileStallMs;
+    std::unique_ptr<BindlessDescriptorHeap> bindlessHeap;
 
     // Synchronization
     std::vector<VkSemaphore> imageAvailableSemaphores;
     std::vector<VkSemaphore> renderFinishedSemaphores;
-    std::vector<VkFence> inFlightFences;
+    VkSemaphore frameTimeline;                  // Signals the frame serial on completion
+    std::vector<uint64_t> frameSlotSerials;     // Serial last submitted from each slot
+    uint64_t submittedFrameSerial;              // Frames submitted so far
+    DeletionQueue deletionQueue;                // Tagged with frame serials
+
+    // Shader hot reload, applied at the start of beginFrame
+    std::unique_ptr<ShaderWatcher> shaderWatcher;
+    uint64_t shaderReloadCount;
+
+    // Latency measurement
+    LatencyTracker latencyTracker;
+    PFN_vkWaitForPresentKHR waitForPresent;
+    std::deque<uint64_t> pendingPresentIds;     // Presented, not yet known displayed
     uint32_t currentFrame;
     uint32_t currentImageIndex;
-    const int MAX_FRAMES_IN_FLIGHT = 2;
+    uint32_t framesInFlight;
+    uint32_t pendingFramesInFlight;             // 0: no change requested
+    FramePacingStats pacingStats;
 	
 	 // Validation layers
     const std::vector<const char*> validationLayers = {
@@ -93,32 +336,50 @@ private:
     void createInstance();
     void createSurface();
     void pickPhysicalDevice();
+    DeviceProfile queryDeviceProfile(VkPhysicalDevice device, uint32_t index);
     void createLogicalDevice();
+    void createAllocator();
+    void createPipelineCache();
+    void createPipelineManager();
+    void createBindlessHeap();
+    void createShaderWatcher();
+    void applyShaderReloads();
     void createSwapChain();
+    void createOffscreenTargets();
     void createImageViews();
     void createRenderPass();
     void createFramebuffers();
+    void beginMainPass(VkCommandBuffer commandBuffer);
+    void endMainPass(VkCommandBuffer commandBuffer);
     void createCommandPool();
+    void createDescriptorAllocator();
+    void createCommandRecorder();
     void createCommandBuffers();
+    void createGpuProfiler();
+    void createStagingUploader();
     void createSyncObjects();
 
     //Swap chain recreation
 
-    void recreateSwapChain();
     void cleanupSwapChain();
+    uint64_t getCompletedFrameSerial() const;
+    void waitForFrameSerial(uint64_t serial);
+    void pollPresentedFrames();
+    uint64_t getLastUseFrameSerial() const;
+    double lastSwapChainRecreateMs;
 
     // Helper functions
     bool isDeviceSuitable(VkPhysicalDevice device);
     QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device);
     bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+    static bool isDeviceExtensionAvailable(VkPhysicalDevice device, const char* name);
+    std::vector<const char*> getRequiredDeviceExtensions() const;
     SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
     VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
     VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
 
     void createGraphicsPipeline();
-    VkShaderModule createShaderModule(const std::vector<char>& code);
-    std::vector<char> readFile(const std::string& filename);
 
     // Device extensions
     const std::vector<const char*> deviceExtensions = {
@@ -0,0 +1,205 @@
+#include "VulkanDrawBackend.h"
+#include "VulkanContext.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+VulkanDrawBackend::VulkanDrawBackend(VulkanContext& context)
+    : context(context)
+    , pipelines()
+    , materials()
+    , meshes()
+    , instanceBuffers(context.getFrameSlotCount())
+    , instanceCapacities(context.getFrameSlotCount(), 0)
+    , frameInstanceBuffer(VK_NULL_HANDLE)
+    , commands()
+    , segments()
+    , boundPipeline(NONE)
+    , boundMaterial(NONE)
+    , boundMesh(NONE)
+    , segmentDraws(0)
+    , lastSecondaryCount(0)
+{
+}
+
+VulkanDrawBackend::~VulkanDrawBackend() {
+    destroy();
+}
+
+void VulkanDrawBackend::destroy() {
+    // Frames in flight may still read them
+    for (uint32_t i = 0; i < instanceBuffers.size(); i++) {
+        context.deferDestroy(instanceBuffers[i]);
+        instanceCapacities[i] = 0;
+    }
+    frameInstanceBuffer = VK_NULL_HANDLE;
+}
+
+VkBuffer VulkanDrawBackend::getInstanceBuffer(uint32_t frameIndex) const {
+    return instanceBuffers[frameIndex].buffer;
+}
+
+// ==================== Registration ====================
+
+uint32_t VulkanDrawBackend::addPipeline(VkPipeline pipeline, VkPipelineLayout layout) {
+    if (pipeline == VK_NULL_HANDLE) {
+        throw std::runtime_error("VulkanDrawBackend: pipeline must not be null!");
+    }
+    pipelines.push_back({ pipeline, layout });
+    return static_cast<uint32_t>(pipelines.size() - 1);
+}
+
+uint32_t VulkanDrawBackend::addMaterial(VkDescriptorSet descriptorSet, uint32_t setIndex) {
+    materials.push_back({ descriptorSet, setIndex });
+    return static_cast<uint32_t>(materials.size() - 1);
+}
+
+uint32_t VulkanDrawBackend::addMesh(const VulkanDrawMesh& mesh) {
+    meshes.push_back(mesh);
+    return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+// ==================== IDrawBackend ====================
+
+void VulkanDrawBackend::beginDraws() {
+    commands.clear();
+    segments.clear();
+    boundPipeline = NONE;
+    boundMaterial = NONE;
+    boundMesh = NONE;
+    segmentDraws = DRAWS_PER_SECONDARY;     // First draw opens a segment
+    frameInstanceBuffer = VK_NULL_HANDLE;
+}
+
+void VulkanDrawBackend::setInstances(const DrawInstance* instances, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    // The slot's previous frame has finished on the GPU, so its buffer is free
+    const uint32_t frameIndex = context.getCurrentFrameIndex();
+    GpuBuffer& buffer = instanceBuffers[frameIndex];
+    if (count > instanceCapacities[frameIndex]) {
+        context.deferDestroy(buffer);
+        uint32_t capacity = std::max(instanceCapacities[frameIndex] * 2, std::max(count, 1024u));
+        buffer = context.createBuffer(sizeof(DrawInstance) * capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        instanceCapacities[frameIndex] = capacity;
+    }
+
+    std::memcpy(buffer.allocation.mappedData, instances, sizeof(DrawInstance) * count);
+    frameInstanceBuffer = buffer.buffer;
+}
+
+void VulkanDrawBackend::bindPipeline(uint32_t pipeline) {
+    if (pipeline >= pipelines.size()) {
+        throw std::runtime_error("VulkanDrawBackend: unknown pipeline ID!");
+    }
+    commands.push_back({ CommandType::Pipeline, pipeline, 0 });
+    boundPipeline = pipeline;
+    boundMaterial = NONE;
+}
+
+void VulkanDrawBackend::bindMaterial(uint32_t material) {
+    if (material >= materials.size()) {
+        throw std::runtime_error("VulkanDrawBackend: unknown material ID!");
+    }
+    commands.push_back({ CommandType::Material, material, 0 });
+    boundMaterial = material;
+}
+
+void VulkanDrawBackend::bindMesh(uint32_t mesh) {
+    if (mesh >= meshes.size()) {
+        throw std::runtime_error("VulkanDrawBackend: unknown mesh ID!");
+    }
+    commands.push_back({ CommandType::Mesh, mesh, 0 });
+    boundMesh = mesh;
+}
+
+void VulkanDrawBackend::draw(uint32_t firstInstance, uint32_t instanceCount) {
+    if (boundPipeline == NONE || boundMesh == NONE) {
+        throw std::runtime_error("VulkanDrawBackend: draw without a bound pipeline and mesh!");
+    }
+
+    // Start a new secondary at this draw; the binds just before it are
+    // already captured in the segment's starting state
+    if (segmentDraws == DRAWS_PER_SECONDARY) {
+        segments.push_back({ static_cast<uint32_t>(commands.size()), boundPipeline, boundMaterial, boundMesh });
+        segmentDraws = 0;
+    }
+    commands.push_back({ CommandType::Draw, firstInstance, instanceCount });
+    segmentDraws++;
+}
+
+void VulkanDrawBackend::endDraws() {
+    lastSecondaryCount = static_cast<uint32_t>(segments.size());
+    if (segments.empty()) {
+        return;
+    }
+    context.recordSecondary(lastSecondaryCount, [this](VkCommandBuffer commandBuffer, uint32_t segmentIndex) {
+        replay(commandBuffer, segmentIndex);
+    });
+}
+
+// ==================== Recording ====================
+
+void VulkanDrawBackend::replay(VkCommandBuffer commandBuffer, uint32_t segmentIndex) const {
+    const Segment& segment = segments[segmentIndex];
+    const uint32_t end = segmentIndex + 1 < segments.size()
+        ? segments[segmentIndex + 1].begin : static_cast<uint32_t>(commands.size());
+
+    // Secondaries inherit no state
+    if (frameInstanceBuffer != VK_NULL_HANDLE) {
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(commandBuffer, INSTANCE_BINDING, 1, &frameInstanceBuffer, &offset);
+    }
+    ReplayState state;
+    record(commandBuffer, { CommandType::Pipeline, segment.pipeline, 0 }, state);
+    if (segment.material != NONE) {
+        record(commandBuffer, { CommandType::Material, segment.material, 0 }, state);
+    }
+    record(commandBuffer, { CommandType::Mesh, segment.mesh, 0 }, state);
+
+    for (uint32_t i = segment.begin; i < end; i++) {
+        record(commandBuffer, commands[i], state);
+    }
+}
+
+void VulkanDrawBackend::record(VkCommandBuffer commandBuffer, const Command& command, ReplayState& state) const {
+    switch (command.type) {
+    case CommandType::Pipeline:
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[command.first].pipeline);
+        state.pipeline = command.first;
+        break;
+    case CommandType::Material: {
+        const MaterialEntry& material = materials[command.first];
+        if (material.descriptorSet != VK_NULL_HANDLE) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[state.pipeline].layout,
+                                    material.setIndex, 1, &material.descriptorSet, 0, nullptr);
+        }
+        break;
+    }
+    case CommandType::Mesh: {
+        const VulkanDrawMesh& mesh = meshes[command.first];
+        if (mesh.vertexBuffer != VK_NULL_HANDLE) {
+            VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mesh.vertexBuffer, &offset);
+        }
+        if (mesh.indexBuffer != VK_NULL_HANDLE) {
+            vkCmdBindIndexBuffer(commandBuffer, mesh.indexBuffer, 0, mesh.indexType);
+        }
+        state.mesh = command.first;
+        break;
+    }
+    case CommandType::Draw: {
+        const VulkanDrawMesh& mesh = meshes[state.mesh];
+        if (mesh.indexBuffer != VK_NULL_HANDLE) {
+            vkCmdDrawIndexed(commandBuffer, mesh.count, command.count, 0, 0, command.first);
+        } else {
+            vkCmdDraw(commandBuffer, mesh.count, command.count, 0, command.first);
+        }
+        break;
+    }
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "../interfaces/IDrawBackend.h"
+#include "GpuAllocator.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+class VulkanContext;
+
+struct VulkanDrawMesh {
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;     // Bound at binding 0; null for shaders that need none
+    VkBuffer indexBuffer = VK_NULL_HANDLE;      // Null: vkCmdDraw of `count` vertices
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    uint32_t count = 0;                         // Index count, or vertex count without indices
+};
+
+/**
+ * VulkanDrawBackend - IDrawBackend over VulkanContext secondaries
+ *
+ * Maps the renderer's IDs to registered pipelines, descriptor sets and
+ * buffers. Calls are validated and buffered as they arrive; endDraws()
+ * replays them into secondaries of the current frame's main pass (so
+ * beginDraws/endDraws must run between beginFrame and endFrame). Streams
+ * longer than DRAWS_PER_SECONDARY are split and recorded in parallel, each
+ * secondary starting by rebinding the state in effect where it begins.
+ *
+ * Instances are copied into a host-visible buffer per frame slot (grown by
+ * doubling) bound at INSTANCE_BINDING; pipelines that use them declare it
+ * as a VK_VERTEX_INPUT_RATE_INSTANCE binding with a DrawInstance stride.
+ * Pipelines that ignore it are unaffected. Destroy before the context.
+ */
+class VulkanDrawBackend : public IDrawBackend {
+public:
+    static constexpr uint32_t DRAWS_PER_SECONDARY = 1024;
+    static constexpr uint32_t INSTANCE_BINDING = 1;
+
+    explicit VulkanDrawBackend(VulkanContext& context);
+    ~VulkanDrawBackend() override;
+
+    VulkanDrawBackend(const VulkanDrawBackend&) = delete;
+    VulkanDrawBackend& operator=(const VulkanDrawBackend&) = delete;
+
+    // Each returns the ID to use in RenderMaterial / MeshComponent. Handles are not owned.
+    uint32_t addPipeline(VkPipeline pipeline, VkPipelineLayout layout);
+    // A null set binds nothing (pipelines without per-material descriptors)
+    uint32_t addMaterial(VkDescriptorSet descriptorSet, uint32_t setIndex);
+    uint32_t addMesh(const VulkanDrawMesh& mesh);
+
+    void beginDraws() override;
+    void setInstances(const DrawInstance* instances, uint32_t count) override;
+    void bindPipeline(uint32_t pipeline) override;
+    void bindMaterial(uint32_t material) override;
+    void bindMesh(uint32_t mesh) override;
+    void draw(uint32_t firstInstance, uint32_t instanceCount) override;
+    void endDraws() override;
+
+    // Secondaries recorded by the last endDraws
+    uint32_t getLastSecondaryCount() const { return lastSecondaryCount; }
+    // Instance buffer of a frame slot; VK_NULL_HANDLE until it has held instances
+    VkBuffer getInstanceBuffer(uint32_t frameIndex) const;
+    void destroy();
+
+private:
+    static constexpr uint32_t NONE = ~0u;
+
+    enum class CommandType : uint8_t { Pipeline, Material, Mesh, Draw };
+
+    struct Command {
+        CommandType type;
+        uint32_t first;     // ID, or firstInstance for draws
+        uint32_t count;     // instanceCount for draws
+    };
+
+    struct PipelineEntry {
+        VkPipeline pipeline;
+        VkPipelineLayout layout;
+    };
+
+    struct MaterialEntry {
+        VkDescriptorSet descriptorSet;
+        uint32_t setIndex;
+    };
+
+    // Where a secondary starts in `commands` and what is bound there
+    struct Segment {
+        uint32_t begin;
+        uint32_t pipeline;
+        uint32_t material;
+        uint32_t mesh;
+    };
+
+    VulkanContext& context;
+    std::vector<PipelineEntry> pipelines;
+    std::vector<MaterialEntry> materials;
+    std::vector<VulkanDrawMesh> meshes;
+
+    // Per frame slot
+    std::vector<GpuBuffer> instanceBuffers;
+    std::vector<uint32_t> instanceCapacities;
+    VkBuffer frameInstanceBuffer;       // Bound by every secondary of the current frame
+
+    std::vector<Command> commands;
+    std::vector<Segment> segments;
+    uint32_t boundPipeline;
+    uint32_t boundMaterial;
+    uint32_t boundMesh;
+    uint32_t segmentDraws;
+    uint32_t lastSecondaryCount;
+
+    // What a secondary has bound so far while replaying
+    struct ReplayState {
+        uint32_t pipeline = NONE;
+        uint32_t mesh = NONE;
+    };
+
+    void replay(VkCommandBuffer commandBuffer, uint32_t segmentIndex) const;
+    void record(VkCommandBuffer commandBuffer, const Command& command, ReplayState& state) const;
+};
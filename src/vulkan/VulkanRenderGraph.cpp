@@ -0,0 +1,406 @@
+#include "VulkanRenderGraph.h"
+#include "VulkanContext.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+struct UsageInfo {
+    VkPipelineStageFlags2 stage;
+    VkAccessFlags2 access;
+    VkImageLayout layout;
+};
+
+// Only flags that also exist in the original synchronization API, so the
+// fallback path can pass them to vkCmdPipelineBarrier unchanged
+UsageInfo getUsageInfo(RenderGraphUsage usage) {
+    switch (usage) {
+    case RenderGraphUsage::ColorAttachment:
+        return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                 VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                 VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    case RenderGraphUsage::DepthAttachment:
+        return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                 VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                 VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+    case RenderGraphUsage::DepthRead:
+        return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT |
+                     VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                 VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT,
+                 VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+    case RenderGraphUsage::Sampled:
+        return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                 VK_ACCESS_2_SHADER_READ_BIT,
+                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    case RenderGraphUsage::StorageRead:
+        return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                 VK_ACCESS_2_SHADER_READ_BIT,
+                 VK_IMAGE_LAYOUT_GENERAL };
+    case RenderGraphUsage::StorageWrite:
+        return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                 VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,
+                 VK_IMAGE_LAYOUT_GENERAL };
+    case RenderGraphUsage::TransferSrc:
+        return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                 VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+    case RenderGraphUsage::TransferDst:
+        return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+    case RenderGraphUsage::Present:
+        return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+    case RenderGraphUsage::None:
+    default:
+        return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED };
+    }
+}
+
+VkImageUsageFlags getImageUsage(RenderGraphUsage usage) {
+    switch (usage) {
+    case RenderGraphUsage::ColorAttachment: return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    case RenderGraphUsage::DepthAttachment: return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    case RenderGraphUsage::DepthRead:       return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    case RenderGraphUsage::Sampled:         return VK_IMAGE_USAGE_SAMPLED_BIT;
+    case RenderGraphUsage::StorageRead:
+    case RenderGraphUsage::StorageWrite:    return VK_IMAGE_USAGE_STORAGE_BIT;
+    case RenderGraphUsage::TransferSrc:     return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    case RenderGraphUsage::TransferDst:     return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    default:                                return 0;
+    }
+}
+
+}
+
+VulkanRenderGraph::VulkanRenderGraph(VulkanContext& context)
+    : context(context)
+    , device(context.getDevice())
+    , synchronization2(context.getEnabledFeatures().synchronization2)
+    , compiled(false)
+{
+}
+
+VulkanRenderGraph::~VulkanRenderGraph() {
+    destroy();
+}
+
+// ==================== Declaration ====================
+
+RenderGraphResource VulkanRenderGraph::createTexture(const std::string& name, uint32_t width, uint32_t height,
+                                                     VkFormat format) {
+    RenderGraphTextureDesc desc;
+    desc.width = width;
+    desc.height = height;
+    desc.format = static_cast<uint32_t>(format);
+
+    RenderGraphResource resource = graph.createTexture(name, desc);
+    textures.resize(graph.getResourceCount());
+    textures[resource].format = format;
+    compiled = false;
+    return resource;
+}
+
+RenderGraphResource VulkanRenderGraph::importImage(const std::string& name, VkImage image, VkImageView view,
+                                                   VkImageAspectFlags aspect, RenderGraphUsage initialUsage,
+                                                   RenderGraphUsage finalUsage) {
+    RenderGraphResource resource = graph.importTexture(name, initialUsage, finalUsage);
+    textures.resize(graph.getResourceCount());
+    textures[resource].image = image;
+    textures[resource].view = view;
+    textures[resource].aspect = aspect;
+    compiled = false;
+    return resource;
+}
+
+void VulkanRenderGraph::setImportedImage(RenderGraphResource resource, VkImage image, VkImageView view) {
+    if (resource >= textures.size() || !graph.isImported(resource)) {
+        throw std::runtime_error("VulkanRenderGraph: not an imported resource!");
+    }
+    textures[resource].image = image;
+    textures[resource].view = view;
+}
+
+uint32_t VulkanRenderGraph::addPass(const std::string& name, PassFn execute, bool sideEffects) {
+    uint32_t pass = graph.addPass(name, sideEffects);
+    passFns.push_back(std::move(execute));
+    compiled = false;
+    return pass;
+}
+
+void VulkanRenderGraph::read(uint32_t pass, RenderGraphResource resource, RenderGraphUsage usage) {
+    graph.read(pass, resource, usage);
+    compiled = false;
+}
+
+void VulkanRenderGraph::write(uint32_t pass, RenderGraphResource resource, RenderGraphUsage usage) {
+    graph.write(pass, resource, usage);
+    compiled = false;
+}
+
+// ==================== Compilation ====================
+
+void VulkanRenderGraph::compile() {
+    releaseTransients();
+
+    // Images are created while the graph places them: their memory
+    // requirements are the placement input
+    VkDeviceSize alignment = 1;
+    uint32_t memoryTypeBits = UINT32_MAX;
+
+    graph.compile([&](RenderGraphResource resource) {
+        const RenderGraphTextureDesc& desc = graph.getTextureDesc(resource);
+        Texture& texture = textures[resource];
+
+        VkImageUsageFlags usage = 0;
+        for (RenderGraphUsage graphUsage : graph.getUsages(resource)) {
+            usage |= getImageUsage(graphUsage);
+        }
+        bool depth = (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) != 0;
+        texture.aspect = depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = texture.format;
+        imageInfo.extent = { desc.width, desc.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(device, &imageInfo, nullptr, &texture.image) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create render graph image: " + graph.getResourceName(resource));
+        }
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device, texture.image, &requirements);
+        alignment = std::max(alignment, requirements.alignment);
+        memoryTypeBits &= requirements.memoryTypeBits;
+
+        RenderGraphMemoryRequirements result;
+        result.size = requirements.size;
+        result.alignment = requirements.alignment;
+        return result;
+    });
+
+    const RenderGraphStats& stats = graph.getStats();
+    if (stats.transientCount > 0) {
+        if (memoryTypeBits == 0) {
+            throw std::runtime_error("Failed to compile render graph: transients share no memory type!");
+        }
+
+        VkMemoryRequirements requirements{};
+        requirements.size = stats.aliasedBytes;
+        requirements.alignment = alignment;
+        requirements.memoryTypeBits = memoryTypeBits;
+        transientMemory = context.getAllocator().allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false);
+    }
+
+    for (RenderGraphResource resource = 0; resource < graph.getResourceCount(); resource++) {
+        Texture& texture = textures[resource];
+        if (graph.isImported(resource) || texture.image == VK_NULL_HANDLE) {
+            continue;
+        }
+
+        VkDeviceSize offset = transientMemory.offset + graph.getPlacement(resource).offset;
+        if (vkBindImageMemory(device, texture.image, transientMemory.memory, offset) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to bind render graph image memory!");
+        }
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = texture.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = texture.format;
+        viewInfo.subresourceRange.aspectMask = texture.aspect;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device, &viewInfo, nullptr, &texture.view) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create render graph image view!");
+        }
+    }
+    compiled = true;
+
+    Logger::verbose("Render graph: " + std::to_string(stats.passCount) + " passes (" +
+                    std::to_string(stats.culledPassCount) + " culled), " +
+                    std::to_string(stats.barrierCount) + " barriers in " +
+                    std::to_string(stats.barrierBatchCount) + " batches, " +
+                    std::to_string(stats.savedBytes / (1024 * 1024)) + " MB saved by aliasing");
+}
+
+void VulkanRenderGraph::releaseTransients() {
+    VkDevice device = this->device;
+    for (RenderGraphResource resource = 0; resource < textures.size(); resource++) {
+        Texture& texture = textures[resource];
+        if (graph.isImported(resource) || texture.image == VK_NULL_HANDLE) {
+            continue;
+        }
+
+        VkImage image = texture.image;
+        VkImageView view = texture.view;
+        context.deferDestroy([device, image, view]() {
+            vkDestroyImageView(device, view, nullptr);
+            vkDestroyImage(device, image, nullptr);
+        });
+        texture.image = VK_NULL_HANDLE;
+        texture.view = VK_NULL_HANDLE;
+    }
+
+    if (transientMemory.isValid()) {
+        GpuAllocator* gpuAllocator = &context.getAllocator();
+        GpuAllocation memory = transientMemory;
+        context.deferDestroy([gpuAllocator, memory]() mutable { gpuAllocator->free(memory); });
+        transientMemory = GpuAllocation{};
+    }
+    compiled = false;
+}
+
+// ==================== Execution ====================
+
+void VulkanRenderGraph::execute(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    if (!compiled) {
+        throw std::runtime_error("VulkanRenderGraph: compile() the graph before executing it!");
+    }
+
+    for (const RenderGraphCompiledPass& pass : graph.getCompiledPasses()) {
+        recordBarriers(commandBuffer, pass.barriers);
+        if (passFns[pass.pass]) {
+            passFns[pass.pass](commandBuffer, frameIndex);
+        }
+    }
+    recordBarriers(commandBuffer, graph.getFinalBarriers());
+}
+
+void VulkanRenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const std::vector<RenderGraphBarrier>& barriers) {
+    if (barriers.empty()) {
+        return;
+    }
+
+    barrierScratch.clear();
+    for (const RenderGraphBarrier& barrier : barriers) {
+        const Texture& texture = textures[barrier.resource];
+        if (texture.image == VK_NULL_HANDLE) {
+            throw std::runtime_error("VulkanRenderGraph: no image for " + graph.getResourceName(barrier.resource) + "!");
+        }
+
+        UsageInfo src = getUsageInfo(barrier.srcUsage);
+        UsageInfo dst = getUsageInfo(barrier.dstUsage);
+
+        // Aliased memory: wait for every earlier user of these bytes
+        for (uint32_t usage = 0; barrier.aliasWaitMask >> usage; usage++) {
+            if (barrier.aliasWaitMask & (1u << usage)) {
+                UsageInfo previous = getUsageInfo(static_cast<RenderGraphUsage>(usage));
+                src.stage |= previous.stage;
+                src.access |= previous.access;
+            }
+        }
+
+        // Undefined contents: only chain with semaphore waits on the same stage
+        if (src.stage == VK_PIPELINE_STAGE_2_NONE) {
+            src.stage = dst.stage;
+        }
+
+        VkImageMemoryBarrier2 imageBarrier{};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        imageBarrier.srcStageMask = src.stage;
+        imageBarrier.srcAccessMask = src.access;
+        imageBarrier.dstStageMask = dst.stage;
+        imageBarrier.dstAccessMask = dst.access;
+        imageBarrier.oldLayout = barrier.discard ? VK_IMAGE_LAYOUT_UNDEFINED : src.layout;
+        imageBarrier.newLayout = dst.layout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = texture.image;
+        imageBarrier.subresourceRange.aspectMask = texture.aspect;
+        imageBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        imageBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+        barrierScratch.push_back(imageBarrier);
+    }
+
+    if (synchronization2) {
+        VkDependencyInfo dependencyInfo{};
+        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(barrierScratch.size());
+        dependencyInfo.pImageMemoryBarriers = barrierScratch.data();
+        vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+        return;
+    }
+
+    // Same batch through the original API: one stage mask pair for the call
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    std::vector<VkImageMemoryBarrier> legacyBarriers;
+    legacyBarriers.reserve(barrierScratch.size());
+    for (const VkImageMemoryBarrier2& imageBarrier : barrierScratch) {
+        srcStages |= static_cast<VkPipelineStageFlags>(imageBarrier.srcStageMask);
+        dstStages |= static_cast<VkPipelineStageFlags>(imageBarrier.dstStageMask);
+
+        VkImageMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        legacy.srcAccessMask = static_cast<VkAccessFlags>(imageBarrier.srcAccessMask);
+        legacy.dstAccessMask = static_cast<VkAccessFlags>(imageBarrier.dstAccessMask);
+        legacy.oldLayout = imageBarrier.oldLayout;
+        legacy.newLayout = imageBarrier.newLayout;
+        legacy.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        legacy.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        legacy.image = imageBarrier.image;
+        legacy.subresourceRange = imageBarrier.subresourceRange;
+        legacyBarriers.push_back(legacy);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         dstStages != 0 ? dstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 0, nullptr,
+                         static_cast<uint32_t>(legacyBarriers.size()), legacyBarriers.data());
+}
+
+// ==================== Queries ====================
+
+VkImage VulkanRenderGraph::getImage(RenderGraphResource resource) const {
+    if (resource >= textures.size()) {
+        throw std::runtime_error("VulkanRenderGraph: unknown resource!");
+    }
+    return textures[resource].image;
+}
+
+VkImageView VulkanRenderGraph::getImageView(RenderGraphResource resource) const {
+    if (resource >= textures.size()) {
+        throw std::runtime_error("VulkanRenderGraph: unknown resource!");
+    }
+    return textures[resource].view;
+}
+
+void VulkanRenderGraph::destroy() {
+    // Never leave the context calling prepare() on a destroyed graph
+    context.removeRenderFeature(this);
+
+    if (device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    // Frames in flight may still use the transients
+    vkDeviceWaitIdle(device);
+
+    for (RenderGraphResource resource = 0; resource < textures.size(); resource++) {
+        Texture& texture = textures[resource];
+        if (graph.isImported(resource) || texture.image == VK_NULL_HANDLE) {
+            continue;
+        }
+        vkDestroyImageView(device, texture.view, nullptr);
+        vkDestroyImage(device, texture.image, nullptr);
+    }
+    textures.clear();
+
+    if (transientMemory.isValid()) {
+        context.getAllocator().free(transientMemory);
+    }
+
+    graph.clear();
+    passFns.clear();
+    compiled = false;
+    device = VK_NULL_HANDLE;
+}
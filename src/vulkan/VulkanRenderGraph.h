@@ -0,0 +1,87 @@
+#pragma once
+
+#include "IRenderFeature.h"
+#include "GpuAllocator.h"
+#include "../renderer/RenderGraph.h"
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+class VulkanContext;
+
+/**
+ * VulkanRenderGraph - RenderGraph backend for VulkanContext
+ *
+ * Owns the transient images and the single device-local allocation they
+ * are aliased into, and replays a compiled graph: each pass gets at most
+ * one vkCmdPipelineBarrier2 (vkCmdPipelineBarrier without
+ * synchronization2) before its callback runs.
+ *
+ * Register it with VulkanContext::addRenderFeature to execute the graph in
+ * every frame's prepare step, outside the main render pass; pass callbacks
+ * begin their own rendering. destroy() (and so the destructor) unregisters
+ * it. Transients are recreated only by compile().
+ */
+class VulkanRenderGraph : public IRenderFeature {
+public:
+    using PassFn = std::function<void(VkCommandBuffer commandBuffer, uint32_t frameIndex)>;
+
+    explicit VulkanRenderGraph(VulkanContext& context);
+    ~VulkanRenderGraph() override;
+
+    VulkanRenderGraph(const VulkanRenderGraph&) = delete;
+    VulkanRenderGraph& operator=(const VulkanRenderGraph&) = delete;
+
+    RenderGraphResource createTexture(const std::string& name, uint32_t width, uint32_t height, VkFormat format);
+
+    // The image may be swapped each frame (swapchain) with setImportedImage
+    RenderGraphResource importImage(const std::string& name, VkImage image, VkImageView view,
+                                    VkImageAspectFlags aspect, RenderGraphUsage initialUsage,
+                                    RenderGraphUsage finalUsage);
+    void setImportedImage(RenderGraphResource resource, VkImage image, VkImageView view);
+
+    uint32_t addPass(const std::string& name, PassFn execute, bool sideEffects = false);
+    void read(uint32_t pass, RenderGraphResource resource, RenderGraphUsage usage);
+    void write(uint32_t pass, RenderGraphResource resource, RenderGraphUsage usage);
+
+    // Culls, places and (re)creates the transient images. Images of a
+    // previous compile are destroyed once no frame in flight uses them.
+    void compile();
+    void execute(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+    // IRenderFeature
+    void prepare(VkCommandBuffer commandBuffer, uint32_t frameIndex) override { execute(commandBuffer, frameIndex); }
+    void draw(VkCommandBuffer, uint32_t) override {}
+
+    VkImage getImage(RenderGraphResource resource) const;
+    VkImageView getImageView(RenderGraphResource resource) const;
+
+    const RenderGraph& getGraph() const { return graph; }
+    const RenderGraphStats& getStats() const { return graph.getStats(); }
+
+    void destroy();
+
+private:
+    struct Texture {
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+    };
+
+    VulkanContext& context;
+    VkDevice device;
+    bool synchronization2;
+
+    RenderGraph graph;
+    std::vector<PassFn> passFns;
+    std::vector<Texture> textures;      // Indexed by RenderGraphResource
+    GpuAllocation transientMemory;
+    bool compiled;
+
+    std::vector<VkImageMemoryBarrier2> barrierScratch;
+
+    void releaseTransients();
+    void recordBarriers(VkCommandBuffer commandBuffer, const std::vector<RenderGraphBarrier>& barriers);
+};
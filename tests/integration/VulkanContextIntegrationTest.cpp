@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
 #include "../../src/platform/GLFWWindow.h"
 #include "../../src/vulkan/VulkanContext.h"
+#include "../../src/vulkan/GpuDrivenRenderer.h"
+#include "../../src/vulkan/VulkanRenderGraph.h"
+#include "../../src/vulkan/VulkanDrawBackend.h"
+#include "../../src/renderer/Renderer.h"
 #include "../../src/utils/Logger.h"
+#include <algorithm>
 
 /**
  * Integration tests for VulkanContext
@@ -142,4 +147,828 @@ TEST_F(VulkanContextIntegrationTest, SequentialInitAndCleanup) {
         delete context;
         context = new VulkanContext(window);
     }
-}
\ No newline at end of file
+}
+TEST_F(VulkanContextIntegrationTest, SubAllocatesManyBuffersFromFewBlocks) {
+    context->initialize();
+
+    uint32_t baseline = context->getAllocator().getDeviceMemoryAllocationCount();
+
+    std::vector<GpuBuffer> buffers;
+    for (int i = 0; i < 1000; i++) {
+        buffers.push_back(context->createBuffer(
+            64 * 1024,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+    }
+
+    // 1000 x 64KB should fit in a handful of blocks, not 1000 allocations
+    uint32_t used = context->getAllocator().getDeviceMemoryAllocationCount() - baseline;
+    EXPECT_LE(used, 4u);
+
+    uint32_t liveAllocations = 0;
+    for (const auto& heap : context->getMemoryStats()) {
+        liveAllocations += heap.allocationCount;
+        EXPECT_LE(heap.usedBytes, heap.reservedBytes);
+    }
+    EXPECT_GE(liveAllocations, 1000u);
+
+    for (auto& buffer : buffers) {
+        context->destroyBuffer(buffer);
+    }
+}
+
+TEST_F(VulkanContextIntegrationTest, PipelineCachePersistsAcrossRuns) {
+    // First run populates (or refreshes) the on-disk cache
+    context->initialize();
+    context->cleanup();
+
+    delete context;
+    context = new VulkanContext(window);
+
+    // Second run must accept the file written by the first
+    context->initialize();
+
+    PipelineCacheStats stats = context->getPipelineCacheStats();
+    EXPECT_TRUE(stats.loadedFromDisk) << "Rejected: " << stats.rejectReason;
+    EXPECT_GT(stats.loadedBytes, 0u);
+    EXPECT_EQ(stats.hits + stats.misses, 1u);
+
+    std::cout << "  Pipeline cache: " << stats.loadedBytes << " bytes loaded in "
+              << stats.loadMs << " ms, hit " << stats.hitCreateMs
+              << " ms / miss " << stats.missCreateMs << " ms" << std::endl;
+}
+
+TEST_F(VulkanContextIntegrationTest, SwapChainRecreateKeepsPipeline) {
+    context->initialize();
+
+    VkPipeline pipelineBefore = context->getGraphicsPipeline();
+    PipelineCacheStats stats = context->getPipelineCacheStats();
+    double pipelineCompileMs = stats.hitCreateMs + stats.missCreateMs;
+
+    const int recreateCount = 10;
+    double totalRecreateMs = 0.0;
+
+    for (int i = 0; i < recreateCount; i++) {
+        context->recreateSwapChain();
+        totalRecreateMs += context->getLastSwapChainRecreateMs();
+
+        EXPECT_NO_THROW({
+            context->beginFrame();
+            context->endFrame();
+        }) << "Failed to render after recreate " << i;
+    }
+
+    // Dynamic viewport/scissor: resize must not touch the pipeline
+    EXPECT_EQ(context->getGraphicsPipeline(), pipelineBefore);
+
+    double averageMs = totalRecreateMs / recreateCount;
+    std::cout << "  Swapchain recreate: " << averageMs << " ms avg (now)"
+              << " vs ~" << (averageMs + pipelineCompileMs)
+              << " ms with pipeline rebuild (before)" << std::endl;
+}
+
+TEST_F(VulkanContextIntegrationTest, SwapChainRecreateRetiresWithoutStall) {
+    context->initialize();
+
+    for (int i = 0; i < 3; i++) {
+        context->beginFrame();
+        context->endFrame();
+    }
+
+    // Frames are still in flight: the old swapchain must be kept alive
+    context->recreateSwapChain();
+    EXPECT_EQ(context->getPendingDeletionCount(), 1u);
+
+    // Once every frame that used it has completed, it is destroyed
+    for (uint32_t i = 0; i < context->getFramesInFlight() + 1; i++) {
+        context->beginFrame();
+        context->endFrame();
+    }
+    context->waitIdle();
+    context->beginFrame();
+    context->endFrame();
+
+    EXPECT_EQ(context->getPendingDeletionCount(), 0u);
+}
+
+TEST_F(VulkanContextIntegrationTest, DeferredDestroyWaitsForFramesInFlight) {
+    context->initialize();
+
+    size_t allocationsBefore = context->getAllocator().getDeviceMemoryAllocationCount();
+
+    context->beginFrame();
+    GpuBuffer buffer = context->createBuffer(64ull * 1024 * 1024, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GPU_ALLOCATION_DEDICATED);
+
+    // Released mid-frame: the frame being recorded may still use it
+    context->deferDestroy(buffer);
+    EXPECT_EQ(buffer.buffer, VK_NULL_HANDLE);
+    EXPECT_EQ(context->getPendingDeletionCount(), 1u);
+    context->endFrame();
+
+    for (uint32_t i = 0; i < context->getFramesInFlight() + 1; i++) {
+        context->beginFrame();
+        context->endFrame();
+    }
+
+    EXPECT_EQ(context->getPendingDeletionCount(), 0u);
+    EXPECT_EQ(context->getAllocator().getDeviceMemoryAllocationCount(), allocationsBefore);
+}
+
+TEST_F(VulkanContextIntegrationTest, PipelineManagerDeduplicatesStates) {
+    context->initialize();
+
+    PipelineManager& manager = context->getPipelineManager();
+    PipelineManagerStats before = manager.getStats();
+
+    PipelineStateDesc desc;
+    desc.vertexShader = manager.loadShader("shaders/triangle.vert.spv");
+    desc.fragmentShader = manager.loadShader("shaders/triangle.frag.spv");
+    desc.blend = BlendMode::AlphaBlend;
+    desc.layout = context->getPipelineLayout();
+    context->setMainPassTarget(desc);
+
+    // 5,000 materials sharing one state
+    VkPipeline first = manager.getPipeline(desc);
+    for (int i = 0; i < 5000; i++) {
+        ASSERT_EQ(manager.getPipeline(desc), first);
+    }
+
+    PipelineManagerStats after = manager.getStats();
+    EXPECT_EQ(after.compiles - before.compiles, 1u);
+    EXPECT_EQ(after.lookups - before.lookups, 5001u);
+    EXPECT_EQ(after.hits - before.hits, 5000u);
+
+    // A different state is a different pipeline
+    desc.blend = BlendMode::Additive;
+    EXPECT_NE(manager.getPipeline(desc), first);
+    EXPECT_EQ(manager.getStats().compiles - before.compiles, 2u);
+}
+
+TEST_F(VulkanContextIntegrationTest, RecordsSecondariesInParallel) {
+    context->initialize();
+
+    VkPipeline pipeline = context->getGraphicsPipeline();
+    const uint32_t taskCount = 64;
+    const uint32_t drawsPerTask = 100;
+
+    for (int frame = 0; frame < 10; frame++) {
+        EXPECT_NO_THROW({
+            context->beginFrame();
+            context->recordSecondary(taskCount, [pipeline](VkCommandBuffer commandBuffer, uint32_t) {
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+                for (uint32_t i = 0; i < drawsPerTask; i++) {
+                    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+                }
+            });
+            context->endFrame();
+        }) << "Failed on frame " << frame;
+    }
+
+    ParallelRecorderStats stats = context->getRecorderStats();
+    EXPECT_EQ(stats.lastFrameSecondaries, taskCount + 1);  // + built-in triangle
+    EXPECT_EQ(stats.commandPools, stats.threadSlots * 2);
+
+    // Pools are reset and reused, so allocations stop growing after warm-up
+    EXPECT_LE(stats.secondaryBuffers, stats.commandPools * 16 + 2 * (taskCount + 1));
+
+    std::cout << "  " << (taskCount * drawsPerTask) << " draws recorded on "
+              << stats.threadSlots << " threads in " << stats.lastFrameRecordMs << " ms" << std::endl;
+}
+
+TEST(VulkanContextHeadlessTest, RendersOffscreenWithReadback) {
+    Logger::setLevel(LogLevel::Minimal);
+
+    // No window, no surface: works on lavapipe and display-less CI nodes
+    VulkanContextConfig config;
+    config.headless = true;
+    config.width = 256;
+    config.height = 128;
+    config.enableReadback = true;
+
+    VulkanContext context(nullptr, config);
+    ASSERT_NO_THROW(context.initialize());
+    EXPECT_TRUE(context.isHeadless());
+    EXPECT_EQ(context.getExtent().width, 256u);
+    EXPECT_EQ(context.getExtent().height, 128u);
+
+    std::vector<uint8_t> pixels;
+    EXPECT_FALSE(context.readbackLastFrame(pixels));
+
+    for (int i = 0; i < 5; i++) {
+        EXPECT_NO_THROW({
+            context.beginFrame();
+            context.endFrame();
+        }) << "Failed on frame " << i;
+    }
+
+    ASSERT_TRUE(context.readbackLastFrame(pixels));
+    ASSERT_EQ(pixels.size(), 256u * 128u * 4u);
+
+    auto pixelAt = [&](uint32_t x, uint32_t y) { return &pixels[(y * 256 + x) * 4]; };
+
+    // Corner is clear color, center is covered by the triangle
+    const uint8_t* corner = pixelAt(0, 0);
+    EXPECT_EQ(corner[0] + corner[1] + corner[2], 0);
+    const uint8_t* center = pixelAt(128, 64);
+    EXPECT_GT(center[0] + center[1] + center[2], 0);
+    EXPECT_EQ(center[3], 255);
+
+    context.cleanup();
+    Logger::setLevel(LogLevel::Normal);
+}
+
+TEST_F(VulkanContextIntegrationTest, GpuProfilerReportsPassTimings) {
+    context->initialize();
+
+    GpuProfiler& profiler = context->getGpuProfiler();
+    if (!profiler.isSupported()) {
+        GTEST_SKIP() << "Timestamps not supported on the graphics queue";
+    }
+
+    VkPipeline pipeline = context->getGraphicsPipeline();
+    for (int i = 0; i < 6; i++) {
+        context->beginFrame();
+        context->recordSecondary(1, [&profiler, pipeline](VkCommandBuffer commandBuffer, uint32_t) {
+            GpuProfiler::Scope scope(profiler, commandBuffer, "extra_draws");
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            vkCmdDraw(commandBuffer, 3, 100, 0, 0);
+        });
+        context->endFrame();
+    }
+
+    // Results lag by the frames-in-flight depth and are harvested without stalling
+    const GpuFrameTimings& timings = profiler.getLastResults();
+    EXPECT_GE(timings.passes.size(), 3u);
+    EXPECT_GT(profiler.getPassMs("frame"), 0.0);
+    EXPECT_GE(profiler.getPassMs("frame"), profiler.getPassMs("main_pass"));
+    EXPECT_GE(profiler.getPassMs("main_pass"), profiler.getPassMs("extra_draws"));
+
+    std::string json = profiler.toJson();
+    EXPECT_NE(json.find("\"main_pass\""), std::string::npos);
+    EXPECT_NE(json.find("\"extra_draws\""), std::string::npos);
+}
+
+TEST_F(VulkanContextIntegrationTest, StagingUploadsAreCoalesced) {
+    context->initialize();
+
+    // Host-visible destination so the result can be checked directly
+    const uint32_t pieceCount = 1000;
+    const VkDeviceSize pieceSize = 64;
+    GpuBuffer target = context->createBuffer(pieceCount * pieceSize,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    StagingUploader& uploader = context->getStagingUploader();
+    StagingUploaderStats before = uploader.getStats();
+
+    std::vector<uint8_t> piece(pieceSize);
+    for (uint32_t i = 0; i < pieceCount; i++) {
+        std::fill(piece.begin(), piece.end(), static_cast<uint8_t>(i));
+        uploader.uploadBuffer(target.buffer, i * pieceSize, piece.data(), pieceSize);
+    }
+    EXPECT_TRUE(uploader.hasPendingUploads());
+
+    context->beginFrame();
+    context->endFrame();
+    context->waitIdle();
+
+    StagingUploaderStats after = uploader.getStats();
+    EXPECT_EQ(after.uploads - before.uploads, pieceCount);
+    EXPECT_EQ(after.batches - before.batches, 1u);
+    EXPECT_EQ(after.copyCommands - before.copyCommands, 1u);
+    EXPECT_EQ(after.copyRegions - before.copyRegions, 1u);  // Contiguous pieces merge
+
+    const uint8_t* data = static_cast<const uint8_t*>(target.allocation.mappedData);
+    for (uint32_t i = 0; i < pieceCount; i++) {
+        ASSERT_EQ(data[i * pieceSize], static_cast<uint8_t>(i));
+        ASSERT_EQ(data[i * pieceSize + pieceSize - 1], static_cast<uint8_t>(i));
+    }
+
+    std::cout << "  Staging: " << pieceCount << " uploads -> " << (after.batches - before.batches)
+              << " batch, " << (after.copyCommands - before.copyCommands) << " copy ("
+              << (after.dedicatedTransferQueue ? "dedicated transfer queue" : "graphics queue") << ")" << std::endl;
+
+    context->destroyBuffer(target);
+}
+
+TEST_F(VulkanContextIntegrationTest, GpuDrivenCullsInstances) {
+    context->initialize();
+    if (!context->getEnabledFeatures().drawIndirectFirstInstance) {
+        GTEST_SKIP() << "drawIndirectFirstInstance not supported";
+    }
+
+    GpuDrivenRenderer renderer(*context, 256);
+
+    uint32_t mesh = renderer.addMesh({ 0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 0.0f,   -1.0f, 1.0f, 0.0f },
+                                     { 0, 1, 2 });
+
+    // Identity view-projection: the frustum is clip space itself
+    const uint32_t insideCount = 100;
+    const uint32_t outsideCount = 50;
+    for (uint32_t i = 0; i < insideCount + outsideCount; i++) {
+        GpuInstance instance;
+        instance.position[0] = (i < insideCount) ? -0.9f + 1.8f * i / insideCount : 5.0f + i;
+        instance.position[2] = 0.5f;
+        instance.scale = 0.05f;
+        instance.meshIndex = mesh;
+        renderer.addInstance(instance);
+    }
+    renderer.upload();
+
+    // Counts are read back once the frame slot comes around again
+    for (uint32_t frame = 0; frame < context->getFramesInFlight() + 2; frame++) {
+        context->beginFrame();
+        context->endFrame();
+    }
+    context->waitIdle();
+
+    GpuDrivenStats stats = renderer.getStats();
+    EXPECT_EQ(stats.instanceCount, insideCount + outsideCount);
+    EXPECT_EQ(stats.meshCount, 1u);
+    EXPECT_EQ(stats.lastVisibleCount, insideCount);
+
+    std::cout << "  GPU-driven: " << stats.lastVisibleCount << "/" << stats.instanceCount << " visible ("
+              << (stats.drawIndirectCount ? "drawIndirectCount" :
+                  stats.multiDrawIndirect ? "multiDrawIndirect" : "single indirect") << ")" << std::endl;
+}
+
+TEST_F(VulkanContextIntegrationTest, FramesInFlightIsConfigurableAtRuntime) {
+    context->initialize();
+
+    EXPECT_THROW(context->setFramesInFlight(0), std::runtime_error);
+    EXPECT_THROW(context->setFramesInFlight(VulkanContext::MAX_FRAMES_IN_FLIGHT + 1), std::runtime_error);
+
+    for (uint32_t depth = 1; depth <= VulkanContext::MAX_FRAMES_IN_FLIGHT; depth++) {
+        context->setFramesInFlight(depth);
+
+        for (int frame = 0; frame < 8; frame++) {
+            context->beginFrame();
+
+            // The CPU never runs more than `depth` frames ahead of the GPU
+            FramePacingStats stats = context->getFramePacingStats();
+            EXPECT_EQ(stats.framesInFlight, depth);
+            EXPECT_GE(stats.completedFrames + depth, stats.submittedFrames + 1);
+
+            context->endFrame();
+        }
+
+        FramePacingStats stats = context->getFramePacingStats();
+        std::cout << "  " << depth << " frame(s) in flight: CPU waited "
+                  << stats.lastCpuWaitMs << " ms last frame" << std::endl;
+    }
+
+    context->waitIdle();
+    FramePacingStats stats = context->getFramePacingStats();
+    EXPECT_EQ(stats.completedFrames, stats.submittedFrames);
+    EXPECT_GT(stats.waits, 0u);
+}
+
+TEST_F(VulkanContextIntegrationTest, PresentModeSwitchAndLatency) {
+    context->initialize();
+
+    std::vector<VkPresentModeKHR> modes = context->getSupportedPresentModes();
+    ASSERT_FALSE(modes.empty());
+
+    // FIFO is always supported; the others fall back to it
+    const VkPresentModeKHR requested[] = {
+        VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR,
+        VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR
+    };
+
+    for (VkPresentModeKHR mode : requested) {
+        bool supported = std::find(modes.begin(), modes.end(), mode) != modes.end();
+        EXPECT_EQ(context->setPresentMode(mode), supported);
+        EXPECT_EQ(context->getPresentMode(), supported ? mode : VK_PRESENT_MODE_FIFO_KHR);
+
+        for (int frame = 0; frame < 5; frame++) {
+            window->pollEvents();
+            context->getLatencyTracker().markInput();
+            context->beginFrame();
+            context->endFrame();
+        }
+    }
+    context->waitIdle();
+
+    LatencyStats stats = context->getLatencyTracker().getStats();
+    EXPECT_GT(stats.frames, 0u);
+    EXPECT_GE(stats.averageInputToPresentMs, stats.averageInputToSubmitMs);
+
+    std::cout << "  Latency: input->submit " << stats.averageInputToSubmitMs
+              << " ms, input->present " << stats.averageInputToPresentMs << " ms";
+    if (context->getEnabledFeatures().presentWait) {
+        std::cout << ", input->display " << stats.averageInputToDisplayMs << " ms";
+    }
+    std::cout << std::endl;
+}
+
+TEST_F(VulkanContextIntegrationTest, BindlessHeapAllocatesSlots) {
+    context->initialize();
+    if (!context->getEnabledFeatures().bindless) {
+        GTEST_SKIP() << "Descriptor indexing not supported";
+    }
+
+    BindlessDescriptorHeap& heap = context->getBindlessHeap();
+    EXPECT_NE(heap.getSetLayout(), VK_NULL_HANDLE);
+    EXPECT_NE(heap.getDescriptorSet(), VK_NULL_HANDLE);
+
+    GpuBuffer buffer = context->createBuffer(4096, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    // Written while the set is bound in the frame being recorded
+    context->beginFrame();
+    uint32_t first = heap.addBuffer(buffer.buffer, 0, 1024);
+    uint32_t second = heap.addBuffer(buffer.buffer, 1024, 1024);
+    EXPECT_EQ(first, 0u);
+    EXPECT_EQ(second, 1u);
+    heap.updateBuffer(second, buffer.buffer, 2048, 1024);
+    context->endFrame();
+
+    // Slots are only recycled once no frame in flight can read them
+    context->deferDestroy([&heap, first]() { heap.removeBuffer(first); });
+    EXPECT_EQ(heap.getStats().buffersInUse, 2u);
+
+    for (uint32_t i = 0; i < context->getFramesInFlight() + 1; i++) {
+        context->beginFrame();
+        context->endFrame();
+    }
+    EXPECT_EQ(heap.getStats().buffersInUse, 1u);
+    EXPECT_EQ(heap.addBuffer(buffer.buffer), first);
+
+    BindlessHeapStats stats = heap.getStats();
+    EXPECT_EQ(stats.descriptorWrites, 4u);
+    std::cout << "  Bindless heap: " << stats.textureCapacity << " textures, "
+              << stats.bufferCapacity << " buffers" << std::endl;
+
+    context->waitIdle();
+    context->destroyBuffer(buffer);
+}
+
+TEST_F(VulkanContextIntegrationTest, DescriptorAllocatorGrowsAndResetsPerFrame) {
+    context->initialize();
+
+    VkDescriptorSetLayoutBinding ubo{};
+    ubo.binding = 0;
+    ubo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    ubo.descriptorCount = 1;
+    ubo.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    VkDescriptorSetLayoutBinding texture{};
+    texture.binding = 1;
+    texture.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    texture.descriptorCount = 1;
+    texture.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // Same bindings in a different order resolve to the same layout
+    DescriptorLayoutCache& layouts = context->getDescriptorLayoutCache();
+    VkDescriptorSetLayout layout = layouts.getLayout({ ubo, texture });
+    EXPECT_EQ(layouts.getLayout({ texture, ubo }), layout);
+    EXPECT_EQ(layouts.getStats().layoutCount, 1u);
+    EXPECT_EQ(layouts.getStats().hits, 1u);
+
+    DescriptorAllocator& allocator = context->getDescriptorAllocator();
+
+    // More sets than one pool holds: allocation spills into new pools
+    context->beginFrame();
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_NE(allocator.allocate(layout), VK_NULL_HANDLE);
+    }
+    context->endFrame();
+
+    DescriptorAllocatorStats grown = allocator.getStats();
+    EXPECT_GT(grown.poolsCreated, 1u);
+    EXPECT_GT(grown.poolExhaustions, 0u);
+
+    // Cycle back to the first slot: its pools are reset and reused
+    for (uint32_t i = 1; i < context->getFramesInFlight(); i++) {
+        context->beginFrame();
+        context->endFrame();
+    }
+    uint64_t poolsBefore = allocator.getStats().poolsCreated;
+
+    context->beginFrame();
+    for (int i = 0; i < 1000; i++) {
+        allocator.allocate(layout);
+    }
+    context->endFrame();
+
+    DescriptorAllocatorStats recycled = allocator.getStats();
+    EXPECT_EQ(recycled.poolsCreated, poolsBefore);
+    EXPECT_GE(recycled.poolResets, grown.poolsCreated);
+
+    std::cout << "  Descriptor pools: " << recycled.poolsCreated << " created, "
+              << recycled.poolResets << " resets, " << recycled.setsAllocated << " sets" << std::endl;
+}
+
+TEST_F(VulkanContextIntegrationTest, ShaderReloadSwapsPipelinesBetweenFrames) {
+    context->initialize();
+
+    context->beginFrame();
+    context->endFrame();
+
+    PipelineManager& pipelines = context->getPipelineManager();
+    VkPipeline before = context->getGraphicsPipeline();
+    uint64_t generation = pipelines.getGeneration();
+    uint64_t compiles = pipelines.getStats().compiles;
+    size_t pendingDeletions = context->getPendingDeletionCount();
+
+    // Unknown paths are ignored; a loaded shader evicts and rebuilds its pipelines
+    EXPECT_FALSE(context->reloadShader("shaders/does_not_exist.frag.spv"));
+    EXPECT_TRUE(context->reloadShader("shaders/triangle.frag.spv"));
+
+    EXPECT_EQ(pipelines.getGeneration(), generation + 1);
+    EXPECT_EQ(pipelines.getStats().compiles, compiles + 1);
+    EXPECT_NE(context->getGraphicsPipeline(), VK_NULL_HANDLE);
+    EXPECT_EQ(context->getShaderReloadCount(), 1u);
+
+    // The old pipeline and module wait for the frame that used them
+    EXPECT_GE(context->getPendingDeletionCount(), pendingDeletions + 2);
+    for (uint32_t i = 0; i < context->getFramesInFlight() + 1; i++) {
+        context->beginFrame();
+        context->endFrame();
+    }
+    EXPECT_EQ(context->getPendingDeletionCount(), 0u);
+
+    std::cout << "  Reloaded triangle.frag: pipeline " << before << " -> "
+              << context->getGraphicsPipeline() << std::endl;
+}
+
+TEST_F(VulkanContextIntegrationTest, ReflectedPipelineLayoutsAreShared) {
+    context->initialize();
+
+    PipelineManager& pipelines = context->getPipelineManager();
+    ShaderReflection cull = pipelines.getShaderReflection(pipelines.loadShader("shaders/cull.comp.spv"));
+    ShaderReflection vertex = pipelines.getShaderReflection(pipelines.loadShader("shaders/indirect.vert.spv"));
+
+    // cull.comp: four storage buffers in set 0 and a CullParams push block
+    EXPECT_EQ(cull.stageFlags, static_cast<uint32_t>(VK_SHADER_STAGE_COMPUTE_BIT));
+    EXPECT_EQ(cull.localSize[0], 64u);
+    ASSERT_EQ(cull.bindings.size(), 4u);
+    for (const SpirvDescriptorBinding& binding : cull.bindings) {
+        EXPECT_EQ(static_cast<VkDescriptorType>(binding.type), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    }
+    ASSERT_EQ(cull.pushConstants.size(), 1u);
+    EXPECT_EQ(cull.pushConstants[0].size, 6 * 16 + 2 * sizeof(uint32_t));
+
+    // indirect.vert: one vec3 attribute and a mat4 push block
+    ASSERT_EQ(vertex.vertexInputs.size(), 1u);
+    EXPECT_EQ(vertex.vertexInputs[0].componentCount, 3u);
+    ASSERT_EQ(vertex.pushConstants.size(), 1u);
+    EXPECT_EQ(vertex.pushConstants[0].size, 64u);
+
+    // Same interface, same handle
+    PipelineLayoutCache& layouts = context->getPipelineLayoutCache();
+    VkPipelineLayout first = layouts.getLayout(cull);
+    uint64_t hits = layouts.getStats().hits;
+    EXPECT_EQ(layouts.getLayout(SpirvReflection::merge({ cull })), first);
+    EXPECT_EQ(layouts.getStats().hits, hits + 1);
+    EXPECT_NE(layouts.getLayout(vertex), first);
+
+    PipelineStateDesc desc;
+    desc.setVertexInputs(vertex);
+    EXPECT_EQ(desc.vertexBindingCount, 1u);
+    EXPECT_EQ(desc.vertexBindings[0].stride, 3 * sizeof(float));
+    EXPECT_EQ(desc.vertexAttributes[0].format, VK_FORMAT_R32G32B32_SFLOAT);
+}
+
+TEST_F(VulkanContextIntegrationTest, AsyncPipelineCompileUsesFallback) {
+    context->initialize();
+
+    PipelineManager& pipelines = context->getPipelineManager();
+    uint32_t vertexShader = pipelines.loadShader("shaders/triangle.vert.spv");
+    uint32_t fragmentShader = pipelines.loadShader("shaders/triangle.frag.spv");
+
+    // Same layout and render pass as the built-in pipeline, which is the fallback
+    PipelineStateDesc desc;
+    desc.vertexShader = vertexShader;
+    desc.fragmentShader = fragmentShader;
+    desc.blend = BlendMode::Additive;
+    desc.layout = context->getPipelineLayout();
+    context->setMainPassTarget(desc);
+
+    PipelineManagerStats before = pipelines.getStats();
+    EXPECT_EQ(pipelines.getPipelineAsync(desc), context->getGraphicsPipeline());
+
+    pipelines.waitForPendingCompiles();
+    VkPipeline compiled = pipelines.getPipelineAsync(desc);
+    EXPECT_NE(compiled, VK_NULL_HANDLE);
+    EXPECT_NE(compiled, context->getGraphicsPipeline());
+
+    PipelineManagerStats after = pipelines.getStats();
+    EXPECT_EQ(after.asyncCompiles, before.asyncCompiles + 1);
+    EXPECT_EQ(after.fallbackDraws, before.fallbackDraws + 1);
+    EXPECT_EQ(after.pendingCompiles, 0u);
+    EXPECT_EQ(after.stallMs, before.stallMs);   // Nothing blocked the caller
+
+    // A frame that compiles nothing synchronously reports no stall
+    context->beginFrame();
+    context->endFrame();
+    context->beginFrame();
+    context->endFrame();
+    EXPECT_EQ(context->getLastFrameCompileStallMs(), 0.0);
+
+    std::cout << "  Async compile took " << (after.compileMs - before.compileMs)
+              << " ms on a worker thread" << std::endl;
+}
+
+TEST_F(VulkanContextIntegrationTest, RenderGraphAliasesTransientsAndCullsPasses) {
+    context->initialize();
+
+    VulkanRenderGraph graph(*context);
+    RenderGraphResource a = graph.createTexture("a", 256, 256, VK_FORMAT_R8G8B8A8_UNORM);
+    RenderGraphResource b = graph.createTexture("b", 256, 256, VK_FORMAT_R8G8B8A8_UNORM);
+    RenderGraphResource c = graph.createTexture("c", 256, 256, VK_FORMAT_R8G8B8A8_UNORM);
+    RenderGraphResource unused = graph.createTexture("unused", 256, 256, VK_FORMAT_R8G8B8A8_UNORM);
+
+    VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    VkImageCopy region{};
+    region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.extent = { 256, 256, 1 };
+
+    auto clear = [&](RenderGraphResource target) {
+        return [&graph, &range, target](VkCommandBuffer commandBuffer, uint32_t) {
+            VkClearColorValue color = { { 1.0f, 0.0f, 1.0f, 1.0f } };
+            vkCmdClearColorImage(commandBuffer, graph.getImage(target),
+                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &color, 1, &range);
+        };
+    };
+    auto copy = [&](RenderGraphResource from, RenderGraphResource to) {
+        return [&graph, &region, from, to](VkCommandBuffer commandBuffer, uint32_t) {
+            vkCmdCopyImage(commandBuffer, graph.getImage(from), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           graph.getImage(to), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        };
+    };
+
+    // a -> b -> c: a is dead before c is first written, so they share memory
+    uint32_t clearA = graph.addPass("clear_a", clear(a));
+    graph.write(clearA, a, RenderGraphUsage::TransferDst);
+    uint32_t copyAB = graph.addPass("copy_ab", copy(a, b));
+    graph.read(copyAB, a, RenderGraphUsage::TransferSrc);
+    graph.write(copyAB, b, RenderGraphUsage::TransferDst);
+    uint32_t copyBC = graph.addPass("copy_bc", copy(b, c));
+    graph.read(copyBC, b, RenderGraphUsage::TransferSrc);
+    graph.write(copyBC, c, RenderGraphUsage::TransferDst);
+    uint32_t consume = graph.addPass("consume", nullptr, true);
+    graph.read(consume, c, RenderGraphUsage::TransferSrc);
+    uint32_t clearUnused = graph.addPass("clear_unused", clear(unused));
+    graph.write(clearUnused, unused, RenderGraphUsage::TransferDst);
+
+    graph.compile();
+
+    const RenderGraphStats& stats = graph.getStats();
+    EXPECT_EQ(stats.passCount, 4u);
+    EXPECT_EQ(stats.culledPassCount, 1u);
+    EXPECT_EQ(stats.transientCount, 3u);
+    EXPECT_GT(stats.savedBytes, 0u);
+    EXPECT_EQ(graph.getGraph().getPlacement(a).offset, graph.getGraph().getPlacement(c).offset);
+    EXPECT_EQ(graph.getImage(unused), VK_NULL_HANDLE);
+
+    context->addRenderFeature(&graph);
+    for (uint32_t i = 0; i < context->getFramesInFlight() + 1; i++) {
+        context->beginFrame();
+        context->endFrame();
+    }
+    context->waitIdle();
+    context->removeRenderFeature(&graph);
+
+    std::cout << "  Render graph: " << stats.barrierCount << " barriers in " << stats.barrierBatchCount
+              << " batches, " << stats.savedBytes << " of " << stats.transientBytes
+              << " transient bytes saved by aliasing" << std::endl;
+}
+
+TEST(VulkanContextHeadlessTest, DynamicRenderingMatchesRenderPassPath) {
+    Logger::setLevel(LogLevel::Minimal);
+
+    auto renderFrames = [](bool dynamicRendering, bool& enabled, std::vector<uint8_t>& pixels) {
+        VulkanContextConfig config;
+        config.headless = true;
+        config.width = 256;
+        config.height = 128;
+        config.enableReadback = true;
+        config.dynamicRendering = dynamicRendering;
+
+        VulkanContext context(nullptr, config);
+        context.initialize();
+        enabled = context.getEnabledFeatures().dynamicRendering;
+
+        // No render pass objects at all on the dynamic path
+        EXPECT_EQ(context.getRenderPass() == VK_NULL_HANDLE, enabled);
+
+        for (int i = 0; i < 3; i++) {
+            context.beginFrame();
+            context.endFrame();
+        }
+        EXPECT_TRUE(context.readbackLastFrame(pixels));
+        context.cleanup();
+    };
+
+    bool renderPassEnabled = true;
+    std::vector<uint8_t> renderPassPixels;
+    renderFrames(false, renderPassEnabled, renderPassPixels);
+    EXPECT_FALSE(renderPassEnabled);
+
+    bool dynamicEnabled = false;
+    std::vector<uint8_t> dynamicPixels;
+    renderFrames(true, dynamicEnabled, dynamicPixels);
+    if (!dynamicEnabled) {
+        Logger::setLevel(LogLevel::Normal);
+        GTEST_SKIP() << "Dynamic rendering not supported";
+    }
+
+    // Same clear, same triangle
+    EXPECT_EQ(dynamicPixels, renderPassPixels);
+
+    Logger::setLevel(LogLevel::Normal);
+}
+
+TEST(VulkanContextHeadlessTest, DeviceOverrideSelectsAdapter) {
+    Logger::setLevel(LogLevel::Minimal);
+
+    VulkanContextConfig config;
+    config.headless = true;
+    config.width = 64;
+    config.height = 64;
+
+    {
+        VulkanContext context(nullptr, config);
+        ASSERT_NO_THROW(context.initialize());
+        const DeviceProfile& best = context.getDeviceProfile();
+        EXPECT_GT(DeviceSelector::score(best), 0);
+
+        // The enabled fast paths never exceed what the device was scored on
+        const EnabledFeatures& features = context.getEnabledFeatures();
+        EXPECT_TRUE(!features.bindless || best.bindless);
+        EXPECT_TRUE(!features.dynamicRendering || best.dynamicRendering);
+        EXPECT_TRUE(!features.synchronization2 || best.synchronization2);
+        context.cleanup();
+
+        // Forcing the same adapter by name picks it again
+        config.device = best.name;
+    }
+
+    {
+        VulkanContext context(nullptr, config);
+        ASSERT_NO_THROW(context.initialize());
+        EXPECT_EQ(context.getDeviceProfile().name, config.device);
+        context.cleanup();
+    }
+
+    config.device = "no such adapter";
+    VulkanContext context(nullptr, config);
+    EXPECT_THROW(context.initialize(), std::runtime_error);
+
+    Logger::setLevel(LogLevel::Normal);
+}
+
+TEST(VulkanContextHeadlessTest, SortedDrawsAreInstancedThroughDrawBackend) {
+    Logger::setLevel(LogLevel::Minimal);
+
+    VulkanContextConfig config;
+    config.headless = true;
+    config.width = 256;
+    config.height = 128;
+    VulkanContext context(nullptr, config);
+
+    Renderer renderer(nullptr, &context);
+    renderer.initialize();
+    renderer.setThreadPool(&context.getThreadPool());
+
+    // The context's own triangle pipeline, no vertex buffers or descriptors
+    VulkanDrawBackend backend(context);
+    uint32_t pipeline = backend.addPipeline(context.getGraphicsPipeline(), context.getPipelineLayout());
+    for (uint32_t i = 0; i < 2; i++) {
+        backend.addMaterial(VK_NULL_HANDLE, 0);
+        VulkanDrawMesh triangle;
+        triangle.count = 3;
+        backend.addMesh(triangle);
+    }
+    renderer.setDrawBackend(&backend);
+    renderer.setMaterial(1, { pipeline, 0, false });
+
+    // More objects than one secondary holds draws for, alternating state
+    const uint32_t objectCount = VulkanDrawBackend::DRAWS_PER_SECONDARY * 2 + 10;
+    Scene& scene = renderer.getScene();
+    for (uint32_t i = 0; i < objectCount; i++) {
+        Entity entity = scene.createEntity(RENDERABLE_COMPONENTS);
+        scene.getMesh(entity).meshIndex = i % 2;
+        scene.getMaterial(entity).materialIndex = (i / 2) % 2;
+    }
+
+    for (int frame = 0; frame < 3; frame++) {
+        renderer.renderFrame();
+    }
+    context.waitIdle();
+
+    // One instanced draw per material/mesh pair, all in one secondary
+    RendererStats stats = renderer.getStats();
+    EXPECT_EQ(stats.instanceCount, objectCount);
+    EXPECT_EQ(stats.drawCount, 4u);
+    EXPECT_EQ(stats.stateChanges, 1u + 2u + 4u);
+    EXPECT_EQ(stats.elidedStateChanges, 3 * objectCount - stats.stateChanges);
+    EXPECT_EQ(backend.getLastSecondaryCount(), 1u);
+    EXPECT_NE(backend.getInstanceBuffer(context.getCurrentFrameIndex()), VK_NULL_HANDLE);
+
+    backend.destroy();
+    renderer.cleanup();
+    Logger::setLevel(LogLevel::Normal);
+}
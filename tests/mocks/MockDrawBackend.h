@@ -0,0 +1,109 @@
+#pragma once
+
+#include "../../src/interfaces/IDrawBackend.h"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * MockDrawBackend - Records draw calls instead of issuing them
+ *
+ * Each call is appended to getCalls() as a short string ("pipeline 2",
+ * "draw 0 16", ...) and the frame's instances are kept. Draws also record
+ * the state bound at that point, so tests can check what each draw would
+ * have rendered with.
+ */
+class MockDrawBackend : public IDrawBackend {
+public:
+    struct DrawCall {
+        uint32_t pipeline;
+        uint32_t material;
+        uint32_t mesh;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+    };
+
+    // ==================== IDrawBackend Interface ====================
+
+    void beginDraws() override {
+        if (inDraws) {
+            throw std::runtime_error("MockDrawBackend: beginDraws called twice!");
+        }
+        inDraws = true;
+        calls.clear();
+        draws.clear();
+        instances.clear();
+        pipeline = material = mesh = NONE;
+    }
+
+    void setInstances(const DrawInstance* data, uint32_t count) override {
+        record("instances " + std::to_string(count));
+        instances.assign(data, data + count);
+    }
+
+    void bindPipeline(uint32_t id) override {
+        record("pipeline " + std::to_string(id));
+        pipeline = id;
+        material = NONE;
+    }
+
+    void bindMaterial(uint32_t id) override {
+        record("material " + std::to_string(id));
+        material = id;
+    }
+
+    void bindMesh(uint32_t id) override {
+        record("mesh " + std::to_string(id));
+        mesh = id;
+    }
+
+    void draw(uint32_t firstInstance, uint32_t instanceCount) override {
+        record("draw " + std::to_string(firstInstance) + " " + std::to_string(instanceCount));
+        if (pipeline == NONE || material == NONE || mesh == NONE) {
+            throw std::runtime_error("MockDrawBackend: draw with unbound state!");
+        }
+        if (instanceCount == 0 || firstInstance + instanceCount > instances.size()) {
+            throw std::runtime_error("MockDrawBackend: draw outside the frame's instances!");
+        }
+        draws.push_back({ pipeline, material, mesh, firstInstance, instanceCount });
+    }
+
+    void endDraws() override {
+        if (!inDraws) {
+            throw std::runtime_error("MockDrawBackend: endDraws without beginDraws!");
+        }
+        inDraws = false;
+        frames++;
+    }
+
+    // ==================== Test Verification Methods ====================
+
+    const std::vector<std::string>& getCalls() const { return calls; }
+    const std::vector<DrawCall>& getDraws() const { return draws; }
+    const std::vector<DrawInstance>& getInstances() const { return instances; }
+    int getFrames() const { return frames; }
+
+    // Pipeline, material and mesh binds in the last frame (calls other than
+    // draws and the one setInstances)
+    size_t getBindCount() const { return calls.size() - draws.size() - 1; }
+
+private:
+    static constexpr uint32_t NONE = ~0u;
+
+    std::vector<std::string> calls;
+    std::vector<DrawCall> draws;
+    std::vector<DrawInstance> instances;
+    uint32_t pipeline = NONE;
+    uint32_t material = NONE;
+    uint32_t mesh = NONE;
+    bool inDraws = false;
+    int frames = 0;
+
+    void record(const std::string& call) {
+        if (!inDraws) {
+            throw std::runtime_error("MockDrawBackend: " + call + " outside beginDraws/endDraws!");
+        }
+        calls.push_back(call);
+    }
+};
@@ -46,6 +46,10 @@ public:
         // Mock implementation: do nothing
         // Real window would process OS events here
     }
+
+    void waitEvents() override {
+        // Mock implementation: return immediately instead of blocking
+    }
     
     int getWidth() const override {
         return width;
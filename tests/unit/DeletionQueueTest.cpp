@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "memory/DeletionQueue.h"
+#include <vector>
+
+/**
+ * Unit tests for DeletionQueue
+ * Serial bookkeeping only - deleters are plain lambdas
+ */
+
+TEST(DeletionQueueTest, RunsOnlyCompletedSerialsInOrder) {
+    DeletionQueue queue;
+    std::vector<int> destroyed;
+
+    queue.push(1, [&] { destroyed.push_back(1); });
+    queue.push(2, [&] { destroyed.push_back(2); });
+    queue.push(2, [&] { destroyed.push_back(3); });
+    queue.push(3, [&] { destroyed.push_back(4); });
+
+    EXPECT_EQ(queue.flush(0), 0u);
+    EXPECT_EQ(queue.flush(2), 3u);
+    EXPECT_EQ(destroyed, (std::vector<int>{ 1, 2, 3 }));
+    EXPECT_EQ(queue.size(), 1u);
+
+    EXPECT_EQ(queue.flush(3), 1u);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(DeletionQueueTest, OlderSerialWaitsForNewestPending) {
+    DeletionQueue queue;
+    int destroyed = 0;
+
+    queue.push(5, [&] { destroyed++; });
+    queue.push(3, [&] { destroyed++; });    // Held back until 5 completes
+
+    EXPECT_EQ(queue.flush(4), 0u);
+    EXPECT_EQ(queue.flush(5), 2u);
+    EXPECT_EQ(destroyed, 2);
+}
+
+TEST(DeletionQueueTest, DeletersMayPushAndFlushAllDrains) {
+    DeletionQueue queue;
+    int destroyed = 0;
+
+    queue.push(1, [&] {
+        destroyed++;
+        queue.push(10, [&] { destroyed++; });
+    });
+
+    EXPECT_EQ(queue.flush(1), 1u);
+    EXPECT_EQ(queue.size(), 1u);
+
+    EXPECT_EQ(queue.flushAll(), 1u);
+    EXPECT_EQ(destroyed, 2);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(DeletionQueueTest, DestructorRunsPendingDeleters) {
+    int destroyed = 0;
+    {
+        DeletionQueue queue;
+        queue.push(100, [&] { destroyed++; });
+    }
+    EXPECT_EQ(destroyed, 1);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "utils/DeviceSelector.h"
+#include <stdexcept>
+
+/**
+ * Unit tests for DeviceSelector
+ * Hand-built profiles for typical multi-adapter hosts
+ */
+
+namespace {
+
+DeviceProfile makeDevice(uint32_t index, const std::string& name, DeviceType type, uint64_t vramMiB) {
+    DeviceProfile profile;
+    profile.index = index;
+    profile.name = name;
+    profile.type = type;
+    profile.apiVersion = (1u << 22) | (3u << 12);
+    profile.deviceLocalBytes = vramMiB << 20;
+    profile.suitable = true;
+    profile.timelineSemaphore = true;
+    return profile;
+}
+
+void enableEverything(DeviceProfile& profile) {
+    profile.dedicatedTransferQueue = true;
+    profile.asyncComputeQueue = true;
+    profile.bindless = true;
+    profile.drawIndirectCount = true;
+    profile.multiDrawIndirect = true;
+    profile.synchronization2 = true;
+    profile.dynamicRendering = true;
+    profile.presentWait = true;
+}
+
+}
+
+TEST(DeviceSelectorTest, PrefersDiscreteOverIntegratedAndSoftware) {
+    // Enumeration order as seen on a laptop with lavapipe installed
+    DeviceProfile lavapipe = makeDevice(0, "llvmpipe (LLVM 17.0.6, 256 bits)", DeviceType::Cpu, 64 << 10);
+    DeviceProfile integrated = makeDevice(1, "Intel(R) UHD Graphics 770", DeviceType::Integrated, 32 << 10);
+    DeviceProfile discrete = makeDevice(2, "NVIDIA GeForce RTX 3060", DeviceType::Discrete, 6 << 10);
+    enableEverything(lavapipe);
+    enableEverything(integrated);
+
+    std::vector<DeviceProfile> profiles = { lavapipe, integrated, discrete };
+    EXPECT_EQ(DeviceSelector::select(profiles), 2u);
+
+    // Without the discrete card the iGPU wins over the software rasterizer
+    profiles.pop_back();
+    EXPECT_EQ(DeviceSelector::select(profiles), 1u);
+}
+
+TEST(DeviceSelectorTest, TypeOutranksEveryTieBreak) {
+    // lavapipe reports system RAM as device-local and enables everything
+    DeviceProfile lavapipe = makeDevice(0, "llvmpipe (LLVM 17.0.6, 256 bits)", DeviceType::Cpu, 64 << 10);
+    DeviceProfile virtualGpu = makeDevice(1, "Virtio-GPU Venus", DeviceType::Virtual, 256);
+    enableEverything(lavapipe);
+    EXPECT_EQ(DeviceSelector::select({ lavapipe, virtualGpu }), 1u);
+
+    DeviceProfile other = makeDevice(1, "Unknown adapter", DeviceType::Other, 0);
+    EXPECT_EQ(DeviceSelector::select({ lavapipe, other }), 1u);
+
+    // A fully featured virtual GPU still loses to a bare integrated one
+    DeviceProfile richVirtual = makeDevice(0, "Virtio-GPU Venus", DeviceType::Virtual, 64 << 10);
+    DeviceProfile bareIntegrated = makeDevice(1, "Intel(R) UHD Graphics 620", DeviceType::Integrated, 0);
+    enableEverything(richVirtual);
+    EXPECT_EQ(DeviceSelector::select({ richVirtual, bareIntegrated }), 1u);
+    EXPECT_GT(DeviceSelector::score(bareIntegrated), DeviceSelector::score(richVirtual));
+}
+
+TEST(DeviceSelectorTest, BreaksTiesOnMemoryQueuesAndFeatures) {
+    DeviceProfile small = makeDevice(0, "GPU A", DeviceType::Discrete, 8 << 10);
+    DeviceProfile large = makeDevice(1, "GPU B", DeviceType::Discrete, 16 << 10);
+    EXPECT_EQ(DeviceSelector::select({ small, large }), 1u);
+
+    DeviceProfile plain = makeDevice(0, "GPU A", DeviceType::Discrete, 8 << 10);
+    DeviceProfile transfer = plain;
+    transfer.index = 1;
+    transfer.dedicatedTransferQueue = true;
+    EXPECT_GT(DeviceSelector::score(transfer), DeviceSelector::score(plain));
+
+    DeviceProfile bindless = plain;
+    bindless.bindless = true;
+    EXPECT_GT(DeviceSelector::score(bindless), DeviceSelector::score(plain));
+
+    // Identical devices: first enumerated
+    EXPECT_EQ(DeviceSelector::select({ plain, plain }), 0u);
+}
+
+TEST(DeviceSelectorTest, RejectsDevicesMissingRequiredFeatures) {
+    DeviceProfile discrete = makeDevice(0, "Old discrete", DeviceType::Discrete, 8 << 10);
+    discrete.timelineSemaphore = false;
+    DeviceProfile integrated = makeDevice(1, "Integrated", DeviceType::Integrated, 2 << 10);
+
+    EXPECT_FALSE(DeviceSelector::rejectReason(discrete).empty());
+    EXPECT_EQ(DeviceSelector::score(discrete), -1);
+    EXPECT_EQ(DeviceSelector::select({ discrete, integrated }), 1u);
+
+    DeviceProfile noSwapchain = makeDevice(0, "Compute only", DeviceType::Discrete, 8 << 10);
+    noSwapchain.suitable = false;
+    DeviceProfile vulkan11 = makeDevice(1, "Vulkan 1.1", DeviceType::Discrete, 8 << 10);
+    vulkan11.apiVersion = (1u << 22) | (1u << 12);
+    EXPECT_THROW(DeviceSelector::select({ noSwapchain, vulkan11 }), std::runtime_error);
+    EXPECT_THROW(DeviceSelector::select({}), std::runtime_error);
+}
+
+TEST(DeviceSelectorTest, OverridesByIndexOrName) {
+    std::vector<DeviceProfile> profiles = {
+        makeDevice(0, "llvmpipe (LLVM 17.0.6, 256 bits)", DeviceType::Cpu, 64 << 10),
+        makeDevice(1, "Intel(R) UHD Graphics 770", DeviceType::Integrated, 32 << 10),
+        makeDevice(2, "NVIDIA GeForce RTX 3060", DeviceType::Discrete, 6 << 10),
+    };
+
+    EXPECT_EQ(DeviceSelector::select(profiles, "0"), 0u);
+    EXPECT_EQ(DeviceSelector::select(profiles, "1"), 1u);
+    EXPECT_EQ(DeviceSelector::select(profiles, "LLVMPIPE"), 0u);
+    EXPECT_EQ(DeviceSelector::select(profiles, "intel"), 1u);
+
+    // Matches all three: best score among them
+    EXPECT_EQ(DeviceSelector::select(profiles, "i"), 2u);
+
+    EXPECT_THROW(DeviceSelector::select(profiles, "3"), std::runtime_error);
+    EXPECT_THROW(DeviceSelector::select(profiles, "radeon"), std::runtime_error);
+
+    // An override cannot force a device that cannot run the renderer
+    profiles[0].timelineSemaphore = false;
+    EXPECT_THROW(DeviceSelector::select(profiles, "llvmpipe"), std::runtime_error);
+}
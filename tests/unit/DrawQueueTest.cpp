@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "renderer/DrawQueue.h"
+#include "renderer/Renderer.h"
+#include "utils/ThreadPool.h"
+#include "../mocks/MockDrawBackend.h"
+#include "../mocks/MockGraphicsContext.h"
+#include "../mocks/MockWindow.h"
+#include <algorithm>
+#include <random>
+#include <tuple>
+
+/**
+ * Unit tests for DrawQueue and the Renderer's draw submission
+ */
+
+namespace {
+
+DrawPacket packet(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth, uint32_t object) {
+    DrawPacket result;
+    result.pipeline = pipeline;
+    result.material = material;
+    result.mesh = mesh;
+    result.depth = depth;
+    result.object = object;
+    return result;
+}
+
+}
+
+TEST(DrawQueueTest, DepthQuantizationPreservesOrder) {
+    EXPECT_EQ(DrawQueue::quantizeDepth(-5.0f), 0u);
+    EXPECT_EQ(DrawQueue::quantizeDepth(0.0f), 0u);
+    EXPECT_LT(DrawQueue::quantizeDepth(0.5f), DrawQueue::quantizeDepth(1.0f));
+    EXPECT_LT(DrawQueue::quantizeDepth(1.0f), DrawQueue::quantizeDepth(100.0f));
+    EXPECT_LT(DrawQueue::quantizeDepth(100.0f), DrawQueue::quantizeDepth(1.0e6f));
+
+    // Pass dominates pipeline, pipeline dominates depth
+    DrawPacket near = packet(1, 0, 0, 1.0f, 0);
+    DrawPacket far = packet(1, 0, 0, 50.0f, 0);
+    EXPECT_LT(DrawQueue::makeKey(near), DrawQueue::makeKey(far));
+    EXPECT_LT(DrawQueue::makeKey(far), DrawQueue::makeKey(packet(2, 0, 0, 1.0f, 0)));
+    DrawPacket laterPass = packet(0, 0, 0, 0.0f, 0);
+    laterPass.pass = 1;
+    EXPECT_LT(DrawQueue::makeKey(packet(DrawQueue::MAX_PIPELINES - 1, 0, 0, 1.0f, 0)), DrawQueue::makeKey(laterPass));
+
+    EXPECT_THROW(DrawQueue::makeKey(packet(DrawQueue::MAX_PIPELINES, 0, 0, 1.0f, 0)), std::runtime_error);
+}
+
+TEST(DrawQueueTest, SortsByStateAndElidesRedundantBinds) {
+    // Interleaved worst case: every consecutive draw changes something
+    DrawQueue queue;
+    uint32_t object = 0;
+    for (int copy = 0; copy < 4; copy++) {
+        for (uint32_t pipeline = 0; pipeline < 2; pipeline++) {
+            for (uint32_t material = 0; material < 2; material++) {
+                queue.add(packet(pipeline, material, copy % 2, 10.0f - copy, object++));
+            }
+        }
+    }
+    queue.sort(nullptr);
+
+    MockDrawBackend backend;
+    const DrawQueueStats& stats = queue.submit(backend);
+    EXPECT_EQ(stats.packets, 16u);
+    EXPECT_EQ(stats.draws, 8u);             // Two instances per pipeline/material/mesh
+    EXPECT_EQ(stats.pipelineBinds, 2u);
+    EXPECT_EQ(stats.materialBinds, 4u);     // Rebound after each pipeline change
+    EXPECT_EQ(stats.meshBinds, 8u);         // Mesh alternates within each material group
+    EXPECT_EQ(stats.elidedBinds, 3u * 16u - 14u);
+    EXPECT_EQ(backend.getBindCount(), 14u);
+
+    // Grouped by pipeline, then material, then mesh, covering every instance once
+    const auto& draws = backend.getDraws();
+    ASSERT_EQ(draws.size(), 8u);
+    uint32_t nextInstance = 0;
+    for (size_t i = 0; i < draws.size(); i++) {
+        EXPECT_EQ(draws[i].firstInstance, nextInstance);
+        EXPECT_EQ(draws[i].instanceCount, 2u);
+        nextInstance += draws[i].instanceCount;
+        if (i > 0) {
+            const auto& a = draws[i - 1];
+            const auto& b = draws[i];
+            EXPECT_LT(std::make_tuple(a.pipeline, a.material, a.mesh), std::make_tuple(b.pipeline, b.material, b.mesh));
+        }
+    }
+    EXPECT_EQ(backend.getInstances().size(), 16u);
+
+    // Nearest first within a draw
+    EXPECT_LT(queue.getSorted(0).depth, queue.getSorted(1).depth);
+}
+
+TEST(DrawQueueTest, BackToFrontDrawsFarthestFirst) {
+    DrawQueue queue;
+    for (uint32_t i = 0; i < 5; i++) {
+        DrawPacket blended = packet(i % 2, i % 3, 0, static_cast<float>(i + 1), i);
+        blended.backToFront = true;
+        blended.pass = 1;
+        queue.add(blended);
+    }
+    // Opaque pass draws first regardless of depth
+    queue.add(packet(3, 0, 0, 1000.0f, 5));
+    queue.sort(nullptr);
+
+    EXPECT_EQ(queue.getSorted(0).object, 5u);
+    for (uint32_t i = 1; i < queue.size(); i++) {
+        EXPECT_EQ(queue.getSorted(i).object, 5u - i);
+    }
+}
+
+TEST(DrawQueueTest, NeverMergesAcrossPasses) {
+    // Same state in two passes ends up adjacent after sorting
+    DrawQueue queue;
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        DrawPacket draw = packet(1, 2, 3, 1.0f, pass);
+        draw.pass = pass;
+        queue.add(draw);
+        queue.add(draw);
+    }
+    queue.sort(nullptr);
+
+    MockDrawBackend backend;
+    const DrawQueueStats& stats = queue.submit(backend);
+    EXPECT_EQ(stats.draws, 2u);
+    EXPECT_EQ(stats.elidedBinds, 3u * 4u - 3u);
+    ASSERT_EQ(backend.getDraws().size(), 2u);
+    EXPECT_EQ(backend.getDraws()[0].instanceCount, 2u);
+    EXPECT_EQ(backend.getDraws()[1].firstInstance, 2u);
+}
+
+TEST(DrawQueueTest, RendererSubmitsVisibleObjectsSorted) {
+    MockWindow window(800, 600, "Test");
+    MockGraphicsContext context;
+    Renderer renderer(&window, &context);
+    renderer.initialize();
+
+    MockDrawBackend backend;
+    renderer.setDrawBackend(&backend);
+    renderer.setMaterial(1, { 1, 0, false });
+    renderer.setMaterial(2, { 1, 0, false });
+
+    // 2000 objects over 3 materials and 4 meshes, created in shuffled order;
+    // the x position identifies each object
+    std::mt19937 rng(5);
+    Scene& scene = renderer.getScene();
+    std::vector<std::pair<uint32_t, uint32_t>> meshMaterials;
+    for (uint32_t i = 0; i < 2000; i++) {
+        Entity entity = scene.createEntity(RENDERABLE_COMPONENTS);
+        meshMaterials.push_back({ rng() % 4, rng() % 3 });
+        scene.getMesh(entity).meshIndex = meshMaterials.back().first;
+        scene.getMaterial(entity).materialIndex = meshMaterials.back().second;
+        scene.getTransform(entity).position[0] = static_cast<float>(i);
+    }
+    // Drawn only with a mesh and a material
+    scene.createEntity(componentBit(SceneComponent::Transform) | componentBit(SceneComponent::Bounds));
+
+    ThreadPool pool(2);
+    renderer.setThreadPool(&pool);
+    renderer.renderFrame();
+
+    RendererStats stats = renderer.getStats();
+    EXPECT_EQ(stats.visibleCount, 2001u);
+    EXPECT_EQ(stats.instanceCount, 2000u);
+
+    // Pipelines 0 and 1, material 0 on the first and 1, 2 on the second,
+    // every mesh under each material: one instanced draw per material/mesh
+    EXPECT_EQ(stats.drawCount, 12u);
+    EXPECT_EQ(backend.getDraws().size(), 12u);
+    EXPECT_EQ(stats.stateChanges, 2u + 3u + 12u);
+    EXPECT_EQ(stats.elidedStateChanges, 3u * 2000u - stats.stateChanges);
+    EXPECT_EQ(backend.getFrames(), 1);
+    EXPECT_TRUE(context.allFramesCompleted());
+
+    // Every draw's instance range holds exactly the objects with its mesh and material
+    std::vector<bool> seen(2000, false);
+    for (const MockDrawBackend::DrawCall& draw : backend.getDraws()) {
+        for (uint32_t i = draw.firstInstance; i < draw.firstInstance + draw.instanceCount; i++) {
+            uint32_t object = static_cast<uint32_t>(backend.getInstances()[i].position[0]);
+            ASSERT_LT(object, 2000u);
+            EXPECT_FALSE(seen[object]);
+            seen[object] = true;
+            EXPECT_EQ(meshMaterials[object].first, draw.mesh);
+            EXPECT_EQ(meshMaterials[object].second, draw.material);
+        }
+    }
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), true), 2000);
+
+    renderer.cleanup();
+}
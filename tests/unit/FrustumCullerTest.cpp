@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "renderer/FrustumCuller.h"
+#include "renderer/Scene.h"
+#include "utils/ThreadPool.h"
+#include <random>
+
+/**
+ * Unit tests for FrustumCuller
+ * Every SIMD level the host supports is checked against the scalar path
+ */
+
+namespace {
+
+// Orthographic box [-10, 10] x [-10, 10], depth 0..100 along +z
+void boxPlanes(float planes[6][4]) {
+    const float box[6][4] = {
+        {  1.0f,  0.0f,  0.0f, 10.0f },
+        { -1.0f,  0.0f,  0.0f, 10.0f },
+        {  0.0f,  1.0f,  0.0f, 10.0f },
+        {  0.0f, -1.0f,  0.0f, 10.0f },
+        {  0.0f,  0.0f,  1.0f,  0.0f },
+        {  0.0f,  0.0f, -1.0f, 100.0f },
+    };
+    for (int p = 0; p < 6; p++) {
+        for (int c = 0; c < 4; c++) {
+            planes[p][c] = box[p][c];
+        }
+    }
+}
+
+struct SphereData {
+    std::vector<float> x, y, z, radius;
+
+    explicit SphereData(uint32_t count, uint32_t seed = 1) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(-40.0f, 140.0f);
+        std::uniform_real_distribution<float> size(0.0f, 5.0f);
+        for (uint32_t i = 0; i < count; i++) {
+            x.push_back(position(rng) - 50.0f);
+            y.push_back(position(rng) - 50.0f);
+            z.push_back(position(rng));
+            radius.push_back(size(rng));
+        }
+    }
+
+    SphereStreams streams() const {
+        SphereStreams spheres;
+        spheres.centerX = x.data();
+        spheres.centerY = y.data();
+        spheres.centerZ = z.data();
+        spheres.radius = radius.data();
+        spheres.count = static_cast<uint32_t>(x.size());
+        return spheres;
+    }
+};
+
+}
+
+TEST(FrustumCullerTest, KeepsSpheresTouchingTheFrustum) {
+    float planes[6][4];
+    boxPlanes(planes);
+
+    // Inside, straddling the right plane, just outside it, behind the camera
+    SphereData spheres(0);
+    spheres.x = { 0.0f, 11.0f, 12.5f, 0.0f };
+    spheres.y = { 0.0f, 0.0f, 0.0f, 0.0f };
+    spheres.z = { 50.0f, 50.0f, 50.0f, -3.0f };
+    spheres.radius = { 1.0f, 2.0f, 2.0f, 2.0f };
+
+    FrustumCuller culler(SimdLevel::Scalar);
+    std::vector<uint32_t> visible;
+    culler.cull(planes, spheres.streams(), nullptr, visible);
+    EXPECT_EQ(visible, (std::vector<uint32_t>{ 0, 1 }));
+}
+
+TEST(FrustumCullerTest, SimdLevelsMatchScalar) {
+    float planes[6][4];
+    boxPlanes(planes);
+
+    // Not a multiple of 8: exercises the scalar tail of the SIMD paths
+    SphereData spheres(10003);
+    FrustumCuller scalar(SimdLevel::Scalar);
+    std::vector<uint32_t> expected;
+    scalar.cull(planes, spheres.streams(), nullptr, expected);
+    ASSERT_GT(expected.size(), 0u);
+    ASSERT_LT(expected.size(), spheres.x.size());
+
+    ThreadPool pool(3);
+    for (SimdLevel level : { SimdLevel::Sse41, SimdLevel::Avx2 }) {
+        FrustumCuller culler(level);
+        EXPECT_LE(culler.getSimdLevel(), FrustumCuller::detectSimdLevel());
+
+        std::vector<uint32_t> visible;
+        culler.cull(planes, spheres.streams(), nullptr, visible);
+        EXPECT_EQ(visible, expected) << FrustumCuller::simdLevelName(culler.getSimdLevel());
+
+        // Several ranges on the pool, same order
+        culler.cull(planes, spheres.streams(), &pool, visible);
+        EXPECT_EQ(visible, expected) << FrustumCuller::simdLevelName(culler.getSimdLevel());
+    }
+}
+
+TEST(FrustumCullerTest, CullsSceneChunksInParallel) {
+    float planes[6][4];
+    boxPlanes(planes);
+
+    SphereData spheres(5000, 7);
+    Scene scene;
+    std::vector<Entity> entities;
+    for (size_t i = 0; i < spheres.x.size(); i++) {
+        Entity entity = scene.createEntity(RENDERABLE_COMPONENTS);
+        BoundsComponent bounds;
+        bounds.center[0] = spheres.x[i];
+        bounds.center[1] = spheres.y[i];
+        bounds.center[2] = spheres.z[i];
+        bounds.radius = spheres.radius[i];
+        scene.setBounds(entity, bounds);
+        entities.push_back(entity);
+    }
+    // No bounds: never tested
+    scene.createEntity(componentBit(SceneComponent::Transform));
+
+    FrustumCuller culler;
+    std::vector<uint32_t> expected;
+    culler.cull(planes, spheres.streams(), nullptr, expected);
+
+    SceneCullResult serial;
+    culler.cull(planes, scene, nullptr, serial);
+    EXPECT_EQ(serial.testedCount, 5000u);
+    ASSERT_EQ(serial.visible.size(), expected.size());
+
+    // Entities were created in order into full chunks, so rows map back 1:1
+    for (size_t i = 0; i < expected.size(); i++) {
+        const VisibleObject& object = serial.visible[i];
+        EXPECT_EQ(serial.chunks[object.chunk]->entities[object.row], entities[expected[i]]);
+    }
+
+    ThreadPool pool(4);
+    SceneCullResult parallel;
+    culler.cull(planes, scene, &pool, parallel);
+    ASSERT_EQ(parallel.visible.size(), serial.visible.size());
+    for (size_t i = 0; i < serial.visible.size(); i++) {
+        EXPECT_EQ(parallel.visible[i].chunk, serial.visible[i].chunk);
+        EXPECT_EQ(parallel.visible[i].row, serial.visible[i].row);
+    }
+}
+
+TEST(FrustumCullerTest, ExtractsNormalizedPlanes) {
+    // Orthographic projection of the box above: x, y / 10, z / 100 (column-major)
+    const float matrix[16] = {
+        0.1f, 0.0f, 0.0f, 0.0f,
+        0.0f, 0.1f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.01f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f,
+    };
+    float planes[6][4];
+    FrustumCuller::extractPlanes(matrix, planes);
+
+    float expected[6][4];
+    boxPlanes(expected);
+    for (int p = 0; p < 6; p++) {
+        for (int c = 0; c < 4; c++) {
+            EXPECT_NEAR(planes[p][c], expected[p][c], 1e-4f) << "plane " << p;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "utils/LatencyTracker.h"
+
+/**
+ * Unit tests for LatencyTracker
+ * Uses explicit time points, so results are exact and timing-independent
+ */
+
+namespace {
+
+LatencyTracker::TimePoint at(int ms) {
+    return LatencyTracker::TimePoint(std::chrono::milliseconds(ms));
+}
+
+}
+
+TEST(LatencyTrackerTest, MeasuresFromLastInputSample) {
+    LatencyTracker tracker;
+
+    tracker.markInput(at(100));
+    tracker.markSubmit(1, at(104));
+    tracker.markPresent(1, at(105));
+    tracker.markDisplayed(1, at(120));
+
+    LatencySample sample = tracker.getLastSample();
+    EXPECT_EQ(sample.frameId, 1u);
+    EXPECT_DOUBLE_EQ(sample.inputToSubmitMs, 4.0);
+    EXPECT_DOUBLE_EQ(sample.inputToPresentMs, 5.0);
+    EXPECT_DOUBLE_EQ(sample.inputToDisplayMs, 20.0);
+}
+
+TEST(LatencyTrackerTest, DisplayTimeIsOptionalAndMayArriveLate) {
+    LatencyTracker tracker;
+
+    tracker.markInput(at(0));
+    tracker.markSubmit(1, at(2));
+    tracker.markPresent(1, at(3));
+    tracker.markInput(at(10));
+    tracker.markSubmit(2, at(12));
+    tracker.markPresent(2, at(13));
+
+    EXPECT_DOUBLE_EQ(tracker.getLastSample().inputToDisplayMs, -1.0);
+    EXPECT_EQ(tracker.getStats().displayedFrames, 0u);
+
+    // Frame 1 reaches the screen after frame 2 was presented
+    tracker.markDisplayed(1, at(30));
+    LatencyStats stats = tracker.getStats();
+    EXPECT_EQ(stats.frames, 2u);
+    EXPECT_EQ(stats.displayedFrames, 1u);
+    EXPECT_DOUBLE_EQ(stats.averageInputToDisplayMs, 30.0);
+    EXPECT_DOUBLE_EQ(stats.averageInputToPresentMs, 3.0);
+}
+
+TEST(LatencyTrackerTest, KeepsOnlyHistoryWindow) {
+    LatencyTracker tracker(10);
+
+    for (int i = 1; i <= 100; i++) {
+        tracker.markInput(at(i * 10));
+        tracker.markSubmit(i, at(i * 10 + (i > 90 ? 5 : 1)));
+        tracker.markPresent(i, at(i * 10 + (i > 90 ? 5 : 1)));
+    }
+
+    LatencyStats stats = tracker.getStats();
+    EXPECT_EQ(stats.frames, 10u);
+    EXPECT_DOUBLE_EQ(stats.averageInputToPresentMs, 5.0);
+    EXPECT_DOUBLE_EQ(stats.p95InputToPresentMs, 5.0);
+
+    // Marks for evicted frames are ignored
+    tracker.markDisplayed(1, at(5000));
+    EXPECT_EQ(tracker.getStats().displayedFrames, 0u);
+}
+
+TEST(LatencyTrackerTest, PercentileReflectsOutliers) {
+    LatencyTracker tracker(100);
+
+    for (int i = 1; i <= 100; i++) {
+        int latency = (i % 20 == 0) ? 50 : 10;     // 5% slow frames
+        tracker.markInput(at(i * 100));
+        tracker.markSubmit(i, at(i * 100 + 1));
+        tracker.markPresent(i, at(i * 100 + latency));
+    }
+
+    LatencyStats stats = tracker.getStats();
+    EXPECT_DOUBLE_EQ(stats.p95InputToPresentMs, 10.0);
+    EXPECT_DOUBLE_EQ(stats.averageInputToPresentMs, 12.0);
+
+    tracker.markInput(at(20000));
+    tracker.markSubmit(101, at(20001));
+    tracker.markPresent(101, at(20050));
+    EXPECT_DOUBLE_EQ(tracker.getStats().p95InputToPresentMs, 50.0);
+}
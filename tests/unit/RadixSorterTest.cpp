@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "utils/RadixSorter.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <random>
+
+/**
+ * Unit tests for RadixSorter
+ * Results are compared against std::stable_sort on the same pairs
+ */
+
+namespace {
+
+void expectSortedLikeStableSort(std::vector<uint64_t> keys, ThreadPool* pool) {
+    std::vector<std::pair<uint64_t, uint32_t>> expected;
+    std::vector<uint32_t> values;
+    for (uint32_t i = 0; i < keys.size(); i++) {
+        expected.push_back({ keys[i], i });
+        values.push_back(i);
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    RadixSorter sorter;
+    sorter.sort(keys, values, pool);
+
+    ASSERT_EQ(keys.size(), expected.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(keys[i], expected[i].first) << "at " << i;
+        ASSERT_EQ(values[i], expected[i].second) << "at " << i;
+    }
+}
+
+}
+
+TEST(RadixSorterTest, SortsFullWidthKeys) {
+    std::mt19937_64 rng(3);
+    std::vector<uint64_t> keys(5000);
+    for (uint64_t& key : keys) {
+        key = rng();
+    }
+    expectSortedLikeStableSort(keys, nullptr);
+}
+
+TEST(RadixSorterTest, IsStableAndSkipsConstantDigits) {
+    // Only bits 16..23 vary, with many duplicates
+    std::vector<uint64_t> keys;
+    for (uint32_t i = 0; i < 1000; i++) {
+        keys.push_back(0xAB00000000000000ull | (static_cast<uint64_t>((i * 7) % 13) << 16));
+    }
+    expectSortedLikeStableSort(keys, nullptr);
+
+    std::vector<uint32_t> values(keys.size());
+    RadixSorter sorter;
+    sorter.sort(keys, values);
+    EXPECT_EQ(sorter.getLastPassCount(), 1u);
+
+    // Already equal keys need no pass at all
+    std::vector<uint64_t> same(10, 42);
+    std::vector<uint32_t> sameValues(10, 0);
+    sorter.sort(same, sameValues);
+    EXPECT_EQ(sorter.getLastPassCount(), 0u);
+}
+
+TEST(RadixSorterTest, ParallelMatchesSerial) {
+    // Enough keys for several blocks; narrow range for duplicates across blocks
+    std::mt19937_64 rng(11);
+    std::vector<uint64_t> keys(4 * RadixSorter::MIN_BLOCK_SIZE + 123);
+    for (uint64_t& key : keys) {
+        key = rng() & 0x0000FFFF000000FFull;
+    }
+
+    ThreadPool pool(3);
+    expectSortedLikeStableSort(keys, &pool);
+}
+
+TEST(RadixSorterTest, RejectsMismatchedValues) {
+    std::vector<uint64_t> keys(4, 1);
+    std::vector<uint32_t> values(3, 0);
+    RadixSorter sorter;
+    EXPECT_THROW(sorter.sort(keys, values), std::runtime_error);
+}
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include "renderer/RenderGraph.h"
+#include <stdexcept>
+
+/**
+ * Unit tests for RenderGraph
+ * Pass culling, barrier derivation and transient aliasing, no GPU involved
+ */
+
+namespace {
+
+const RenderGraphTextureDesc FULLSCREEN = { 1920, 1080, 0 };
+
+// Every texture takes `size` bytes with 256-byte alignment
+RenderGraph::MemoryQuery fixedSize(uint64_t size) {
+    return [size](RenderGraphResource) {
+        RenderGraphMemoryRequirements requirements;
+        requirements.size = size;
+        requirements.alignment = 256;
+        return requirements;
+    };
+}
+
+}
+
+TEST(RenderGraphTest, CullsPassesThatDoNotReachAnOutput) {
+    RenderGraph graph;
+    RenderGraphResource backbuffer = graph.importTexture("backbuffer", RenderGraphUsage::None, RenderGraphUsage::Present);
+    RenderGraphResource albedo = graph.createTexture("albedo", FULLSCREEN);
+    RenderGraphResource debug = graph.createTexture("debug", FULLSCREEN);
+    RenderGraphResource readback = graph.createTexture("readback", FULLSCREEN);
+
+    uint32_t gbuffer = graph.addPass("gbuffer");
+    graph.write(gbuffer, albedo, RenderGraphUsage::ColorAttachment);
+
+    uint32_t debugView = graph.addPass("debug_view");
+    graph.read(debugView, albedo, RenderGraphUsage::Sampled);
+    graph.write(debugView, debug, RenderGraphUsage::ColorAttachment);
+
+    uint32_t lighting = graph.addPass("lighting");
+    graph.read(lighting, albedo, RenderGraphUsage::Sampled);
+    graph.write(lighting, backbuffer, RenderGraphUsage::ColorAttachment);
+
+    // Nothing reads its output, but it must run anyway
+    uint32_t capture = graph.addPass("capture", true);
+    graph.read(capture, albedo, RenderGraphUsage::TransferSrc);
+    graph.write(capture, readback, RenderGraphUsage::TransferDst);
+
+    graph.compile(fixedSize(1 << 20));
+
+    EXPECT_FALSE(graph.isPassCulled(gbuffer));
+    EXPECT_TRUE(graph.isPassCulled(debugView));
+    EXPECT_FALSE(graph.isPassCulled(lighting));
+    EXPECT_FALSE(graph.isPassCulled(capture));
+    EXPECT_FALSE(graph.isResourceUsed(debug));
+    EXPECT_TRUE(graph.isResourceUsed(readback));
+
+    const RenderGraphStats& stats = graph.getStats();
+    EXPECT_EQ(stats.passCount, 3u);
+    EXPECT_EQ(stats.culledPassCount, 1u);
+    EXPECT_EQ(stats.transientCount, 2u);
+}
+
+TEST(RenderGraphTest, EmitsOnlyTheBarriersUsageChangesNeed) {
+    RenderGraph graph;
+    RenderGraphResource backbuffer = graph.importTexture("backbuffer", RenderGraphUsage::None, RenderGraphUsage::Present);
+    RenderGraphResource shadow = graph.createTexture("shadow", FULLSCREEN);
+
+    uint32_t shadowPass = graph.addPass("shadow");
+    graph.write(shadowPass, shadow, RenderGraphUsage::DepthAttachment);
+
+    uint32_t opaque = graph.addPass("opaque");
+    graph.read(opaque, shadow, RenderGraphUsage::Sampled);
+    graph.write(opaque, backbuffer, RenderGraphUsage::ColorAttachment);
+
+    // Same usage as the previous reader: no barrier for the shadow map
+    uint32_t transparent = graph.addPass("transparent");
+    graph.read(transparent, shadow, RenderGraphUsage::Sampled);
+    graph.write(transparent, backbuffer, RenderGraphUsage::ColorAttachment);
+
+    graph.compile(fixedSize(1 << 20));
+
+    const std::vector<RenderGraphCompiledPass>& passes = graph.getCompiledPasses();
+    ASSERT_EQ(passes.size(), 3u);
+
+    ASSERT_EQ(passes[0].barriers.size(), 1u);
+    EXPECT_TRUE(passes[0].barriers[0].discard);
+    EXPECT_EQ(passes[0].barriers[0].dstUsage, RenderGraphUsage::DepthAttachment);
+
+    // Shadow depth -> sampled, backbuffer undefined -> color, in one batch
+    ASSERT_EQ(passes[1].barriers.size(), 2u);
+    EXPECT_EQ(passes[1].barriers[0].resource, shadow);
+    EXPECT_EQ(passes[1].barriers[0].srcUsage, RenderGraphUsage::DepthAttachment);
+    EXPECT_EQ(passes[1].barriers[0].dstUsage, RenderGraphUsage::Sampled);
+    EXPECT_TRUE(passes[1].barriers[1].discard);
+
+    // Write-after-write on the backbuffer still orders the two passes
+    ASSERT_EQ(passes[2].barriers.size(), 1u);
+    EXPECT_EQ(passes[2].barriers[0].resource, backbuffer);
+    EXPECT_EQ(passes[2].barriers[0].srcUsage, RenderGraphUsage::ColorAttachment);
+
+    ASSERT_EQ(graph.getFinalBarriers().size(), 1u);
+    EXPECT_EQ(graph.getFinalBarriers()[0].dstUsage, RenderGraphUsage::Present);
+
+    EXPECT_EQ(graph.getStats().barrierCount, 5u);
+    EXPECT_EQ(graph.getStats().barrierBatchCount, 4u);
+}
+
+TEST(RenderGraphTest, AliasesTransientsWithDisjointLifetimes) {
+    RenderGraph graph;
+    RenderGraphResource backbuffer = graph.importTexture("backbuffer", RenderGraphUsage::None, RenderGraphUsage::Present);
+    RenderGraphResource gbuffer = graph.createTexture("gbuffer", FULLSCREEN);
+    RenderGraphResource hdr = graph.createTexture("hdr", FULLSCREEN);
+    RenderGraphResource bloom = graph.createTexture("bloom", FULLSCREEN);
+
+    uint32_t geometry = graph.addPass("geometry");
+    graph.write(geometry, gbuffer, RenderGraphUsage::ColorAttachment);
+
+    uint32_t lighting = graph.addPass("lighting");
+    graph.read(lighting, gbuffer, RenderGraphUsage::Sampled);
+    graph.write(lighting, hdr, RenderGraphUsage::ColorAttachment);
+
+    // gbuffer is dead from here on; bloom can take its memory
+    uint32_t bloomPass = graph.addPass("bloom");
+    graph.read(bloomPass, hdr, RenderGraphUsage::Sampled);
+    graph.write(bloomPass, bloom, RenderGraphUsage::StorageWrite);
+
+    uint32_t tonemap = graph.addPass("tonemap");
+    graph.read(tonemap, hdr, RenderGraphUsage::Sampled);
+    graph.read(tonemap, bloom, RenderGraphUsage::Sampled);
+    graph.write(tonemap, backbuffer, RenderGraphUsage::ColorAttachment);
+
+    const uint64_t size = 8ull << 20;
+    graph.compile(fixedSize(size));
+
+    // hdr overlaps both, so it gets its own range
+    EXPECT_EQ(graph.getPlacement(bloom).offset, graph.getPlacement(gbuffer).offset);
+    EXPECT_NE(graph.getPlacement(hdr).offset, graph.getPlacement(gbuffer).offset);
+
+    const RenderGraphStats& stats = graph.getStats();
+    EXPECT_EQ(stats.transientBytes, 3 * size);
+    EXPECT_EQ(stats.aliasedBytes, 2 * size);
+    EXPECT_EQ(stats.savedBytes, size);
+
+    // bloom's first write waits for the last sampled read of the gbuffer
+    const RenderGraphCompiledPass& bloomCompiled = graph.getCompiledPasses()[2];
+    bool found = false;
+    for (const RenderGraphBarrier& barrier : bloomCompiled.barriers) {
+        if (barrier.resource == bloom) {
+            found = true;
+            EXPECT_TRUE(barrier.discard);
+            EXPECT_EQ(barrier.aliasWaitMask, 1u << static_cast<uint32_t>(RenderGraphUsage::Sampled));
+        }
+    }
+    EXPECT_TRUE(found);
+}
+
+TEST(RenderGraphTest, RejectsInvalidAccesses) {
+    RenderGraph graph;
+    RenderGraphResource backbuffer = graph.importTexture("backbuffer", RenderGraphUsage::None, RenderGraphUsage::Present);
+    RenderGraphResource texture = graph.createTexture("texture", FULLSCREEN);
+
+    uint32_t pass = graph.addPass("pass");
+    EXPECT_THROW(graph.write(pass, texture, RenderGraphUsage::Sampled), std::runtime_error);
+    EXPECT_THROW(graph.read(pass, texture, RenderGraphUsage::ColorAttachment), std::runtime_error);
+    EXPECT_THROW(graph.createTexture("empty", RenderGraphTextureDesc{}), std::runtime_error);
+
+    // Sampling a texture while rendering to it is a feedback loop
+    graph.read(pass, texture, RenderGraphUsage::Sampled);
+    EXPECT_THROW(graph.write(pass, texture, RenderGraphUsage::ColorAttachment), std::runtime_error);
+
+    // Never written before being read
+    graph.write(pass, backbuffer, RenderGraphUsage::ColorAttachment);
+    EXPECT_THROW(graph.compile(fixedSize(1024)), std::runtime_error);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "memory/RingAllocator.h"
+#include <vector>
+
+/**
+ * Unit tests for RingAllocator
+ * Pure offset bookkeeping for the staging ring - no GPU memory involved
+ */
+
+TEST(RingAllocatorTest, AllocatesLinearly) {
+    RingAllocator ring(1024);
+
+    EXPECT_EQ(ring.allocate(100), 0u);
+    EXPECT_EQ(ring.allocate(100), 100u);
+    EXPECT_EQ(ring.allocate(100, 64), 256u);
+
+    // 56 bytes of alignment padding are accounted as used
+    EXPECT_EQ(ring.getUsedBytes(), 356u);
+    EXPECT_EQ(ring.getOpenBytes(), 356u);
+}
+
+TEST(RingAllocatorTest, FailsWhenFullAndRecoversAfterRelease) {
+    RingAllocator ring(1000);
+
+    EXPECT_EQ(ring.allocate(600), 0u);
+    ring.endSubmission(1);
+    EXPECT_EQ(ring.allocate(400), 600u);
+    ring.endSubmission(2);
+
+    EXPECT_EQ(ring.allocate(1), RingAllocator::INVALID_OFFSET);
+
+    ring.release(1);
+    EXPECT_EQ(ring.getUsedBytes(), 400u);
+    EXPECT_EQ(ring.allocate(500), 0u);  // Wraps into the released front
+}
+
+TEST(RingAllocatorTest, WrapsAroundAndAccountsPadding) {
+    RingAllocator ring(1000);
+
+    ring.allocate(700);
+    ring.endSubmission(1);
+    ring.allocate(200);
+    ring.endSubmission(2);
+    ring.release(1);
+
+    // 100 bytes left at the end are too small; wrap to 0 and skip them
+    EXPECT_EQ(ring.allocate(300), 0u);
+    EXPECT_EQ(ring.getUsedBytes(), 200u + 100u + 300u);
+    ring.endSubmission(3);
+
+    ring.release(2);
+    EXPECT_EQ(ring.getUsedBytes(), 400u);  // Wrap padding belongs to submission 3
+    ring.release(3);
+    EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(RingAllocatorTest, NeverOverlapsInFlightData) {
+    RingAllocator ring(4096);
+
+    struct Range { uint64_t offset, size, serial; };
+    std::vector<Range> live;
+    uint64_t serial = 0;
+    uint64_t released = 0;
+
+    for (int frame = 0; frame < 500; frame++) {
+        for (int i = 0; i < 5; i++) {
+            uint64_t size = 16 + (frame * 37 + i * 101) % 300;
+            uint64_t offset = ring.allocate(size, 16);
+            if (offset == RingAllocator::INVALID_OFFSET) {
+                continue;
+            }
+            EXPECT_EQ(offset % 16, 0u);
+            EXPECT_LE(offset + size, ring.getCapacity());
+
+            for (const auto& other : live) {
+                bool disjoint = offset + size <= other.offset || other.offset + other.size <= offset;
+                EXPECT_TRUE(disjoint) << "frame " << frame;
+            }
+            live.push_back({ offset, size, serial + 1 });
+        }
+        ring.endSubmission(++serial);
+
+        // GPU lags two submissions behind
+        if (serial > 2) {
+            released = serial - 2;
+            ring.release(released);
+            std::vector<Range> stillLive;
+            for (const auto& range : live) {
+                if (range.serial > released) {
+                    stillLive.push_back(range);
+                }
+            }
+            live.swap(stillLive);
+        }
+    }
+
+    ring.release(serial);
+    EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(RingAllocatorTest, RejectsOversizedRequests) {
+    RingAllocator ring(256);
+
+    EXPECT_EQ(ring.allocate(257), RingAllocator::INVALID_OFFSET);
+    EXPECT_EQ(ring.allocate(0), RingAllocator::INVALID_OFFSET);
+    EXPECT_EQ(ring.allocate(256), 0u);
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "renderer/Scene.h"
+#include "utils/ThreadPool.h"
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * Unit tests for Scene
+ * Archetype chunk layout, entity lifetime and chunk iteration
+ */
+
+TEST(SceneTest, LaysOutChunksAsAlignedComponentArrays) {
+    // 8 (entity) + 32 (transform) + 16 (bounds) + 4 + 4 bytes per entity
+    EXPECT_EQ(Scene::chunkCapacity(RENDERABLE_COMPONENTS), 256u);
+    EXPECT_EQ(Scene::chunkCapacity(componentBit(SceneComponent::Transform)) % 8, 0u);
+
+    Scene scene;
+    Entity entity = scene.createEntity(RENDERABLE_COMPONENTS);
+
+    std::vector<SceneChunk*> chunks = scene.getChunks(RENDERABLE_COMPONENTS);
+    ASSERT_EQ(chunks.size(), 1u);
+    const SceneChunk& chunk = *chunks[0];
+    EXPECT_EQ(chunk.count, 1u);
+    EXPECT_EQ(chunk.entities[0], entity);
+
+    const void* columns[] = {
+        chunk.entities, chunk.transforms, chunk.boundsCenterX, chunk.boundsCenterY,
+        chunk.boundsCenterZ, chunk.boundsRadius, chunk.meshes, chunk.materials
+    };
+    for (const void* column : columns) {
+        ASSERT_NE(column, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(column) % Scene::CHUNK_ALIGNMENT, 0u);
+    }
+
+    // Defaults
+    EXPECT_FLOAT_EQ(chunk.transforms[0].scale, 1.0f);
+    EXPECT_FLOAT_EQ(chunk.transforms[0].rotation[3], 1.0f);
+    EXPECT_FLOAT_EQ(chunk.boundsRadius[0], 0.0f);
+}
+
+TEST(SceneTest, DestroyKeepsChunksDenseAndHandlesValid) {
+    Scene scene;
+    const uint32_t capacity = Scene::chunkCapacity(RENDERABLE_COMPONENTS);
+
+    std::vector<Entity> entities;
+    for (uint32_t i = 0; i < capacity + 10; i++) {
+        Entity entity = scene.createEntity(RENDERABLE_COMPONENTS);
+        scene.getMesh(entity).meshIndex = i;
+        entities.push_back(entity);
+    }
+    EXPECT_EQ(scene.getStats().chunkCount, 2u);
+
+    // The last entity moves into the hole; its handle keeps working
+    scene.destroyEntity(entities[3]);
+    EXPECT_FALSE(scene.isAlive(entities[3]));
+    EXPECT_THROW(scene.getMesh(entities[3]), std::runtime_error);
+    EXPECT_EQ(scene.getMesh(entities.back()).meshIndex, capacity + 9);
+    EXPECT_EQ(scene.getChunks(RENDERABLE_COMPONENTS)[0]->count, capacity);
+
+    // Emptying the tail chunk frees it
+    for (uint32_t i = 0; i < 9; i++) {
+        scene.destroyEntity(entities[capacity + i]);
+    }
+    EXPECT_EQ(scene.getStats().chunkCount, 1u);
+    EXPECT_EQ(scene.getEntityCount(), capacity);
+
+    // Reused index, new generation
+    Entity reused = scene.createEntity(RENDERABLE_COMPONENTS);
+    EXPECT_EQ(reused.index, entities[capacity + 8].index);
+    EXPECT_NE(reused, entities[capacity + 8]);
+    EXPECT_FALSE(scene.isAlive(entities[capacity + 8]));
+}
+
+TEST(SceneTest, ClearInvalidatesExistingHandles) {
+    Scene scene;
+    Entity first = scene.createEntity(RENDERABLE_COMPONENTS);
+    Entity second = scene.createEntity(componentBit(SceneComponent::Transform));
+    scene.destroyEntity(second);
+    Entity third = scene.createEntity(RENDERABLE_COMPONENTS);
+
+    scene.clear();
+    EXPECT_EQ(scene.getEntityCount(), 0u);
+    EXPECT_EQ(scene.getStats().chunkCount, 0u);
+    EXPECT_FALSE(scene.isAlive(first));
+    EXPECT_FALSE(scene.isAlive(third));
+
+    // New entities reuse the indices, lowest first, under new generations
+    Entity reused = scene.createEntity(RENDERABLE_COMPONENTS);
+    EXPECT_EQ(reused.index, first.index);
+    EXPECT_NE(reused, first);
+    EXPECT_FALSE(scene.isAlive(first));
+    EXPECT_THROW(scene.getMesh(first), std::runtime_error);
+    EXPECT_TRUE(scene.isAlive(reused));
+
+    Entity reusedAgain = scene.createEntity(RENDERABLE_COMPONENTS);
+    EXPECT_EQ(reusedAgain.index, third.index);
+    EXPECT_NE(reusedAgain, third);
+    EXPECT_FALSE(scene.isAlive(third));
+}
+
+TEST(SceneTest, AddingComponentsMovesBetweenArchetypes) {
+    Scene scene;
+    const ComponentMask transformOnly = componentBit(SceneComponent::Transform);
+
+    Entity entity = scene.createEntity(transformOnly);
+    Entity other = scene.createEntity(transformOnly);
+    scene.getTransform(entity).position[1] = 5.0f;
+    scene.getTransform(other).position[1] = 7.0f;
+    EXPECT_THROW(scene.getBounds(entity), std::runtime_error);
+
+    scene.addComponents(entity, componentBit(SceneComponent::Bounds));
+    EXPECT_EQ(scene.getComponents(entity), transformOnly | componentBit(SceneComponent::Bounds));
+    EXPECT_FLOAT_EQ(scene.getTransform(entity).position[1], 5.0f);
+    EXPECT_FLOAT_EQ(scene.getTransform(other).position[1], 7.0f);
+
+    BoundsComponent bounds;
+    bounds.center[2] = -3.0f;
+    bounds.radius = 2.0f;
+    scene.setBounds(entity, bounds);
+    EXPECT_FLOAT_EQ(scene.getBounds(entity).center[2], -3.0f);
+    EXPECT_FLOAT_EQ(scene.getBounds(entity).radius, 2.0f);
+
+    scene.removeComponents(entity, componentBit(SceneComponent::Bounds));
+    EXPECT_THROW(scene.getBounds(entity), std::runtime_error);
+    EXPECT_EQ(scene.getStats().archetypeCount, 2u);
+    EXPECT_THROW(scene.createEntity(1u << 31), std::runtime_error);
+}
+
+TEST(SceneTest, IteratesMatchingChunksInParallel) {
+    Scene scene;
+    for (uint32_t i = 0; i < 2000; i++) {
+        scene.createEntity(RENDERABLE_COMPONENTS);
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        scene.createEntity(componentBit(SceneComponent::Transform));
+    }
+
+    ThreadPool pool(4);
+    std::atomic<uint32_t> visited{ 0 };
+    scene.parallelForEachChunk(pool, componentBit(SceneComponent::Transform), [&](SceneChunk& chunk, uint32_t) {
+        for (uint32_t i = 0; i < chunk.count; i++) {
+            chunk.transforms[i].position[0] += 1.0f;
+        }
+        visited += chunk.count;
+    });
+    EXPECT_EQ(visited.load(), 2100u);
+
+    // Only the renderable archetype has bounds
+    uint32_t withBounds = 0;
+    scene.forEachChunk(componentBit(SceneComponent::Bounds), [&](SceneChunk& chunk) {
+        EXPECT_TRUE(chunk.has(RENDERABLE_COMPONENTS));
+        EXPECT_FLOAT_EQ(chunk.transforms[chunk.count - 1].position[0], 1.0f);
+        withBounds += chunk.count;
+    });
+    EXPECT_EQ(withBounds, 2000u);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "utils/ShaderWatcher.h"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+/**
+ * Unit tests for ShaderWatcher
+ * A small shell script stands in for glslc: it copies the source to the
+ * output unless the source contains "error"
+ */
+
+namespace {
+
+namespace fs = std::filesystem;
+
+void writeFile(const fs::path& path, const std::string& text) {
+    std::ofstream file(path, std::ios::trunc);
+    file << text;
+}
+
+std::string readFile(const fs::path& path) {
+    std::ifstream file(path);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+std::vector<ShaderCompileResult> waitForResults(ShaderWatcher& watcher, size_t count) {
+    std::vector<ShaderCompileResult> results;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (results.size() < count && std::chrono::steady_clock::now() < deadline) {
+        for (auto& result : watcher.takeResults()) {
+            results.push_back(std::move(result));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return results;
+}
+
+class ShaderWatcherTest : public ::testing::Test {
+protected:
+    fs::path root;
+    fs::path sourceDir;
+    fs::path binaryDir;
+    fs::path compiler;
+
+    void SetUp() override {
+#ifndef __linux__
+        GTEST_SKIP() << "Fake compiler is a POSIX shell script";
+#endif
+        root = fs::temp_directory_path() / ("shader_watcher_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+        fs::remove_all(root);
+        sourceDir = root / "shaders";
+        binaryDir = root / "bin";
+        fs::create_directories(sourceDir);
+
+        // $1 = source, $2 = -o, $3 = output
+        compiler = root / "fakeglslc.sh";
+        writeFile(compiler, "#!/bin/sh\nif grep -q error \"$1\"; then echo \"$1: syntax error\"; exit 1; fi\ncp \"$1\" \"$3\"\n");
+        fs::permissions(compiler, fs::perms::owner_all);
+    }
+
+    void TearDown() override {
+        std::error_code error;
+        fs::remove_all(root, error);
+    }
+};
+
+}
+
+TEST(ShaderWatcherStaticTest, RecognizesShaderStages) {
+    EXPECT_TRUE(ShaderWatcher::isShaderSource("triangle.vert"));
+    EXPECT_TRUE(ShaderWatcher::isShaderSource("cull.comp"));
+    EXPECT_FALSE(ShaderWatcher::isShaderSource("triangle.vert.spv"));
+    EXPECT_FALSE(ShaderWatcher::isShaderSource("common.glsl.swp"));
+    EXPECT_FALSE(ShaderWatcher::isShaderSource("README"));
+}
+
+TEST_F(ShaderWatcherTest, RecompilesChangedSource) {
+    writeFile(sourceDir / "triangle.frag", "v1");
+
+    ShaderWatcher watcher(sourceDir.string(), binaryDir.string(), compiler.string());
+    watcher.start();
+    EXPECT_TRUE(watcher.takeResults().empty());     // Existing files are not rebuilt
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writeFile(sourceDir / "triangle.frag", "v2");
+    writeFile(sourceDir / "notes.txt", "ignored");
+
+    std::vector<ShaderCompileResult> results = waitForResults(watcher, 1);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_TRUE(results[0].success) << results[0].log;
+    EXPECT_EQ(fs::path(results[0].outputPath), binaryDir / "triangle.frag.spv");
+    EXPECT_EQ(readFile(binaryDir / "triangle.frag.spv"), "v2");
+
+    watcher.stop();
+    EXPECT_FALSE(watcher.isRunning());
+}
+
+TEST_F(ShaderWatcherTest, FailedCompileKeepsPreviousOutput) {
+    fs::create_directories(binaryDir);
+    writeFile(binaryDir / "cull.comp.spv", "good");
+
+    ShaderWatcher watcher(sourceDir.string(), binaryDir.string(), compiler.string());
+    watcher.start();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writeFile(sourceDir / "cull.comp", "error here");
+
+    std::vector<ShaderCompileResult> results = waitForResults(watcher, 1);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_FALSE(results[0].success);
+    EXPECT_NE(results[0].log.find("syntax error"), std::string::npos);
+    EXPECT_EQ(readFile(binaryDir / "cull.comp.spv"), "good");
+    EXPECT_FALSE(fs::exists(binaryDir / "cull.comp.spv.tmp"));
+}
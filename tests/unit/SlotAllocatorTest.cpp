@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include "memory/SlotAllocator.h"
+#include <set>
+#include <stdexcept>
+
+/**
+ * Unit tests for SlotAllocator
+ * Index bookkeeping behind the bindless descriptor heap
+ */
+
+TEST(SlotAllocatorTest, HandsOutUniqueSlotsUntilFull) {
+    SlotAllocator slots(100);
+
+    std::set<uint32_t> seen;
+    for (int i = 0; i < 100; i++) {
+        uint32_t slot = slots.allocate();
+        ASSERT_NE(slot, SlotAllocator::INVALID_SLOT);
+        EXPECT_LT(slot, 100u);
+        EXPECT_TRUE(seen.insert(slot).second);
+    }
+
+    EXPECT_EQ(slots.allocate(), SlotAllocator::INVALID_SLOT);
+    EXPECT_EQ(slots.getUsedCount(), 100u);
+    EXPECT_EQ(slots.getFreeCount(), 0u);
+}
+
+TEST(SlotAllocatorTest, ReusesFreedSlotsBeforeGrowing) {
+    SlotAllocator slots(16);
+
+    EXPECT_EQ(slots.allocate(), 0u);
+    EXPECT_EQ(slots.allocate(), 1u);
+    EXPECT_EQ(slots.allocate(), 2u);
+
+    slots.free(1);
+    EXPECT_FALSE(slots.isAllocated(1));
+    EXPECT_EQ(slots.allocate(), 1u);
+    EXPECT_EQ(slots.allocate(), 3u);
+
+    // Array bound shaders need only cover the slots ever used
+    EXPECT_EQ(slots.getHighWaterMark(), 4u);
+}
+
+TEST(SlotAllocatorTest, RejectsDoubleAndInvalidFree) {
+    SlotAllocator slots(4);
+
+    uint32_t slot = slots.allocate();
+    slots.free(slot);
+
+    EXPECT_THROW(slots.free(slot), std::runtime_error);
+    EXPECT_THROW(slots.free(3), std::runtime_error);
+    EXPECT_THROW(slots.free(SlotAllocator::INVALID_SLOT), std::runtime_error);
+    EXPECT_THROW(SlotAllocator(0), std::runtime_error);
+}
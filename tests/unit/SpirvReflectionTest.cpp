@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include "utils/SpirvReflection.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Unit tests for SpirvReflection
+ * Modules are assembled word by word, so no shader compiler is needed
+ */
+
+namespace {
+
+// Minimal SPIR-V assembler: opcodes and enums as in the specification
+class SpirvBuilder {
+public:
+    SpirvBuilder() : words{ 0x07230203, 0x00010000, 0, 200, 0 } {}
+
+    void op(uint32_t opcode, std::vector<uint32_t> operands) {
+        words.push_back(static_cast<uint32_t>((operands.size() + 1) << 16) | opcode);
+        words.insert(words.end(), operands.begin(), operands.end());
+    }
+
+    void opString(uint32_t opcode, std::vector<uint32_t> before, const std::string& text,
+                  std::vector<uint32_t> after = {}) {
+        std::vector<uint32_t> packed(text.size() / 4 + 1, 0);
+        std::memcpy(packed.data(), text.c_str(), text.size());
+        before.insert(before.end(), packed.begin(), packed.end());
+        before.insert(before.end(), after.begin(), after.end());
+        op(opcode, before);
+    }
+
+    void name(uint32_t id, const std::string& text) { opString(5, { id }, text); }
+    void decorate(uint32_t id, std::vector<uint32_t> decoration) {
+        decoration.insert(decoration.begin(), id);
+        op(71, decoration);
+    }
+    void memberDecorate(uint32_t id, uint32_t member, std::vector<uint32_t> decoration) {
+        decoration.insert(decoration.begin(), { id, member });
+        op(72, decoration);
+    }
+
+    // Shared scalar and vector types: 2 float, 3 vec4, 4 vec3, 5 uint, 6 mat4, 7 int, 8 bool
+    void declareBasicTypes() {
+        op(22, { 2, 32 });
+        op(23, { 3, 2, 4 });
+        op(23, { 4, 2, 3 });
+        op(21, { 5, 32, 0 });
+        op(24, { 6, 3, 4 });
+        op(21, { 7, 32, 1 });
+        op(20, { 8 });
+    }
+
+    // Uniform block { mat4 } at (set, binding) through ids 10..12
+    void declareUniformBuffer(uint32_t set, uint32_t binding) {
+        op(30, { 10, 6 });
+        decorate(10, { 2 });                    // Block
+        memberDecorate(10, 0, { 35, 0 });       // Offset 0
+        memberDecorate(10, 0, { 7, 16 });       // MatrixStride 16
+        name(10, "Camera");
+        op(32, { 11, 2, 10 });                  // Uniform pointer
+        op(59, { 11, 12, 2 });
+        decorate(12, { 34, set });
+        decorate(12, { 33, binding });
+    }
+
+    std::vector<uint32_t> words;
+};
+
+std::vector<uint32_t> buildVertexShader() {
+    SpirvBuilder b;
+    b.opString(15, { 0, 1 }, "main", { 27, 29, 32 });  // Vertex entry point
+    b.declareBasicTypes();
+    b.declareUniformBuffer(0, 0);
+
+    // sampler2D textures[4] at set 1, binding 2
+    b.op(25, { 13, 2, 1, 0, 0, 0, 1, 0 });
+    b.op(27, { 14, 13 });
+    b.op(43, { 5, 15, 4 });
+    b.op(28, { 16, 14, 15 });
+    b.op(32, { 17, 0, 16 });
+    b.op(59, { 17, 18, 0 });
+    b.decorate(18, { 34, 1 });
+    b.decorate(18, { 33, 2 });
+    b.name(18, "textures");
+
+    // buffer { vec4 data[]; } at set 0, binding 1
+    b.op(29, { 19, 3 });
+    b.decorate(19, { 6, 16 });
+    b.op(30, { 20, 19 });
+    b.decorate(20, { 2 });
+    b.memberDecorate(20, 0, { 35, 0 });
+    b.op(32, { 21, 12, 20 });
+    b.op(59, { 21, 22, 12 });
+    b.decorate(22, { 34, 0 });
+    b.decorate(22, { 33, 1 });
+
+    // push_constant { vec4 tint; uint materialId; }
+    b.op(30, { 23, 3, 5 });
+    b.decorate(23, { 2 });
+    b.memberDecorate(23, 0, { 35, 0 });
+    b.memberDecorate(23, 1, { 35, 16 });
+    b.op(32, { 24, 9, 23 });
+    b.op(59, { 24, 25, 9 });
+
+    // in vec3 inPosition (0), in vec4 inColor (1), gl_VertexIndex
+    b.op(32, { 26, 1, 4 });
+    b.op(59, { 26, 27, 1 });
+    b.decorate(27, { 30, 0 });
+    b.name(27, "inPosition");
+    b.op(32, { 28, 1, 3 });
+    b.op(59, { 28, 29, 1 });
+    b.decorate(29, { 30, 1 });
+    b.op(32, { 30, 1, 7 });
+    b.op(59, { 30, 32, 1 });
+    b.decorate(32, { 11, 42 });
+
+    // layout(constant_id = 5) const uint LIGHTS = 7; constant_id = 3 bool = true
+    b.op(50, { 5, 33, 7 });
+    b.decorate(33, { 1, 5 });
+    b.name(33, "LIGHTS");
+    b.op(48, { 8, 34 });
+    b.decorate(34, { 1, 3 });
+
+    return b.words;
+}
+
+std::vector<uint32_t> buildFragmentShader(uint32_t uniformBinding) {
+    SpirvBuilder b;
+    b.opString(15, { 4, 1 }, "main");
+    b.declareBasicTypes();
+    b.declareUniformBuffer(0, uniformBinding);
+    return b.words;
+}
+
+}
+
+TEST(SpirvReflectionTest, ReflectsDescriptorsPushConstantsAndInputs) {
+    std::vector<uint32_t> code = buildVertexShader();
+    ShaderReflection reflection = SpirvReflection::reflect(code.data(), code.size());
+
+    EXPECT_EQ(reflection.stageFlags, SPIRV_STAGE_VERTEX);
+    EXPECT_EQ(reflection.entryPoint, "main");
+    EXPECT_EQ(reflection.getSetCount(), 2u);
+
+    ASSERT_EQ(reflection.bindings.size(), 3u);
+    EXPECT_EQ(reflection.bindings[0].type, SpirvDescriptorType::UniformBuffer);
+    EXPECT_EQ(reflection.bindings[0].name, "Camera");
+    EXPECT_EQ(reflection.bindings[1].binding, 1u);
+    EXPECT_EQ(reflection.bindings[1].type, SpirvDescriptorType::StorageBuffer);
+    EXPECT_EQ(reflection.bindings[2].set, 1u);
+    EXPECT_EQ(reflection.bindings[2].binding, 2u);
+    EXPECT_EQ(reflection.bindings[2].type, SpirvDescriptorType::CombinedImageSampler);
+    EXPECT_EQ(reflection.bindings[2].count, 4u);
+    EXPECT_EQ(reflection.bindings[2].name, "textures");
+
+    ASSERT_EQ(reflection.pushConstants.size(), 1u);
+    EXPECT_EQ(reflection.pushConstants[0].offset, 0u);
+    EXPECT_EQ(reflection.pushConstants[0].size, 20u);
+
+    // Built-ins are not vertex attributes
+    ASSERT_EQ(reflection.vertexInputs.size(), 2u);
+    EXPECT_EQ(reflection.vertexInputs[0].name, "inPosition");
+    EXPECT_EQ(reflection.vertexInputs[0].componentCount, 3u);
+    EXPECT_EQ(reflection.vertexInputs[0].type, SpirvScalarType::Float);
+    EXPECT_EQ(reflection.vertexInputs[1].location, 1u);
+    EXPECT_EQ(reflection.vertexInputs[1].componentCount, 4u);
+
+    ASSERT_EQ(reflection.specConstants.size(), 2u);
+    EXPECT_EQ(reflection.specConstants[0].specId, 3u);
+    EXPECT_EQ(reflection.specConstants[0].type, SpirvScalarType::Bool);
+    EXPECT_EQ(reflection.specConstants[0].defaultValue, 1u);
+    EXPECT_EQ(reflection.specConstants[1].name, "LIGHTS");
+    EXPECT_EQ(reflection.specConstants[1].defaultValue, 7u);
+}
+
+TEST(SpirvReflectionTest, MergesStagesOfOnePipeline) {
+    std::vector<uint32_t> vertex = buildVertexShader();
+    std::vector<uint32_t> fragment = buildFragmentShader(0);
+
+    ShaderReflection merged = SpirvReflection::merge({
+        SpirvReflection::reflect(vertex.data(), vertex.size()),
+        SpirvReflection::reflect(fragment.data(), fragment.size())
+    });
+
+    EXPECT_EQ(merged.stageFlags, SPIRV_STAGE_VERTEX | SPIRV_STAGE_FRAGMENT);
+    ASSERT_EQ(merged.bindings.size(), 3u);
+    EXPECT_EQ(merged.bindings[0].stageFlags, SPIRV_STAGE_VERTEX | SPIRV_STAGE_FRAGMENT);
+    EXPECT_EQ(merged.bindings[1].stageFlags, SPIRV_STAGE_VERTEX);
+    EXPECT_EQ(merged.vertexInputs.size(), 2u);
+
+    // Same slot, different descriptor type
+    std::vector<uint32_t> conflicting = buildFragmentShader(1);
+    EXPECT_THROW(SpirvReflection::merge({
+        SpirvReflection::reflect(vertex.data(), vertex.size()),
+        SpirvReflection::reflect(conflicting.data(), conflicting.size())
+    }), std::runtime_error);
+}
+
+TEST(SpirvReflectionTest, ReadsComputeLocalSize) {
+    SpirvBuilder b;
+    b.opString(15, { 5, 1 }, "main");
+    b.op(16, { 1, 17, 64, 2, 1 });
+
+    ShaderReflection reflection = SpirvReflection::reflect(b.words.data(), b.words.size());
+    EXPECT_EQ(reflection.stageFlags, SPIRV_STAGE_COMPUTE);
+    EXPECT_EQ(reflection.localSize[0], 64u);
+    EXPECT_EQ(reflection.localSize[1], 2u);
+    EXPECT_EQ(reflection.localSize[2], 1u);
+    EXPECT_TRUE(reflection.bindings.empty());
+}
+
+TEST(SpirvReflectionTest, RejectsMalformedModules) {
+    std::vector<char> notSpirv = { 'G', 'L', 'S', 'L' };
+    EXPECT_THROW(SpirvReflection::reflect(notSpirv), std::runtime_error);
+
+    std::vector<uint32_t> code = buildVertexShader();
+    code[5] = (1000u << 16) | 15;       // Length runs past the end
+    EXPECT_THROW(SpirvReflection::reflect(code.data(), code.size()), std::runtime_error);
+
+    SpirvBuilder noEntryPoint;
+    noEntryPoint.declareBasicTypes();
+    EXPECT_THROW(SpirvReflection::reflect(noEntryPoint.words.data(), noEntryPoint.words.size()), std::runtime_error);
+}
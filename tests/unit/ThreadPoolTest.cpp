@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "utils/ThreadPool.h"
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * Unit tests for ThreadPool
+ * Covers index coverage, thread slot stability and error propagation
+ */
+
+TEST(ThreadPoolTest, VisitsEveryIndexExactlyOnce) {
+    ThreadPool pool(4);
+
+    std::vector<std::atomic<int>> visits(10000);
+    pool.parallelFor(static_cast<uint32_t>(visits.size()), [&](uint32_t index, uint32_t) {
+        visits[index]++;
+    });
+
+    for (const auto& count : visits) {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+TEST(ThreadPoolTest, RangesRespectGrain) {
+    ThreadPool pool(3);
+
+    std::atomic<uint32_t> total{0};
+    std::atomic<uint32_t> oversized{0};
+    pool.parallelFor(1000, 64, [&](uint32_t begin, uint32_t end, uint32_t) {
+        if (end - begin > 64) {
+            oversized++;
+        }
+        total += end - begin;
+    });
+
+    EXPECT_EQ(total.load(), 1000u);
+    EXPECT_EQ(oversized.load(), 0u);
+}
+
+TEST(ThreadPoolTest, ThreadSlotsAreStablePerThread) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.getThreadSlotCount(), 5u);
+    EXPECT_EQ(pool.getCurrentThreadSlot(), pool.getWorkerCount());
+
+    std::mutex mutex;
+    std::vector<std::set<std::thread::id>> threadsPerSlot(pool.getThreadSlotCount());
+
+    for (int frame = 0; frame < 20; frame++) {
+        pool.parallelFor(256, [&](uint32_t, uint32_t slot) {
+            ASSERT_LT(slot, pool.getThreadSlotCount());
+            std::lock_guard<std::mutex> lock(mutex);
+            threadsPerSlot[slot].insert(std::this_thread::get_id());
+        });
+    }
+
+    // A slot must never be shared by two threads, or per-slot resources would race
+    for (const auto& threads : threadsPerSlot) {
+        EXPECT_LE(threads.size(), 1u);
+    }
+}
+
+TEST(ThreadPoolTest, RethrowsWorkerExceptions) {
+    ThreadPool pool(2);
+
+    EXPECT_THROW(pool.parallelFor(100, [](uint32_t index, uint32_t) {
+        if (index == 57) {
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+
+    // Pool stays usable afterwards
+    std::atomic<int> count{0};
+    pool.parallelFor(10, [&](uint32_t, uint32_t) { count++; });
+    EXPECT_EQ(count.load(), 10);
+}
+
+TEST(ThreadPoolTest, NestedParallelForCompletes) {
+    ThreadPool pool(2);
+
+    std::atomic<int> count{0};
+    pool.parallelFor(8, [&](uint32_t, uint32_t) {
+        pool.parallelFor(8, [&](uint32_t, uint32_t) { count++; });
+    });
+
+    EXPECT_EQ(count.load(), 64);
+}
+
+TEST(ThreadPoolTest, SubmitRunsInBackground) {
+    ThreadPool pool(2);
+
+    std::atomic<bool> ran{false};
+    auto future = pool.submit([&] { ran = true; });
+    future.get();
+    EXPECT_TRUE(ran.load());
+
+    auto failing = pool.submit([] { throw std::runtime_error("background failure"); });
+    EXPECT_THROW(failing.get(), std::runtime_error);
+}
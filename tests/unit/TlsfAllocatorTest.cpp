@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "memory/TlsfAllocator.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+/**
+ * Unit tests for TlsfAllocator
+ * Pure offset bookkeeping - no GPU memory involved
+ */
+
+TEST(TlsfAllocatorTest, StartsEmpty) {
+    TlsfAllocator allocator(1024 * 1024);
+
+    EXPECT_TRUE(allocator.isEmpty());
+    EXPECT_EQ(allocator.getUsedBytes(), 0u);
+    EXPECT_EQ(allocator.getFreeBytes(), 1024u * 1024u);
+    EXPECT_EQ(allocator.getLargestFreeRegion(), 1024u * 1024u);
+    EXPECT_EQ(allocator.getFreeRegionCount(), 1u);
+}
+
+TEST(TlsfAllocatorTest, AllocationsDoNotOverlap) {
+    TlsfAllocator allocator(1024 * 1024);
+
+    std::vector<TlsfAllocator::Allocation> allocations;
+    for (int i = 0; i < 100; i++) {
+        auto allocation = allocator.allocate(1000 + i * 10, 16);
+        ASSERT_TRUE(allocation.isValid());
+        allocations.push_back(allocation);
+    }
+
+    std::sort(allocations.begin(), allocations.end(),
+        [](const auto& a, const auto& b) { return a.offset < b.offset; });
+
+    for (size_t i = 1; i < allocations.size(); i++) {
+        EXPECT_GE(allocations[i].offset, allocations[i - 1].offset + allocations[i - 1].size);
+    }
+}
+
+TEST(TlsfAllocatorTest, RespectsAlignment) {
+    TlsfAllocator allocator(1024 * 1024);
+
+    allocator.allocate(3);  // Misalign the next free offset
+    for (uint64_t alignment : { 4ull, 256ull, 4096ull, 65536ull }) {
+        auto allocation = allocator.allocate(100, alignment);
+        ASSERT_TRUE(allocation.isValid());
+        EXPECT_EQ(allocation.offset % alignment, 0u) << "alignment " << alignment;
+    }
+}
+
+TEST(TlsfAllocatorTest, FailsWhenFull) {
+    TlsfAllocator allocator(4096);
+
+    auto whole = allocator.allocate(4096);
+    ASSERT_TRUE(whole.isValid());
+
+    EXPECT_FALSE(allocator.allocate(1).isValid());
+    EXPECT_FALSE(allocator.allocate(8192).isValid());
+}
+
+TEST(TlsfAllocatorTest, FreeCoalescesNeighbours) {
+    TlsfAllocator allocator(64 * 1024);
+
+    auto a = allocator.allocate(16 * 1024);
+    auto b = allocator.allocate(16 * 1024);
+    auto c = allocator.allocate(16 * 1024);
+    ASSERT_TRUE(a.isValid() && b.isValid() && c.isValid());
+
+    allocator.free(a.handle);
+    allocator.free(c.handle);
+    allocator.free(b.handle);
+
+    EXPECT_TRUE(allocator.isEmpty());
+    EXPECT_EQ(allocator.getFreeRegionCount(), 1u);
+    EXPECT_EQ(allocator.getLargestFreeRegion(), 64u * 1024u);
+
+    // The full range must be usable again after coalescing
+    EXPECT_TRUE(allocator.allocate(64 * 1024).isValid());
+}
+
+TEST(TlsfAllocatorTest, DoubleFreeThrows) {
+    TlsfAllocator allocator(4096);
+
+    auto allocation = allocator.allocate(128);
+    allocator.free(allocation.handle);
+
+    EXPECT_THROW({
+        allocator.free(allocation.handle);
+    }, std::runtime_error);
+}
+
+TEST(TlsfAllocatorTest, RejectsNonPowerOfTwoAlignment) {
+    TlsfAllocator allocator(4096);
+
+    EXPECT_THROW({
+        allocator.allocate(64, 48);
+    }, std::runtime_error);
+}
+
+TEST(TlsfAllocatorTest, ForEachVisitsLiveAllocationsInOrder) {
+    TlsfAllocator allocator(64 * 1024);
+
+    auto a = allocator.allocate(1024);
+    auto b = allocator.allocate(1024);
+    auto c = allocator.allocate(1024);
+    allocator.free(b.handle);
+
+    std::vector<uint32_t> visited;
+    uint64_t lastOffset = 0;
+    allocator.forEachAllocation([&](uint32_t handle, uint64_t offset, uint64_t) {
+        EXPECT_GE(offset, lastOffset);
+        lastOffset = offset;
+        visited.push_back(handle);
+    });
+
+    ASSERT_EQ(visited.size(), 2u);
+    EXPECT_EQ(visited[0], a.handle);
+    EXPECT_EQ(visited[1], c.handle);
+}
+
+TEST(TlsfAllocatorTest, RandomChurnKeepsAccounting) {
+    TlsfAllocator allocator(16 * 1024 * 1024);
+    std::mt19937 rng(42);
+    std::vector<TlsfAllocator::Allocation> live;
+
+    for (int i = 0; i < 10000; i++) {
+        if (live.empty() || rng() % 3 != 0) {
+            auto allocation = allocator.allocate(1 + rng() % 20000, 1ull << (rng() % 9));
+            if (allocation.isValid()) {
+                live.push_back(allocation);
+            }
+        } else {
+            size_t index = rng() % live.size();
+            allocator.free(live[index].handle);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    uint64_t used = 0;
+    for (const auto& allocation : live) {
+        used += allocation.size;
+    }
+    EXPECT_EQ(allocator.getUsedBytes(), used);
+    EXPECT_EQ(allocator.getAllocationCount(), live.size());
+
+    for (const auto& allocation : live) {
+        allocator.free(allocation.handle);
+    }
+    EXPECT_TRUE(allocator.isEmpty());
+    EXPECT_EQ(allocator.getFreeRegionCount(), 1u);
+}